@@ -15,11 +15,18 @@
 
 //int Noise3DTexSize = 64;
 //GLubyte* Noise3DTexPtr;
+extern const char* Noise3DCacheFile;
 
 // don't use this until I know what I'm doing
+// loads the volume from Noise3DCacheFile, baking it if needed
 void CreateNoise3D();
+// uses DR::NoiseEngine, see noise_engine.h
 void make3DNoiseTexture();
-void init3DNoiseTexture(int texSize, GLubyte* texPtr);
+// original version using noise3(), texPtr must hold texSize^3 * 4 bytes
+void make3DNoiseTextureScalar(int texSize, GLubyte* texPtr);
+// upload texSize^3 RGBA texels to the bound 3D texture
+// texPtr still belongs to the caller
+void init3DNoiseTexture(int texSize, const GLubyte* texPtr);
 
 void SetNoiseFrequency(int frequency);
 double noise1(double arg);
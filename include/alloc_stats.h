@@ -0,0 +1,44 @@
+/*
+ * alloc_stats.h
+ *
+ * Counts of heap allocations, from replacing the global operator new and
+ * delete.  Take a snapshot before and after something and subtract.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ALLOC_STATS_H_
+#define ALLOC_STATS_H_
+
+#include <cstddef>
+#include <ostream>
+
+namespace DR {
+
+struct AllocStats {
+	AllocStats() : allocs(0), frees(0), bytes(0) {}
+
+	// totals since startup
+	static AllocStats now();
+
+	AllocStats operator-(const AllocStats& before) const {
+		AllocStats d;
+		d.allocs = allocs - before.allocs;
+		d.frees = frees - before.frees;
+		d.bytes = bytes - before.bytes;
+		return d;
+	}
+
+	// calls to operator new / new[]
+	unsigned long long allocs;
+	// calls to operator delete / delete[] with non NULL pointers
+	unsigned long long frees;
+	// bytes requested from operator new
+	unsigned long long bytes;
+};
+
+std::ostream& operator<<(std::ostream& out, const AllocStats& s);
+
+} // end namespace DR
+
+#endif /* ALLOC_STATS_H_ */
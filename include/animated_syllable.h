@@ -32,14 +32,15 @@ public:
 	 * speed:  magnitude of velocity vector
 	 * which_surface: which face (or sides can be selected),
 	 * possible values = -1 -> all, BASE, EXTRUDED, SIDES
+	 * visible_only: only from meshlets the last cull() left, see sample_polygon()
 	 */
 	void get_particles(DR::ParticleSet& part_set, GLfloat speed=1.0,
-			int num_per_face=-1, int which_surface=-1);
+			int num_per_face=-1, int which_surface=-1, bool visible_only=false);
 
 //	void get_particles_verts(DR::ParticleSet& part_set, GLfloat speed=1.0);
 
 	void get_beams(DR::LightBeamSet& beam_set, GLfloat speed=1.0,
-			int num_per_face=-1, int which_surface=-1);
+			int num_per_face=-1, int which_surface=-1, bool visible_only=false);
 
 protected:
 	// when generating a new beam, mark the index of the
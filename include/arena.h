@@ -0,0 +1,143 @@
+/*
+ * arena.h
+ *
+ * Bump allocator for mesh construction.  A mesh puts its polygons,
+ * regions and index arrays in one Arena, and frees them all at once
+ * with reset() instead of one delete per object.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace DR {
+
+/**
+ * Meshes created while this is true allocate from their own Arena.
+ * Set false for the old one new per object behavior, for comparing.
+ */
+extern bool use_mesh_arenas;
+
+class Arena {
+public:
+	// param: block_size - bytes per block, bigger requests get their own block
+	explicit Arena(size_t block_size=64*1024);
+	~Arena();
+
+	/**
+	 * Raw memory, freed by reset() or the destructor.
+	 * align must be a power of 2.
+	 */
+	void* allocate(size_t bytes, size_t align=alignof(std::max_align_t));
+
+	// uninitialized array of n T
+	template<typename T>
+	T* allocate_array(size_t n) {
+		return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+	}
+
+	/**
+	 * Construct a T in the arena.  Its destructor is run by reset(),
+	 * newest first, unless T is trivially destructible.
+	 */
+	template<typename T, typename... Args>
+	T* create(Args&&... args) {
+		void *mem = allocate(sizeof(T), alignof(T));
+		T *obj = new (mem) T(std::forward<Args>(args)...);
+		if(!std::is_trivially_destructible<T>::value) {
+			add_finalizer(obj, &destroy<T>);
+		}
+		return obj;
+	}
+
+	/**
+	 * Destroy everything created and make all memory available again.
+	 * Blocks are kept for reuse, so rebuilding the same mesh doesn't
+	 * go back to the heap.
+	 */
+	void reset();
+
+	// bytes handed out since the last reset
+	size_t bytes_used() const { return used; }
+	// bytes held in blocks
+	size_t bytes_reserved() const { return reserved; }
+	size_t num_blocks() const;
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	struct Block {
+		Block *next;
+		size_t size;
+		// data follows
+		char* data() { return reinterpret_cast<char*>(this + 1); }
+	};
+	struct Finalizer {
+		void (*fn)(void*);
+		void *obj;
+		Finalizer *next;
+	};
+	template<typename T>
+	static void destroy(void *p) { static_cast<T*>(p)->~T(); }
+
+	void add_finalizer(void *obj, void (*fn)(void*));
+	// make current a block with at least bytes + align free
+	void next_block(size_t bytes, size_t align);
+
+	size_t block_size;
+	Block *first;
+	Block *current;
+	char *cur;
+	char *end;
+	Finalizer *finalizers;
+	size_t used;
+	size_t reserved;
+
+	Arena(const Arena&);
+	Arena& operator=(const Arena&);
+};
+
+/**
+ * Standard allocator on an Arena, for containers owned by a mesh.
+ * deallocate() is a no-op, memory comes back at Arena::reset().
+ * With a NULL arena it uses the heap, so the same container type works
+ * for meshes that aren't using an arena.
+ */
+template<typename T>
+struct ArenaAllocator {
+	typedef T value_type;
+
+	ArenaAllocator(Arena *arena=NULL) : arena(arena) {}
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t n) {
+		if(arena) {
+			return arena->allocate_array<T>(n);
+		}
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+	void deallocate(T *p, size_t) {
+		if(!arena) {
+			::operator delete(p);
+		}
+	}
+
+	Arena *arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+} // end namespace DR
+
+#endif /* ARENA_H_ */
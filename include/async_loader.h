@@ -0,0 +1,131 @@
+/*
+ * async_loader.h
+ *
+ * Models parsed and built on worker threads while the main loop keeps
+ * drawing.  Each job's GL uploads are left for the main thread, a few
+ * a frame, so no frame stalls on a whole model.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef ASYNC_LOADER_H_
+#define ASYNC_LOADER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+/**
+ * Work for an AsyncLoader, and the handle to see it through: poll
+ * ready() as with a future, then take what it built.
+ */
+class LoadJob {
+public:
+	enum State { WAITING, QUEUED, LOADING, LOADED, READY, FAILED };
+
+	LoadJob(const std::string& name) : name(name), st(WAITING), prereqs(0) {}
+	virtual ~LoadJob() {}
+
+	/**
+	 * On a worker thread: parse and build, no GL calls.  false on failure,
+	 * and jobs after this one fail too.
+	 */
+	virtual bool load() = 0;
+	/**
+	 * On the main thread once loaded, with a current context.  No more
+	 * than budget uploads, taking those done from budget.  True once
+	 * there are none left, else it's called again next frame.
+	 */
+	virtual bool upload(int& budget) { return true; }
+
+	/**
+	 * Don't load until prereq has.  Call before submitting this job, with
+	 * prereq from the same loader.
+	 */
+	void after(LoadJob *prereq) { waits_for.push_back(prereq); }
+
+	const std::string& get_name() const { return name; }
+	State state() const { return (State)st.load(); }
+	// loaded and uploaded, what it built is the main thread's
+	bool ready() const { return state() == READY; }
+	bool failed() const { return state() == FAILED; }
+	bool done() const { return ready() || failed(); }
+
+private:
+	friend class AsyncLoader;
+	std::string name;
+	std::atomic<int> st;
+	std::vector<LoadJob*> waits_for;
+	// jobs waiting on this one, and how many this one still waits on
+	std::vector<LoadJob*> dependents;
+	int prereqs;
+
+	LoadJob(const LoadJob&);
+	LoadJob& operator=(const LoadJob&);
+};
+
+/**
+ * Runs LoadJobs on its workers, first submitted first, and their uploads
+ * when pumped from the main thread.
+ */
+class AsyncLoader {
+public:
+	// 0 threads for one less than the cores, at least 1
+	AsyncLoader(int num_threads=0);
+	// jobs loading finish, those queued never start, all are deleted
+	~AsyncLoader();
+
+	// takes job, which stays good as its handle until the loader goes
+	LoadJob* submit(LoadJob *job);
+	/**
+	 * Each frame on the main thread: uploads for loaded jobs, in the order
+	 * they loaded, no more than max_uploads.
+	 * return: jobs that became ready or failed
+	 */
+	int pump(int max_uploads=2);
+	// pump until job is done, for when there's nothing to draw without it
+	void wait(LoadJob *job);
+	// wait for them all
+	void finish();
+
+	size_t num_jobs() const { return jobs.size(); }
+	size_t num_done() const;
+	// 0 to 1, by jobs done, 1 with none submitted
+	float progress() const;
+	bool is_done() const { return num_done() == jobs.size(); }
+	int num_threads() const { return workers.size(); }
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	std::vector<std::thread> workers;
+	// guards queue, loaded, stopping and the jobs' dependents and prereqs
+	std::mutex lock;
+	std::condition_variable work_ready, job_loaded;
+	std::deque<LoadJob*> queue;
+	// loaded, and failed, for the main thread to take
+	std::deque<LoadJob*> loaded;
+	bool stopping;
+	// the main thread's: every job submitted, and those uploading
+	std::vector<LoadJob*> jobs;
+	std::deque<LoadJob*> uploading;
+
+	void work();
+	// with lock held
+	void finished_loading(LoadJob *job, bool ok);
+
+	AsyncLoader(const AsyncLoader&);
+	AsyncLoader& operator=(const AsyncLoader&);
+};
+
+} // end namespace DR
+
+#endif /* ASYNC_LOADER_H_ */
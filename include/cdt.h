@@ -0,0 +1,155 @@
+/*
+ * cdt.h
+ *
+ * Constrained Delaunay triangulation of points and segments in the plane,
+ * with Ruppert style refinement for a minimum angle and a maximum area.
+ * Does in process what export_poly_file -> triangle -> triangle_to_obj.py
+ * did for re-tessellating a face, see Syllable3D::retessellate_base.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CDT_H_
+#define CDT_H_
+
+#include "linalg.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+struct CDTOptions {
+	CDTOptions() : min_angle(0), max_area(0), max_steiner(2000000) {}
+	// degrees, 0 -> no quality refinement, like triangle's -q
+	// clamped to MAX_MIN_ANGLE, above that refinement may not terminate
+	double min_angle;
+	// 0 -> no limit, like triangle's -a
+	double max_area;
+	// stop refining after adding this many points
+	size_t max_steiner;
+};
+
+struct CDTMesh {
+	// the added points first, in order, then points added by refinement
+	std::vector<linalg::Vec2d> points;
+	// 3 indices into points per triangle, counter clockwise
+	std::vector<GLint> triangles;
+	size_t num_triangles() const { return triangles.size() / 3; }
+	void clear() { points.clear(); triangles.clear(); }
+};
+
+/**
+ * Add points, and segments or closed loops between them, then triangulate().
+ * The output covers everything inside an odd number of loops, so
+ * inner loops are holes and loops inside holes are filled again.
+ * Crossing segments are split where they cross, duplicate points merge.
+ * With no loops at all, the whole convex hull is triangulated, and refinement
+ * doesn't grow it.
+ */
+class CDT {
+public:
+	static const double MAX_MIN_ANGLE;
+
+	CDT() {}
+	// returns the index of the point in CDTMesh::points
+	GLint add_point(double x, double y);
+	void add_segment(GLint a, GLint b);
+	// segments between n points and back to the first
+	void add_loop(const GLint *pts, size_t n);
+	void clear();
+
+	void triangulate(CDTMesh& out, const CDTOptions& opts=CDTOptions());
+
+	// prints "!=:" lines on failure
+	static void test();
+	static void bench();
+
+private:
+	struct Tri {
+		// counter clockwise
+		GLint v[3];
+		// n[i] is the neighbor across the edge opposite v[i], -1 if none
+		GLint n[3];
+		// SEGMENT and BOUNDARY flags of the edge opposite v[i]
+		unsigned char c[3];
+		bool inside;
+	};
+	// constrained edge, and part of a loop, so counted for inside
+	enum { SEGMENT = 1, BOUNDARY = 2 };
+	struct Segment {
+		GLint a, b;
+		bool boundary;
+	};
+	enum Where { INSIDE, ON_EDGE, ON_VERTEX, BLOCKED };
+
+	// input
+	std::vector<linalg::Vec2d> input;
+	std::vector<Segment> segments;
+
+	// working triangulation, the first 3 points are the enclosing triangle
+	std::vector<linalg::Vec2d> pts;
+	std::vector<Tri> tris;
+	// some triangle using each point
+	std::vector<GLint> vert_tri;
+	// flips still to check after an insertion, (tri, edge)
+	std::vector<GLint> flip_stack;
+
+	void init_super();
+	GLint new_tri(GLint a, GLint b, GLint c, bool inside);
+	void set_neighbor(GLint t, GLint old_nb, GLint new_nb);
+	GLint edge_to(GLint t, GLint nb) const;
+
+	/**
+	 * Walk from start to the triangle containing p.  With stop_at_segments
+	 * the walk doesn't cross segments, returning BLOCKED and the segment
+	 * in tri, edge.  For ON_VERTEX, edge is the vertex's index in tri.
+	 */
+	Where locate(const linalg::Vec2d& p, GLint start, bool stop_at_segments,
+			GLint& tri, GLint& edge) const;
+	// returns the point, an existing one if p is on it
+	GLint insert_point(const linalg::Vec2d& p, GLint start);
+	GLint insert_in_tri(const linalg::Vec2d& p, GLint t);
+	GLint insert_on_edge(const linalg::Vec2d& p, GLint t, GLint e);
+	void legalize();
+	void flip(GLint t, GLint e);
+
+	// the tri and edge index going a -> b counter clockwise, false if no edge
+	bool find_edge(GLint a, GLint b, GLint& tri, GLint& edge) const;
+	// boundary toggles, so an edge in 2 loops is not a boundary
+	void set_segment(GLint t, GLint e, bool boundary);
+	void insert_segment(GLint a, GLint b, bool boundary);
+
+	// marks Tri::inside by counting segments crossed from outside
+	void classify();
+
+	// refinement state
+	struct BadTri {
+		GLint t;
+		GLint v[3];
+	};
+	// worst allowed circumradius^2 / shortest edge^2, 0 -> no quality
+	double max_ratio2;
+	double max_area;
+	// edges shorter than this aren't refined, guards against input noise
+	double min_len2;
+	// segment endpoint pairs to split
+	std::vector<GLint> split_queue;
+	// FIFO from bad_head
+	std::vector<BadTri> bad;
+	size_t bad_head;
+
+	void refine(const CDTOptions& opts);
+	bool encroached(GLint t, GLint e) const;
+	bool is_bad(GLint t) const;
+	void push_bad(GLint t);
+	// queues bad triangles around v, and segments v encroaches
+	void check_around(GLint v);
+	// queues segments p would encroach if inserted in t, returns how many
+	int encroached_by(const linalg::Vec2d& p, GLint t);
+	GLint split_segment(GLint t, GLint e);
+};
+
+} // end namespace DR
+
+#endif /* CDT_H_ */
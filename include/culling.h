@@ -0,0 +1,101 @@
+/*
+ * culling.h
+ *
+ * Bounding volumes, view frustum tests, and normal cones for skipping
+ * groups of polygons that all face away from the eye.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CULLING_H_
+#define CULLING_H_
+
+#include "dr_util.h"
+#include "linalg.h"
+#include "poly.h"
+
+#include <vector>
+#include <cstddef>
+#include <ostream>
+
+namespace DR {
+
+struct Sphere {
+	Sphere() : radius(0) {}
+	linalg::Vec3f center;
+	GLfloat radius;
+};
+
+struct Aabb {
+	linalg::Vec3f lo, hi;
+};
+
+/**
+ * Every normal is within some angle of axis, cutoff is the sine of that
+ * angle.  Cutoff > 1 when the normals spread too far to ever cull.
+ */
+struct NormalCone {
+	NormalCone() : cutoff(2) {}
+	linalg::Vec3f axis;
+	GLfloat cutoff;
+};
+
+struct CullStats {
+	CullStats() { clear(); }
+	void clear();
+	CullStats& operator+=(const CullStats& o);
+
+	size_t objects, objects_culled;
+	size_t meshlets, meshlets_frustum, meshlets_backface;
+	size_t polygons, polygons_drawn;
+};
+
+std::ostream& operator<<(std::ostream& out, const CullStats& s);
+
+// box around the points, and a sphere around the box's center
+void bounds_of(const vec3 *points, size_t n, Aabb& box, Sphere& sphere);
+// same, over verts[index[0]] .. verts[index[n - 1]]
+void bounds_of(const vec3 *verts, const GLint *index, size_t n, Aabb& box, Sphere& sphere);
+
+/**
+ * Cone around normals, all unit length.
+ */
+NormalCone normal_cone(const std::vector<linalg::Vec3f>& normals);
+
+/**
+ * True if everything inside bounds with normals in cone faces away from eye,
+ * all in the same object space.  Only right for closed meshes, where the
+ * polygons facing the eye hide the rest, and the cone is of outward normals.
+ */
+bool cone_backfacing(const Sphere& bounds, const NormalCone& cone, const linalg::Vec3f& eye);
+
+/**
+ * The 6 planes of the view volume, pointing in, in the object space of the
+ * modelview that went into clip.
+ */
+class Frustum {
+public:
+	Frustum() {}
+	// clip: projection * modelview
+	explicit Frustum(const linalg::Mat4f& clip);
+	// from the current GL projection and modelview
+	static Frustum from_gl();
+
+	bool visible(const Sphere& s) const;
+	bool visible(const Aabb& b) const;
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	linalg::Vec4f planes[6];
+};
+
+// the eye in the object space of modelview
+linalg::Vec3f eye_position(const linalg::Mat4f& modelview);
+// same, from the current GL modelview
+linalg::Vec3f eye_position();
+
+} // end namespace DR
+
+#endif /* CULLING_H_ */
@@ -10,9 +10,12 @@
 
 #include <iostream>
 #include <vector>
+#include <utility>
 
 #include "vec.h"
 #include "geo.h"
+#include "linalg.h"
+#include "overlay.h"
 
 using std::cout;
 using std::endl;
@@ -20,10 +23,8 @@ using std::vector;
 using DR::Vec;
 using DR::vec3;
 
-// a convenience typdef meant to contain just an x and y
-// no actual constraint on size, so ..
-//class Vec2: public vector<GLfloat> { };
-typedef vector<GLfloat> Vec2;
+// just an x and y, kept inline so verts2d is one flat allocation
+typedef DR::linalg::Vec2f Vec2;
 
 // anything that can be expressed as a set of vertices in 2d
 // assume incoming verts are Vecs (3d) with one component that will be ignored when
@@ -31,12 +32,6 @@ typedef vector<GLfloat> Vec2;
 class Mappable2D {
 public:
 	Mappable2D() { }
-	~Mappable2D() {
-//		for (int i = 0; i < verts3d.size(); ++i) {
-//			delete verts3d[i];
-//			delete [] verts2d[i];
-//		}
-	}
 	void add_vert(const Vec& vert) {
 //		cout << vert << endl;
 //		Vec *v = new Vec(vert);
@@ -84,6 +79,13 @@ public:
 	// y_lines -- ie longitude
 	vector<VertexSet> y_lines;
 	void render(GLfloat *color, GLfloat line_width=1.0);
+	// call after changing x_lines or y_lines, render() builds the lines again
+	void invalidate() { overlay.clear(); }
+private:
+	// line segments of the last render(), in overlay_color
+	DR::DebugOverlay overlay;
+	GLfloat overlay_color[3];
+	void build_overlay(GLfloat *color);
 };
 
 // maps vertices from original mappable2d, contained in a unit space
@@ -104,8 +106,10 @@ public:
 	// add a unit space to be mapped
 	// return:  index into sets of vertices
 	//          and normals produced by mapping
+	// unit_space is moved in, callers that are done with theirs
+	// should pass std::move(space)
 	int add_unit_space(UnitSpace2D unit_space) {
-		unit_spaces.push_back(unit_space);
+		unit_spaces.push_back(std::move(unit_space));
 		vertex_sets.push_back(VertexSet());
 		normal_sets.push_back(NormalSet());
 		return unit_spaces.size() - 1;
@@ -17,6 +17,12 @@ extern "C" {
 #include "glm.h"
 }
 #include "poly.h"
+#include "lod.h"
+#include "culling.h"
+#include "meshlet.h"
+#include "mesh_buffer.h"
+#include "overlay.h"
+#include "uniform_blocks.h"
 
 #include <vector>
 
@@ -30,6 +36,10 @@ public:
 	DrGlmModel();
 	~DrGlmModel();
 	void init(GLMmodel *glm_model);
+	/**
+	 * Transform the model into place once, see Syllable3D::bake_transform().
+	 */
+	void bake_transform(const linalg::Mat4f& m);
 
 	/**
 	 * Render the model.
@@ -38,6 +48,58 @@ public:
 	 */
 	void render(bool wire=false, bool use_facetnorm=false);
 	void render_diff_colors(bool wire=false);
+
+	/**
+	 * Levels of detail, see build_lod_chain(), level 0 is the full model.
+	 * Call after init, and after bake_transform so errors are in world units.
+	 */
+	void build_lods(GLfloat ratio=0.5f, size_t max_levels=6);
+	size_t num_lods() const { return lods.size(); }
+	const LodLevel& get_lod_level(size_t i) const { return lods[i]; }
+	// level drawn by render(), 0 -> full model
+	void set_lod(int level) { lod = level; }
+	int current_lod() const { return lod; }
+	// sets and returns the coarsest level within max_pixels of full detail on screen
+	int select_lod(GLfloat pixels_per_unit, GLfloat max_pixels=1.0f);
+	// middle of the bounding box, set by build_lods
+	void get_center(vec3 out) const { copyv(out, center); }
+
+	// set by init and bake_transform
+	const Sphere& get_bounds() const { return bounds; }
+	/**
+	 * Meshlets of the full model and every level of detail, for cull().
+	 * build_lods and bake_transform keep them up.
+	 */
+	void build_meshlets(size_t max_vertices=MeshletSet::MAX_VERTICES,
+			size_t max_triangles=MeshletSet::MAX_TRIANGLES);
+	// of level of detail level, 0 -> full model
+	const MeshletSet& get_meshlets(size_t level) const { return meshlets[level]; }
+	/**
+	 * Frustum cull the whole model, then the meshlets of the current level if
+	 * built, frustum in the model's space.  No backface culling, the model
+	 * needn't be closed.  render() skips whatever is culled until the next
+	 * cull() or clear_cull().
+	 */
+	void cull(const Frustum& frustum, CullStats& stats);
+	void clear_cull() { culled = false; poly_visible.clear(); meshlet_visible.clear(); }
+	/**
+	 * Vertex and index buffers of the full model and every level of detail,
+	 * a range per meshlet if built.  Unless optimize is false, triangles are
+	 * ordered for the vertex cache within each range and vertices by first
+	 * use.  render() draws solid with vertex normals through them.
+	 * build_lods, build_meshlets and bake_transform keep them up.
+	 */
+	void build_buffers(bool optimize=true);
+	// of level, 0 -> full model, NULL if not built
+	const MeshBuffer* get_buffer(size_t level) const {
+		return level < buffers.size() ? buffers[level] : NULL;
+	}
+	/**
+	 * Upload buffers not yet in GL, no more than budget of them, taking
+	 * those uploaded from budget.  True once all are.  Needs a current
+	 * context, drawing uploads any left.
+	 */
+	bool upload_buffers(int& budget);
 	void render_solid_and_wire();
 	/**
 	 * Draw polygon normals
@@ -72,6 +134,8 @@ public:
 	GLfloat specular[4];
 	GLfloat shininess[1];
 	GLfloat emissive[4];
+	// the same for the shaders, when they read uniform blocks
+	UniformBuffer material_block;
 
 
 private:
@@ -80,10 +144,42 @@ private:
 	GLint num_normals;
 	vec3 *vertices;
 	vec3 *normals;
+	// polygons are in arena if poly_arena is set, see use_mesh_arenas
+	Arena arena;
+	Arena *poly_arena;
 
 
 	GLfloat near_white[4];
 
+	std::vector<LodLevel> lods;
+	int lod;
+	vec3 center;
+
+	Sphere bounds;
+	Aabb box;
+	bool culled;
+	// by level of detail, limits 0 -> none built
+	std::vector<MeshletSet> meshlets;
+	size_t meshlet_vertices, meshlet_triangles;
+	// whether each polygon and meshlet of the current level is drawn, empty -> all
+	std::vector<char> poly_visible;
+	std::vector<char> meshlet_visible;
+	// level meshlet_visible is for
+	int culled_level;
+	// by level of detail, empty until build_buffers()
+	std::vector<MeshBuffer*> buffers;
+	bool buffers_optimized;
+	void free_buffers();
+	bool drawn(size_t poly) const { return poly >= poly_visible.size() || poly_visible[poly]; }
+	// lines built by draw_normals() for normals_which and normals_size,
+	// cleared when the geometry changes
+	DebugOverlay normals_overlay;
+	char normals_which;
+	GLfloat normals_size;
+
+	// sets shortest_side_len and longest_side_len
+	void set_side_lengths();
+
 
 	std::vector<GLfloat *> colors;
 	// set to 1 for normal display,
@@ -16,6 +16,8 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <cmath>
+#include <cstddef>
 
 
 namespace DR  {
@@ -38,6 +40,19 @@ typedef GLfloat vec4[4];
  */
 void err_exit(string msg);
 
+/**
+ * Wall clock timer for benchmarks and stats.  Monotonic.
+ */
+class Stopwatch {
+public:
+	Stopwatch() { reset(); }
+	void reset();
+	// milliseconds since construction or last reset
+	double elapsed_ms() const;
+private:
+	long long start_ns;
+};
+
 //*********************************************************************************************
 //***********
 //***********    Opengl and glsl utility stuff
@@ -150,20 +165,41 @@ void test();
 
 /**
  * Comparison functor for vec3 ie, GLfloat *, assuming 3 members.  Can therefore use in sets, etc
+ * Exact lexicographic order, the tolerance in equal() isn't transitive so can't be used here.
  */
 struct Vec3Compare: std::binary_function<const vec3, const vec3, bool> {
 	bool operator()(const vec3 lhs, const vec3 rhs) const {
-		if(lhs[0] < rhs[0]) {
-			return true;
-		} else if(lhs[1] < rhs[1]) {
-			return true;
-		} else if(lhs[2] < rhs[2]) {
-			return true;
+		if(lhs[0] != rhs[0]) {
+			return lhs[0] < rhs[0];
+		} else if(lhs[1] != rhs[1]) {
+			return lhs[1] < rhs[1];
 		}
-		return false;
+		return lhs[2] < rhs[2];
 	}
 };
 
+/**
+ * Index of the cell of width cell that val falls in.  The hashed containers
+ * in geo.h treat floats in the same cell as the same key.
+ */
+inline long long float_bucket(GLfloat val, GLfloat cell=FLOAT_TOLERANCE) {
+	return (long long)std::floor((double)val / cell);
+}
+
+// mix h into seed, as boost::hash_combine
+inline void hash_combine(size_t& seed, size_t h) {
+	seed ^= h + (size_t)0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
+// hash of the float_bucket() cells of n floats
+inline size_t hash_buckets(const GLfloat *vals, int n) {
+	size_t seed = 0;
+	for (int i = 0; i < n; ++i) {
+		hash_combine(seed, std::hash<long long>()(float_bucket(vals[i])));
+	}
+	return seed;
+}
+
 /**
  * Compare floats for equality within tolerance.
  * Default tolerance=0.000001
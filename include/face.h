@@ -14,8 +14,11 @@
 
 #include "poly.h"
 #include "vec.h"
+#include "arena.h"
 
 #include <vector>
+#include <cassert>
+#include <unordered_map>
 
 using DR::vec3;
 using DR::Polygon;
@@ -23,9 +26,15 @@ using DR::Triangle;
 using DR::Quad;
 using DR::IndexedEdge;
 using DR::Vec;
+using DR::PolyIdSet;
 
 using std::vector;
 
+// vertex indices around a perimeter, in the mesh's arena if it has one
+typedef vector<GLint, DR::ArenaAllocator<GLint> > Perimeter;
+
+class Face;
+
 // A region is a connected group of polygons
 // bounded by an outer perimeter,
 // and possible a number of inner perimeters (edges of holes)
@@ -33,11 +42,26 @@ using std::vector;
 // and keep in order using right hand winding (ie cross product
 // of successive edges in a perimeter points up, however defined)
 struct Region {
-	vector<GLint> perimeter;
-	vector<vector<GLint> > inner_perimeters;
-	vector<Polygon *> polygons;
-	bool contains(const Polygon *poly);
-	bool contains(GLint vert);
+	// perimeters are allocated from arena, if not NULL
+	Region(Face *face=NULL, DR::Arena *arena=NULL)
+	: perimeter(DR::ArenaAllocator<GLint>(arena)),
+	  inner_perimeters(DR::ArenaAllocator<Perimeter>(arena)), face(face) {}
+	Perimeter perimeter;
+	vector<Perimeter, DR::ArenaAllocator<Perimeter> > inner_perimeters;
+	// ids of the region's polygons in face, sorted
+	// faces built from the same polygons in the same order can share these
+	PolyIdSet poly_ids;
+	Face *face;
+	// the i'th polygon of the region
+	Polygon* poly(size_t i) const;
+	// poly must be from the region's face
+	bool contains(const Polygon *poly) const;
+	bool contains(GLint vert) const;
+	// append an empty inner perimeter using the same storage as perimeter
+	Perimeter& add_inner_perimeter() {
+		inner_perimeters.push_back(Perimeter(perimeter.get_allocator()));
+		return inner_perimeters.back();
+	}
 };
 
 class Syllable3D;
@@ -63,29 +87,42 @@ public:
 	vector<Region *> regions;
 	vector<Polygon *> polygons;
 	Face();
-	Face(Syllable3D *syll);
+	// if arena is given, polygons and regions are in it and are
+	// freed by its owner resetting it, not by the face
+	Face(Syllable3D *syll, DR::Arena *arena=NULL);
 	~Face();
-	// add polygon created with new
+	// add polygon created with new, or from the face's arena
 	void add_polygon(Polygon *p);
 	// remove all polygons and regions from this face, clearing storage
 	void clear();
-	// overall initialization and setup of regions
+	// new region, in the arena if there is one
+	Region* new_region();
+	DR::Arena* get_arena() const { return arena; }
+	// overall initialization and setup of regions, from the parent's
+	// layout positions, so vertices moved since don't matter
 	void init_regions(GLint start_vert);
 	// expand neighbors of start until region is defined
 	void grow_region(Region& region, Polygon *start);
 	// returns polygon containing all verts
-	void get_poly(vector<GLint> verts, Polygon& out);
+	void get_poly(const vector<GLint>& verts, Polygon& out);
 	// returns index of poly in face.polygons vector
 	// returns -1 if poly not found
+	// O(1), polys of this face are found by id, others by value through a hash
 	GLint get_poly_index(const Polygon *poly) const;
 	void create_perimeters(Region& region, vector<vector<GLint> >& perimeters, bool debug=false);
 	// perimeters are always (we hope) in right handed winding order with respect to the outside of the face
 	// so if you flip the face, reverse the windings if desired (for instance, create_sides depends on face winding)
 	// reverses all perimeter windings
 	void reverse_perimeter_windings();
+	// all the perimeter vertices, outer then inner, region by region, appended to out
+	void get_perimeter_verts(vector<GLint>& out) const;
 	void find_polys_containing(vector<Polygon *>& out, GLint vert);
 	void find_polys_containing(vector<Polygon *>& out, const IndexedEdge& edge);
 	void get_neighbors(vector<Polygon *>& out, const Polygon *poly);
+	// ids of the polys containing vert, from an index built on first use
+	const PolyIdSet& polys_containing(GLint vert);
+	// ids of polys sharing a vertex with polygons[id], not including id
+	void get_neighbor_ids(PolyIdSet& out, GLint id);
 	/**
 	 * Get center of center polygon.
 	 * Asserts center poly is set.
@@ -95,14 +132,20 @@ public:
 	 * Get copy of center poly, asserts that there is one.
 	 */
 	void get_center(Polygon& out);
+	// the center poly itself, no copy
+	const Polygon& center_poly() const {
+		assert(center_index != -1);
+		return *polygons[center_index];
+	}
 	/**
 	 * Get the index of center poly.
 	 * Asserts center poly is set.
 	 */
-	GLint get_center_index();
+	GLint get_center_index() const;
+	bool has_center() const { return center_index != -1; }
 	// tell face to decide which is center poly. for simplicity,
 	// assume syllable is flat on xz plane as it first
-	// comes in (ie this will assert up = Vec(0, 0, 1)
+	// comes in (ie this will assert up = Vec(0, 0, 1), and use the layout positions
 	void set_center(Vec up);
 	// if you have a center point, this will set the
 	// center poly with it
@@ -121,10 +164,20 @@ public:
 private:
 
 	Syllable3D *parent;
+	DR::Arena *arena;
 	// index of center poly
 	GLint center_index;
+	// polys containing each vertex, empty until polys_containing() needs it
+	vector<PolyIdSet> vert_polys;
+	// value to index for get_poly_index() on polys from elsewhere,
+	// empty until needed
+	mutable std::unordered_map<const Polygon*, GLint, DR::PolygonHash, DR::PolygonKeyEqual> poly_lookup;
 };
 
+inline Polygon* Region::poly(size_t i) const {
+	return face->polygons[poly_ids[i]];
+}
+
 
 
 #endif /* FACE_H_ */
@@ -0,0 +1,111 @@
+/*
+ * force_field.h
+ *
+ * Force fields acting on particles: gravity, radial pull toward a point,
+ * curl noise turbulence and drag.  Which fields are on is given by a
+ * combination of ForceFlags.  ParticleSet turns the runtime flags into a
+ * template parameter, so each combination gets its own update loop and
+ * a disabled field costs nothing.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FORCE_FIELD_H_
+#define FORCE_FIELD_H_
+
+#include "dr_util.h"
+#include "noise_engine.h"
+#include <cmath>
+
+namespace DR {
+
+// bits for ForceFields::enabled and the FIELDS template parameter
+enum ForceFlags {
+	FORCE_NONE = 0,
+	FORCE_GRAVITY = 1 << 0,
+	FORCE_RADIAL = 1 << 1,
+	FORCE_CURL = 1 << 2,
+	FORCE_DRAG = 1 << 3,
+	FORCE_ALL = FORCE_GRAVITY | FORCE_RADIAL | FORCE_CURL | FORCE_DRAG
+};
+
+/**
+ * Parameters for the force fields.  All fields are off by default, which
+ * gives the old straight line motion.
+ * Forces are given as accelerations, ie particles are all unit mass.
+ */
+struct ForceFields {
+	ForceFields();
+
+	// combination of ForceFlags
+	unsigned enabled;
+
+	// constant acceleration, units/sec^2
+	vec3 gravity;
+	// point particles are pulled toward, eg a syllable's assigned_center
+	vec3 center;
+	// magnitude of acceleration toward center, units/sec^2
+	GLfloat radial_strength;
+	// magnitude of turbulence acceleration
+	GLfloat curl_strength;
+	// noise is sampled at position * curl_scale
+	GLfloat curl_scale;
+	// source of the turbulence
+	NoiseEngine noise;
+	// linear drag coefficient, 1/sec
+	GLfloat drag;
+
+	void enable(unsigned flags) { enabled |= flags; }
+	void disable(unsigned flags) { enabled &= ~flags; }
+	bool is_enabled(unsigned flags) const { return (enabled & flags) == flags; }
+	void set_center(const vec3 c) { copyv(center, c); }
+};
+
+/**
+ * Curl of a vector potential made of 3 offset perlin noise fields, sampled at
+ * pos * scale.  Divergence free, so particles swirl rather than bunch up.
+ * Uses central differences: 12 samples, evaluated as a batch.
+ */
+void curl_noise(const NoiseEngine& noise, const GLfloat pos[3], GLfloat scale, GLfloat out[3]);
+
+/**
+ * Acceleration on a particle at (x, y, z) with velocity (vx, vy, vz) from
+ * the fields in FIELDS.  FIELDS is a compile time constant so the tests
+ * below fold away.
+ */
+template<unsigned FIELDS>
+inline void accumulate_forces(const ForceFields& f, GLfloat x, GLfloat y, GLfloat z,
+		GLfloat vx, GLfloat vy, GLfloat vz, GLfloat acc[3]) {
+	acc[0] = acc[1] = acc[2] = 0.0f;
+	if(FIELDS & FORCE_GRAVITY) {
+		acc[0] += f.gravity[0];
+		acc[1] += f.gravity[1];
+		acc[2] += f.gravity[2];
+	}
+	if(FIELDS & FORCE_RADIAL) {
+		GLfloat dx = f.center[0] - x, dy = f.center[1] - y, dz = f.center[2] - z;
+		GLfloat len = std::sqrt(dx*dx + dy*dy + dz*dz);
+		if(len > FLOAT_TOLERANCE) {
+			GLfloat s = f.radial_strength / len;
+			acc[0] += s * dx;
+			acc[1] += s * dy;
+			acc[2] += s * dz;
+		}
+	}
+	if(FIELDS & FORCE_CURL) {
+		GLfloat pos[3] = {x, y, z}, curl[3];
+		curl_noise(f.noise, pos, f.curl_scale, curl);
+		acc[0] += f.curl_strength * curl[0];
+		acc[1] += f.curl_strength * curl[1];
+		acc[2] += f.curl_strength * curl[2];
+	}
+	if(FIELDS & FORCE_DRAG) {
+		acc[0] -= f.drag * vx;
+		acc[1] -= f.drag * vy;
+		acc[2] -= f.drag * vz;
+	}
+}
+
+} // end namespace DR
+
+#endif /* FORCE_FIELD_H_ */
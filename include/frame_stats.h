@@ -0,0 +1,103 @@
+/*
+ * frame_stats.h
+ *
+ * Frame times kept in fixed size log-linear histograms, as HdrHistogram
+ * does, so every frame counts and percentiles come out within about 1.5%
+ * however long the run.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAME_STATS_H_
+#define FRAME_STATS_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <ostream>
+
+namespace DR {
+
+/**
+ * Times in whole microseconds, the first 2 * SUB_BUCKETS exactly, then
+ * SUB_BUCKETS buckets for each further power of 2.  Past the last bucket,
+ * about 76 hours, times go in the last one.
+ */
+class TimeHistogram {
+public:
+	static const int SUB_BITS = 6;
+	static const int SUB_BUCKETS = 1 << SUB_BITS;
+	static const int MAX_SHIFT = 31;
+	static const int NUM_BUCKETS = (MAX_SHIFT + 2) * SUB_BUCKETS;
+
+	TimeHistogram() { clear(); }
+	void clear();
+	void record(double ms);
+
+	size_t count() const { return total; }
+	// exact, 0 if empty
+	double min_ms() const { return total ? min_us * 0.001 : 0; }
+	double max_ms() const { return max_us * 0.001; }
+	double mean_ms() const { return total ? sum_us * 0.001 / total : 0; }
+	/**
+	 * Time p percent of those recorded are at or below, p from 0 to 100.
+	 * The top of the bucket it falls in, no more than max_ms().
+	 */
+	double percentile(double p) const;
+
+	// nonzero buckets as (top ms, count)
+	void buckets(std::vector<std::pair<double, size_t> >& out) const;
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	size_t counts[NUM_BUCKETS];
+	size_t total;
+	unsigned long long min_us, max_us;
+	double sum_us;
+
+	static int bucket_of(unsigned long long us);
+	// largest time in bucket b
+	static unsigned long long bucket_top(int b);
+};
+
+/**
+ * Per frame CPU times, the whole frame and its parts, and the bytes
+ * streamed each frame.
+ */
+class FrameStats {
+public:
+	enum Part { FRAME, SIMULATE, RENDER, SWAP, NUM_PARTS };
+	static const char* part_name(int part);
+
+	void record(int part, double ms) { parts[part].record(ms); }
+	const TimeHistogram& get(int part) const { return parts[part]; }
+	size_t frames() const { return parts[FRAME].count(); }
+	// histogram counts whole microseconds, so KB as ms keeps every byte
+	void record_streamed(size_t bytes) { streamed.record(bytes * 0.001); }
+	// in KB
+	const TimeHistogram& get_streamed() const { return streamed; }
+	void clear();
+
+	// table of count, mean, p50, p90, p99, p99.9 and worst for each part,
+	// then a table for streamed KB
+	void print(std::ostream& out) const;
+	// the parts as csv, a header in ms then a row per part
+	void write_csv(std::ostream& out) const;
+	// streamed as csv, a header in KB then its row
+	void write_streamed_csv(std::ostream& out) const;
+	// the same with the nonzero buckets of each part
+	void write_json(std::ostream& out) const;
+	// to base + ".csv", base + "_streamed.csv" and base + ".json",
+	// false if any can't be written
+	bool write(const std::string& base) const;
+
+private:
+	TimeHistogram parts[NUM_PARTS];
+	TimeHistogram streamed;
+};
+
+} // end namespace DR
+
+#endif /* FRAME_STATS_H_ */
@@ -20,6 +20,8 @@
 #include <functional>
 #include <vector>
 #include <map>
+#include <unordered_set>
+#include <unordered_map>
 
 
 namespace DR  {
@@ -35,6 +37,12 @@ typedef std::vector<DR::vec3>  Vec3Array;
 
 typedef std::map<DR::Vec, DR::Polygon *, DR::VecCompare> VecPolyMap;
 
+// hashed versions of the above, Vec keys are bucketed by FLOAT_TOLERANCE, see VecHash
+// vec3 is an array type so has no hashed set, use VecHashSet
+typedef std::unordered_set<const DR::Polygon *, DR::PolygonHash, DR::PolygonKeyEqual> PolygonHashSet;
+typedef std::unordered_set<DR::Vec, DR::VecHash, DR::VecKeyEqual> VecHashSet;
+typedef std::unordered_map<DR::Vec, DR::Polygon *, DR::VecHash, DR::VecKeyEqual> VecPolyHashMap;
+
 template <typename T>
 inline void print_elements (const T& coll, string sep="\n", string head="")
 {
@@ -14,6 +14,7 @@
 
 #include "mygl.h"
 #include "dr_util.h"
+#include "frame_stats.h"
 
 #include <vector>
 
@@ -58,18 +59,59 @@ public:
 	// updated in idle()
 	GLfloat framerate; 		// = 0;
 	bool show_framerate; 	// = true;
-	// framerate stats, samples of framerate taken regularly
-	// for now, just sample it when updating headsup display
-	// if sampling
-	std::vector<GLfloat> framerate_samples;
+	// every frame's times, after the first stats_warmup_secs
+	FrameStats frame_stats;
+	GLfloat stats_warmup_secs;		// = 5
+	// frame_stats are written to this plus .csv, _streamed.csv and .json
+	string frame_stats_file;		// = "frame_stats"
+	// call at the start of display()
+	void begin_render();
+	// call instead of glutSwapBuffers(), records the frame's times
+	void swap_buffers();
 
 	// output file for collecting whatever information
 	string output_file;
 
-	// general timing - millisecond accuracy
-	// use with glutGet(GLUT_ELAPSED_TIME)
+	// general timing - use with elapsed_ms()
 	GLfloat curr_time_ms;
 	GLfloat start_time_ms;
+	// time since construction or start_clock(), monotonic, sub millisecond
+	GLdouble elapsed_ms() const { return clock.elapsed_ms(); }
+	GLdouble elapsed_secs() const { return 0.001 * clock.elapsed_ms(); }
+
+	// fixed timestep simulation, results don't depend on the framerate
+	// secs simulated by each simulate() call
+	GLdouble sim_step;				// = 1/120
+	// most steps in one advance(), real time past that is dropped rather
+	// than falling further behind
+	int max_sim_steps;				// = 8
+	// secs simulated so far
+	GLdouble sim_time;
+	// how far real time is past sim_time, in steps, 0 to 1.  Draw moving
+	// things sim_alpha * sim_step secs ahead to smooth between steps
+	GLfloat sim_alpha;
+	// pace_frame() sleeps so frames come no faster than this, 0 -> no cap
+	GLfloat frame_rate_cap;			// = 60
+	// set when the buffer swap waits for vsync, which paces frames already
+	bool vsync;						// = false
+
+	// zero the clock, sim_time and the steps owed, call when done loading
+	void start_clock();
+	/**
+	 * Call simulate(sim_step) for each whole step of real time since the last
+	 * call, then set sim_alpha.  Call from idle().
+	 * return: steps taken
+	 */
+	int advance();
+	// as advance(), for elapsed secs of real time
+	int advance(GLdouble elapsed);
+	// one step of the simulation, dt in secs
+	virtual void simulate(GLdouble dt) {}
+	/**
+	 * Sleep out the rest of this frame for frame_rate_cap, unless vsync,
+	 * then ask glut to redisplay.  Call at the end of idle().
+	 */
+	void pace_frame();
 
 	// support for heads-up display
 	// prompt/announcement to display when not showing anything else
@@ -99,6 +141,16 @@ public:
 	// max g_zoom can be
 	GLfloat z_zoom_max; 	// = -g_z_start;
 
+protected:
+	Stopwatch clock;
+	// real time owed to the simulation, secs
+	GLdouble sim_owed;
+	// elapsed_secs() at the last advance() and pace_frame()
+	GLdouble last_advance_secs;
+	GLdouble last_frame_secs;
+	// simulate() time since the last swap_buffers(), and when render began
+	GLdouble frame_sim_ms;
+	GLdouble render_start_ms;
 
 };
 
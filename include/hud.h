@@ -0,0 +1,137 @@
+/*
+ * hud.h
+ *
+ * Heads up display text.  A font is rasterized once into a texture atlas,
+ * each run of text is laid out into textured quads only when it changes,
+ * and all of them draw with one call.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef HUD_H_
+#define HUD_H_
+
+#include "dr_util.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+class GlyphAtlas {
+public:
+	static const int WIDTH = 256;
+	static const int FIRST_CHAR = 32;
+	static const int LAST_CHAR = 126;
+
+	// where a glyph is in the atlas, pixels
+	struct Glyph {
+		GLint x, y, width, height;
+		// the pen, from the left, and the baseline, up from the bottom
+		GLint left, descent;
+		GLint advance;
+	};
+
+	GlyphAtlas();
+	// frees the texture, needs the context it was made in
+	~GlyphAtlas();
+	void clear();
+
+	/**
+	 * Add glyph c, width x height alpha values, bottom row first, drawn with
+	 * the pen left pixels in and the baseline descent rows up.  Before finish().
+	 */
+	void add_glyph(unsigned char c, int width, int height, int left, int descent, int advance,
+			const unsigned char *pixels);
+	/**
+	 * Draw each character of a glut bitmap font and read it back, needs a
+	 * current context.  line_height and descent in pixels, the glut fonts
+	 * don't say.  Calls finish().
+	 */
+	void rasterize_glut(void *font, int line_height, int descent);
+	// pads the height to a power of 2, texture coords are known after
+	void finish();
+	bool is_finished() const { return finished; }
+
+	// NULL if c has no glyph
+	const Glyph* glyph(unsigned char c) const;
+	GLint line_height() const { return line_h; }
+	GLint width() const { return WIDTH; }
+	GLint height() const { return tex_height; }
+	const std::vector<unsigned char>& get_pixels() const { return pixels; }
+
+	// creates the texture the first time
+	void bind();
+
+private:
+	Glyph glyphs[LAST_CHAR + 1];
+	bool has_glyph[LAST_CHAR + 1];
+	std::vector<unsigned char> pixels;
+	// next free spot, and the tallest glyph in its row
+	GLint pen_x, pen_y, row_height;
+	GLint line_h, tex_height;
+	bool finished;
+	GLuint texture;
+
+	GlyphAtlas(const GlyphAtlas&);
+	GlyphAtlas& operator=(const GlyphAtlas&);
+};
+
+/**
+ * Runs of text at pixel positions from the bottom left of the window.
+ */
+class HudText {
+public:
+	// x, y, s, t, r, g, b, a
+	static const int FLOATS_PER_VERTEX = 8;
+
+	HudText(GlyphAtlas& atlas) : atlas(atlas), dirty(false), layouts(0) {}
+
+	/**
+	 * Run run shows text with its first baseline at x, y, lines split at
+	 * '\n' and line_spacing apart, < 0 for the atlas line height.  Laid out
+	 * again only if something differs from last time.  "" hides it.
+	 */
+	void set_text(size_t run, GLfloat x, GLfloat y, const std::string& text,
+			const GLfloat *color=NULL, GLfloat line_spacing=-1);
+	void clear();
+
+	/**
+	 * All runs in one glDrawArrays, over a window width x height pixels.
+	 * Leaves the matrices, texture and blending as they were.
+	 */
+	void draw(int width, int height);
+
+	// quads of visible glyphs in all runs
+	size_t num_quads() const;
+	// layouts done since construction, to see caching work
+	size_t num_layouts() const { return layouts; }
+	// vertices of run, FLOATS_PER_VERTEX each
+	const std::vector<GLfloat>& get_vertices(size_t run) const { return runs[run].vertices; }
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	struct Run {
+		Run() : x(0), y(0), line_spacing(-1) { setv(color, 1, 1, 1, 1); }
+		std::string text;
+		GLfloat x, y, line_spacing;
+		vec4 color;
+		std::vector<GLfloat> vertices;
+	};
+
+	GlyphAtlas& atlas;
+	std::vector<Run> runs;
+	// all runs' vertices, rebuilt when one changes
+	std::vector<GLfloat> vertices;
+	bool dirty;
+	size_t layouts;
+
+	void layout(Run& r);
+};
+
+} // end namespace DR
+
+#endif /* HUD_H_ */
@@ -0,0 +1,381 @@
+/*
+ * linalg.h
+ *
+ * Fixed size vectors and 4x4 matrices as templates, header only.
+ * Storage is a plain T[N] (or T[16], column major like OpenGL), so a vec3,
+ * vec4 or GLfloat[16] can be viewed in place with as_vec3(), as_vec4() and
+ * as_mat4() without copying.
+ * Everything is constexpr except what needs sqrt/trig and the float
+ * specializations of Vec<4>/Mat4 arithmetic, which use SSE.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LINALG_H_
+#define LINALG_H_
+
+#include "mygl.h"
+
+#include <cmath>
+#include <cassert>
+#include <ostream>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+namespace DR {
+namespace linalg {
+
+template<int N, typename T = GLfloat>
+struct Vec {
+	T v[N];
+
+	constexpr Vec() : v() {}
+	// one value per component, eg Vec<3>(x, y, z)
+	template<typename... A,
+		typename = typename std::enable_if<sizeof...(A) == N && (N > 1)>::type>
+	constexpr Vec(A... a) : v{ static_cast<T>(a)... } {}
+
+	// copy of N values at p
+	static constexpr Vec from(const T *p) {
+		Vec r;
+		for (int i = 0; i < N; ++i) r.v[i] = p[i];
+		return r;
+	}
+	static constexpr Vec fill(T s) {
+		Vec r;
+		for (int i = 0; i < N; ++i) r.v[i] = s;
+		return r;
+	}
+
+	// unchecked, asserts in debug builds
+	constexpr T& operator[](int i) { assert(i >= 0 && i < N); return v[i]; }
+	constexpr const T& operator[](int i) const { assert(i >= 0 && i < N); return v[i]; }
+	T* data() { return v; }
+	const T* data() const { return v; }
+	void store(T *p) const { for (int i = 0; i < N; ++i) p[i] = v[i]; }
+
+	constexpr Vec& operator+=(const Vec& o) { for (int i = 0; i < N; ++i) v[i] += o.v[i]; return *this; }
+	constexpr Vec& operator-=(const Vec& o) { for (int i = 0; i < N; ++i) v[i] -= o.v[i]; return *this; }
+	constexpr Vec& operator*=(T s) { for (int i = 0; i < N; ++i) v[i] *= s; return *this; }
+	constexpr Vec& operator/=(T s) { for (int i = 0; i < N; ++i) v[i] /= s; return *this; }
+};
+
+typedef Vec<2, GLfloat> Vec2f;
+typedef Vec<3, GLfloat> Vec3f;
+typedef Vec<4, GLfloat> Vec4f;
+typedef Vec<2, double> Vec2d;
+
+template<int N, typename T>
+constexpr Vec<N,T> operator+(Vec<N,T> a, const Vec<N,T>& b) { return a += b; }
+template<int N, typename T>
+constexpr Vec<N,T> operator-(Vec<N,T> a, const Vec<N,T>& b) { return a -= b; }
+template<int N, typename T>
+constexpr Vec<N,T> operator-(Vec<N,T> a) { for (int i = 0; i < N; ++i) a.v[i] = -a.v[i]; return a; }
+template<int N, typename T>
+constexpr Vec<N,T> operator*(Vec<N,T> a, T s) { return a *= s; }
+template<int N, typename T>
+constexpr Vec<N,T> operator*(T s, Vec<N,T> a) { return a *= s; }
+template<int N, typename T>
+constexpr Vec<N,T> operator/(Vec<N,T> a, T s) { return a /= s; }
+
+// exact comparison, see almost_equal() for tolerance
+template<int N, typename T>
+constexpr bool operator==(const Vec<N,T>& a, const Vec<N,T>& b) {
+	for (int i = 0; i < N; ++i) if(a.v[i] != b.v[i]) return false;
+	return true;
+}
+template<int N, typename T>
+constexpr bool operator!=(const Vec<N,T>& a, const Vec<N,T>& b) { return !(a == b); }
+
+template<int N, typename T>
+constexpr bool almost_equal(const Vec<N,T>& a, const Vec<N,T>& b, T tolerance=T(0.000001)) {
+	for (int i = 0; i < N; ++i) {
+		T d = a.v[i] - b.v[i];
+		if(d > tolerance || d < -tolerance) return false;
+	}
+	return true;
+}
+
+template<int N, typename T>
+constexpr T dot(const Vec<N,T>& a, const Vec<N,T>& b) {
+	T s = T(0);
+	for (int i = 0; i < N; ++i) s += a.v[i] * b.v[i];
+	return s;
+}
+
+template<typename T>
+constexpr Vec<3,T> cross(const Vec<3,T>& a, const Vec<3,T>& b) {
+	return Vec<3,T>(a.v[1] * b.v[2] - a.v[2] * b.v[1],
+			a.v[2] * b.v[0] - a.v[0] * b.v[2],
+			a.v[0] * b.v[1] - a.v[1] * b.v[0]);
+}
+
+template<int N, typename T>
+constexpr T length2(const Vec<N,T>& a) { return dot(a, a); }
+
+template<int N, typename T>
+inline T length(const Vec<N,T>& a) { return std::sqrt(dot(a, a)); }
+
+template<int N, typename T>
+inline T distance(const Vec<N,T>& a, const Vec<N,T>& b) { return length(a - b); }
+
+/**
+ * Unit vector in the direction of a, or a if it is 0 length.
+ */
+template<int N, typename T>
+inline Vec<N,T> normalized(const Vec<N,T>& a) {
+	T len = length(a);
+	return len > T(0) ? a / len : a;
+}
+
+template<int N, typename T>
+constexpr Vec<N,T> lerp(const Vec<N,T>& a, const Vec<N,T>& b, T t) { return a + (b - a) * t; }
+
+template<int N, typename T>
+constexpr Vec<N,T> min(Vec<N,T> a, const Vec<N,T>& b) {
+	for (int i = 0; i < N; ++i) a.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i];
+	return a;
+}
+template<int N, typename T>
+constexpr Vec<N,T> max(Vec<N,T> a, const Vec<N,T>& b) {
+	for (int i = 0; i < N; ++i) a.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i];
+	return a;
+}
+
+//***** views of existing storage
+
+template<int N, typename T>
+inline Vec<N,T>& as_vec(T *p) { return *reinterpret_cast<Vec<N,T>*>(p); }
+template<int N, typename T>
+inline const Vec<N,T>& as_vec(const T *p) { return *reinterpret_cast<const Vec<N,T>*>(p); }
+
+// eg as_vec3(vertices[i]) += offset;
+inline Vec3f& as_vec3(GLfloat *p) { return as_vec<3>(p); }
+inline const Vec3f& as_vec3(const GLfloat *p) { return as_vec<3>(p); }
+inline Vec4f& as_vec4(GLfloat *p) { return as_vec<4>(p); }
+inline const Vec4f& as_vec4(const GLfloat *p) { return as_vec<4>(p); }
+
+static_assert(sizeof(Vec3f) == 3 * sizeof(GLfloat), "Vec3f must match vec3 layout");
+static_assert(sizeof(Vec4f) == 4 * sizeof(GLfloat), "Vec4f must match vec4 layout");
+static_assert(std::is_standard_layout<Vec3f>::value, "Vec3f must be standard layout");
+
+//***** 4x4 matrix
+
+/**
+ * Column major, element (row, col) is m[col*4 + row], same as OpenGL.
+ */
+template<typename T = GLfloat>
+struct Mat4 {
+	T m[16];
+
+	constexpr Mat4() : m() {}
+
+	static constexpr Mat4 identity() {
+		Mat4 r;
+		r.m[0] = r.m[5] = r.m[10] = r.m[15] = T(1);
+		return r;
+	}
+	static constexpr Mat4 from(const T *p) {
+		Mat4 r;
+		for (int i = 0; i < 16; ++i) r.m[i] = p[i];
+		return r;
+	}
+	static constexpr Mat4 translate(T x, T y, T z) {
+		Mat4 r = identity();
+		r.m[12] = x; r.m[13] = y; r.m[14] = z;
+		return r;
+	}
+	static constexpr Mat4 scale(T x, T y, T z) {
+		Mat4 r = identity();
+		r.m[0] = x; r.m[5] = y; r.m[10] = z;
+		return r;
+	}
+	/**
+	 * Same matrix as glRotate(degrees, x, y, z).
+	 */
+	static Mat4 rotate(T degrees, T x, T y, T z) {
+		Vec<3,T> a = normalized(Vec<3,T>(x, y, z));
+		T rad = degrees * T(3.14159265358979 / 180.0);
+		T c = std::cos(rad), s = std::sin(rad), t = T(1) - c;
+		x = a.v[0]; y = a.v[1]; z = a.v[2];
+		Mat4 r = identity();
+		r.m[0] = x*x*t + c;   r.m[4] = x*y*t - z*s; r.m[8] = x*z*t + y*s;
+		r.m[1] = y*x*t + z*s; r.m[5] = y*y*t + c;   r.m[9] = y*z*t - x*s;
+		r.m[2] = x*z*t - y*s; r.m[6] = y*z*t + x*s; r.m[10] = z*z*t + c;
+		return r;
+	}
+	/**
+	 * Same matrix as gluPerspective().
+	 */
+	static Mat4 perspective(T fovy_degrees, T aspect, T near, T far) {
+		T f = T(1) / std::tan(fovy_degrees * T(3.14159265358979 / 360.0));
+		Mat4 r;
+		r.m[0] = f / aspect;
+		r.m[5] = f;
+		r.m[10] = (far + near) / (near - far);
+		r.m[11] = T(-1);
+		r.m[14] = T(2) * far * near / (near - far);
+		return r;
+	}
+
+	constexpr T& operator()(int row, int col) { return m[col*4 + row]; }
+	constexpr const T& operator()(int row, int col) const { return m[col*4 + row]; }
+	T* data() { return m; }
+	const T* data() const { return m; }
+	void store(T *p) const { for (int i = 0; i < 16; ++i) p[i] = m[i]; }
+
+	/**
+	 * p as a point, w = 1, no perspective divide.
+	 */
+	constexpr Vec<3,T> transform_point(const Vec<3,T>& p) const {
+		return Vec<3,T>(m[0]*p.v[0] + m[4]*p.v[1] + m[8]*p.v[2] + m[12],
+				m[1]*p.v[0] + m[5]*p.v[1] + m[9]*p.v[2] + m[13],
+				m[2]*p.v[0] + m[6]*p.v[1] + m[10]*p.v[2] + m[14]);
+	}
+	/**
+	 * d as a direction, w = 0, ie just the upper 3x3.
+	 */
+	constexpr Vec<3,T> transform_dir(const Vec<3,T>& d) const {
+		return Vec<3,T>(m[0]*d.v[0] + m[4]*d.v[1] + m[8]*d.v[2],
+				m[1]*d.v[0] + m[5]*d.v[1] + m[9]*d.v[2],
+				m[2]*d.v[0] + m[6]*d.v[1] + m[10]*d.v[2]);
+	}
+
+	constexpr Mat4 transposed() const {
+		Mat4 r;
+		for (int c = 0; c < 4; ++c)
+			for (int row = 0; row < 4; ++row)
+				r.m[row*4 + c] = m[c*4 + row];
+		return r;
+	}
+
+	/**
+	 * General inverse by cofactors.
+	 * return: false if singular, out is untouched
+	 */
+	constexpr bool inverse(Mat4& out) const {
+		T inv[16];
+		inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+		inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+		inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+		inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+		inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+		inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+		inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+		inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+		inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+		inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+		inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+		inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+		inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+		inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+		inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11] - m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+		inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10] + m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+		T det = m[0]*inv[0] + m[1]*inv[4] + m[2]*inv[8] + m[3]*inv[12];
+		if(det == T(0)) {
+			return false;
+		}
+		for (int i = 0; i < 16; ++i) out.m[i] = inv[i] / det;
+		return true;
+	}
+};
+
+typedef Mat4<GLfloat> Mat4f;
+
+static_assert(sizeof(Mat4f) == 16 * sizeof(GLfloat), "Mat4f must match GLfloat[16] layout");
+
+template<typename T>
+constexpr Mat4<T> operator*(const Mat4<T>& a, const Mat4<T>& b) {
+	Mat4<T> r;
+	for (int c = 0; c < 4; ++c) {
+		for (int row = 0; row < 4; ++row) {
+			T s = T(0);
+			for (int k = 0; k < 4; ++k) s += a.m[k*4 + row] * b.m[c*4 + k];
+			r.m[c*4 + row] = s;
+		}
+	}
+	return r;
+}
+
+template<typename T>
+constexpr Vec<4,T> operator*(const Mat4<T>& a, const Vec<4,T>& v) {
+	Vec<4,T> r;
+	for (int row = 0; row < 4; ++row) {
+		r.v[row] = a.m[row] * v.v[0] + a.m[4 + row] * v.v[1] + a.m[8 + row] * v.v[2] + a.m[12 + row] * v.v[3];
+	}
+	return r;
+}
+
+template<typename T>
+constexpr bool operator==(const Mat4<T>& a, const Mat4<T>& b) {
+	for (int i = 0; i < 16; ++i) if(a.m[i] != b.m[i]) return false;
+	return true;
+}
+
+inline Mat4f& as_mat4(GLfloat *p) { return *reinterpret_cast<Mat4f*>(p); }
+inline const Mat4f& as_mat4(const GLfloat *p) { return *reinterpret_cast<const Mat4f*>(p); }
+
+//***** SSE versions for float, preferred over the templates by overload resolution
+
+#if defined(__SSE2__)
+
+inline Vec4f operator+(const Vec4f& a, const Vec4f& b) {
+	Vec4f r;
+	_mm_storeu_ps(r.v, _mm_add_ps(_mm_loadu_ps(a.v), _mm_loadu_ps(b.v)));
+	return r;
+}
+inline Vec4f operator-(const Vec4f& a, const Vec4f& b) {
+	Vec4f r;
+	_mm_storeu_ps(r.v, _mm_sub_ps(_mm_loadu_ps(a.v), _mm_loadu_ps(b.v)));
+	return r;
+}
+inline Vec4f operator*(const Vec4f& a, GLfloat s) {
+	Vec4f r;
+	_mm_storeu_ps(r.v, _mm_mul_ps(_mm_loadu_ps(a.v), _mm_set1_ps(s)));
+	return r;
+}
+inline Vec4f operator*(GLfloat s, const Vec4f& a) { return a * s; }
+
+inline Vec4f operator*(const Mat4f& a, const Vec4f& v) {
+	__m128 r = _mm_mul_ps(_mm_loadu_ps(a.m), _mm_set1_ps(v.v[0]));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a.m + 4), _mm_set1_ps(v.v[1])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a.m + 8), _mm_set1_ps(v.v[2])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a.m + 12), _mm_set1_ps(v.v[3])));
+	Vec4f out;
+	_mm_storeu_ps(out.v, r);
+	return out;
+}
+
+inline Mat4f operator*(const Mat4f& a, const Mat4f& b) {
+	__m128 a0 = _mm_loadu_ps(a.m), a1 = _mm_loadu_ps(a.m + 4),
+			a2 = _mm_loadu_ps(a.m + 8), a3 = _mm_loadu_ps(a.m + 12);
+	Mat4f r;
+	for (int c = 0; c < 4; ++c) {
+		const GLfloat *col = b.m + 4*c;
+		__m128 s = _mm_mul_ps(a0, _mm_set1_ps(col[0]));
+		s = _mm_add_ps(s, _mm_mul_ps(a1, _mm_set1_ps(col[1])));
+		s = _mm_add_ps(s, _mm_mul_ps(a2, _mm_set1_ps(col[2])));
+		s = _mm_add_ps(s, _mm_mul_ps(a3, _mm_set1_ps(col[3])));
+		_mm_storeu_ps(r.m + 4*c, s);
+	}
+	return r;
+}
+
+#endif
+
+template<int N, typename T>
+std::ostream& operator<<(std::ostream& out, const Vec<N,T>& a) {
+	out << "(";
+	for (int i = 0; i < N; ++i) {
+		out << a.v[i] << (i < N-1 ? ", " : "");
+	}
+	return out << ")";
+}
+
+} // end namespace linalg
+} // end namespace DR
+
+#endif /* LINALG_H_ */
@@ -0,0 +1,139 @@
+/*
+ * lod.h
+ *
+ * Levels of detail by quadric error metric simplification (Garland and
+ * Heckbert), and picking a level from the projected size on screen.
+ * Collapses are half edge collapses, a vertex merges into a neighbor,
+ * so every level indexes the original vertex and normal arrays.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LOD_H_
+#define LOD_H_
+
+#include "dr_util.h"
+#include "linalg.h"
+#include "poly.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+// one level's triangles over the original vertices and normals
+struct LodLevel {
+	LodLevel() : error(0) {}
+	// 3 per triangle
+	std::vector<GLint> verts;
+	std::vector<GLint> norms;
+	// how far the surface may be from full detail, model units
+	GLfloat error;
+	size_t num_triangles() const { return verts.size() / 3; }
+};
+
+class QemSimplifier {
+public:
+	/**
+	 * tris: 3 vertex indices per triangle.
+	 * Degenerate triangles are dropped.
+	 */
+	QemSimplifier(const vec3 *verts, size_t num_verts, const std::vector<GLint>& tris);
+
+	// v won't be merged away
+	void lock(GLint v) { locked[v] = true; }
+
+	/**
+	 * Collapse edges, cheapest first, until there are at most target triangles
+	 * or the next collapse would move the surface more than max_error.
+	 * Vertices on a boundary only merge along it, so outlines and holes keep
+	 * their loops, and boundary edges have constraint planes to keep their shape.
+	 * Can be called again with a smaller target.  Returns triangles left.
+	 */
+	size_t simplify(size_t target, GLfloat max_error);
+
+	size_t num_triangles() const { return live_tris; }
+	// largest collapse so far as a distance
+	GLfloat error() const;
+	// the vertex each vertex has merged into, itself if still there
+	void get_remap(std::vector<GLint>& out) const;
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	struct Quadric {
+		double q[10];
+		Quadric() { for (int i = 0; i < 10; ++i) q[i] = 0; }
+		// plane ax + by + cz + d = 0, unit normal
+		void add_plane(double a, double b, double c, double d, double w);
+		void add(const Quadric& o) { for (int i = 0; i < 10; ++i) q[i] += o.q[i]; }
+		double eval(const linalg::Vec<3, double>& v) const;
+	};
+	struct Candidate {
+		double cost;
+		GLint u, v;
+		GLint u_version, v_version;
+		bool operator<(const Candidate& o) const { return cost > o.cost; }
+	};
+
+	std::vector<linalg::Vec<3, double> > pos;
+	std::vector<GLint> tris;
+	std::vector<bool> tri_alive;
+	std::vector<std::vector<GLint> > vert_tris;
+	std::vector<Quadric> quadrics;
+	std::vector<bool> locked;
+	std::vector<bool> boundary;
+	std::vector<GLint> merged_into;
+	std::vector<GLint> version;
+	std::vector<Candidate> heap;
+	size_t live_tris;
+	double max_cost;
+	bool heap_built;
+
+	void neighbors(GLint v, std::vector<GLint>& out) const;
+	// live triangles on edge a-b
+	int edge_count(GLint a, GLint b) const;
+	void push_candidates(GLint v);
+	bool can_collapse(GLint u, GLint v) const;
+	void collapse(GLint u, GLint v);
+	GLint find(GLint v) const;
+};
+
+/**
+ * Level 0 is polys as they are, then each level about ratio times the
+ * triangles of the one before, until a level doesn't get smaller or its
+ * error would pass max_error.  polys must be triangles.
+ * Corners that move to another vertex take the normal that vertex had.
+ */
+void build_lod_chain(const std::vector<Polygon*>& polys, const vec3 *verts, size_t num_verts,
+		std::vector<LodLevel>& chain, GLfloat max_error, GLfloat ratio=0.5f, size_t max_levels=6);
+
+/**
+ * Apply a remap from QemSimplifier to polys, dropping triangles that collapse.
+ * Vertex v of a poly becomes remap[v - offset] + offset, so a face built
+ * over offset copies of the vertices can follow the same collapses.
+ * vert_norm: normal index for each vertex, for corners that moved
+ */
+void remap_triangles(const std::vector<Polygon*>& polys, const std::vector<GLint>& remap,
+		const std::vector<GLint>& vert_norm, GLint offset, LodLevel& out);
+// a normal index used by each vertex in polys, -1 if unused
+void vertex_normals(const std::vector<Polygon*>& polys, size_t num_verts, std::vector<GLint>& out);
+
+/**
+ * Pixels on screen per model unit at p, for the given modelview, projection
+ * and viewport height.  Perspective only.
+ */
+GLfloat pixels_per_unit(const linalg::Mat4f& modelview, const linalg::Mat4f& projection,
+		GLint viewport_height, const vec3 p);
+// same, from the current GL matrices and viewport
+GLfloat pixels_per_unit(const vec3 p);
+
+/**
+ * Coarsest level in chain whose error is at most max_pixels on screen.
+ */
+int select_lod(const std::vector<LodLevel>& chain, GLfloat pixels_per_unit, GLfloat max_pixels=1.0f);
+
+} // end namespace DR
+
+#endif /* LOD_H_ */
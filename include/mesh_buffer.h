@@ -0,0 +1,111 @@
+/*
+ * mesh_buffer.h
+ *
+ * Indexed triangles with interleaved positions and normals, in GL buffer
+ * objects, drawn in ranges so culled meshlets can be left out.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MESH_BUFFER_H_
+#define MESH_BUFFER_H_
+
+#include "dr_util.h"
+#include "vertex_cache.h"
+
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+
+namespace DR {
+
+class MeshBuffer {
+public:
+	// indices[first .. first + count)
+	struct Range {
+		GLuint first, count;
+	};
+	// position then normal
+	static const int FLOATS_PER_VERTEX = 6;
+
+	MeshBuffer();
+	// frees the GL buffers, needs the context they were made in
+	~MeshBuffer();
+	void clear();
+
+	// following triangles go in a new range
+	void begin_range();
+	/**
+	 * Polygon with corners verts[vi[k]], fanned into triangles.  Normals are
+	 * norms[ni[k]], or normal for all of them if ni is NULL.
+	 * Corners with the same position and normal share a vertex.
+	 */
+	void add_polygon(const vec3 *verts, const GLint *vi, int size,
+			const vec3 *norms, const GLint *ni, const GLfloat *normal=NULL);
+
+	/**
+	 * Order the triangles of each range for the vertex cache, then number
+	 * the vertices in the order they are used.  Call before upload().
+	 */
+	void optimize(size_t cache_size=32);
+	VertexCacheStats cache_stats(size_t cache_size=16) const;
+
+	/**
+	 * Draw the ranges with a nonzero visible entry, all if visible is NULL.
+	 * Uploads the first time, falling back to client arrays without
+	 * buffer objects.  Positions and normals only, material and color are
+	 * whatever is current.
+	 */
+	void draw(const char *visible=NULL);
+	/**
+	 * Into buffer objects now rather than at the first draw, so loading can
+	 * spread uploads over frames.  Needs a current context.
+	 */
+	void upload();
+	bool is_uploaded() const { return uploaded; }
+
+	size_t num_vertices() const { return data.size() / FLOATS_PER_VERTEX; }
+	size_t num_triangles() const { return indices.size() / 3; }
+	size_t num_ranges() const { return ranges.size(); }
+	const std::vector<GLfloat>& get_data() const { return data; }
+	const std::vector<GLuint>& get_indices() const { return indices; }
+	const std::vector<Range>& get_ranges() const { return ranges; }
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	struct Key {
+		GLfloat v[FLOATS_PER_VERTEX];
+		bool operator==(const Key& o) const { return memcmp(v, o.v, sizeof(v)) == 0; }
+	};
+	struct KeyHash {
+		size_t operator()(const Key& k) const;
+	};
+
+	std::vector<GLfloat> data;
+	std::vector<GLuint> indices;
+	std::vector<Range> ranges;
+	// vertex of each position and normal, while adding
+	std::unordered_map<Key, GLuint, KeyHash> lookup;
+	// 0 until uploaded
+	GLuint vbo, ibo;
+	bool uploaded;
+
+	GLuint add_vertex(const GLfloat *pos, const GLfloat *norm);
+	void free_buffers();
+
+	MeshBuffer(const MeshBuffer&);
+	MeshBuffer& operator=(const MeshBuffer&);
+};
+
+/**
+ * Upload buffers not yet in GL, no more than budget of them, taking
+ * those uploaded from budget.  True once all are.  Needs a current context.
+ */
+bool upload_buffers(const std::vector<MeshBuffer*>& buffers, int& budget);
+
+} // end namespace DR
+
+#endif /* MESH_BUFFER_H_ */
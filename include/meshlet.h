@@ -0,0 +1,89 @@
+/*
+ * meshlet.h
+ *
+ * Meshlets: a mesh split into small groups of connected triangles, each
+ * with at most max_vertices distinct vertices and max_triangles triangles,
+ * its own bounding sphere and cone of normals, so culling, picking and
+ * sampling can work a group at a time.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MESHLET_H_
+#define MESHLET_H_
+
+#include "culling.h"
+#include "poly.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+struct Meshlet {
+	// into MeshletSet::vertices
+	GLuint vertex_offset, vertex_count;
+	// into MeshletSet::triangles (3 per) and MeshletSet::prims (1 per)
+	GLuint triangle_offset, triangle_count;
+	Sphere bounds;
+	NormalCone cone;
+};
+
+/**
+ * All meshlets of a mesh, in 3 contiguous arrays.
+ * A quad becomes 2 triangles, prims says which polygon and which half
+ * each triangle is: polygon = prims[t] >> 1, corners (0, 1, 2) or (0, 2, 3)
+ * if prims[t] & 1.
+ */
+struct MeshletSet {
+	static const size_t MAX_VERTICES = 64;
+	static const size_t MAX_TRIANGLES = 124;
+
+	std::vector<Meshlet> meshlets;
+	// mesh vertex index of each meshlet's vertices
+	std::vector<GLint> vertices;
+	// 3 per triangle, into the meshlet's part of vertices
+	std::vector<unsigned char> triangles;
+	// the polygon each triangle came from, see above
+	std::vector<GLint> prims;
+
+	size_t size() const { return meshlets.size(); }
+	size_t num_triangles() const { return prims.size(); }
+	void clear();
+	// mesh vertex index of corner k of triangle t of meshlet m
+	GLint vertex(const Meshlet& m, size_t t, int k) const {
+		return vertices[m.vertex_offset + triangles[3 * (m.triangle_offset + t) + k]];
+	}
+
+	/**
+	 * Nearest triangle ray hits, only testing meshlets whose sphere it hits.
+	 * dir needn't be unit, dist is in multiples of it.
+	 * return: index into prims, -1 if none
+	 */
+	GLint ray_intersect(const vec3 *verts, const linalg::Vec3f& origin, const linalg::Vec3f& dir,
+			GLfloat& dist) const;
+
+	// prints "!=:" lines on failure
+	static void test();
+};
+
+/**
+ * Grows meshlets over shared vertices, each time adding the triangle that
+ * brings in the fewest new vertices, starting a new one at the first
+ * unused triangle when full or out of neighbors.  Cones are of the
+ * facetnorms times outward (1 or -1).
+ */
+void build_meshlets(const std::vector<Polygon*>& polys, const vec3 *verts, GLfloat outward,
+		MeshletSet& out, size_t max_vertices=MeshletSet::MAX_VERTICES,
+		size_t max_triangles=MeshletSet::MAX_TRIANGLES);
+/**
+ * Same over an index array, prim_size (3 or 4) per polygon, normals from
+ * the winding.
+ */
+void build_meshlets(const std::vector<GLint>& indices, int prim_size, const vec3 *verts,
+		GLfloat outward, MeshletSet& out, size_t max_vertices=MeshletSet::MAX_VERTICES,
+		size_t max_triangles=MeshletSet::MAX_TRIANGLES);
+
+} // end namespace DR
+
+#endif /* MESHLET_H_ */
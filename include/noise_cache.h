@@ -0,0 +1,83 @@
+/*
+ * noise_cache.h
+ *
+ * Disk cache for the 3D noise texture.  The volume is stored as a small
+ * header followed by the RGBA texels, and memory mapped when opened, so
+ * startup doesn't have to bake it again.  The file is rebuilt when the
+ * parameters in the header don't match what was asked for.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef NOISE_CACHE_H_
+#define NOISE_CACHE_H_
+
+#include "mygl.h"
+#include <string>
+
+namespace DR {
+
+/**
+ * What a noise volume was baked with, see NoiseEngine::bake_texture().
+ */
+struct NoiseVolumeParams {
+	NoiseVolumeParams(int size=64, int octaves=4, int start_frequency=4, unsigned seed=30757)
+	: size(size), octaves(octaves), start_frequency(start_frequency), seed(seed) {}
+
+	bool operator==(const NoiseVolumeParams& other) const {
+		return size == other.size && octaves == other.octaves &&
+				start_frequency == other.start_frequency && seed == other.seed;
+	}
+	// bytes of texel data, RGBA
+	size_t num_bytes() const { return (size_t)size * size * size * 4; }
+
+	int size;
+	int octaves;
+	int start_frequency;
+	unsigned seed;
+};
+
+class NoiseVolumeCache {
+public:
+	NoiseVolumeCache()
+	: regenerated(false), map_base(NULL), map_len(0) {}
+	~NoiseVolumeCache() { close(); }
+
+	/**
+	 * Map the volume in path, baking it and writing the file first if it is
+	 * missing, unreadable or was made with different params.
+	 * return: false if the file could not be written or mapped
+	 */
+	bool open(const std::string& path, const NoiseVolumeParams& params);
+	/**
+	 * Unmap.  texels() is invalid after this.
+	 */
+	void close();
+
+	bool is_open() const { return map_base != NULL; }
+	// the texels, params.num_bytes() long, valid while open
+	const GLubyte* texels() const;
+	const NoiseVolumeParams& get_params() const { return params; }
+
+	// true if the last open() had to bake the volume
+	bool regenerated;
+
+	static void test();
+
+private:
+	// map path if its header matches params
+	bool map(const std::string& path, const NoiseVolumeParams& params);
+	// bake and write to path
+	bool write(const std::string& path, const NoiseVolumeParams& params);
+
+	NoiseVolumeParams params;
+	void *map_base;
+	size_t map_len;
+
+	NoiseVolumeCache(const NoiseVolumeCache&);
+	NoiseVolumeCache& operator=(const NoiseVolumeCache&);
+};
+
+} // end namespace DR
+
+#endif /* NOISE_CACHE_H_ */
@@ -0,0 +1,88 @@
+/*
+ * noise_engine.h
+ *
+ * Reentrant gradient noise.  Replaces the permutation and gradient tables
+ * in Noise.cpp with an integer hash of the lattice point, so an engine is
+ * just a seed and a period and any number of threads can share one.
+ * Evaluates in float, one sample at a time or 8 at a time with SSE2.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef NOISE_ENGINE_H_
+#define NOISE_ENGINE_H_
+
+#include "mygl.h"
+#include <cstddef>
+
+namespace DR {
+
+class NoiseEngine {
+public:
+	// samples per batch call
+	static const int BATCH = 8;
+
+	/**
+	 * params: seed - selects the noise pattern
+	 * period: if > 0, perlin noise repeats every period units along
+	 * each axis, so it can be used for tileable textures
+	 */
+	explicit NoiseEngine(unsigned seed=30757, int period=0)
+	: seed(seed), period(period) {}
+
+	/**
+	 * Improved Perlin noise at (x, y, z).  Roughly in [-1, 1],
+	 * 0 at integer lattice points.
+	 */
+	float perlin(float x, float y, float z) const;
+	/**
+	 * 3D simplex noise at (x, y, z), roughly in [-1, 1].
+	 * Ignores period.
+	 */
+	float simplex(float x, float y, float z) const;
+
+	/**
+	 * Batch versions, BATCH samples from x[], y[], z[] into out[].
+	 * Same results as the scalar versions.
+	 */
+	void perlin8(const float *x, const float *y, const float *z, float *out) const;
+	void simplex8(const float *x, const float *y, const float *z, float *out) const;
+
+	/**
+	 * Any number of samples, in batches with a scalar tail.
+	 */
+	void perlin(const float *x, const float *y, const float *z, float *out, size_t n) const;
+	void simplex(const float *x, const float *y, const float *z, float *out, size_t n) const;
+
+	/**
+	 * Sum of octaves like PerlinNoise3D(): sum of noise(p * beta^i) / alpha^i
+	 */
+	float fractal(float x, float y, float z, float alpha=2.0f, float beta=2.0f,
+			int octaves=4) const;
+
+	/**
+	 * Fills texPtr (size^3 * 4 bytes) with the same layout as make3DNoiseTexture():
+	 * octave i goes in channel i, frequency doubling and amplitude halving each octave.
+	 * Each octave repeats across the volume, so the texture tiles.
+	 * param: threads - number of worker threads, 0 -> one per core
+	 */
+	void bake_texture(GLubyte *texPtr, int size, int start_frequency=4,
+			int octaves=4, int threads=0) const;
+
+	unsigned seed;
+	int period;
+
+	// checks batch against scalar, tiling, threads; prints "!=:" lines on failure
+	static void test();
+	// timings against noise3() and PerlinNoise3D()
+	static void bench();
+
+private:
+	// bake z slices [z_begin, z_end) of one octave into channel
+	void bake_slices(GLubyte *texPtr, int size, int frequency, int channel,
+			float amp, int z_begin, int z_end) const;
+};
+
+} // end namespace DR
+
+#endif /* NOISE_ENGINE_H_ */
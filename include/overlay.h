@@ -0,0 +1,65 @@
+/*
+ * overlay.h
+ *
+ * Debug geometry, normals, grids, marked points, edges and polygons, built
+ * once into colored vertex arrays and drawn from them until the owner
+ * clears it.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef OVERLAY_H_
+#define OVERLAY_H_
+
+#include "dr_util.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+class DebugOverlay {
+public:
+	// position then color
+	static const int FLOATS_PER_VERTEX = 6;
+
+	DebugOverlay() : built(false) {}
+
+	// empty and not built, owners rebuild before the next draw
+	void clear();
+	// true once something was added or done() called, until clear()
+	bool is_built() const { return built; }
+	// built even if nothing was added
+	void done() { built = true; }
+
+	void add_line(const GLfloat *a, const GLfloat *b, const GLfloat *color);
+	void add_point(const GLfloat *p, const GLfloat *color);
+	// from p along unit n for size, with a point at the end
+	void add_normal(const GLfloat *p, const GLfloat *n, GLfloat size, const GLfloat *color);
+	// corners of a polygon by index into verts, filled as a fan
+	void add_polygon(const vec3 *verts, const GLint *index, int size, const GLfloat *color);
+
+	/**
+	 * Triangles, lines then points, one glDrawArrays each, lighting off.
+	 * line_width and point_size as glLineWidth and glPointSize.
+	 */
+	void draw(GLfloat line_width=1, GLfloat point_size=1, bool smooth_points=false) const;
+
+	size_t num_lines() const { return lines.size() / (2 * FLOATS_PER_VERTEX); }
+	size_t num_points() const { return points.size() / FLOATS_PER_VERTEX; }
+	size_t num_triangles() const { return triangles.size() / (3 * FLOATS_PER_VERTEX); }
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	std::vector<GLfloat> lines, points, triangles;
+	bool built;
+
+	static void add_vertex(std::vector<GLfloat>& to, const GLfloat *p, const GLfloat *color);
+	static void draw_array(const std::vector<GLfloat>& from, GLenum mode);
+};
+
+} // end namespace DR
+
+#endif /* OVERLAY_H_ */
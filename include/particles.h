@@ -13,6 +13,8 @@
 
 #include "dr_util.h"
 #include "vec.h"
+#include "linalg.h"
+#include "force_field.h"
 #include <vector>
 #include <stack>
 
@@ -22,7 +24,6 @@ class Particle {
 public:
 	Particle();
 	Particle(vec4 color, GLfloat size=1.0f, bool alive=true);
-	Particle(const Particle& other);
 	bool operator==(const Particle& other) const;
 	bool operator!=(const Particle& other) const {
 		return !(*this == other);
@@ -45,27 +46,15 @@ public:
 			color[i] = 1.0f;
 		}
 	}
-	LightBeam(const LightBeam& other) {
-		front = other.front;
-		tail = other.tail;
-		velocity = other.velocity;
-		copyv(color, other.color, 4);
-		width = other.width;
-		age = other.age;
-		front_life_span = other.front_life_span;
-		max_length = other.max_length;
-		tail_free = other.tail_free;
-		alive = other.alive;
-	}
 	//	LightBeam(Particle *end, vec3 origin)
 //	: front(end), tail(origin), front_life_span(4.0), no_back(true) {}
 
 	// simple light beam is a line connecting 2 points
 	// front and tail
 	// it is essentially a stretched out particle
-	Vec front;
-	Vec tail;
-	Vec velocity;
+	linalg::Vec3f front;
+	linalg::Vec3f tail;
+	linalg::Vec3f velocity;
 	vec4 color;
 	GLfloat width;
 	GLfloat age; // secs
@@ -93,11 +82,11 @@ public:
 	/**
 	 * Vector that is the front point of the beam minus the tail.
 	 */
-	void as_vec(Vec& out) const { out = front - tail; }
+	linalg::Vec3f as_vec() const { return front - tail; }
 	/**
 	 * Magnitude of as_vec vector.
 	 */
-	GLfloat length() const { return (front - tail).magnitude(); }
+	GLfloat length() const { return linalg::length(front - tail); }
 	/**
 	 * Kill this beam.  Does not remove.
 	 */
@@ -105,10 +94,36 @@ public:
 
 };
 
+/**
+ * Particles stored as a structure of arrays, so the update pass streams
+ * through each component rather than striding over whole Particles.
+ * Particle is still the unit for getting data in and out.
+ */
+struct ParticleArrays {
+	std::vector<GLfloat> px, py, pz;
+	std::vector<GLfloat> vx, vy, vz;
+	std::vector<GLfloat> age;
+	std::vector<GLfloat> size;
+	// rgba, 4 per particle
+	std::vector<GLfloat> color;
+	// alpha when reincarnated, what fading scales down
+	std::vector<GLfloat> spawn_alpha;
+	std::vector<unsigned char> alive;
+
+	size_t count() const { return px.size(); }
+	bool empty() const { return px.empty(); }
+	void assign(size_t n, const Particle& p);
+	void push_back(const Particle& p);
+	void set(size_t i, const Particle& p);
+	void get(size_t i, Particle& out) const;
+	void erase(size_t i);
+};
+
 /**
  * Collection of particles, using stl, but keeping particle vector full,
  * and kill particles by setting their alive flag off.  They are then
  * available to whomever wants a new particle.
+ * Particles are moved by the fields in forces, which are all off by default.
  */
 class ParticleSet {
 public:
@@ -134,25 +149,53 @@ public:
 	 */
 	bool reincarnate(vec4 color, vec3 pos, vec3 vel, GLfloat size=1.0f);
 
+	/**
+	 * Apply forces, move particles, kill particles past life span.
+	 */
 	virtual void update(GLfloat time_ms);
+	/**
+	 * Same as update, but alpha fades linearly from its spawn value
+	 * to 0 over the life span.
+	 */
 	void update_w_fade(GLfloat time_ms);
-	virtual void render();
+	/**
+	 * One fused pass over the particles: forces, integration, aging, fading.
+	 * param: dt - secs
+	 */
+	void step(GLfloat dt, bool fade);
+	/**
+	 * Particles drawn where they will be in ahead secs, to draw between
+	 * steps.  Streamed through frame_stream(), or from client memory when
+	 * it's full, a draw for each run of particles the same size.
+	 */
+	virtual void render(GLfloat ahead=0);
+	// position, color
+	static const int FLOATS_PER_VERTEX = 7;
 
 	bool is_empty() { return particles.empty(); }
-	int size() { return particles.size(); }
+	int size() { return particles.count(); }
 
-	int total_particles() { return particles.size(); }
-	int live_particles() { return particles.size() - dead_particles.size(); }
+	int total_particles() { return particles.count(); }
+	int live_particles() { return particles.count() - dead_particles.size(); }
 
 	// life span in secs
 	GLfloat life_span;
 	GLfloat old_time_ms;
 
+	// fields applied in update, see force_field.h
+	ForceFields forces;
+
+	// prints "!=:" lines on failure
+	static void test();
 
 protected:
-	std::vector<Particle> particles;
+	ParticleArrays particles;
 	// stack of indices of dead particles in particles vector
 	std::stack<int> dead_particles;
+	// point size and first vertex of each run drawn, kept between frames
+	std::vector<std::pair<GLfloat, GLint> > size_runs;
+	// vertices drawn from client memory when the frame's stream is full
+	std::vector<GLfloat> client_verts;
 
 };
 
@@ -172,7 +215,19 @@ public:
 	bool get_beam(vec4 color, vec3 pos, vec3 vel,
 			GLfloat life_span,  GLfloat length, GLfloat width=1.0f);
 	void update(GLfloat time_ms);
-	void render();
+	/**
+	 * Move, age and fade the beams.
+	 * param: dt - secs
+	 */
+	void step(GLfloat dt);
+	/**
+	 * Moving ends drawn where they will be in ahead secs.  Streamed through
+	 * frame_stream(), or from client memory when it's full, a draw for each
+	 * line width.
+	 */
+	void render(GLfloat ahead=0);
+	// beams flicker between this many widths
+	static const int NUM_WIDTHS = 6;
 	bool is_empty() { return beams.empty(); }
 	int size() { return beams.size(); }
 
@@ -188,6 +243,10 @@ protected:
 	std::vector<LightBeam> beams;
 	// stack of indices of dead beams in beams vector
 	std::vector<int> dead_beams;
+	// width picked for each beam this frame, kept between frames
+	std::vector<unsigned char> widths;
+	// vertices drawn from client memory when the frame's stream is full
+	std::vector<GLfloat> client_verts;
 
 };
 
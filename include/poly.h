@@ -13,10 +13,14 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <utility>
+#include <algorithm>
 
 #include "mygl.h"
 #include "dr_util.h"
 #include "vec.h"
+#include "linalg.h"
+#include "arena.h"
 
 // a namespace for things that might easily clash
 // may extend this
@@ -31,10 +35,6 @@ struct IndexedEdge {
 	GLint u;
 	GLint v;
 	IndexedEdge() {}
-	IndexedEdge(const IndexedEdge&  other) {
-		u = other.u;
-		v = other.v;
-	}
 	GLint other_end(GLint vert) {
 		return vert == u ? v : u;
 	}
@@ -58,12 +58,20 @@ class Polygon {
 public:
 	Polygon();
 	// vertices and normals are the arrays the GLint indices index
-	Polygon(GLint size, vec3 *vertices, vec3 *normals);
+	// if arena is given, index arrays come from it and aren't deleted
+	Polygon(GLint size, vec3 *vertices, vec3 *normals, Arena *arena=NULL);
+	// copies of polygons up to INLINE_SIZE vertices don't allocate
 	Polygon(const Polygon& p);
+	// takes p's heap index arrays, p is left empty
+	Polygon(Polygon&& p);
 	virtual ~Polygon();
 	// assignment makes a deep copy of everything
 	// but actual_verts and actual_norms point to same storage
+	// reuses this polygon's index arrays when the size matches
 	const Polygon& operator=(const Polygon& other);
+	const Polygon& operator=(Polygon&& other);
+	// triangles and quads keep their indices in the polygon itself
+	static const GLint INLINE_SIZE = 4;
 	// at this point == compares verts and norms by index
 	// not by actual vertex or normal contents
 	bool operator==(const Polygon& other) const;
@@ -71,6 +79,8 @@ public:
 		return !(*this == other);
 	}
 	GLint size;
+	// index in the face's polygons, set by Face::add_polygon, -1 if in no face
+	GLint id;
 	GLint *verts;
 	GLint *norms;
 	vec3 facetnorm;
@@ -100,6 +110,12 @@ public:
 	// applying cross product: (v0, v1) X (v1, v2)
 	// supply vertices[3] and above will be used with param vertices[]
 	void set_facetnorm(GLint *vertices=NULL);
+	/**
+	 * Carry facetnorm, center and the ray intersection data along after the
+	 * shared vertex storage has been transformed by m.
+	 * param: nm - normal_matrix(m), see transform.h
+	 */
+	void bake_transform(const linalg::Mat4f& m, const linalg::Mat4f& nm);
 
 	// ensures that polygon has right handed winding based on the normal
 	// if no normal is passed in, uses first vertex normal ( actual_norms[norms[0]] )
@@ -193,6 +209,19 @@ protected:
 	// references to vertex and normal storage
 	vec3 *actual_verts;
 	vec3 *actual_norms;
+	// verts, norms and edges belong to an Arena
+	bool arena_storage;
+	// verts, norms and edges for size <= INLINE_SIZE
+	GLint inline_verts[INLINE_SIZE];
+	GLint inline_norms[INLINE_SIZE];
+	IndexedEdge inline_edges[INLINE_SIZE];
+
+	// point verts, norms and edges at storage for size indices
+	void alloc_indices(Arena *arena);
+	void free_indices();
+	bool heap_storage() const { return verts && verts != inline_verts && !arena_storage; }
+	void copy_from(const Polygon& p);
+	void take_indices(Polygon& p);
 
 
 //	virtual void render();
@@ -200,9 +229,12 @@ protected:
 
 class Triangle: public Polygon {
 public:
-	Triangle(vec3 *vertices, vec3 *normals)
-	: Polygon(3, vertices, normals) {}
+	Triangle(vec3 *vertices, vec3 *normals, Arena *arena=NULL)
+	: Polygon(3, vertices, normals, arena) {}
 	Triangle(const Triangle& t): Polygon(t) {}
+	Triangle(Triangle&& t): Polygon(std::move(t)) {}
+	const Triangle& operator=(const Triangle& t) { Polygon::operator=(t); return *this; }
+	const Triangle& operator=(Triangle&& t) { Polygon::operator=(std::move(t)); return *this; }
 	void set_center();
 	/**
 	 * Returns true if ray intersects this poly.
@@ -222,9 +254,20 @@ private:
 
 class Quad: public Polygon {
 public:
-	Quad(vec3 *vertices, vec3 *normals)
-	: Polygon(4, vertices, normals) {}
-	Quad(const Quad& q): Polygon(q) {}
+	Quad(vec3 *vertices, vec3 *normals, Arena *arena=NULL)
+	: Polygon(4, vertices, normals, arena) {}
+	Quad(const Quad& q): Polygon(q), precomputed2(q.precomputed2) {}
+	Quad(Quad&& q): Polygon(std::move(q)), precomputed2(q.precomputed2) {}
+	const Quad& operator=(const Quad& q) {
+		Polygon::operator=(q);
+		precomputed2 = q.precomputed2;
+		return *this;
+	}
+	const Quad& operator=(Quad&& q) {
+		Polygon::operator=(std::move(q));
+		precomputed2 = q.precomputed2;
+		return *this;
+	}
 	void set_center();
 	/**
 	 * Returns true if ray intersects this poly.
@@ -250,21 +293,61 @@ struct PolygonCompare: std::binary_function<const Polygon *, const Polygon *, bo
 		bool operator()(const Polygon *lhs, const Polygon *rhs) const;
 };
 
+/**
+ * Hash and key equality for poly pointers in unordered containers.
+ * Equal as Polygon ==, the hash is of the index verts only.
+ */
+struct PolygonHash {
+	size_t operator()(const Polygon *p) const {
+		size_t seed = std::hash<GLint>()(p->size);
+		for (int i = 0; i < p->size; ++i) {
+			hash_combine(seed, std::hash<GLint>()(p->verts[i]));
+		}
+		return seed;
+	}
+};
+struct PolygonKeyEqual {
+	bool operator()(const Polygon *lhs, const Polygon *rhs) const {
+		return *lhs == *rhs;
+	}
+};
+
 // print out vector of polys with indices of vector
 // set a limit for printing if desired, -1 -> no limit
 // print_p: print the pointer as well
 void print_polys(const std::vector<Polygon*>& polys, int limit=-1, bool print_p=false);
 
+/**
+ * Sets of polygons in one face, as sorted vectors of unique Polygon::id.
+ * Linear merges with the std set algorithms, in place of the by value
+ * functions below.  out must not be one of the inputs.
+ */
+typedef vector<GLint> PolyIdSet;
+
+// ids of polys, sorted and uniqued
+void to_id_set(const vector<Polygon*>& polys, PolyIdSet& out);
+void id_union(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out);
+void id_intersection(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out);
+// in a and not in b
+void id_difference(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out);
+// in exactly one of a and b, what difference() below computes
+void id_symmetric_difference(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out);
+inline bool id_contains(const PolyIdSet& s, GLint id) {
+	return std::binary_search(s.begin(), s.end(), id);
+}
+
 //*** note these implementations could be done somehow with stl,
 // but since I'm using pointers, and I don't want to compare pointers
 // it's a thing
+// These compare polys by value and are O(n^2), they are kept as the
+// reference for testing the PolyIdSet functions above.
 
 // puts the intersection of v1 and v2 in intersect
 // clears intersect before and removes duplicates from intersect after
 void intersection(const vector<Polygon*>& v1, const vector<Polygon*>& v2,
 		vector<Polygon*>& intersect);
 
-// puts elements of the set difference of v1 and v2 in out
+// puts elements of the symmetric difference of v1 and v2 in out
 void difference(const vector<Polygon*>& v1, const vector<Polygon*>& v2,
 		vector<Polygon*>& out);
 
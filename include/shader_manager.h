@@ -0,0 +1,105 @@
+/*
+ * shader_manager.h
+ *
+ * GLSL programs built from source files specialized with #defines, kept
+ * by a hash of the final source.  Linked binaries are saved to disk and
+ * loaded on later runs when the driver supports program binaries.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SHADER_MANAGER_H_
+#define SHADER_MANAGER_H_
+
+#include "dr_util.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace DR {
+
+// name, value, in order
+typedef std::vector<std::pair<std::string, std::string> > ShaderDefines;
+
+/**
+ * src with each define set: an existing "#define name" line gets the new
+ * value, others are added after any #version line.  Carriage returns are
+ * dropped so the hash doesn't depend on line endings.
+ */
+std::string specialize_shader(const std::string& src, const ShaderDefines& defines);
+
+// 64 bit FNV-1a, stable across runs and builds, for names on disk
+unsigned long long fnv1a(const std::string& s, unsigned long long seed=14695981039346656037ULL);
+
+/**
+ * Key of a program from its final sources and the driver that would
+ * compile them, binaries from another driver don't load.
+ */
+unsigned long long shader_program_key(const std::string& vert, const std::string& frag,
+		const std::string& driver);
+
+// a program binary file: magic, format, size, then the binary
+bool write_program_binary(const std::string& path, GLenum format, const std::vector<char>& binary);
+// false if missing, truncated or not one of ours
+bool read_program_binary(const std::string& path, GLenum& format, std::vector<char>& binary);
+
+/**
+ * Where a program's uniform or attribute is, for a table resolved once
+ * after linking.  location is set to -1 if the program doesn't have it.
+ */
+struct ShaderBinding {
+	const char *name;
+	GLint *location;
+	bool attribute;
+};
+
+class ShaderManager {
+public:
+	// binaries go in cache_dir, "" to not save them
+	ShaderManager(const std::string& cache_dir="shader_cache/");
+	// deletes the programs, needs the context they were made in
+	~ShaderManager();
+
+	/**
+	 * Program from a vertex and fragment shader file, specialized with
+	 * defines.  The same sources give the same program.  Loads a saved
+	 * binary if there is one for this driver, otherwise compiles, links and
+	 * saves one.  0 if the files can't be read or it won't link.
+	 */
+	GLuint program(const std::string& vert_file, const std::string& frag_file,
+			const ShaderDefines& defines=ShaderDefines());
+
+	/**
+	 * Look up each binding in program, once, rather than by name each use.
+	 * return: how many the program doesn't have
+	 */
+	static int resolve(GLuint program, const ShaderBinding *bindings, size_t n);
+
+	// programs loaded from binaries and compiled from source since construction
+	int num_loaded() const { return loaded; }
+	int num_compiled() const { return compiled; }
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	std::string cache_dir;
+	std::map<unsigned long long, GLuint> programs;
+	int loaded, compiled;
+
+	static bool read_file(const std::string& path, std::string& out);
+	static bool binaries_supported();
+	GLuint load_binary(const std::string& path);
+	GLuint compile(const std::string& vert, const std::string& frag, bool retrievable);
+	void save_binary(GLuint program, const std::string& path);
+
+	ShaderManager(const ShaderManager&);
+	ShaderManager& operator=(const ShaderManager&);
+};
+
+} // end namespace DR
+
+#endif /* SHADER_MANAGER_H_ */
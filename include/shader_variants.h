@@ -0,0 +1,101 @@
+/*
+ * shader_variants.h
+ *
+ * The lighting shaders are one source, shaders/lighting.vp and .fp,
+ * specialized by #defines into a program for each light count, per vertex
+ * or per pixel lighting, specular, fog and wireframe.  Each draw picks its
+ * variant from the lights on and its material.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SHADER_VARIANTS_H_
+#define SHADER_VARIANTS_H_
+
+#include "dr_util.h"
+#include "shader_manager.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+struct ShaderVariant {
+	// as in the shaders
+	static const int MAX_LIGHTS = 8;
+
+	// GL_LIGHT0 up to this, 0 for the light model's scene color only
+	int num_lights;
+	bool per_pixel;
+	bool specular;
+	bool fog;
+	// unlit, vertex color, the rest is ignored
+	bool wireframe;
+	// lights and material from the blocks in uniform_blocks.h, not fixed function state
+	bool uniform_blocks;
+
+	ShaderVariant()
+	: num_lights(0), per_pixel(true), specular(true), fog(false), wireframe(false),
+	  uniform_blocks(false) {}
+
+	/**
+	 * Variant for a material lit by lights, which should be GL_LIGHT0 on up.
+	 * No specular if the material's specular color or all the lights' are
+	 * black, or material_specular is NULL.
+	 */
+	static ShaderVariant lit(const std::vector<const GLlight*>& lights,
+			const GLfloat *material_specular, bool per_pixel, bool fog, bool uniform_blocks=false);
+	static ShaderVariant wire(bool fog);
+
+	// the defines for the shader source
+	ShaderDefines defines() const;
+	// distinct for each variant that compiles differently
+	int key() const;
+	// eg "2 lights per pixel specular"
+	std::string name() const;
+};
+
+/**
+ * A program for each variant used, built the first time it is, and which
+ * is bound so switching to the same one costs nothing.
+ */
+class LightingShaders {
+public:
+	LightingShaders(ShaderManager& shaders, const std::string& vert_file,
+			const std::string& frag_file)
+	: shaders(shaders), vert_file(vert_file), frag_file(frag_file), bound(0), switches(0) {}
+
+	/**
+	 * Bind variant's program, building it the first time, with its blocks
+	 * at their bindings.  0 and the fixed pipeline if it won't build.
+	 * Needs a current context.
+	 */
+	GLuint use(const ShaderVariant& variant);
+	// back to the fixed pipeline
+	void release();
+
+	GLuint current() const { return bound; }
+	// variants built, including any that failed
+	size_t num_variants() const { return programs.size(); }
+	// glUseProgram calls made, to see switches being saved
+	size_t num_switches() const { return switches; }
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	ShaderManager& shaders;
+	std::string vert_file, frag_file;
+	// by key
+	std::map<int, GLuint> programs;
+	GLuint bound;
+	size_t switches;
+
+	void bind(GLuint program);
+};
+
+} // end namespace DR
+
+#endif /* SHADER_VARIANTS_H_ */
@@ -19,6 +19,10 @@
 #include "cylinder_model.h"
 #include "particles.h"
 #include "dr_glm.h"
+#include "hud.h"
+#include "shader_manager.h"
+#include "shader_variants.h"
+#include "async_loader.h"
 
 // glut global functions, can't be in a class
 // see show_mantra.cpp for info
@@ -31,7 +35,7 @@ int main(int argc, char** argv);
 class ShowMantraApp: public DR::GlutTrackballApp {
 public:
 	ShowMantraApp()
-	: NUM_SYLLS(6){}
+	: NUM_SYLLS(6), lighting(shaders, LIGHTING_VP, LIGHTING_FP), hud(hud_font) {}
 	ShowMantraApp(int window_width, int window_height,
 				int glut_button, int glut_modifier=0);
 	~ShowMantraApp();
@@ -40,13 +44,33 @@ public:
 //	void mouse_motion(int x, int y);
 //	void mouse(int button, int state, int x, int y);
 	void idle();
+	// moves the particles and beams, a fixed step at a time
+	void simulate(GLdouble dt);
 	void display();
 	void keyboard(unsigned char key, int x, int y);
 	void reshape(int w, int h);
 
-	void init_syllables();
+	/**
+	 * Start building the syllables and lotus moon on the loader's threads.
+	 * Each is drawn from the frame it's ready, see pump_loading().
+	 */
+	void load_models();
+	// once a frame: a few uploads, then swap in what's ready
+	void pump_loading();
+	bool loading() const { return !loader.is_done(); }
+	// steps of load_models(), on loader threads, no GL
+	void build_seed_syllable(Syllable3D *syll);
+	void build_syllable_base(size_t s, Syllable3D *syll);
+	// pre: sylls have initialized their bases
+	void map_bases_to_cylinder(const vector<Syllable3D*>& sylls, bool do_2d_tweak);
+	// extrude syllable s once mapped
+	void build_on_cylinder(size_t s, Syllable3D *syll);
+	void build_lotus_moon();
+	// the mapping steps at once, for the syllables already drawn
 	void map_to_cylinder(bool do_2d_tweak);
 	void toggle_normal_display(bool& normal_flag);
+	// show_normals and the like to the models loaded
+	void apply_normal_display();
 	void heads_up_display(bool show_keys, bool show_particles, bool show_framerate);
 	void init_syllable(const char *name, Syllable3D*& syll);
 	void init();
@@ -58,8 +82,20 @@ public:
 	void draw_seed_syllable(Syllable3D *syll, bool wire=false);
 	void draw_debug_syllable(Syllable3D *syll, bool wire);
 	void init_single_syll();
-	void init_lotus_moon();
 	void draw_lotus_moon();
+	// per draw lighting program, for a material with this specular color,
+	// or unlit, all only if shader_on
+	void use_lit_shader(const GLfloat *specular);
+	void use_wire_shader();
+	void use_fixed_pipeline();
+	// lights_block up to date and bound, once a frame
+	void upload_lights();
+	// where the seed syllable and lotus moon sit in world space
+	static DR::linalg::Mat4f seed_placement();
+	static DR::linalg::Mat4f lotus_placement();
+
+	// frustum and backface cull a syllable under the current modelview
+	void cull_syllable(Syllable3D *syll);
 
 	// lotus and moon seat under syllables
 	// glm version
@@ -74,6 +110,14 @@ public:
 	DR::GLlight light0;
 	// a second light, maybe not used all the time
 	DR::GLlight light1;
+	// the lights enabled, in GL_LIGHT0 on up order, for picking shaders
+	std::vector<const DR::GLlight*> lights_on;
+	// the modelview the lights were positioned under
+	GLfloat light_view[16];
+	// lights_on for the shaders reading uniform blocks
+	DR::UniformBuffer lights_block;
+	// material of the debug shape
+	DR::UniformBuffer debug_material;
 
 	// 'name' of current syllable
 	const int NUM_SYLLS; // = 6;
@@ -81,7 +125,10 @@ public:
 
 	// syllables on cylinder
 	AnimatedSyllable3D  *om, *ma, *ni, *pay, *may, *hung, *hrih;
+	// NULL until loaded, then mantra's
 	vector<Syllable3D*> syllables;
+	// the syllables loading, in syllables' order
+	vector<Syllable3D*> mantra;
 
 
 	// syllable rendering
@@ -129,22 +176,50 @@ public:
 	int beam_ct;
 
 	// shader stuff
-	GLint vert_shader;
-	GLint frag_shader;
-	GLint shader_prog;
-	// uniforms
-	GLint loc_front_light_model_product;
-	GLfloat front_light_model_product[4];
-	// flag to allow disabling of lighting with shader
-	GLint loc_disable_lighting;
-	//bool disable_lighting = false;
+	static const char *LIGHTING_VP, *LIGHTING_FP;
+	DR::ShaderManager shaders;
+	// a lighting program for each combination of lights, material and state used
+	DR::LightingShaders lighting;
 	// flag for turning off shaders
 	bool shader_on;
+	// light each pixel rather than each vertex, x key toggles
+	bool per_pixel_lighting;
+	// linear fog to the background color, F key toggles
+	bool use_fog;
+	// lights and materials go to the shaders in uniform buffers, if the driver has them
+	bool use_uniform_blocks;
+	// if true the seed syllable and lotus moon are transformed into
+	// world space once when loaded, rather than every frame by the matrix stack
+	bool bake_placements;
+	// if true the syllables and lotus moon draw a level of detail picked
+	// each frame by their size on screen, l key toggles
+	bool use_lods;
+	// if true skip syllables, their meshlets and the lotus moon
+	// when out of view or facing away, c key toggles
+	bool use_culling;
+	// this frame's, shown with the framerate
+	DR::CullStats cull_stats;
 
 	// not a general thing, just use for when working something out
 	// d key toggles
 	bool debug;
 
+	// heads up display text, Times Roman 24 rasterized in init()
+	DR::GlyphAtlas hud_font;
+	DR::HudText hud;
+	enum HudRun { HUD_KEYS, HUD_KEYS_RIGHT, HUD_ANNOUNCE, HUD_COUNT, HUD_FRAMERATE, HUD_CULLED };
+	// keybindings, a line each, for the HUD_KEYS runs
+	std::string hud_keys[2];
+
+	// GL buffers uploaded a frame while loading
+	int uploads_per_frame;
+	DR::Stopwatch load_time;
+	// building each of syllables, hrih and the lotus moon
+	std::vector<DR::LoadJob*> syllable_jobs;
+	DR::LoadJob *seed_job, *lotus_moon_job;
+	// last, so its threads stop before what they build goes
+	DR::AsyncLoader loader;
+
 };
 
 
@@ -0,0 +1,107 @@
+/*
+ * stream_buffer.h
+ *
+ * Vertices made fresh each frame go in one ring of NUM_FRAMES regions.
+ * A frame sub-allocates from its region, and the region isn't written
+ * again until a fence says the GPU has drawn from it.  The buffer is
+ * mapped once, persistently, where the driver allows it.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef STREAM_BUFFER_H_
+#define STREAM_BUFFER_H_
+
+#include "dr_util.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+class StreamBuffer {
+public:
+	static const int NUM_FRAMES = 3;
+	/**
+	 * PERSISTENT maps a buffer object, and falls back to CPU if the driver
+	 * can't.  CPU keeps the ring in client memory, drawn as client arrays,
+	 * and needs no GL context.
+	 */
+	enum Mode { CPU, PERSISTENT };
+
+	// frame_bytes for each frame
+	StreamBuffer(size_t frame_bytes, Mode mode=PERSISTENT);
+	// frees the buffer, needs the context it was made in
+	~StreamBuffer();
+
+	/**
+	 * Move to the next frame's region, waiting for the GPU to finish with
+	 * it if it hasn't.  Makes the buffer the first time.
+	 */
+	void begin_frame();
+	// fence the frame's region, after its draws
+	void end_frame();
+
+	/**
+	 * bytes from this frame's region, at a multiple of align.  NULL if the
+	 * region is full.  offset: where it starts, for pointer()
+	 */
+	void* alloc(size_t bytes, size_t& offset, size_t align=16);
+	GLfloat* alloc_floats(size_t n, size_t& offset) {
+		return (GLfloat*)alloc(n * sizeof(GLfloat), offset);
+	}
+
+	// bind before the gl*Pointer calls with pointer(offset), unbind after
+	void bind() const;
+	void unbind() const;
+	const GLvoid* pointer(size_t offset) const;
+
+	Mode get_mode() const { return mode; }
+	size_t frame_capacity() const { return frame_bytes; }
+	// region in use
+	int frame_region() const { return region; }
+	// this frame so far, padding included
+	size_t bytes_used() const { return used; }
+	size_t last_frame_bytes() const { return last_used; }
+	unsigned long long total_bytes() const { return total; }
+	size_t frames() const { return num_frames; }
+	// allocations that didn't fit
+	size_t failed_allocs() const { return failed; }
+	// frames that had to wait on a fence
+	size_t fence_waits() const { return waits; }
+
+	// prints "!=:" lines on failure
+	static void test();
+
+private:
+	Mode mode;
+	size_t frame_bytes;
+	// CPU mode
+	std::vector<unsigned char> memory;
+	// PERSISTENT mode
+	GLuint buffer;
+	unsigned char *mapped;
+	GLsync fences[NUM_FRAMES];
+	bool made;
+
+	int region;
+	size_t used, last_used;
+	unsigned long long total;
+	size_t num_frames, failed, waits;
+
+	void make();
+	unsigned char* base() { return mode == CPU ? &memory[0] : mapped; }
+
+	StreamBuffer(const StreamBuffer&);
+	StreamBuffer& operator=(const StreamBuffer&);
+};
+
+/**
+ * The ring shared by everything drawn per frame.  GlutApp begins and ends
+ * its frames around each render.
+ */
+StreamBuffer& frame_stream();
+
+} // end namespace DR
+
+#endif /* STREAM_BUFFER_H_ */
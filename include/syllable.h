@@ -17,6 +17,13 @@
 #include "vec.h"
 #include "face.h"
 #include "geo.h"
+#include "cdt.h"
+#include "lod.h"
+#include "culling.h"
+#include "meshlet.h"
+#include "mesh_buffer.h"
+#include "overlay.h"
+#include "uniform_blocks.h"
 
 extern "C" {
 #include "glm.h"
@@ -83,7 +90,8 @@ public:
 
 	GLMmodel* getBase2dModel() { return base2d.getModel(); }
 
-	// initialize base_face using base2d model information
+	// initialize base_face using base2d model information,
+	// its regions, perimeters and center are left until needed
 	void init_base();
 	/**
 	 * removes sides and extruded face and resets base_face from model
@@ -91,6 +99,13 @@ public:
 	 */
 	void reinit();
 
+	// regions and perimeters of the base face, found on first use
+	const vector<Region*>& base_regions();
+	// the extruded face's, copied from the base face's on first use after extrude
+	const vector<Region*>& extruded_regions();
+	// false from init_base until something needs the regions or center
+	bool has_topology() const { return !topology_dirty; }
+
 	// reset winding for all base polygons
 	// for now uses set_winding_from_normal()
 	void reset_base_windings();
@@ -110,8 +125,20 @@ public:
 	//		  and set facetnorm accordingly
 	void create_sides(bool rev_winding=false);
 
+	/**
+	 * Transform the syllable into place once, rather than through the
+	 * matrix stack every frame.  Moves vertices, normals, polygon facetnorms
+	 * and centers, center and assigned_center.  Call after extrude.
+	 * The glm model drawn by render_model() is left alone.
+	 * m must not mirror, polygon winding is not flipped.
+	 */
+	void bake_transform(const DR::linalg::Mat4f& m);
+
 	// get a copy of the actual vertex from its index
 	void get_vert(GLint index, vec3 out);
+	// base vertex index as loaded, or as added by retessellate_base,
+	// flat on xz, however it has moved since
+	void get_layout_vert(GLint index, vec3 out);
 	// get a copy of the actual normal from its index
 	void get_norm(GLint index, vec3 out);
 
@@ -123,8 +150,115 @@ public:
 	// for input to triangle program
 	void export_poly_file(const char *polyfile);
 
+	/**
+	 * Constrained Delaunay triangulation of the base face's region
+	 * perimeters as (x, z), in process instead of the export_poly_file,
+	 * triangle, triangle_to_obj.py round trip.  Any number of holes per region.
+	 * Use opts to trade triangle count for quality and size.
+	 * If vert_index isn't NULL, it gets the base vertex index of each
+	 * perimeter point in out.points, points after those are new.
+	 */
+	void triangulate_base(DR::CDTMesh& out, const DR::CDTOptions& opts=DR::CDTOptions(),
+			vector<GLint> *vert_index=NULL);
+	/**
+	 * Rebuild the base face from triangulate_base's triangles, after
+	 * init_base and before mapping or extrude.  Perimeter points keep their
+	 * base vertices, points added by refinement become new base vertices
+	 * on the face's plane.  Vertices only inside the old triangles are left
+	 * unused.  reinit goes back to the model's triangles.
+	 */
+	void retessellate_base(const DR::CDTOptions& opts=DR::CDTOptions());
+
+	// one level of detail of the whole syllable, see build_lods()
+	struct Lod {
+		DR::LodLevel base;
+		DR::LodLevel extruded;
+		// 4 vertices per side quad, wound like sides
+		vector<GLint> side_verts;
+		// facet normal of each side quad
+		vector<DR::linalg::Vec3f> side_norms;
+		// by BASE, EXTRUDED, SIDES, see build_meshlets()
+		DR::MeshletSet meshlets[3];
+		size_t num_triangles() const {
+			return base.num_triangles() + extruded.num_triangles() + side_verts.size() / 2;
+		}
+	};
+	/**
+	 * Simplify the base and extruded faces together into levels of detail,
+	 * level 0 being the full mesh, each about ratio times the one before.
+	 * Region perimeters only lose vertices along themselves, and the sides
+	 * are rebuilt between the ones left, so the faces and sides still close up.
+	 * Call after extrude, and after bake_transform so errors are in world units.
+	 */
+	void build_lods(GLfloat ratio=0.5f, size_t max_levels=5);
+	size_t num_lods() const { return lods.size(); }
+	const Lod& get_lod_level(size_t i) const { return lods[i]; }
+	// level drawn by render() and render_wire(), 0 -> full mesh
+	void set_lod(int level) { lod = level; }
+	int current_lod() const { return lod; }
+	// sets and returns the coarsest level within max_pixels of full detail on screen
+	int select_lod(GLfloat pixels_per_unit, GLfloat max_pixels=1.0f);
+
+	/**
+	 * Bounds of the syllable, and meshlets of each surface for the full mesh
+	 * and every level of detail, for cull(), pick() and sample_polygon().
+	 * Call after extrude, build_lods and bake_transform keep them up.
+	 */
+	void build_meshlets(size_t max_vertices=DR::MeshletSet::MAX_VERTICES,
+			size_t max_triangles=DR::MeshletSet::MAX_TRIANGLES);
+	// of the full mesh, by BASE, EXTRUDED, SIDES
+	const DR::MeshletSet& get_meshlets(int surface) const { return meshlets[surface]; }
+	const DR::Sphere& get_bounds() const { return bounds; }
+	const DR::Aabb& get_box() const { return box; }
+	/**
+	 * Frustum cull the syllable, then the meshlets of the current level of
+	 * detail, and if backface, meshlets facing away from eye.  frustum and
+	 * eye are in the syllable's space.  render() and render_wire() skip
+	 * whatever is culled until the next cull() or clear_cull().
+	 */
+	void cull(const DR::Frustum& frustum, const DR::linalg::Vec3f& eye, bool backface,
+			DR::CullStats& stats);
+	void clear_cull();
+	/**
+	 * Nearest polygon of the full mesh the ray hits, in the syllable's space,
+	 * testing the triangles of meshlets whose bounds it passes through.
+	 * surface gets BASE, EXTRUDED or SIDES, dist how far along dir.
+	 * return: index in that surface's polygons, -1 if none or no meshlets
+	 */
+	GLint pick(const DR::linalg::Vec3f& origin, const DR::linalg::Vec3f& dir,
+			int& surface, GLfloat& dist) const;
+	/**
+	 * Random polygon index of surface, evenly by triangle.  If visible_only,
+	 * only from meshlets left by the last cull() while at level 0, or the
+	 * whole surface unless the syllable was culled at other levels.
+	 * return: -1 if none
+	 */
+	GLint sample_polygon(int surface, bool visible_only=false) const;
+
+	/**
+	 * Vertex and index buffers of the full mesh and every level of detail,
+	 * a range per meshlet if built, else per surface.  Unless optimize is
+	 * false, triangles are ordered for the vertex cache within each range
+	 * and vertices by first use.  render() draws through them, except
+	 * with a color per polygon.  build_lods, build_meshlets and
+	 * bake_transform keep them up.
+	 */
+	void build_buffers(bool optimize=true);
+	// of level, 0 -> full mesh, NULL if not built
+	const DR::MeshBuffer* get_buffer(size_t level) const {
+		return level < buffers.size() ? buffers[level] : NULL;
+	}
+	/**
+	 * Upload buffers not yet in GL, no more than budget of them, taking
+	 * those uploaded from budget.  True once all are.  Needs a current
+	 * context, drawing uploads any left.
+	 */
+	bool upload_buffers(int& budget);
+
 	// just all purpose testing
 	static void test();
+	// time and count allocations building and freeing the syllables
+	static void bench();
 
 	int num_polygons() {
 		int total = base_face.polygons.size() + extruded_face.polygons.size() + sides.size();
@@ -144,6 +278,7 @@ public:
 	void print_polygons(int which_surface, int how_many=-1,
 			int start_index=0);
 
+	// filled from the faces on the first render_debug() after init_base
 	vector<Polygon*> debug_polygons;
 	vector<IndexedEdge> debug_edges;
 	vector<GLint> debug_verts;
@@ -171,8 +306,12 @@ public:
 	vec3* get_normals() {
 		return normals;
 	}
+	// regions may not be found yet, see base_regions()
+	const Face& get_base_face() const {
+		return base_face;
+	}
 
-	// center is set during init_base, then during extrude
+	// center is the base face's after init_base, then set during extrude
 	// so after one of these, you should get something of interest
 	void get_center(vec3 out);
 
@@ -182,6 +321,8 @@ public:
 	GLfloat specular[4];
 	GLfloat shininess[1];
 	GLfloat emissive[4];
+	// the same for the shaders, when they read uniform blocks
+	DR::UniformBuffer material_block;
 
 	// point to set manually however looks good
 	vec3 assigned_center;
@@ -199,9 +340,14 @@ protected:
 	// if wire -> render with wireframe, using line_sz
 	void render_face(const Face& face, GLfloat *color=NULL,
 			bool wire=false, bool no_mat=false, GLfloat line_sz=1);
+	// same rules as with faces, for lods[lod]
+	void render_lod(const Lod& l, GLfloat *color=NULL, bool wire=false,
+			bool no_mat=false, GLfloat line_sz=1);
 	// same rules as with faces
 	void render_sides(GLfloat *color=NULL, bool wire=false,
 			bool no_mat=false, GLfloat line_sz=1);
+	// solid, through buffers[level], the meshlets left by cull()
+	void render_buffer(size_t level, GLfloat *color, bool no_mat);
 	/**
 	 * Draw all normals the same size, if not given, will use average of max/min base face poly
 	 * side lengths
@@ -210,6 +356,9 @@ protected:
 	 * 					'b': both
 	 */
 	void draw_normals(char which='f', GLfloat size=-1.0);
+	// drop what draw_normals() and render_debug() keep, call after changing
+	// vertices or normals directly
+	void invalidate_overlays();
 	// render the glm model that we started from
 	void render_model();
 	// render an individual polygon
@@ -231,9 +380,18 @@ protected:
 
 	// all vertices, first half should be from base2d
 	vec3 *vertices;
+	// layout of base vertices after the model's, from retessellate_base
+	vector<Vec> added_layout;
 	// normals match up with vertices
 	vec3 *normals;
 
+	// polygons, regions and perimeters of the faces and sides,
+	// unless use_mesh_arenas was off when constructed
+	DR::Arena mesh_arena;
+	// new polygon on vertices and normals, in mesh_arena if in use
+	Triangle* new_triangle();
+	Quad* new_quad();
+
 	// base face is made up of base2d vertices
 	// but normals will be opposite
 	Face base_face;
@@ -248,11 +406,70 @@ protected:
 	// storage for vertex normals for side polygons
 	vec3 *side_normals;
 
+	// levels of detail, empty until build_lods()
+	vector<Lod> lods;
+	// lods[i].base.error, only the errors, for DR::select_lod
+	vector<DR::LodLevel> lod_errors;
+	int lod;
+	// side quads of l between the perimeter vertices remap keeps
+	void build_lod_sides(const vector<GLint>& remap, Lod& l);
+
+	DR::Sphere bounds;
+	DR::Aabb box;
+	// meshlets of the full mesh, limits 0 -> none built
+	DR::MeshletSet meshlets[3];
+	size_t meshlet_vertices, meshlet_triangles;
+	// 1 or -1 by surface, facetnorm * outward points out of the syllable
+	GLfloat outward[3];
+	// whether each meshlet and each polygon of the current level is drawn, empty -> all
+	vector<char> meshlet_visible[3];
+	vector<char> poly_visible[3];
+	// level meshlet_visible is for
+	int culled_lod;
+	bool culled;
+	// sets outward from the geometry, the windings differ between extrude options
+	void find_outward();
+	bool drawn(int surface, size_t poly) const {
+		const vector<char>& v = poly_visible[surface];
+		return poly >= v.size() || v[poly];
+	}
+
+	// by level of detail, empty until build_buffers()
+	vector<DR::MeshBuffer*> buffers;
+	bool buffers_optimized;
+	// meshlet_visible of all surfaces, one per buffer range
+	vector<char> range_visible;
+	void free_buffers();
+	// half of a quad split as in meshlets, -1 -> the whole polygon
+	void buffer_polygon(DR::MeshBuffer& mb, size_t level, int surface, GLint poly, int half);
+
+	// lines built by draw_normals() for normals_which and normals_size
+	DR::DebugOverlay normals_overlay;
+	char normals_which;
+	GLfloat normals_size;
+	void build_normals_overlay(char which, GLfloat size);
+	// render_debug()'s, for the debug lists at these sizes and debug_color
+	DR::DebugOverlay debug_overlay;
+	size_t debug_counts[4];
+	GLfloat *debug_color;
+	void build_debug_overlay(GLfloat *color);
+
+	// base_face's regions and center are out of date with its polygons
+	bool topology_dirty;
+	// extrude reversed base_face's perimeters after making the sides
+	bool base_perimeters_reversed;
+	// the debug lists are, filled by render_debug()
+	bool debug_dirty;
+	// if dirty, base_face's regions and center poly, and center if not extruded yet
+	void update_topology();
+	void update_debug();
+
 	// center of syllable, be wary,
-	// initialized to set to {0, 0, 0}, reset by init_base, extrude
+	// initialized to set to {0, 0, 0}, reset by update_topology, extrude
 	vec3 center;
 
-	clock_t start_time;
+	// for age(), from construction
+	DR::Stopwatch lifetime;
 };
 
 
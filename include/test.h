@@ -15,6 +15,13 @@
 
 namespace DR {
 
+/**
+ * Run headless benchmarks, from main with --bench [name].
+ * param: which - name of one benchmark, empty -> all of them
+ * DR::test() (see dr_util.h) runs the headless tests, from main with --test.
+ */
+void bench(const std::string& which="");
+
 class GLTest {
 public:
 	virtual void init() {}
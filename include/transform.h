@@ -0,0 +1,53 @@
+/*
+ * transform.h
+ *
+ * Batch transforms of vec3 arrays by a Mat4, for baking static placements
+ * into world space once instead of going through the GL matrix stack
+ * every frame.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TRANSFORM_H_
+#define TRANSFORM_H_
+
+#include "dr_util.h"
+#include "linalg.h"
+#include <cstddef>
+
+namespace DR {
+
+/**
+ * Matrix for transforming normals along with points transformed by m:
+ * the inverse transpose of the upper 3x3, no translation.
+ * If m is singular, returns its upper 3x3.
+ */
+linalg::Mat4f normal_matrix(const linalg::Mat4f& m);
+
+// largest scale along any axis of m's upper 3x3, lengths grow at most this much
+GLfloat max_scale(const linalg::Mat4f& m);
+
+/**
+ * out[i] = m * in[i] as points, w = 1, no perspective divide.
+ * in and out may be the same array.
+ * param: threads - worker threads, 0 -> one per core, small arrays
+ * 		always run on the calling thread
+ */
+void transform_points(const linalg::Mat4f& m, const vec3 *in, vec3 *out,
+		size_t count, int threads=1);
+
+/**
+ * out[i] = normalized(normal_matrix(m) * in[i]).
+ * m is the matrix the points were transformed with, not the normal matrix.
+ * in and out may be the same array.
+ */
+void transform_normals(const linalg::Mat4f& m, const vec3 *in, vec3 *out,
+		size_t count, int threads=1);
+
+// checks kernels against transform_vec; prints "!=:" lines on failure
+void transform_test();
+void transform_bench();
+
+} // end namespace DR
+
+#endif /* TRANSFORM_H_ */
@@ -0,0 +1,117 @@
+/*
+ * uniform_blocks.h
+ *
+ * Lights and materials for the lighting shaders in std140 uniform blocks,
+ * packed on the CPU and kept in buffer objects, so a draw binds a buffer
+ * rather than setting fixed function state for the shader to read back.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef UNIFORM_BLOCKS_H_
+#define UNIFORM_BLOCKS_H_
+
+#include "dr_util.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace DR {
+
+// binding points of the blocks in shaders/lighting.vp and .fp
+enum UniformBlockBinding { LIGHTS_BINDING = 0, MATERIAL_BINDING = 1 };
+
+/**
+ * Bytes laid out as std140 would lay out the same members in order.
+ * Each add returns the member's offset.
+ */
+class Std140Packer {
+public:
+	void clear() { bytes.clear(); }
+
+	// scalars on 4 bytes, vec2 on 8, vec3 and vec4 on 16
+	size_t add_float(GLfloat f);
+	size_t add_int(GLint i);
+	size_t add_vec(const GLfloat *v, int n);
+	// column major, 4 vec4 columns
+	size_t add_mat4(const GLfloat *m);
+	// structs and array elements start and end on 16 bytes
+	void align_struct() { pad_to(16); }
+
+	// of the block, rounded up to 16 bytes
+	size_t size() const { return (bytes.size() + 15) & ~(size_t)15; }
+	const std::vector<unsigned char>& get_bytes() const { return bytes; }
+
+private:
+	std::vector<unsigned char> bytes;
+
+	void pad_to(size_t align);
+	size_t add(const void *p, size_t n, size_t align);
+};
+
+/**
+ * The Lights block, for GL_LIGHT0 on up, unused ones zero:
+ *   struct LightParams { vec4 position, halfVector, ambient, diffuse, specular; };
+ *   LightParams light_source[ShaderVariant::MAX_LIGHTS]; vec4 scene_ambient;
+ * Positions go to eye space by view, the modelview the lights are set
+ * under, as glLightfv does.  Half vectors are for a viewer at infinity.
+ */
+void pack_lights(Std140Packer& p, const std::vector<const GLlight*>& lights,
+		const GLfloat *scene_ambient, const GLfloat *view);
+/**
+ * The Material block:
+ *   struct MaterialParams { vec4 ambient, diffuse, specular, emission; float shininess; };
+ */
+void pack_material(Std140Packer& p, const GLfloat *ambient, const GLfloat *diffuse,
+		const GLfloat *specular, const GLfloat *emission, GLfloat shininess);
+
+/**
+ * A uniform buffer holding one packed block, uploaded only when the bytes
+ * differ from what it holds.
+ */
+class UniformBuffer {
+public:
+	UniformBuffer() : buffer(0), uploads(0) {}
+	// frees the buffer, needs the context it was made in
+	~UniformBuffer();
+
+	// cleared, to pack this block's bytes into for upload(), keeps its capacity
+	Std140Packer& packer() { staging.clear(); return staging; }
+	// true if it had to upload
+	bool upload(const Std140Packer& p);
+	// to binding, for the blocks bound there
+	void bind(GLuint binding) const;
+
+	size_t num_uploads() const { return uploads; }
+
+private:
+	GLuint buffer;
+	std::vector<unsigned char> held;
+	size_t uploads;
+	Std140Packer staging;
+
+	UniformBuffer(const UniformBuffer&);
+	UniformBuffer& operator=(const UniformBuffer&);
+};
+
+/**
+ * Point program's Lights and Material blocks, if it has them, at their
+ * bindings.  Once after linking.
+ */
+void bind_uniform_blocks(GLuint program);
+
+// true while the programs drawn with read the blocks, off by default
+void set_material_blocks(bool on);
+bool material_blocks();
+
+/**
+ * Material for the next draw: through block, uploaded the first time or
+ * when it changes, if material_blocks(), otherwise glMaterialfv on GL_FRONT.
+ * ambient_diffuse is both, as GL_AMBIENT_AND_DIFFUSE.
+ */
+void apply_material(UniformBuffer& block, const GLfloat *ambient_diffuse, const GLfloat *specular,
+		const GLfloat *shininess, const GLfloat *emission);
+
+} // end namespace DR
+
+#endif /* UNIFORM_BLOCKS_H_ */
@@ -13,6 +13,7 @@
 #include <iostream>
 #include <string>
 #include <set>
+#include <unordered_set>
 
 #include "mygl.h"
 #include "dr_util.h"
@@ -41,9 +42,6 @@ public:
 	Vec(GLfloat _x=0, GLfloat _y=0, GLfloat _z=0)
 	: x(_x), y(_y), z(_z) {	}
 
-	Vec(const Vec& other)
-	: x(other.x), y(other.y), z(other.z) { }
-
 	Vec(const GLfloat other[3])
 	: x(other[0]), y(other[1]), z(other[2]) { }
 
@@ -87,9 +85,8 @@ public:
 	bool equal_within(const Vec& other, GLfloat tolerance);
 
 	// subscript
-	// calls exit if bad index
-	GLfloat operator[](GLint index);
-	const Vec& operator=(const Vec& other_vec);
+	// bad index asserts in debug builds
+	GLfloat operator[](GLint index) const;
 	const Vec& operator=(const GLfloat other[3]);
 	const Vec& operator+=(const Vec& other_vec);
 	const Vec& operator-=(const Vec& other_vec);
@@ -107,17 +104,37 @@ Vec operator*(GLfloat matrix[16], Vec p);
 
 /**
  * Comparison functor for Vec objects.  Can therefore use in sets, etc
+ * Exact lexicographic order, not the tolerance of ==, which isn't transitive.
  */
 struct VecCompare: std::binary_function<Vec, Vec, bool> {
 	bool operator()(const Vec& lhs, const Vec& rhs) const {
-		if(lhs.x < rhs.x) {
-			return true;
-		} else if(lhs.y < rhs.y) {
-			return true;
-		} else if(lhs.z < rhs.z) {
-			return true;
+		if(lhs.x != rhs.x) {
+			return lhs.x < rhs.x;
+		} else if(lhs.y != rhs.y) {
+			return lhs.y < rhs.y;
 		}
-		return false;
+		return lhs.z < rhs.z;
+	}
+};
+
+/**
+ * Hash and key equality for Vecs in unordered containers.
+ * Components are snapped to cells of FLOAT_TOLERANCE, Vecs in the same
+ * cell are the same key.  Unlike ==, Vecs within tolerance of each other
+ * on either side of a cell boundary are different keys, but hash and
+ * equality always agree.
+ */
+struct VecHash {
+	size_t operator()(const Vec& v) const {
+		GLfloat vals[3] = { v.x, v.y, v.z };
+		return hash_buckets(vals, 3);
+	}
+};
+struct VecKeyEqual {
+	bool operator()(const Vec& lhs, const Vec& rhs) const {
+		return float_bucket(lhs.x) == float_bucket(rhs.x) &&
+				float_bucket(lhs.y) == float_bucket(rhs.y) &&
+				float_bucket(lhs.z) == float_bucket(rhs.z);
 	}
 };
 
@@ -150,10 +167,6 @@ public:
 	: start(start), end(end), width(width) {
 		copyv(this->color, color);
 	}
-	LineSeg(const LineSeg& other)
-	: start(other.start), end(other.end), width(other.width) {
-		copyv(this->color, other.color);
-	}
 	/**
 	 * Calls draw_line() - ie sets up opengl state.
 	 */
@@ -173,21 +186,42 @@ public:
 struct LineSegCompare: std::binary_function<LineSeg, LineSeg, bool> {
 	VecCompare vecless;
 	Vec3Compare vec3less;
+	// lexicographic on start, end, width, color
 	bool operator()(const LineSeg& lhs, const LineSeg& rhs) const {
 		if( vecless(lhs.start, rhs.start) ) {
 			return true;
+		} else if( vecless(rhs.start, lhs.start) ) {
+			return false;
 		} else if( vecless(lhs.end, rhs.end) ) {
 			return true;
-		} else if( lhs.width < rhs.width ) {
-			return true;
-		} else if( vec3less(lhs.color, rhs.color) ) {
-			return true;
+		} else if( vecless(rhs.end, lhs.end) ) {
+			return false;
+		} else if( lhs.width != rhs.width ) {
+			return lhs.width < rhs.width;
 		}
-		return false;
+		return vec3less(lhs.color, rhs.color);
+	}
+};
+
+// hash and key equality for LineSegs, bucketed as VecHash
+struct LineSegHash {
+	size_t operator()(const LineSeg& l) const {
+		GLfloat vals[10] = { l.start.x, l.start.y, l.start.z, l.end.x, l.end.y, l.end.z,
+				l.color[0], l.color[1], l.color[2], l.width };
+		return hash_buckets(vals, 10);
+	}
+};
+struct LineSegKeyEqual {
+	VecKeyEqual vec_equal;
+	bool operator()(const LineSeg& lhs, const LineSeg& rhs) const {
+		return vec_equal(lhs.start, rhs.start) && vec_equal(lhs.end, rhs.end) &&
+				vec_equal(Vec(lhs.color), Vec(rhs.color)) &&
+				float_bucket(lhs.width) == float_bucket(rhs.width);
 	}
 };
 
 typedef std::set<LineSeg, LineSegCompare> LineSet;
+typedef std::unordered_set<LineSeg, LineSegHash, LineSegKeyEqual> LineHashSet;
 
 /**
  * Draws a line with a point for the tip of the vector, ie the direction it is pointing.
@@ -0,0 +1,56 @@
+/*
+ * vertex_cache.h
+ *
+ * Triangle order for the post transform vertex cache (Tom Forsyth's
+ * linear speed optimisation), vertex order for fetching, and how well an
+ * index buffer uses a FIFO cache.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VERTEX_CACHE_H_
+#define VERTEX_CACHE_H_
+
+#include "dr_util.h"
+
+#include <vector>
+#include <cstddef>
+#include <ostream>
+
+namespace DR {
+
+struct VertexCacheStats {
+	VertexCacheStats() : acmr(0), atvr(0), misses(0) {}
+	// average cache misses per triangle, 0.5 is the best a big grid can do, 3 the worst
+	GLfloat acmr;
+	// misses per vertex used, 1 is best
+	GLfloat atvr;
+	size_t misses;
+};
+
+std::ostream& operator<<(std::ostream& out, const VertexCacheStats& s);
+
+/**
+ * Reorder the triangles of indices, 3 per, in place so consecutive
+ * triangles share vertices still in an LRU cache of cache_size.  Each
+ * triangle keeps its corners in order, so windings don't change.
+ * num_verts: greater than every index
+ */
+void optimize_vertex_cache(GLuint *indices, size_t num_indices, size_t num_verts, size_t cache_size=32);
+
+/**
+ * Renumber vertices in the order indices first use them.
+ * remap gets the new index of each old vertex, -1 if unused.
+ * return: number of vertices used
+ */
+size_t optimize_vertex_fetch(GLuint *indices, size_t num_indices, size_t num_verts, std::vector<GLint>& remap);
+
+/**
+ * Misses drawing indices through a FIFO cache of cache_size vertices.
+ */
+VertexCacheStats analyze_vertex_cache(const GLuint *indices, size_t num_indices, size_t num_verts,
+		size_t cache_size=16);
+
+} // end namespace DR
+
+#endif /* VERTEX_CACHE_H_ */
@@ -1,8 +0,0 @@
-// fragment shader
-// stock shader for directional lights 
-// with per vertex lighting
-// should exactly mimic fixed pipeline
-
-void main() {
-	gl_FragColor = gl_Color;
-}
@@ -0,0 +1,84 @@
+#version 120
+// fragment shader
+// directional lights, GL_LIGHT0 on up
+// the app sets the defines below for each variant it draws with,
+// see shader_variants.h
+
+#define MAX_LIGHTS 8
+
+// lights on, 0 for just the light model's scene color
+#define NUM_LIGHTS 2
+// 1 lights each pixel, 0 each vertex like the fixed pipeline
+#define PER_PIXEL 1
+// 0 when the material or the lights have no highlight
+#define SPECULAR 1
+// 1 for linear fog from gl_Fog
+#define FOG 0
+// 1 for lines in their own color, unlit
+#define WIREFRAME 0
+// 1 to read lights and material from the Lights and Material blocks,
+// 0 from the fixed function state
+#define UNIFORM_BLOCKS 0
+
+#define LIT (WIREFRAME == 0 && NUM_LIGHTS > 0)
+
+#if UNIFORM_BLOCKS
+#extension GL_ARB_uniform_buffer_object : require
+// packed by uniform_blocks.cpp
+struct LightParams {
+	vec4 position, halfVector, ambient, diffuse, specular;
+};
+struct MaterialParams {
+	vec4 ambient, diffuse, specular, emission;
+	float shininess;
+};
+layout(std140) uniform Lights {
+	LightParams light_source[MAX_LIGHTS];
+	vec4 scene_ambient;
+};
+layout(std140) uniform Material {
+	MaterialParams material;
+};
+#define LIGHT_SOURCE light_source
+#define FRONT_MATERIAL material
+#define SCENE_COLOR (material.emission + material.ambient * scene_ambient)
+#else
+#define LIGHT_SOURCE gl_LightSource
+#define FRONT_MATERIAL gl_FrontMaterial
+#define SCENE_COLOR gl_FrontLightModelProduct.sceneColor
+#endif
+
+varying vec4 Color;
+
+#if LIT && PER_PIXEL
+varying vec3 N;
+varying vec3 L[NUM_LIGHTS], H[NUM_LIGHTS];
+varying vec4 Diffuse[NUM_LIGHTS];
+#endif
+
+void main() {
+	// color has all ambient components
+	vec4 color = Color;
+
+#if LIT && PER_PIXEL
+	vec3 n = normalize(N);
+	int i;
+	for(i=0; i<NUM_LIGHTS; i++) {
+		float NdotL = max(0.0, dot(n, L[i]));
+		color += Diffuse[i] * NdotL;
+#if SPECULAR
+		// no highlight facing away from the light, without a branch
+		float spec_factor = step(0.00001, NdotL) *
+				pow(max(0.0, dot(n, normalize(H[i]))), FRONT_MATERIAL.shininess);
+		color += FRONT_MATERIAL.specular * LIGHT_SOURCE[i].specular * spec_factor;
+#endif
+	}
+#endif
+	color = clamp(color, 0.0, 1.0);
+
+#if FOG
+	float fog = clamp((gl_Fog.end - gl_FogFragCoord) * gl_Fog.scale, 0.0, 1.0);
+	color.rgb = mix(gl_Fog.color.rgb, color.rgb, fog);
+#endif
+	gl_FragColor = color;
+}
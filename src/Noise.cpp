@@ -4,7 +4,10 @@
 //
 
 #include "Noise.h"
+#include "noise_engine.h"
+#include "noise_cache.h"
 #include <cmath>
+#include <cstdlib>
 //#include "os.h"
 
 //void init3DNoiseTexture(int texSize, GLubyte* texPtr);
@@ -40,10 +43,22 @@ int start;
 int B;
 int BM;
 
+// baked volume, rebuilt when the parameters change
+const char* Noise3DCacheFile = "data/noise3d.cache";
+
 void CreateNoise3D()
 {
+	DR::NoiseVolumeCache cache;
+	if(cache.open(Noise3DCacheFile, DR::NoiseVolumeParams(Noise3DTexSize)))
+	{
+		init3DNoiseTexture(Noise3DTexSize, cache.texels());
+		return;
+	}
+	// no cache, bake in memory
 	make3DNoiseTexture();
 	init3DNoiseTexture(Noise3DTexSize, Noise3DTexPtr);
+	free(Noise3DTexPtr);
+	Noise3DTexPtr = NULL;
 }
 
 void SetNoiseFrequency(int frequency)
@@ -284,6 +299,14 @@ double PerlinNoise3D(double x, double y, double z, double alpha, double beta, in
 }
 
 void make3DNoiseTexture()
+{
+	Noise3DTexPtr = (GLubyte*) malloc(Noise3DTexSize * Noise3DTexSize * Noise3DTexSize * 4);
+	// same layout as make3DNoiseTextureScalar(), but batched and threaded
+	DR::NoiseEngine().bake_texture(Noise3DTexPtr, Noise3DTexSize, 4, 4);
+}
+
+// the original one sample at a time version, kept for comparison
+void make3DNoiseTextureScalar(int texSize, GLubyte* texPtr)
 {
 	int f, i, j, k, inc;
 	int startFrequency = 4;
@@ -294,22 +317,21 @@ void make3DNoiseTexture()
 	GLubyte* ptr;
 	double amp = 0.5;
 
-	Noise3DTexPtr = (GLubyte*) malloc(Noise3DTexSize * Noise3DTexSize * Noise3DTexSize * 4);
 	for (f = 0, inc = 0; f < numOctaves; ++f, frequency *= 2, ++inc, amp *= 0.5)
 	{
 //		wxGetApp().Statusf("Generating 3D noise: octave %d/%d...", f + 1, numOctaves);
 		SetNoiseFrequency(frequency);
-		ptr = Noise3DTexPtr;
+		ptr = texPtr;
 		ni[0] = ni[1] = ni[2] = 0;
 
-		inci = 1.0 / (Noise3DTexSize / frequency);
-		for (i = 0; i < Noise3DTexSize; ++i, ni[0] += inci)
+		inci = 1.0 / (texSize / frequency);
+		for (i = 0; i < texSize; ++i, ni[0] += inci)
 		{
-			incj = 1.0 / (Noise3DTexSize / frequency);
-			for (j = 0; j < Noise3DTexSize; ++j, ni[1] += incj)
+			incj = 1.0 / (texSize / frequency);
+			for (j = 0; j < texSize; ++j, ni[1] += incj)
 			{
-				inck = 1.0 / (Noise3DTexSize / frequency);
-				for (k = 0; k < Noise3DTexSize; ++k, ni[2] += inck, ptr += 4)
+				inck = 1.0 / (texSize / frequency);
+				for (k = 0; k < texSize; ++k, ni[2] += inck, ptr += 4)
 					*(ptr + inc) = (GLubyte) (((noise3(ni) + 1.0) * amp) * 128.0);
 			}
 		}
@@ -376,7 +398,7 @@ void init3DNoiseTexture()
 	GL_UNSIGNED_BYTE, noise3DTexPtr);
 }
  */
-void init3DNoiseTexture(int texSize, GLubyte* texPtr)
+void init3DNoiseTexture(int texSize, const GLubyte* texPtr)
 {
 	glTexParameterf(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameterf(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -384,5 +406,4 @@ void init3DNoiseTexture(int texSize, GLubyte* texPtr)
 	glTexParameterf(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameterf(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA, texSize, texSize, texSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, texPtr);
-	free(texPtr);
 }
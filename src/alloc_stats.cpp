@@ -0,0 +1,64 @@
+/*
+ * alloc_stats.cpp
+ *
+ * Replaces the global operator new and delete to count calls.  The
+ * nothrow and array forms in libstdc++ go through these.
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "alloc_stats.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+using namespace DR;
+
+// relaxed is enough, these are only ever read as totals
+static atomic<unsigned long long> num_allocs(0), num_frees(0), num_bytes(0);
+
+void* operator new(size_t size) {
+	num_allocs.fetch_add(1, memory_order_relaxed);
+	num_bytes.fetch_add(size, memory_order_relaxed);
+	void *p = malloc(size ? size : 1);
+	if(!p) {
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size) {
+	return ::operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+	if(p) {
+		num_frees.fetch_add(1, memory_order_relaxed);
+		free(p);
+	}
+}
+
+void operator delete[](void *p) noexcept {
+	::operator delete(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	::operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+	::operator delete(p);
+}
+
+AllocStats AllocStats::now() {
+	AllocStats s;
+	s.allocs = num_allocs.load(memory_order_relaxed);
+	s.frees = num_frees.load(memory_order_relaxed);
+	s.bytes = num_bytes.load(memory_order_relaxed);
+	return s;
+}
+
+ostream& DR::operator<<(ostream& out, const AllocStats& s) {
+	return out << s.allocs << " allocs, " << s.frees << " frees, " << s.bytes << " bytes";
+}
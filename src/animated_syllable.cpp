@@ -20,16 +20,20 @@ using namespace DR;
  * possible values = -1 -> all, BASE, EXTRUDED, SIDES
  */
 void AnimatedSyllable3D::get_particles(ParticleSet& part_set, GLfloat speed,
-			int num_per_face, int which_surface) {
+			int num_per_face, int which_surface, bool visible_only) {
 	int num_in_face = base_face.polygons.size();
 	if(num_per_face == -1) {
 		num_per_face = num_in_face/3;
 	}
 	// assign random polygon indices to get particles from
-	// within faces
-	vector<int> poly_indices(num_per_face);
+	// within faces, through the meshlets if built
+	vector<int> poly_indices;
+	poly_indices.reserve(num_per_face);
 	for (int i = 0; i < num_per_face; ++i) {
-		poly_indices.push_back( rand() % num_in_face );
+		int poss_index = sample_polygon(BASE, visible_only);
+		if(poss_index >= 0) {
+			poly_indices.push_back( poss_index );
+		}
 	}
 	// color
 	vec4 col;
@@ -39,6 +43,8 @@ void AnimatedSyllable3D::get_particles(ParticleSet& part_set, GLfloat speed,
 	// center of syllable
 //	Vec syll_center = center;
 	Vec syll_center = assigned_center;
+	// radial force field pulls back toward the syllable
+	part_set.forces.set_center(assigned_center);
 
 	// ray to vertex on face
 	Vec ray_from_center;
@@ -92,7 +98,7 @@ void AnimatedSyllable3D::get_particles(ParticleSet& part_set, GLfloat speed,
  * Like get_particles.
  */
 void AnimatedSyllable3D::get_beams(LightBeamSet& beam_set, GLfloat speed,
-		int num_per_face, int which_surface) {
+		int num_per_face, int which_surface, bool visible_only) {
 	GLfloat min_lifetime = 1;
 	GLfloat max_lifetime = 4;
 	// length of beam
@@ -106,12 +112,14 @@ void AnimatedSyllable3D::get_beams(LightBeamSet& beam_set, GLfloat speed,
 	}
 
 	// assign random polygon indices to get particles from
-	// within faces
-	vector<int> poly_indices(num_per_face);
+	// within faces, through the meshlets if built
+	vector<int> poly_indices;
+	poly_indices.reserve(num_per_face);
 	for (int i = 0; i < num_per_face; ++i) {
-		int poss_index = rand() % num_in_face;
-
-		poly_indices.push_back( poss_index );
+		int poss_index = sample_polygon(BASE, visible_only);
+		if(poss_index >= 0) {
+			poly_indices.push_back( poss_index );
+		}
 	}
 	// color of beam (all same for now)
 	vec4 color;
@@ -181,9 +189,10 @@ void AnimatedSyllable3D::get_beams(LightBeamSet& beam_set, GLfloat speed,
 	int num_for_sides = (int)(num_in_sides * .75);
 
 	for (int i = 0; i < num_for_sides; ++i) {
-		int poss_index = rand() % num_in_sides;
-
-		poly_indices.push_back( poss_index );
+		int poss_index = sample_polygon(SIDES, visible_only);
+		if(poss_index >= 0) {
+			poly_indices.push_back( poss_index );
+		}
 	}
 
 	for (size_t i = 0; i < poly_indices.size(); ++i) {
@@ -0,0 +1,151 @@
+/*
+ * arena.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "arena.h"
+#include <cstdint>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace DR;
+
+bool DR::use_mesh_arenas = true;
+
+Arena::Arena(size_t block_size)
+: block_size(block_size), first(NULL), current(NULL), cur(NULL), end(NULL),
+  finalizers(NULL), used(0), reserved(0) {}
+
+Arena::~Arena() {
+	reset();
+	while(first) {
+		Block *next = first->next;
+		::operator delete(first);
+		first = next;
+	}
+}
+
+void* Arena::allocate(size_t bytes, size_t align) {
+	assert(align && (align & (align - 1)) == 0);
+	uintptr_t p = (reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(uintptr_t)(align - 1);
+	if(!cur || p + bytes > reinterpret_cast<uintptr_t>(end)) {
+		next_block(bytes, align);
+		p = (reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(uintptr_t)(align - 1);
+	}
+	cur = reinterpret_cast<char*>(p + bytes);
+	used += bytes;
+	return reinterpret_cast<void*>(p);
+}
+
+void Arena::next_block(size_t bytes, size_t align) {
+	size_t need = bytes + align;
+	// reuse blocks kept from before a reset
+	Block *next = current ? current->next : first;
+	if(!next || next->size < need) {
+		size_t size = need > block_size ? need : block_size;
+		Block *b = static_cast<Block*>(::operator new(sizeof(Block) + size));
+		b->size = size;
+		b->next = next;
+		if(current) {
+			current->next = b;
+		} else {
+			first = b;
+		}
+		reserved += size;
+		next = b;
+	}
+	current = next;
+	cur = current->data();
+	end = cur + current->size;
+}
+
+void Arena::add_finalizer(void *obj, void (*fn)(void*)) {
+	Finalizer *f = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+	f->fn = fn;
+	f->obj = obj;
+	f->next = finalizers;
+	finalizers = f;
+}
+
+void Arena::reset() {
+	while(finalizers) {
+		// the record is arena memory too, so read next before running
+		Finalizer *next = finalizers->next;
+		finalizers->fn(finalizers->obj);
+		finalizers = next;
+	}
+	current = NULL;
+	cur = end = NULL;
+	used = 0;
+}
+
+size_t Arena::num_blocks() const {
+	size_t n = 0;
+	for (Block *b = first; b; b = b->next) {
+		++n;
+	}
+	return n;
+}
+
+namespace {
+// counts live instances, for checking reset() runs destructors
+struct Counted {
+	static int live;
+	Counted() { ++live; }
+	~Counted() { --live; }
+	double pad[3];
+};
+int Counted::live = 0;
+}
+
+void Arena::test() {
+	cout <<  "\n******************** Arena::test() **************************" << endl;
+	Arena arena(1024);
+	for (int i = 0; i < 100; ++i) {
+		arena.create<Counted>();
+	}
+	if(Counted::live != 100) {
+		cout << "!=: create: live = " << Counted::live << endl;
+	}
+	char *c = arena.allocate_array<char>(3);
+	double *d = arena.allocate_array<double>(4);
+	if((reinterpret_cast<uintptr_t>(d) & (alignof(double) - 1)) != 0 || (void*)c == (void*)d) {
+		cout << "!=: allocate alignment" << endl;
+	}
+	// bigger than a block
+	char *big = arena.allocate_array<char>(5000);
+	big[4999] = 1;
+	size_t reserved = arena.bytes_reserved();
+	arena.reset();
+	if(Counted::live != 0 || arena.bytes_used() != 0) {
+		cout << "!=: reset: live = " << Counted::live << ", used = " << arena.bytes_used() << endl;
+	}
+	// same again reuses the blocks
+	for (int i = 0; i < 100; ++i) {
+		arena.create<Counted>();
+	}
+	arena.allocate_array<char>(5000);
+	if(arena.bytes_reserved() != reserved) {
+		cout << "!=: reset should keep blocks: " << reserved << " -> " << arena.bytes_reserved() << endl;
+	}
+
+	vector<int, ArenaAllocator<int> > v((ArenaAllocator<int>(&arena)));
+	for (int i = 0; i < 1000; ++i) {
+		v.push_back(i);
+	}
+	vector<int, ArenaAllocator<int> > heap_v;
+	heap_v.assign(v.begin(), v.end());
+	if(v.size() != 1000 || v[999] != 999 || heap_v != v || heap_v.get_allocator().arena != NULL) {
+		cout << "!=: ArenaAllocator vector" << endl;
+	}
+	v.clear();
+	v.shrink_to_fit();
+	arena.reset();
+	if(Counted::live != 0) {
+		cout << "!=: second reset: live = " << Counted::live << endl;
+	}
+	cout << "\n***************** Done:  Arena::test() ***********************" << endl;
+}
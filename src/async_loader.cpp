@@ -0,0 +1,283 @@
+/*
+ * async_loader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "async_loader.h"
+
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+AsyncLoader::AsyncLoader(int num_threads)
+: stopping(false) {
+	if(num_threads <= 0) {
+		num_threads = max(1, (int)thread::hardware_concurrency() - 1);
+	}
+	for (int t = 0; t < num_threads; ++t) {
+		workers.push_back(thread(&AsyncLoader::work, this));
+	}
+}
+
+AsyncLoader::~AsyncLoader() {
+	{
+		lock_guard<mutex> l(lock);
+		stopping = true;
+	}
+	work_ready.notify_all();
+	for (size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		delete jobs[i];
+	}
+}
+
+LoadJob* AsyncLoader::submit(LoadJob *job) {
+	jobs.push_back(job);
+	lock_guard<mutex> l(lock);
+	bool failed = false;
+	for (size_t i = 0; i < job->waits_for.size(); ++i) {
+		LoadJob *p = job->waits_for[i];
+		if(p->state() == LoadJob::FAILED) {
+			failed = true;
+		} else if(p->state() < LoadJob::LOADED) {
+			p->dependents.push_back(job);
+			++job->prereqs;
+		}
+	}
+	if(failed) {
+		finished_loading(job, false);
+	} else if(job->prereqs == 0) {
+		job->st = LoadJob::QUEUED;
+		queue.push_back(job);
+		work_ready.notify_one();
+	}
+	return job;
+}
+
+void AsyncLoader::work() {
+	unique_lock<mutex> l(lock);
+	while(true) {
+		while(!stopping && queue.empty()) {
+			work_ready.wait(l);
+		}
+		if(stopping) {
+			return;
+		}
+		LoadJob *job = queue.front();
+		queue.pop_front();
+		job->st = LoadJob::LOADING;
+		l.unlock();
+		bool ok = job->load();
+		l.lock();
+		finished_loading(job, ok);
+		job_loaded.notify_all();
+	}
+}
+
+void AsyncLoader::finished_loading(LoadJob *job, bool ok) {
+	job->st = ok ? LoadJob::LOADED : LoadJob::FAILED;
+	loaded.push_back(job);
+	for (size_t i = 0; i < job->dependents.size(); ++i) {
+		LoadJob *d = job->dependents[i];
+		if(d->state() != LoadJob::WAITING) {
+			// failed by another of its prereqs
+			continue;
+		}
+		if(!ok) {
+			finished_loading(d, false);
+		} else if(--d->prereqs == 0) {
+			d->st = LoadJob::QUEUED;
+			queue.push_back(d);
+			work_ready.notify_one();
+		}
+	}
+	job->dependents.clear();
+}
+
+int AsyncLoader::pump(int max_uploads) {
+	int done = 0;
+	{
+		lock_guard<mutex> l(lock);
+		for ( ; !loaded.empty(); loaded.pop_front()) {
+			LoadJob *job = loaded.front();
+			if(job->failed()) {
+				cerr << "AsyncLoader: " << job->get_name() << " failed" << endl;
+				++done;
+			} else {
+				uploading.push_back(job);
+			}
+		}
+	}
+	int budget = max_uploads;
+	while(!uploading.empty() && uploading.front()->upload(budget)) {
+		uploading.front()->st = LoadJob::READY;
+		uploading.pop_front();
+		++done;
+	}
+	return done;
+}
+
+void AsyncLoader::wait(LoadJob *job) {
+	while(true) {
+		// nothing else is drawing meanwhile, so no limit on uploads
+		pump(INT_MAX);
+		if(job->done()) {
+			return;
+		}
+		unique_lock<mutex> l(lock);
+		while(loaded.empty()) {
+			job_loaded.wait(l);
+		}
+	}
+}
+
+void AsyncLoader::finish() {
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		wait(jobs[i]);
+	}
+}
+
+size_t AsyncLoader::num_done() const {
+	size_t n = 0;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		n += jobs[i]->done();
+	}
+	return n;
+}
+
+float AsyncLoader::progress() const {
+	return jobs.empty() ? 1.0f : (float)num_done() / jobs.size();
+}
+
+namespace {
+// sums to n, then pretends to upload in uploads steps
+struct TestJob : public DR::LoadJob {
+	TestJob(const string& name, int n, int uploads, bool fails=false)
+	: LoadJob(name), n(n), uploads_left(uploads), fails(fails), sum(0),
+	  prereqs_loaded(true), off_main(false) {}
+	bool load() {
+		for (size_t i = 0; i < waits_for_copy.size(); ++i) {
+			LoadJob::State s = waits_for_copy[i]->state();
+			prereqs_loaded = prereqs_loaded && (s == LOADED || s == READY);
+		}
+		off_main = this_thread::get_id() != main_id;
+		for (int i = 1; i <= n; ++i) {
+			sum += i;
+		}
+		this_thread::sleep_for(chrono::microseconds(200));
+		return !fails;
+	}
+	bool upload(int& budget) {
+		while(uploads_left > 0 && budget > 0) {
+			--uploads_left;
+			--budget;
+			++uploads;
+		}
+		return uploads_left == 0;
+	}
+	void wait_on(LoadJob *p) {
+		after(p);
+		waits_for_copy.push_back(p);
+	}
+	int n, uploads_left;
+	bool fails;
+	long long sum;
+	bool prereqs_loaded, off_main;
+	vector<LoadJob*> waits_for_copy;
+	static thread::id main_id;
+	static int uploads;
+};
+thread::id TestJob::main_id;
+int TestJob::uploads = 0;
+}
+
+void AsyncLoader::test() {
+	cout <<  "\n******************** AsyncLoader::test() **************************" << endl;
+	TestJob::main_id = this_thread::get_id();
+	{
+		AsyncLoader loader(3);
+		vector<TestJob*> built;
+		for (int i = 0; i < 8; ++i) {
+			built.push_back(new TestJob("sum", 1000 * (i + 1), 3));
+			loader.submit(built.back());
+		}
+		// a chain, each loaded only after the one before
+		TestJob *first = new TestJob("first", 10, 1), *second = new TestJob("second", 10, 1),
+				*third = new TestJob("third", 10, 0);
+		second->wait_on(first);
+		third->wait_on(second);
+		third->wait_on(built[7]);
+		// submitted out of order
+		loader.submit(third);
+		loader.submit(first);
+		loader.submit(second);
+		// a failure fails what waits on it
+		TestJob *bad = new TestJob("bad", 1, 1, true), *after_bad = new TestJob("after bad", 1, 1);
+		after_bad->wait_on(bad);
+		loader.submit(bad);
+		loader.submit(after_bad);
+
+		TestJob::uploads = 0;
+		int frames = 0, done = 0;
+		bool over_budget = false;
+		while(!loader.is_done() && frames < 100000) {
+			int before = TestJob::uploads;
+			done += loader.pump(2);
+			over_budget = over_budget || TestJob::uploads - before > 2;
+			++frames;
+			this_thread::sleep_for(chrono::microseconds(100));
+		}
+		if(!loader.is_done() || done != 13 || loader.progress() != 1.0f) {
+			cout << "!=: " << loader.num_done() << " of " << loader.num_jobs() << " done, pump said "
+					<< done << endl;
+		}
+		if(over_budget || TestJob::uploads != 8 * 3 + 2) {
+			cout << "!=: " << TestJob::uploads << " uploads, over budget " << over_budget << endl;
+		}
+		bool sums = true, off_main = true;
+		for (size_t i = 0; i < built.size(); ++i) {
+			long long n = built[i]->n;
+			sums = sums && built[i]->ready() && built[i]->sum == n * (n + 1) / 2;
+			off_main = off_main && built[i]->off_main;
+		}
+		if(!sums || !off_main) {
+			cout << "!=: jobs built " << sums << ", off the main thread " << off_main << endl;
+		}
+		if(!third->ready() || !second->prereqs_loaded || !third->prereqs_loaded) {
+			cout << "!=: chain loaded before its prereqs" << endl;
+		}
+		if(!bad->failed() || !after_bad->failed() || after_bad->sum != 0) {
+			cout << "!=: failure didn't fail the job after it" << endl;
+		}
+		// after a failure, submitted later
+		TestJob *late = new TestJob("late", 1, 0);
+		late->wait_on(bad);
+		loader.submit(late);
+		TestJob *waited = new TestJob("waited", 100, 5);
+		loader.submit(waited);
+		loader.wait(waited);
+		if(!late->failed() || !waited->ready() || waited->sum != 5050) {
+			cout << "!=: late " << late->state() << ", waited " << waited->state() << endl;
+		}
+	}
+	// goes with jobs still queued, without running them
+	chrono::steady_clock::time_point quit = chrono::steady_clock::now();
+	{
+		AsyncLoader loader(1);
+		for (int i = 0; i < 200; ++i) {
+			loader.submit(new TestJob("queued", 10, 1));
+		}
+	}
+	double quit_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - quit).count();
+	if(quit_ms > 30) {
+		cout << "!=: " << quit_ms << " ms to stop with jobs queued" << endl;
+	}
+	cout << "\n***************** Done:  AsyncLoader::test() ***********************" << endl;
+}
@@ -0,0 +1,1036 @@
+/*
+ * cdt.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "cdt.h"
+#include "dr_util.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <deque>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+using linalg::Vec2d;
+
+// Ruppert guarantees about 20.7, in practice refinement finishes up to about this
+const double CDT::MAX_MIN_ANGLE = 34.0;
+
+static inline int next(int i) { return i == 2 ? 0 : i + 1; }
+static inline int prev(int i) { return i == 0 ? 2 : i - 1; }
+
+// > 0 if a, b, c are counter clockwise, twice the triangle's area
+static inline double orient(const Vec2d& a, const Vec2d& b, const Vec2d& c) {
+	return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+}
+
+// > 0 if d is inside the circle through counter clockwise a, b, c
+static double incircle(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& d) {
+	double adx = a[0] - d[0], ady = a[1] - d[1];
+	double bdx = b[0] - d[0], bdy = b[1] - d[1];
+	double cdx = c[0] - d[0], cdy = c[1] - d[1];
+	double alift = adx * adx + ady * ady;
+	double blift = bdx * bdx + bdy * bdy;
+	double clift = cdx * cdx + cdy * cdy;
+	return alift * (bdx * cdy - bdy * cdx) + blift * (cdx * ady - cdy * adx)
+			+ clift * (adx * bdy - ady * bdx);
+}
+
+static Vec2d circumcenter(const Vec2d& a, const Vec2d& b, const Vec2d& c) {
+	Vec2d ab = b - a, ac = c - a;
+	double d = 2.0 * (ab[0] * ac[1] - ab[1] * ac[0]);
+	double ab2 = linalg::length2(ab), ac2 = linalg::length2(ac);
+	return a + Vec2d((ac[1] * ab2 - ab[1] * ac2) / d, (ab[0] * ac2 - ac[0] * ab2) / d);
+}
+
+// where segment ab crosses line cd
+static Vec2d intersection(const Vec2d& a, const Vec2d& b, const Vec2d& c, const Vec2d& d) {
+	double da = orient(c, d, a), db = orient(c, d, b);
+	return a + (b - a) * (da / (da - db));
+}
+
+// p strictly inside the circle with diameter ab
+static inline bool in_diametral(const Vec2d& a, const Vec2d& b, const Vec2d& p) {
+	return linalg::dot(a - p, b - p) < 0;
+}
+
+GLint CDT::add_point(double x, double y) {
+	input.push_back(Vec2d(x, y));
+	return input.size() - 1;
+}
+
+void CDT::add_segment(GLint a, GLint b) {
+	Segment s = { a, b, false };
+	segments.push_back(s);
+}
+
+void CDT::add_loop(const GLint *loop, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		Segment s = { loop[i], loop[(i + 1) % n], true };
+		segments.push_back(s);
+	}
+}
+
+void CDT::clear() {
+	input.clear();
+	segments.clear();
+	pts.clear();
+	tris.clear();
+	vert_tri.clear();
+}
+
+void CDT::init_super() {
+	double lo[2] = { 0, 0 }, hi[2] = { 0, 0 };
+	for (size_t i = 0; i < input.size(); ++i) {
+		for (int k = 0; k < 2; ++k) {
+			if(i == 0 || input[i][k] < lo[k]) lo[k] = input[i][k];
+			if(i == 0 || input[i][k] > hi[k]) hi[k] = input[i][k];
+		}
+	}
+	double cx = (lo[0] + hi[0]) * 0.5, cy = (lo[1] + hi[1]) * 0.5;
+	double size = max(max(hi[0] - lo[0], hi[1] - lo[1]), 1e-6);
+	min_len2 = 1e-12 * size * size;
+	// far enough that it doesn't disturb the hull much
+	size *= 100;
+	pts.push_back(Vec2d(cx - size, cy - size));
+	pts.push_back(Vec2d(cx + size, cy - size));
+	pts.push_back(Vec2d(cx, cy + size));
+	vert_tri.resize(3);
+	new_tri(0, 1, 2, false);
+}
+
+GLint CDT::new_tri(GLint a, GLint b, GLint c, bool inside) {
+	Tri t = { { a, b, c }, { -1, -1, -1 }, { 0, 0, 0 }, inside };
+	GLint index = tris.size();
+	tris.push_back(t);
+	vert_tri[a] = vert_tri[b] = vert_tri[c] = index;
+	return index;
+}
+
+void CDT::set_neighbor(GLint t, GLint old_nb, GLint new_nb) {
+	if(t < 0) {
+		return;
+	}
+	Tri& tri = tris[t];
+	for (int i = 0; i < 3; ++i) {
+		if(tri.n[i] == old_nb) {
+			tri.n[i] = new_nb;
+			return;
+		}
+	}
+}
+
+GLint CDT::edge_to(GLint t, GLint nb) const {
+	const Tri& tri = tris[t];
+	return tri.n[0] == nb ? 0 : (tri.n[1] == nb ? 1 : 2);
+}
+
+CDT::Where CDT::locate(const Vec2d& p, GLint start, bool stop_at_segments,
+		GLint& tri, GLint& edge) const {
+	GLint t = start, from = -1;
+	size_t steps = 0;
+	for (;;) {
+		const Tri& cur = tris[t];
+		int cross = -1;
+		// vary the first edge tried, so near degenerate walks don't cycle
+		int first = steps % 3;
+		for (int k = 0; k < 3; ++k) {
+			int i = (first + k) % 3;
+			if(cur.n[i] == from && from >= 0) {
+				continue;
+			}
+			if(orient(pts[cur.v[next(i)]], pts[cur.v[prev(i)]], p) < 0) {
+				cross = i;
+				break;
+			}
+		}
+		if(cross < 0) {
+			break;
+		}
+		if(cur.n[cross] < 0 || (stop_at_segments && cur.c[cross])) {
+			tri = t;
+			edge = cross;
+			return BLOCKED;
+		}
+		from = t;
+		t = cur.n[cross];
+		if(++steps > tris.size()) {
+			// lost to round off, take any triangle that holds p
+			for (size_t i = 0; i < tris.size(); ++i) {
+				const Tri& s = tris[i];
+				if(orient(pts[s.v[0]], pts[s.v[1]], p) >= 0 && orient(pts[s.v[1]], pts[s.v[2]], p) >= 0
+						&& orient(pts[s.v[2]], pts[s.v[0]], p) >= 0) {
+					t = i;
+					break;
+				}
+			}
+			break;
+		}
+	}
+	tri = t;
+	const Tri& found = tris[t];
+	for (int i = 0; i < 3; ++i) {
+		if(pts[found.v[i]] == p) {
+			edge = i;
+			return ON_VERTEX;
+		}
+	}
+	for (int i = 0; i < 3; ++i) {
+		if(orient(pts[found.v[next(i)]], pts[found.v[prev(i)]], p) == 0) {
+			edge = i;
+			return ON_EDGE;
+		}
+	}
+	return INSIDE;
+}
+
+GLint CDT::insert_point(const Vec2d& p, GLint start) {
+	GLint t, e;
+	Where where = locate(p, start, false, t, e);
+	if(where == ON_VERTEX) {
+		return tris[t].v[e];
+	}
+	GLint v = where == ON_EDGE ? insert_on_edge(p, t, e) : insert_in_tri(p, t);
+	legalize();
+	return v;
+}
+
+// (a, b, c) -> (v, b, c), (v, c, a), (v, a, b)
+GLint CDT::insert_in_tri(const Vec2d& p, GLint t) {
+	GLint v = pts.size();
+	pts.push_back(p);
+	vert_tri.push_back(t);
+	Tri old = tris[t];
+	GLint t1 = new_tri(v, old.v[2], old.v[0], old.inside);
+	GLint t2 = new_tri(v, old.v[0], old.v[1], old.inside);
+	Tri& t0 = tris[t];
+	t0.v[0] = v;
+	t0.n[1] = t1;
+	t0.n[2] = t2;
+	t0.c[1] = t0.c[2] = 0;
+	Tri& nt1 = tris[t1];
+	nt1.n[0] = old.n[1];
+	nt1.n[1] = t2;
+	nt1.n[2] = t;
+	nt1.c[0] = old.c[1];
+	Tri& nt2 = tris[t2];
+	nt2.n[0] = old.n[2];
+	nt2.n[1] = t;
+	nt2.n[2] = t1;
+	nt2.c[0] = old.c[2];
+	set_neighbor(old.n[1], t, t1);
+	set_neighbor(old.n[2], t, t2);
+	GLint check[] = { t, 0, t1, 0, t2, 0 };
+	flip_stack.insert(flip_stack.end(), check, check + 6);
+	return v;
+}
+
+// edge b-c of t = (a, b, c) and u = (d, c, b) ->
+// (a, b, v), (a, v, c), (d, c, v), (d, v, b)
+GLint CDT::insert_on_edge(const Vec2d& p, GLint t, GLint e) {
+	GLint v = pts.size();
+	pts.push_back(p);
+	vert_tri.push_back(t);
+	Tri old = tris[t];
+	GLint a = old.v[e], b = old.v[next(e)], c = old.v[prev(e)];
+	GLint u = old.n[e];
+	unsigned char seg = old.c[e];
+	GLint t2 = new_tri(a, v, c, old.inside);
+	Tri& nt = tris[t];
+	nt.v[0] = a;
+	nt.v[1] = b;
+	nt.v[2] = v;
+	nt.n[0] = -1;
+	nt.n[1] = t2;
+	nt.n[2] = old.n[prev(e)];
+	nt.c[0] = seg;
+	nt.c[1] = 0;
+	nt.c[2] = old.c[prev(e)];
+	Tri& nt2 = tris[t2];
+	nt2.n[0] = u;
+	nt2.n[1] = old.n[next(e)];
+	nt2.n[2] = t;
+	nt2.c[0] = seg;
+	nt2.c[1] = old.c[next(e)];
+	set_neighbor(old.n[next(e)], t, t2);
+	GLint check[] = { t, 2, t2, 1 };
+	flip_stack.insert(flip_stack.end(), check, check + 4);
+	if(u >= 0) {
+		Tri oldu = tris[u];
+		int j = edge_to(u, t);
+		GLint d = oldu.v[j];
+		GLint u2 = new_tri(d, v, b, oldu.inside);
+		Tri& nu = tris[u];
+		nu.v[0] = d;
+		nu.v[1] = c;
+		nu.v[2] = v;
+		nu.n[0] = t2;
+		nu.n[1] = u2;
+		nu.n[2] = oldu.n[prev(j)];
+		nu.c[0] = seg;
+		nu.c[1] = 0;
+		nu.c[2] = oldu.c[prev(j)];
+		Tri& nu2 = tris[u2];
+		nu2.n[0] = t;
+		nu2.n[1] = oldu.n[next(j)];
+		nu2.n[2] = u;
+		nu2.c[0] = seg;
+		nu2.c[1] = oldu.c[next(j)];
+		set_neighbor(oldu.n[next(j)], u, u2);
+		tris[t].n[0] = u2;
+		GLint checku[] = { u, 2, u2, 1 };
+		flip_stack.insert(flip_stack.end(), checku, checku + 4);
+	}
+	return v;
+}
+
+// Lawson flips until the edges on flip_stack are locally Delaunay
+void CDT::legalize() {
+	while(!flip_stack.empty()) {
+		GLint e = flip_stack.back();
+		flip_stack.pop_back();
+		GLint t = flip_stack.back();
+		flip_stack.pop_back();
+		const Tri& tri = tris[t];
+		GLint u = tri.n[e];
+		// inside only changes across segments, or across the hull of lone segments,
+		// which flipping towards the super triangle would dent
+		if(u < 0 || tri.c[e] || tri.inside != tris[u].inside) {
+			continue;
+		}
+		GLint d = tris[u].v[edge_to(u, t)];
+		if(incircle(pts[tri.v[0]], pts[tri.v[1]], pts[tri.v[2]], pts[d]) > 0) {
+			flip(t, e);
+			GLint check[] = { t, 0, u, 0 };
+			flip_stack.insert(flip_stack.end(), check, check + 4);
+		}
+	}
+}
+
+// diagonal b-c of t = (a, b, c) and u = (d, c, b) -> a-d, t = (a, b, d), u = (a, d, c)
+void CDT::flip(GLint t, GLint e) {
+	Tri old = tris[t];
+	GLint u = old.n[e];
+	Tri oldu = tris[u];
+	int j = edge_to(u, t);
+	GLint a = old.v[e], b = old.v[next(e)], c = old.v[prev(e)], d = oldu.v[j];
+	Tri& nt = tris[t];
+	nt.v[0] = a;
+	nt.v[1] = b;
+	nt.v[2] = d;
+	nt.n[0] = oldu.n[next(j)];
+	nt.n[1] = u;
+	nt.n[2] = old.n[prev(e)];
+	nt.c[0] = oldu.c[next(j)];
+	nt.c[1] = 0;
+	nt.c[2] = old.c[prev(e)];
+	Tri& nu = tris[u];
+	nu.v[0] = a;
+	nu.v[1] = d;
+	nu.v[2] = c;
+	nu.n[0] = oldu.n[prev(j)];
+	nu.n[1] = old.n[next(e)];
+	nu.n[2] = t;
+	nu.c[0] = oldu.c[prev(j)];
+	nu.c[1] = old.c[next(e)];
+	nu.c[2] = 0;
+	set_neighbor(oldu.n[next(j)], u, t);
+	set_neighbor(old.n[next(e)], t, u);
+	vert_tri[a] = vert_tri[b] = vert_tri[d] = t;
+	vert_tri[c] = u;
+}
+
+bool CDT::find_edge(GLint a, GLint b, GLint& tri, GLint& edge) const {
+	GLint start = vert_tri[a], t = start;
+	// counter clockwise around a, then clockwise if that hits the hull
+	for (int dir = 0; dir < 2; ++dir) {
+		t = start;
+		do {
+			const Tri& cur = tris[t];
+			int k = cur.v[0] == a ? 0 : (cur.v[1] == a ? 1 : 2);
+			if(cur.v[next(k)] == b) {
+				tri = t;
+				edge = prev(k);
+				return true;
+			}
+			t = dir == 0 ? cur.n[next(k)] : cur.n[prev(k)];
+		} while(t >= 0 && t != start);
+		if(t >= 0) {
+			break;
+		}
+	}
+	return false;
+}
+
+void CDT::set_segment(GLint t, GLint e, bool boundary) {
+	unsigned char flags = tris[t].c[e] | SEGMENT;
+	if(boundary) {
+		flags ^= BOUNDARY;
+	}
+	tris[t].c[e] = flags;
+	GLint u = tris[t].n[e];
+	if(u >= 0) {
+		tris[u].c[edge_to(u, t)] = flags;
+	}
+}
+
+/**
+ * Sloan's method: collect the edges crossing a-b, flip them until none
+ * cross, then flip the new edges back to Delaunay.
+ * Splits at points on a-b, and where a-b crosses another segment.
+ */
+void CDT::insert_segment(GLint a0, GLint b0, bool boundary) {
+	vector<GLint> todo, crossing;
+	deque<GLint> queue;
+	todo.push_back(a0);
+	todo.push_back(b0);
+	while(!todo.empty()) {
+		GLint b = todo.back();
+		todo.pop_back();
+		GLint a = todo.back();
+		todo.pop_back();
+		GLint t, e;
+		if(a == b) {
+			continue;
+		}
+		if(find_edge(a, b, t, e)) {
+			set_segment(t, e, boundary);
+			continue;
+		}
+		Vec2d pa = pts[a], pb = pts[b];
+
+		// the triangle around a that a-b leaves through
+		GLint start = vert_tri[a], mid = -1;
+		t = start;
+		e = -1;
+		GLint left = -1, right = -1;
+		do {
+			const Tri& cur = tris[t];
+			int k = cur.v[0] == a ? 0 : (cur.v[1] == a ? 1 : 2);
+			GLint p = cur.v[next(k)], q = cur.v[prev(k)];
+			double op = orient(pa, pb, pts[p]), oq = orient(pa, pb, pts[q]);
+			if(op == 0 && linalg::dot(pts[p] - pa, pb - pa) > 0) {
+				mid = p;
+				break;
+			}
+			if(op < 0 && oq > 0) {
+				e = k;
+				right = p;
+				left = q;
+				break;
+			}
+			t = cur.n[next(k)];
+		} while(t >= 0 && t != start);
+		if(mid >= 0) {
+			GLint split[] = { mid, b, a, mid };
+			todo.insert(todo.end(), split, split + 4);
+			continue;
+		}
+		if(e < 0) {
+			cerr << "CDT::insert_segment: no way out of " << a << " toward " << b << endl;
+			continue;
+		}
+
+		// walk across, collecting crossed edges as (left, right) pairs
+		crossing.clear();
+		GLint target = b;
+		bool split_crossing = false;
+		for (;;) {
+			const Tri& cur = tris[t];
+			if(cur.c[e]) {
+				// crosses another segment, split both where they cross
+				GLint x = insert_on_edge(intersection(pa, pb, pts[left], pts[right]), t, e);
+				legalize();
+				GLint split[] = { x, b, a, x };
+				todo.insert(todo.end(), split, split + 4);
+				split_crossing = true;
+				break;
+			}
+			crossing.push_back(left);
+			crossing.push_back(right);
+			GLint u = cur.n[e];
+			const Tri& nu = tris[u];
+			GLint w = nu.v[edge_to(u, t)];
+			if(w == b) {
+				break;
+			}
+			double ow = orient(pa, pb, pts[w]);
+			if(ow == 0) {
+				// w is on a-b, finish a-w here and w-b after
+				target = w;
+				todo.push_back(w);
+				todo.push_back(b);
+				break;
+			}
+			GLint replaced = ow > 0 ? left : right;
+			e = nu.v[0] == replaced ? 0 : (nu.v[1] == replaced ? 1 : 2);
+			if(ow > 0) {
+				left = w;
+			} else {
+				right = w;
+			}
+			t = u;
+		}
+		if(split_crossing) {
+			continue;
+		}
+		pb = pts[target];
+
+		// flip crossing edges away, keeping the ones that stop crossing
+		queue.assign(crossing.begin(), crossing.end());
+		vector<GLint> made;
+		size_t guard = 0, limit = 50 * crossing.size() + 1000;
+		while(!queue.empty()) {
+			GLint p = queue.front();
+			queue.pop_front();
+			GLint q = queue.front();
+			queue.pop_front();
+			if(!find_edge(p, q, t, e)) {
+				continue;
+			}
+			const Tri& cur = tris[t];
+			GLint x = cur.v[e];
+			GLint u = cur.n[e];
+			GLint d = tris[u].v[edge_to(u, t)];
+			if(orient(pts[x], pts[d], pts[p]) * orient(pts[x], pts[d], pts[q]) < 0) {
+				flip(t, e);
+				bool crosses = x != a && x != target && d != a && d != target
+						&& orient(pa, pb, pts[x]) * orient(pa, pb, pts[d]) < 0;
+				if(crosses) {
+					queue.push_back(x);
+					queue.push_back(d);
+				} else {
+					made.push_back(x);
+					made.push_back(d);
+				}
+			} else {
+				queue.push_back(p);
+				queue.push_back(q);
+			}
+			if(++guard > limit) {
+				cerr << "CDT::insert_segment: gave up flipping " << a << " - " << target << endl;
+				break;
+			}
+		}
+		if(find_edge(a, target, t, e)) {
+			set_segment(t, e, boundary);
+		} else {
+			cerr << "CDT::insert_segment: missing " << a << " - " << target << endl;
+		}
+
+		// back to Delaunay around the new edges
+		bool flipped = true;
+		while(flipped) {
+			flipped = false;
+			for (size_t i = 0; i < made.size(); i += 2) {
+				if(!find_edge(made[i], made[i+1], t, e)) {
+					continue;
+				}
+				const Tri& cur = tris[t];
+				GLint u = cur.n[e];
+				if(cur.c[e] || u < 0) {
+					continue;
+				}
+				GLint x = cur.v[e];
+				GLint d = tris[u].v[edge_to(u, t)];
+				if(incircle(pts[cur.v[0]], pts[cur.v[1]], pts[cur.v[2]], pts[d]) > 0) {
+					flip(t, e);
+					made[i] = x;
+					made[i+1] = d;
+					flipped = true;
+				}
+			}
+		}
+	}
+}
+
+// 0-1 breadth first from the enclosing triangle, boundaries cost 1
+void CDT::classify() {
+	bool any_boundary = false;
+	for (size_t i = 0; i < segments.size(); ++i) {
+		any_boundary = any_boundary || segments[i].boundary;
+	}
+	if(!any_boundary) {
+		for (size_t i = 0; i < tris.size(); ++i) {
+			Tri& t = tris[i];
+			t.inside = t.v[0] > 2 && t.v[1] > 2 && t.v[2] > 2;
+		}
+		return;
+	}
+	vector<int> depth(tris.size(), -1);
+	deque<GLint> queue;
+	depth[vert_tri[0]] = 0;
+	queue.push_back(vert_tri[0]);
+	while(!queue.empty()) {
+		GLint t = queue.front();
+		queue.pop_front();
+		const Tri& cur = tris[t];
+		for (int i = 0; i < 3; ++i) {
+			GLint nb = cur.n[i];
+			if(nb < 0) {
+				continue;
+			}
+			int cost = (cur.c[i] & BOUNDARY) ? 1 : 0;
+			int d = depth[t] + cost;
+			if(depth[nb] < 0 || d < depth[nb]) {
+				depth[nb] = d;
+				if(cost) {
+					queue.push_back(nb);
+				} else {
+					queue.push_front(nb);
+				}
+			}
+		}
+	}
+	for (size_t i = 0; i < tris.size(); ++i) {
+		tris[i].inside = (depth[i] & 1) == 1;
+	}
+}
+
+bool CDT::encroached(GLint t, GLint e) const {
+	const Tri& tri = tris[t];
+	const Vec2d& a = pts[tri.v[next(e)]];
+	const Vec2d& b = pts[tri.v[prev(e)]];
+	if(tri.v[e] > 2 && in_diametral(a, b, pts[tri.v[e]])) {
+		return true;
+	}
+	GLint u = tri.n[e];
+	if(u >= 0) {
+		GLint d = tris[u].v[edge_to(u, t)];
+		return d > 2 && in_diametral(a, b, pts[d]);
+	}
+	return false;
+}
+
+bool CDT::is_bad(GLint t) const {
+	const Tri& tri = tris[t];
+	if(!tri.inside) {
+		return false;
+	}
+	const Vec2d& a = pts[tri.v[0]];
+	const Vec2d& b = pts[tri.v[1]];
+	const Vec2d& c = pts[tri.v[2]];
+	double area2 = orient(a, b, c);
+	if(max_area > 0 && area2 > 2 * max_area) {
+		return true;
+	}
+	if(max_ratio2 <= 0) {
+		return false;
+	}
+	// edge lengths^2, opposite each vertex
+	double len2[3] = { linalg::length2(c - b), linalg::length2(a - c), linalg::length2(b - a) };
+	int shortest = 0;
+	for (int i = 1; i < 3; ++i) {
+		if(len2[i] < len2[shortest]) shortest = i;
+	}
+	if(len2[shortest] < min_len2) {
+		return false;
+	}
+	// the smallest angle is between 2 segments, it came in with the input
+	if(tri.c[next(shortest)] && tri.c[prev(shortest)]) {
+		return false;
+	}
+	// R = abc / (4 area)
+	double r2 = len2[0] * len2[1] * len2[2] / (4 * area2 * area2);
+	return r2 > max_ratio2 * len2[shortest];
+}
+
+void CDT::push_bad(GLint t) {
+	if(is_bad(t)) {
+		const Tri& tri = tris[t];
+		BadTri b = { t, { tri.v[0], tri.v[1], tri.v[2] } };
+		bad.push_back(b);
+	}
+}
+
+void CDT::check_around(GLint v) {
+	GLint start = vert_tri[v], t = start;
+	do {
+		const Tri& cur = tris[t];
+		int k = cur.v[0] == v ? 0 : (cur.v[1] == v ? 1 : 2);
+		push_bad(t);
+		// the edge opposite v, and one of the edges at v
+		int edges[] = { k, prev(k) };
+		for (int i = 0; i < 2; ++i) {
+			int e = edges[i];
+			if(cur.c[e] && encroached(t, e)) {
+				split_queue.push_back(cur.v[next(e)]);
+				split_queue.push_back(cur.v[prev(e)]);
+			}
+		}
+		t = cur.n[next(k)];
+	} while(t >= 0 && t != start);
+}
+
+// segments on the boundary of the cavity p would open up in t
+int CDT::encroached_by(const Vec2d& p, GLint t) {
+	GLint cavity[64];
+	int size = 0, count = 0;
+	cavity[size++] = t;
+	for (int i = 0; i < size; ++i) {
+		const Tri& cur = tris[cavity[i]];
+		for (int k = 0; k < 3; ++k) {
+			GLint a = cur.v[next(k)], b = cur.v[prev(k)];
+			if(cur.c[k]) {
+				if(in_diametral(pts[a], pts[b], p)) {
+					split_queue.push_back(a);
+					split_queue.push_back(b);
+					++count;
+				}
+				continue;
+			}
+			GLint nb = cur.n[k];
+			if(nb < 0 || size == 64 || find(cavity, cavity + size, nb) != cavity + size) {
+				continue;
+			}
+			const Tri& n = tris[nb];
+			if(incircle(pts[n.v[0]], pts[n.v[1]], pts[n.v[2]], p) > 0) {
+				cavity[size++] = nb;
+			}
+		}
+	}
+	return count;
+}
+
+GLint CDT::split_segment(GLint t, GLint e) {
+	const Tri& tri = tris[t];
+	GLint a = tri.v[next(e)], b = tri.v[prev(e)];
+	Vec2d pa = pts[a], pb = pts[b];
+	Vec2d split = (pa + pb) * 0.5;
+	// concentric shells: splitting at a power of 2 from an input point
+	// keeps segments meeting at small angles from splitting each other forever
+	GLint first_steiner = input.size() + 3;
+	if((a < first_steiner) != (b < first_steiner)) {
+		const Vec2d& from = a < first_steiner ? pa : pb;
+		const Vec2d& to = a < first_steiner ? pb : pa;
+		double len = linalg::distance(from, to);
+		double shell = pow(2.0, floor(log2(len * 0.5) + 0.5));
+		if(shell > 0.25 * len && shell < 0.75 * len) {
+			split = from + (to - from) * (shell / len);
+		}
+	}
+	GLint v = insert_on_edge(split, t, e);
+	legalize();
+	return v;
+}
+
+void CDT::refine(const CDTOptions& opts) {
+	double min_angle = min(opts.min_angle, MAX_MIN_ANGLE);
+	max_ratio2 = 0;
+	if(min_angle > 0) {
+		double s = sin(radians(min_angle));
+		max_ratio2 = 1.0 / (4.0 * s * s);
+	}
+	max_area = opts.max_area;
+	if(max_ratio2 <= 0 && max_area <= 0) {
+		return;
+	}
+	split_queue.clear();
+	bad.clear();
+	bad_head = 0;
+	for (size_t t = 0; t < tris.size(); ++t) {
+		const Tri& tri = tris[t];
+		for (int e = 0; e < 3; ++e) {
+			if(tri.c[e] && (GLint)t < tri.n[e] && encroached(t, e)) {
+				split_queue.push_back(tri.v[next(e)]);
+				split_queue.push_back(tri.v[prev(e)]);
+			}
+		}
+		push_bad(t);
+	}
+
+	size_t limit = pts.size() + opts.max_steiner;
+	while(pts.size() < limit) {
+		if(!split_queue.empty()) {
+			GLint b = split_queue.back();
+			split_queue.pop_back();
+			GLint a = split_queue.back();
+			split_queue.pop_back();
+			GLint t, e;
+			if(!find_edge(a, b, t, e) || !tris[t].c[e]) {
+				// already split
+				continue;
+			}
+			if(linalg::length2(pts[a] - pts[b]) < min_len2) {
+				continue;
+			}
+			GLint v = split_segment(t, e);
+			check_around(v);
+			continue;
+		}
+		if(bad_head == bad.size()) {
+			break;
+		}
+		BadTri b = bad[bad_head++];
+		if(bad_head > 4096 && bad_head * 2 > bad.size()) {
+			bad.erase(bad.begin(), bad.begin() + bad_head);
+			bad_head = 0;
+		}
+		const Tri& tri = tris[b.t];
+		if(tri.v[0] != b.v[0] || tri.v[1] != b.v[1] || tri.v[2] != b.v[2] || !is_bad(b.t)) {
+			continue;
+		}
+		Vec2d center = circumcenter(pts[tri.v[0]], pts[tri.v[1]], pts[tri.v[2]]);
+		GLint t, e;
+		Where where = locate(center, b.t, true, t, e);
+		if(where == ON_VERTEX) {
+			continue;
+		}
+		// off the mesh, or outside with only lone segments, where nothing guards
+		// the hull and a center outside would grow it
+		GLint across = where == ON_EDGE ? tris[t].n[e] : -1;
+		bool off_mesh = where == BLOCKED && tris[t].n[e] < 0;
+		bool outside = where != BLOCKED && !tris[t].inside && (across < 0 || !tris[across].inside);
+		if(off_mesh || outside) {
+			continue;
+		}
+		if(where == BLOCKED) {
+			// center is across a segment, split that instead and come back
+			split_queue.push_back(tris[t].v[next(e)]);
+			split_queue.push_back(tris[t].v[prev(e)]);
+			bad.push_back(b);
+			continue;
+		}
+		if(encroached_by(center, t) > 0) {
+			bad.push_back(b);
+			continue;
+		}
+		GLint v = where == ON_EDGE ? insert_on_edge(center, t, e) : insert_in_tri(center, t);
+		legalize();
+		check_around(v);
+	}
+	if(pts.size() >= limit) {
+		cerr << "CDT::refine: stopped at max_steiner = " << opts.max_steiner << endl;
+	}
+}
+
+void CDT::triangulate(CDTMesh& out, const CDTOptions& opts) {
+	pts.clear();
+	tris.clear();
+	vert_tri.clear();
+	flip_stack.clear();
+	init_super();
+	tris.reserve(2 * input.size() + 16);
+
+	// input i is pts[i + 3], or merged into an earlier copy
+	vector<GLint> merged(input.size());
+	GLint hint = 0;
+	for (size_t i = 0; i < input.size(); ++i) {
+		GLint v = insert_point(input[i], hint);
+		if(v < (GLint)i + 3) {
+			// a duplicate, keep the numbering
+			pts.push_back(input[i]);
+			vert_tri.push_back(vert_tri[v]);
+		}
+		merged[i] = v;
+		hint = vert_tri[v];
+	}
+	for (size_t i = 0; i < segments.size(); ++i) {
+		const Segment& s = segments[i];
+		insert_segment(merged[s.a], merged[s.b], s.boundary);
+	}
+	classify();
+	refine(opts);
+
+	out.clear();
+	out.points.assign(pts.begin() + 3, pts.end());
+	for (size_t i = 0; i < tris.size(); ++i) {
+		const Tri& t = tris[i];
+		if(t.inside) {
+			for (int k = 0; k < 3; ++k) {
+				out.triangles.push_back(t.v[k] - 3);
+			}
+		}
+	}
+}
+
+// test helpers
+
+static double mesh_area(const CDTMesh& m) {
+	double sum = 0;
+	for (size_t i = 0; i < m.triangles.size(); i += 3) {
+		sum += orient(m.points[m.triangles[i]], m.points[m.triangles[i+1]], m.points[m.triangles[i+2]]);
+	}
+	return sum * 0.5;
+}
+
+// smallest angle of triangle t in degrees
+static double min_angle_of(const CDTMesh& m, size_t t) {
+	const GLint *v = &m.triangles[3 * t];
+	double least = 180;
+	for (int i = 0; i < 3; ++i) {
+		Vec2d a = m.points[v[next(i)]] - m.points[v[i]];
+		Vec2d b = m.points[v[prev(i)]] - m.points[v[i]];
+		double cos_angle = linalg::dot(a, b) / (linalg::length(a) * linalg::length(b));
+		least = min(least, acos(max(-1.0, min(1.0, cos_angle))) * 180.0 / PI);
+	}
+	return least;
+}
+
+// counter clockwise square, indices to loop
+static void add_square(CDT& cdt, GLint *loop, double x, double y, double size) {
+	loop[0] = cdt.add_point(x, y);
+	loop[1] = cdt.add_point(x + size, y);
+	loop[2] = cdt.add_point(x + size, y + size);
+	loop[3] = cdt.add_point(x, y + size);
+}
+
+// counter clockwise circle of n points
+static void add_circle(CDT& cdt, double x, double y, double r, int n) {
+	vector<GLint> loop(n);
+	for (int i = 0; i < n; ++i) {
+		double theta = 2 * PI * i / n;
+		loop[i] = cdt.add_point(x + r * cos(theta), y + r * sin(theta));
+	}
+	cdt.add_loop(&loop[0], n);
+}
+
+void CDT::test() {
+	cout <<  "\n******************** CDT::test() **************************" << endl;
+	CDT cdt;
+	GLint outer[4], hole[4];
+	add_square(cdt, outer, 0, 0, 4);
+	add_square(cdt, hole, 1, 1, 2);
+	cdt.add_loop(outer, 4);
+	cdt.add_loop(hole, 4);
+	CDTMesh mesh;
+	CDTOptions opts;
+	for (int pass = 0; pass < 2; ++pass) {
+		if(pass == 1) {
+			opts.min_angle = 30;
+			opts.max_area = 0.05;
+		}
+		cdt.triangulate(mesh, opts);
+		if(fabs(mesh_area(mesh) - 12) > 1e-9 || (pass == 0 && mesh.num_triangles() != 8)) {
+			cout << "!=: CDT square with hole, pass " << pass << ": " << mesh.num_triangles()
+					<< " triangles, area " << mesh_area(mesh) << endl;
+		}
+		// the segments, however split, are all still there
+		double seg_length = 0;
+		int not_delaunay = 0;
+		for (size_t t = 0; t < cdt.tris.size(); ++t) {
+			const Tri& tri = cdt.tris[t];
+			for (int e = 0; e < 3; ++e) {
+				GLint u = tri.n[e];
+				if(tri.c[e] && (GLint)t < u) {
+					seg_length += linalg::distance(cdt.pts[tri.v[next(e)]], cdt.pts[tri.v[prev(e)]]);
+				}
+				if(tri.inside && !tri.c[e] && u >= 0 && incircle(cdt.pts[tri.v[0]], cdt.pts[tri.v[1]],
+						cdt.pts[tri.v[2]], cdt.pts[cdt.tris[u].v[cdt.edge_to(u, t)]]) > 1e-9) {
+					++not_delaunay;
+				}
+			}
+		}
+		if(fabs(seg_length - 24) > 1e-9 || not_delaunay) {
+			cout << "!=: CDT segments, pass " << pass << ": length " << seg_length
+					<< ", " << not_delaunay << " edges not Delaunay" << endl;
+		}
+	}
+	size_t worse = 0;
+	for (size_t t = 0; t < mesh.num_triangles(); ++t) {
+		const GLint *v = &mesh.triangles[3 * t];
+		double area = 0.5 * orient(mesh.points[v[0]], mesh.points[v[1]], mesh.points[v[2]]);
+		if(min_angle_of(mesh, t) < opts.min_angle - 1e-6 || area > opts.max_area + 1e-12) {
+			++worse;
+		}
+	}
+	if(worse) {
+		cout << "!=: CDT refine: " << worse << " of " << mesh.num_triangles()
+				<< " triangles under 30 degrees or over max area" << endl;
+	}
+
+	// crossing lone segments split each other, and don't count for inside
+	// a duplicate point merges
+	CDT cross;
+	add_square(cross, outer, 0, 0, 2);
+	GLint dup = cross.add_point(0, 0);
+	outer[0] = dup;
+	cross.add_loop(outer, 4);
+	cross.add_segment(outer[0], outer[2]);
+	cross.add_segment(outer[1], outer[3]);
+	cross.triangulate(mesh);
+	bool uses_dup = find(mesh.triangles.begin(), mesh.triangles.end(), dup) != mesh.triangles.end();
+	if(mesh.num_triangles() != 4 || mesh.points.size() != 6 || mesh.points[5] != Vec2d(1, 1)
+			|| fabs(mesh_area(mesh) - 4) > 1e-9 || uses_dup) {
+		cout << "!=: CDT crossing segments: " << mesh.num_triangles() << " triangles, "
+				<< mesh.points.size() << " points" << endl;
+	}
+
+	// refined lone segments stay inside the hull, and every point is used
+	CDT lone;
+	add_square(lone, outer, 0, 0, 4);
+	lone.add_point(3.5, 0.2);
+	lone.add_point(0.2, 3.7);
+	lone.add_segment(outer[0], outer[2]);
+	lone.add_segment(outer[1], outer[3]);
+	opts.min_angle = 30;
+	opts.max_area = 0;
+	lone.triangulate(mesh, opts);
+	vector<bool> used(mesh.points.size(), false);
+	for (size_t i = 0; i < mesh.triangles.size(); ++i) {
+		used[mesh.triangles[i]] = true;
+	}
+	size_t stray = count(used.begin(), used.end(), false);
+	size_t outside = 0;
+	for (size_t i = 0; i < mesh.points.size(); ++i) {
+		const Vec2d& p = mesh.points[i];
+		if(p[0] < -1e-9 || p[1] < -1e-9 || p[0] > 4 + 1e-9 || p[1] > 4 + 1e-9) {
+			++outside;
+		}
+	}
+	if(fabs(mesh_area(mesh) - 16) > 1e-9 || stray || outside) {
+		cout << "!=: CDT refined lone segments: area " << mesh_area(mesh) << ", " << stray
+				<< " points unused, " << outside << " outside the hull" << endl;
+	}
+
+	// island in a hole is filled, outside of everything is not
+	CDT nested;
+	add_circle(nested, 0, 0, 3, 24);
+	add_circle(nested, 0, 0, 2, 24);
+	add_circle(nested, 0, 0, 1, 24);
+	nested.triangulate(mesh);
+	double ring = 0.5 * 24 * sin(2.0 * PI / 24);
+	double expect = ring * (9 - 4 + 1);
+	// loose, the circle points are at float angles
+	if(fabs(mesh_area(mesh) - expect) > 1e-6) {
+		cout << "!=: CDT nested loops: area " << mesh_area(mesh) << " vs " << expect << endl;
+	}
+	cout << "\n***************** Done:  CDT::test() ***********************" << endl;
+}
+
+// disc with holes, refined to about 100k triangles
+void CDT::bench() {
+	cout <<  "\n******************** CDT::bench() **************************" << endl;
+	CDT cdt;
+	add_circle(cdt, 0, 0, 1, 256);
+	for (int i = 0; i < 6; ++i) {
+		double theta = 2 * PI * i / 6;
+		add_circle(cdt, 0.55 * cos(theta), 0.55 * sin(theta), 0.15, 64);
+	}
+	CDTMesh mesh;
+	const int runs = 4;
+	const char *names[] = { "segments only", "min angle 30", "min angle 25, max area 4e-5",
+			"min angle 30, max area 4e-5" };
+	double angles[] = { 0, 30, 25, 30 };
+	double areas[] = { 0, 0, 4e-5, 4e-5 };
+	for (int i = 0; i < runs; ++i) {
+		CDTOptions opts;
+		opts.min_angle = angles[i];
+		opts.max_area = areas[i];
+		Stopwatch sw;
+		cdt.triangulate(mesh, opts);
+		double ms = sw.elapsed_ms();
+		double least = 180;
+		for (size_t t = 0; t < mesh.num_triangles(); ++t) {
+			least = min(least, min_angle_of(mesh, t));
+		}
+		cout << "\t" << names[i] << ": " << ms << " ms, " << mesh.num_triangles() << " triangles, "
+				<< mesh.points.size() << " points, min angle " << least << ", "
+				<< (mesh.num_triangles() / ms / 1000.0) << " M triangles/s" << endl;
+	}
+	cout << "\n***************** Done:  CDT::bench() ***********************" << endl;
+}
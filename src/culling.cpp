@@ -0,0 +1,205 @@
+/*
+ * culling.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "culling.h"
+
+#include <cmath>
+#include <cfloat>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+using linalg::Vec3f;
+using linalg::Vec4f;
+using linalg::Mat4f;
+
+void CullStats::clear() {
+	objects = objects_culled = 0;
+	meshlets = meshlets_frustum = meshlets_backface = 0;
+	polygons = polygons_drawn = 0;
+}
+
+CullStats& CullStats::operator+=(const CullStats& o) {
+	objects += o.objects;
+	objects_culled += o.objects_culled;
+	meshlets += o.meshlets;
+	meshlets_frustum += o.meshlets_frustum;
+	meshlets_backface += o.meshlets_backface;
+	polygons += o.polygons;
+	polygons_drawn += o.polygons_drawn;
+	return *this;
+}
+
+ostream& DR::operator<<(ostream& out, const CullStats& s) {
+	out << "objects " << s.objects - s.objects_culled << "/" << s.objects
+			<< ", meshlets " << s.meshlets - s.meshlets_frustum - s.meshlets_backface << "/" << s.meshlets
+			<< " (frustum " << s.meshlets_frustum << ", backface " << s.meshlets_backface << ")"
+			<< ", polygons " << s.polygons_drawn << "/" << s.polygons;
+	return out;
+}
+
+// sphere around the box's center through its farthest point
+static void sphere_of(const vec3 *verts, const GLint *index, size_t n, const Aabb& box, Sphere& sphere) {
+	sphere.center = (box.lo + box.hi) * 0.5f;
+	GLfloat r2 = 0;
+	for (size_t i = 0; i < n; ++i) {
+		const Vec3f& p = linalg::as_vec3(verts[index ? index[i] : i]);
+		r2 = max(r2, linalg::length2(p - sphere.center));
+	}
+	sphere.radius = sqrt(r2);
+}
+
+void DR::bounds_of(const vec3 *points, size_t n, Aabb& box, Sphere& sphere) {
+	box.lo = box.hi = n ? linalg::as_vec3(points[0]) : Vec3f();
+	for (size_t i = 1; i < n; ++i) {
+		box.lo = linalg::min(box.lo, linalg::as_vec3(points[i]));
+		box.hi = linalg::max(box.hi, linalg::as_vec3(points[i]));
+	}
+	sphere_of(points, NULL, n, box, sphere);
+}
+
+void DR::bounds_of(const vec3 *verts, const GLint *index, size_t n, Aabb& box, Sphere& sphere) {
+	box.lo = box.hi = n ? linalg::as_vec3(verts[index[0]]) : Vec3f();
+	for (size_t i = 1; i < n; ++i) {
+		box.lo = linalg::min(box.lo, linalg::as_vec3(verts[index[i]]));
+		box.hi = linalg::max(box.hi, linalg::as_vec3(verts[index[i]]));
+	}
+	sphere_of(verts, index, n, box, sphere);
+}
+
+NormalCone DR::normal_cone(const vector<Vec3f>& normals) {
+	NormalCone cone;
+	Vec3f sum;
+	for (size_t i = 0; i < normals.size(); ++i) {
+		sum += normals[i];
+	}
+	if(linalg::length2(sum) < 1e-12f) {
+		return cone;
+	}
+	cone.axis = linalg::normalized(sum);
+	GLfloat min_dot = 1;
+	for (size_t i = 0; i < normals.size(); ++i) {
+		min_dot = min(min_dot, linalg::dot(cone.axis, normals[i]));
+	}
+	// wider than a hemisphere can't all face away
+	if(min_dot > 0) {
+		cone.cutoff = sqrt(1 - min_dot * min_dot);
+	}
+	return cone;
+}
+
+bool DR::cone_backfacing(const Sphere& bounds, const NormalCone& cone, const Vec3f& eye) {
+	if(cone.cutoff > 1) {
+		return false;
+	}
+	Vec3f d = bounds.center - eye;
+	return linalg::dot(d, cone.axis) >= cone.cutoff * linalg::length(d) + bounds.radius;
+}
+
+Frustum::Frustum(const Mat4f& clip) {
+	// Gribb and Hartmann, w +- x, y, z
+	for (int i = 0; i < 6; ++i) {
+		int row = i / 2;
+		GLfloat sign = i % 2 ? -1.0f : 1.0f;
+		Vec4f p;
+		for (int c = 0; c < 4; ++c) {
+			p[c] = clip(3, c) + sign * clip(row, c);
+		}
+		GLfloat len = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+		planes[i] = len > 0 ? p * (1.0f / len) : p;
+	}
+}
+
+Frustum Frustum::from_gl() {
+	Mat4f modelview, projection;
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview.m);
+	glGetFloatv(GL_PROJECTION_MATRIX, projection.m);
+	return Frustum(projection * modelview);
+}
+
+bool Frustum::visible(const Sphere& s) const {
+	for (int i = 0; i < 6; ++i) {
+		const Vec4f& p = planes[i];
+		if(p[0] * s.center[0] + p[1] * s.center[1] + p[2] * s.center[2] + p[3] < -s.radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::visible(const Aabb& b) const {
+	for (int i = 0; i < 6; ++i) {
+		const Vec4f& p = planes[i];
+		// the corner farthest along the plane's normal
+		GLfloat x = p[0] >= 0 ? b.hi[0] : b.lo[0];
+		GLfloat y = p[1] >= 0 ? b.hi[1] : b.lo[1];
+		GLfloat z = p[2] >= 0 ? b.hi[2] : b.lo[2];
+		if(p[0] * x + p[1] * y + p[2] * z + p[3] < 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Vec3f DR::eye_position(const Mat4f& modelview) {
+	Mat4f inv;
+	if(!modelview.inverse(inv)) {
+		return Vec3f();
+	}
+	return inv.transform_point(Vec3f());
+}
+
+Vec3f DR::eye_position() {
+	Mat4f modelview;
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview.m);
+	return eye_position(modelview);
+}
+
+void Frustum::test() {
+	cout <<  "\n******************** Frustum::test() **************************" << endl;
+	// looking down -z from (0, 0, 10), 90 degrees
+	Mat4f modelview = Mat4f::translate(0, 0, -10);
+	Frustum f(Mat4f::perspective(90, 1, 1, 100) * modelview);
+	Sphere s;
+	s.radius = 1;
+	struct { GLfloat x, y, z; bool in; } cases[] = {
+		{ 0, 0, 0, true }, { 0, 0, 20, false }, { 0, 0, -89, true }, { 0, 0, -120, false },
+		// the side planes are at 45 degrees, 10 out at the origin
+		{ 10.5f, 0, 0, true }, { 13, 0, 0, false }, { 0, -13, 0, false }, { 0, 11, -5, true },
+	};
+	for (size_t i = 0; i < sizeof(cases)/sizeof(cases[0]); ++i) {
+		s.center = Vec3f(cases[i].x, cases[i].y, cases[i].z);
+		Aabb b;
+		b.lo = s.center - Vec3f(1, 1, 1);
+		b.hi = s.center + Vec3f(1, 1, 1);
+		if(f.visible(s) != cases[i].in || f.visible(b) != cases[i].in) {
+			cout << "!=: frustum case " << i << ": sphere " << f.visible(s) << ", box " << f.visible(b) << endl;
+		}
+	}
+	Vec3f eye = eye_position(Mat4f::rotate(30, 0, 1, 0) * modelview);
+	if(fabs(eye[0]) > 1e-4f || fabs(eye[1]) > 1e-4f || fabs(eye[2] - 10) > 1e-4f) {
+		cout << "!=: eye_position " << eye[0] << " " << eye[1] << " " << eye[2] << endl;
+	}
+
+	// a group of polygons facing +z at the origin
+	Sphere bounds;
+	bounds.radius = 1;
+	vector<Vec3f> normals;
+	normals.push_back(Vec3f(0, 0, 1));
+	normals.push_back(linalg::normalized(Vec3f(0.3f, 0, 1)));
+	normals.push_back(linalg::normalized(Vec3f(0, -0.3f, 1)));
+	NormalCone cone = normal_cone(normals);
+	if(cone_backfacing(bounds, cone, Vec3f(0, 0, 10)) || !cone_backfacing(bounds, cone, Vec3f(0, 0, -10))
+			|| cone_backfacing(bounds, cone, Vec3f(10, 0, 0.5f))) {
+		cout << "!=: cone_backfacing" << endl;
+	}
+	normals.push_back(Vec3f(0, 0, -1));
+	if(normal_cone(normals).cutoff <= 1) {
+		cout << "!=: normal_cone should not cull opposite normals" << endl;
+	}
+	cout << "\n***************** Done:  Frustum::test() ***********************" << endl;
+}
@@ -7,9 +7,11 @@
 
 #include "cylinder_model.h"
 #include "dr_util.h"
+#include "linalg.h"
 //#include "vec.h"
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 using namespace std;
 using namespace DR;
@@ -24,7 +26,7 @@ void Mappable2D::map(int zero_component) {
 	minx = miny = 1000.0;
 	maxx = maxy = -1000.0;
 	for (size_t i = 0; i < verts3d.size(); ++i) {
-		Vec vert = verts3d[i];
+		const Vec& vert = verts3d[i];
 		minx = min(minx, vert[xcomp]);
 		miny = min(miny, vert[ycomp]);
 		maxx = max(maxx, vert[xcomp]);
@@ -35,15 +37,11 @@ void Mappable2D::map(int zero_component) {
 	x_scale_factor = 1 / xrange;
 	y_scale_factor = 1 / yrange;
 
+	verts2d.reserve(verts2d.size() + verts3d.size());
 	for (size_t i = 0; i < verts3d.size(); ++i) {
-		Vec vert3 = verts3d[i];
-//		GLfloat *vert2 = new GLfloat[2];
-//		vert2[0] = vert3[xcomp] * x_scale_factor + 0.5;
-//		vert2[1] = vert3[ycomp] * y_scale_factor + 0.5;
-		Vec2 vert2;
-		vert2.push_back( vert3[xcomp] * x_scale_factor + 0.5 );
-		vert2.push_back( vert3[ycomp] * y_scale_factor + 0.5 );
-		verts2d.push_back(vert2);
+		const Vec& vert3 = verts3d[i];
+		verts2d.push_back(Vec2(vert3[xcomp] * x_scale_factor + 0.5f,
+				vert3[ycomp] * y_scale_factor + 0.5f));
 	}
 }
 
@@ -83,21 +81,23 @@ void UnitSpace2D::flip(GLint which) {
 // grid is rendered as a line loop of the x_lines
 // and a line between the 2 endpoints of each of the y_lines
 void Grid::render(GLfloat *color, GLfloat line_width) {
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-	bool lighting_enabled = glIsEnabled(GL_LIGHTING);
-	if(lighting_enabled) {
-		glDisable(GL_LIGHTING);
+	if(!overlay.is_built() || !std::equal(color, color + 3, overlay_color)) {
+		build_overlay(color);
 	}
-	glLineWidth(line_width);
-	glColor3fv(color);
+	overlay.draw(line_width);
+}
+
+void Grid::build_overlay(GLfloat *color) {
+	overlay.clear();
+	copyv(overlay_color, color);
 	for (size_t i = 0; i < x_lines.size(); ++i) {
-		glBegin(GL_LINE_LOOP);
-		for (size_t j = 0; j < x_lines[i].size(); ++j) {
-			vec3 v;
-			x_lines[i][j].array_out(v);
-			glVertex3fv(v);
+		size_t n = x_lines[i].size();
+		for (size_t j = 0; j < n; ++j) {
+			vec3 a, b;
+			x_lines[i][j].array_out(a);
+			x_lines[i][(j + 1) % n].array_out(b);
+			overlay.add_line(a, b, color);
 		}
-		glEnd();
 	}
 	for (size_t i = 0; i < y_lines.size(); ++i) {
 		if(y_lines[i].size() != 2) {
@@ -106,18 +106,12 @@ void Grid::render(GLfloat *color, GLfloat line_width) {
 					<< endl << "** exiting **" << endl;
 			exit(1);
 		}
-		glBegin(GL_LINES);
-		vec3 v;
-		y_lines[i][0].array_out(v);
-		glVertex3fv(v);
-		y_lines[i][1].array_out(v);
-		glVertex3fv(v);
-		glEnd();
+		vec3 a, b;
+		y_lines[i][0].array_out(a);
+		y_lines[i][1].array_out(b);
+		overlay.add_line(a, b, color);
 	}
-	if(lighting_enabled) {
-		glEnable(GL_LIGHTING);
-	}
-	glPopAttrib();
+	overlay.done();
 }
 
 CylinderModel::~CylinderModel() {
@@ -135,38 +129,36 @@ void CylinderModel::map() {
 	GLfloat offset_theta;
 
 	for (size_t i = 0; i < unit_spaces.size(); ++i) {
-		UnitSpace2D unit_space = unit_spaces[i];
+		const UnitSpace2D& unit_space = unit_spaces[i];
 		base_theta = i * unit_width;
 
 		cout << "***********  cylinder map: starting unit space: "
 						<< i << "  **********" << endl;
 		cout << "unit_space.element.verts2d.size(): "
 				<< unit_space.element.verts2d.size() << endl;
-		for (size_t index = 0; index < unit_space.element.verts2d.size(); ++index) {
+		size_t num_verts = unit_space.element.verts2d.size();
+		vertex_sets[i].reserve(vertex_sets[i].size() + num_verts);
+		normal_sets[i].reserve(normal_sets[i].size() + num_verts);
+		for (size_t index = 0; index < num_verts; ++index) {
 			GLfloat x2d = unit_space.element.verts2d[index][0];
 			GLfloat y2d = unit_space.element.verts2d[index][1];
-			GLfloat x3d, y3d, z3d;
 
 //			cout << "x2d=" << x2d << "   y2d=" << y2d << endl;
 
 			offset_theta = x2d;
 			theta = base_theta + offset_theta;
-			x3d = radius * sin(theta);
-			z3d = radius * cos(theta);
 
 			// the top of the cylinder is at y = height/2, bottom at y = -height/2
 			// the unit space y is mapped over [0,1]
-			y3d = (y2d - 0.5) * height;
-
-			Vec vert = Vec(x3d, y3d, z3d);
+			linalg::Vec3f vert(radius * sin(theta), (y2d - 0.5f) * height, radius * cos(theta));
 //			cout << "cylinder map: vert: " << index << " " << vert << endl;
-			vertex_sets[i].push_back(vert);
+			vertex_sets[i].push_back(Vec(vert.data()));
 
 			// normal:  for this mapping, the normal is just radiating out from the y axis
 			// could be changed ..
-			Vec norm = Vec(x3d, 0, z3d).unit_vec();
+			linalg::Vec3f norm = linalg::normalized(linalg::Vec3f(vert[0], 0, vert[2]));
 //			cout << "map: norm: " << norm << endl;
-			normal_sets[i].push_back(norm);
+			normal_sets[i].push_back(Vec(norm.data()));
 		}
 
 //		cout << "***********  cylinder map: done with unit space: "
@@ -214,6 +206,7 @@ void CylinderModel::grid(Grid& out, const vector<GLfloat>& latitudes,
 		const vector<GLfloat>& longitudes) {
 	out.x_lines.clear();
 	out.y_lines.clear();
+	out.invalidate();
 	// latitude requires series of vertices
 	int numverts = 36;
 	GLfloat theta;
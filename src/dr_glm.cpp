@@ -6,6 +6,7 @@
  */
 
 #include "dr_glm.h"
+#include "transform.h"
 #include <cassert>
 
 using namespace std;
@@ -13,16 +14,20 @@ using namespace DR;
 
 DrGlmModel::DrGlmModel()
 : num_vertices(0), num_normals(0),
-  vertices(NULL), normals(NULL)  {
+  vertices(NULL), normals(NULL), poly_arena(NULL), lod(0), culled(false),
+  meshlet_vertices(0), meshlet_triangles(0), culled_level(0), buffers_optimized(true)  {
 	setv(near_white, 0.973, 0.976, 0.957, 1.0);
 
 	copyv(ambient_diffuse, near_white, 4);
 	copyv(specular, near_white, 4);
 	shininess[0] = 128.0;
 	setv(emissive, 0.0, 0.0, 0.0, 1.0);
+	setv(center, 0, 0, 0);
 
 	show_normals = show_facet_norms = show_vert_norms = false;
-	GLfloat draw_normals_length = -1;
+	draw_normals_length = -1;
+	normals_which = 'f';
+	normals_size = 0;
 
 	// debug as well
 	diff_colors = false;
@@ -33,8 +38,12 @@ DrGlmModel::DrGlmModel()
 }
 
 DrGlmModel::~DrGlmModel() {
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		delete polygons[i];
+	free_buffers();
+	// arena polygons go with the arena
+	if(!poly_arena) {
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			delete polygons[i];
+		}
 	}
 	polygons.clear();
 	delete [] vertices;
@@ -61,9 +70,12 @@ void DrGlmModel::init(GLMmodel *glm_model) {
 	}
 	// need to deal with glm's [1] == our [0] here as well
 	int num_triangles = glm_model->numtriangles;
+	poly_arena = use_mesh_arenas ? &arena : NULL;
+	polygons.reserve(num_triangles);
 	for (int i = 0; i < num_triangles; ++i) {
 		GLMtriangle *f=&(glm_model->triangles[i]);
-		Triangle *t = new Triangle(vertices, normals);
+		Triangle *t = poly_arena ? arena.create<Triangle>(vertices, normals, poly_arena) :
+				new Triangle(vertices, normals);
 		//**debug for printing out vindices
 		//cout << i;
 		for (int j = 0; j < 3; ++j) {
@@ -81,7 +93,13 @@ void DrGlmModel::init(GLMmodel *glm_model) {
 
 		polygons.push_back(t);
 	}
-	// set longest and shortest side lengths
+	set_side_lengths();
+	bounds_of(vertices, num_vertices, box, bounds);
+	normals_overlay.clear();
+}
+
+// set longest and shortest side lengths
+void DrGlmModel::set_side_lengths() {
 	GLfloat minlen = 10000, maxlen = 0;
 	for (size_t i = 0; i < polygons.size(); ++i) {
 		const Polygon *p = polygons[i];
@@ -99,12 +117,151 @@ void DrGlmModel::init(GLMmodel *glm_model) {
 	longest_side_len = maxlen;
 	assert(maxlen > 0 && minlen < 10000);
 }
+
+void DrGlmModel::bake_transform(const linalg::Mat4f& m) {
+	linalg::Mat4f nm = normal_matrix(m);
+	transform_points(m, vertices, vertices, num_vertices);
+	transform_normals(m, normals, normals, num_normals);
+	for (size_t i = 0; i < polygons.size(); ++i) {
+		polygons[i]->bake_transform(m, nm);
+	}
+	set_side_lengths();
+	bounds_of(vertices, num_vertices, box, bounds);
+	normals_overlay.clear();
+	transform_points(m, &center, &center, 1);
+	// errors grow with the largest scale
+	GLfloat scale = max_scale(m);
+	for (size_t i = 0; i < lods.size(); ++i) {
+		lods[i].error *= scale;
+	}
+	if(meshlet_vertices) {
+		build_meshlets(meshlet_vertices, meshlet_triangles);
+	} else if(!buffers.empty()) {
+		build_buffers(buffers_optimized);
+	}
+}
+
+// largest error for a level of detail, as a fraction of the model's radius
+static const GLfloat LOD_MAX_ERROR = 0.05f;
+
+void DrGlmModel::build_lods(GLfloat ratio, size_t max_levels) {
+	linalg::Vec3f lo = linalg::as_vec3(vertices[0]), hi = lo;
+	for (int i = 1; i < num_vertices; ++i) {
+		lo = linalg::min(lo, linalg::as_vec3(vertices[i]));
+		hi = linalg::max(hi, linalg::as_vec3(vertices[i]));
+	}
+	linalg::as_vec3(center) = (lo + hi) * 0.5f;
+	GLfloat radius = linalg::distance(lo, hi) * 0.5f;
+	build_lod_chain(polygons, vertices, num_vertices, lods, radius * LOD_MAX_ERROR, ratio, max_levels);
+	lod = 0;
+	if(meshlet_vertices) {
+		build_meshlets(meshlet_vertices, meshlet_triangles);
+	} else if(!buffers.empty()) {
+		build_buffers(buffers_optimized);
+	}
+}
+
+void DrGlmModel::build_meshlets(size_t max_vertices, size_t max_triangles) {
+	meshlet_vertices = max_vertices;
+	meshlet_triangles = max_triangles;
+	meshlets.assign(max((size_t)1, lods.size()), MeshletSet());
+	DR::build_meshlets(polygons, vertices, 1, meshlets[0], max_vertices, max_triangles);
+	for (size_t i = 1; i < lods.size(); ++i) {
+		DR::build_meshlets(lods[i].verts, 3, vertices, 1, meshlets[i], max_vertices, max_triangles);
+	}
+	clear_cull();
+	if(!buffers.empty()) {
+		build_buffers(buffers_optimized);
+	}
+}
+
+bool DrGlmModel::upload_buffers(int& budget) {
+	return DR::upload_buffers(buffers, budget);
+}
+
+void DrGlmModel::free_buffers() {
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		delete buffers[i];
+	}
+	buffers.clear();
+}
+
+void DrGlmModel::build_buffers(bool optimize) {
+	free_buffers();
+	buffers_optimized = optimize;
+	for (size_t level = 0; level < max((size_t)1, lods.size()); ++level) {
+		MeshBuffer *mb = new MeshBuffer();
+		const MeshletSet *ms = level < meshlets.size() ? &meshlets[level] : NULL;
+		size_t num_polys = level ? lods[level].num_triangles() : polygons.size();
+		size_t num_ranges = ms ? ms->size() : 1;
+		for (size_t r = 0; r < num_ranges; ++r) {
+			mb->begin_range();
+			size_t count = ms ? ms->meshlets[r].triangle_count : num_polys;
+			for (size_t t = 0; t < count; ++t) {
+				// glm triangles, never split
+				GLint p = ms ? ms->prims[ms->meshlets[r].triangle_offset + t] >> 1 : t;
+				if(level) {
+					mb->add_polygon(vertices, &lods[level].verts[3 * p], 3, normals, &lods[level].norms[3 * p]);
+				} else {
+					mb->add_polygon(vertices, polygons[p]->verts, polygons[p]->size, normals, polygons[p]->norms);
+				}
+			}
+		}
+		if(optimize) {
+			mb->optimize();
+		}
+		buffers.push_back(mb);
+	}
+}
+
+int DrGlmModel::select_lod(GLfloat pixels_per_unit, GLfloat max_pixels) {
+	lod = DR::select_lod(lods, pixels_per_unit, max_pixels);
+	return lod;
+}
+
+void DrGlmModel::cull(const Frustum& frustum, CullStats& stats) {
+	culled = !frustum.visible(bounds) || !frustum.visible(box);
+	++stats.objects;
+	stats.objects_culled += culled ? 1 : 0;
+	int level = lod > 0 && lod < (int)lods.size() ? lod : 0;
+	size_t count = level ? lods[level].num_triangles() : polygons.size();
+	stats.polygons += count;
+	poly_visible.clear();
+	meshlet_visible.clear();
+	culled_level = level;
+	if(level >= (int)meshlets.size()) {
+		stats.polygons_drawn += culled ? 0 : count;
+		return;
+	}
+	const MeshletSet& ms = meshlets[level];
+	poly_visible.assign(count, 0);
+	meshlet_visible.assign(ms.size(), 0);
+	for (size_t i = 0; i < ms.size(); ++i) {
+		const Meshlet& m = ms.meshlets[i];
+		++stats.meshlets;
+		if(culled || !frustum.visible(m.bounds)) {
+			++stats.meshlets_frustum;
+			continue;
+		}
+		meshlet_visible[i] = 1;
+		for (GLuint t = 0; t < m.triangle_count; ++t) {
+			poly_visible[ms.prims[m.triangle_offset + t] >> 1] = 1;
+		}
+	}
+	for (size_t i = 0; i < count; ++i) {
+		stats.polygons_drawn += poly_visible[i];
+	}
+}
+
 /**
  * Render the model.
  * params: wire - [false] if true render wireframe
  * use_facetnorm - [false] if true use facetnorm instead of vertex norms
  */
 void DrGlmModel::render(bool wire, bool use_facetnorm) {
+	if(culled) {
+		return;
+	}
 	glPushMatrix();
 	glPushAttrib(GL_ALL_ATTRIB_BITS);
 	glLineWidth(1);
@@ -112,9 +269,7 @@ void DrGlmModel::render(bool wire, bool use_facetnorm) {
 //	glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, specular);
 //	glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
 
-	glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, ambient_diffuse);
-	glMaterialfv(GL_FRONT, GL_SPECULAR, specular);
-	glMaterialfv(GL_FRONT, GL_SHININESS, shininess);
+	apply_material(material_block, ambient_diffuse, specular, shininess, emissive);
 
 //	glEnable(GL_NORMALIZE);
 
@@ -132,31 +287,65 @@ void DrGlmModel::render(bool wire, bool use_facetnorm) {
 		glColor4fv(ambient_diffuse);
 	}
 
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		const Polygon *p = polygons[i];
-
-		if(wire) {
-			glBegin(GL_LINE_LOOP);
-			for (int j=0; j<p->size; ++j) {
-				glVertex3fv ( vertices[p->verts[j]] );
+	size_t level = lod > 0 && lod < (int)lods.size() ? lod : 0;
+	if(!wire && !use_facetnorm && level < buffers.size()) {
+		// ranges are the meshlets in order if cull() was for this level
+		MeshBuffer *mb = buffers[level];
+		bool ranged = culled_level == (int)level && !meshlet_visible.empty()
+				&& meshlet_visible.size() == mb->num_ranges();
+		mb->draw(ranged ? &meshlet_visible[0] : NULL);
+	} else if(level > 0) {
+		const LodLevel& l = lods[lod];
+		for (size_t i = 0; i < l.num_triangles(); ++i) {
+			if(!drawn(i)) {
+				continue;
 			}
-		} else {
-			if(p->size == 3) {
-			glBegin(GL_TRIANGLES);
-			} else if(p->size == 4) {
-				glBegin(GL_QUADS);
+			const GLint *v = &l.verts[3*i];
+			glBegin(wire ? GL_LINE_LOOP : GL_TRIANGLES);
+			if(!wire && use_facetnorm) {
+				linalg::Vec3f n = linalg::cross(
+						linalg::as_vec3(vertices[v[1]]) - linalg::as_vec3(vertices[v[0]]),
+						linalg::as_vec3(vertices[v[2]]) - linalg::as_vec3(vertices[v[0]]));
+				glNormal3fv(linalg::normalized(n).v);
 			}
-			if(use_facetnorm) {
-				glNormal3fv(p->facetnorm);
+			for (int j = 0; j < 3; ++j) {
+				if(!wire && !use_facetnorm) {
+					glNormal3fv( normals[l.norms[3*i + j]] );
+				}
+				glVertex3fv ( vertices[v[j]] );
+			}
+			glEnd();
+		}
+	} else {
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			if(!drawn(i)) {
+				continue;
 			}
-			for (int j=0; j<p->size; ++j) {
-				if(!use_facetnorm) {
-					glNormal3fv( normals[p->norms[j]] );
+			const Polygon *p = polygons[i];
+
+			if(wire) {
+				glBegin(GL_LINE_LOOP);
+				for (int j=0; j<p->size; ++j) {
+					glVertex3fv ( vertices[p->verts[j]] );
+				}
+			} else {
+				if(p->size == 3) {
+				glBegin(GL_TRIANGLES);
+				} else if(p->size == 4) {
+					glBegin(GL_QUADS);
+				}
+				if(use_facetnorm) {
+					glNormal3fv(p->facetnorm);
+				}
+				for (int j=0; j<p->size; ++j) {
+					if(!use_facetnorm) {
+						glNormal3fv( normals[p->norms[j]] );
+					}
+					glVertex3fv ( vertices[p->verts[j]] );
 				}
-				glVertex3fv ( vertices[p->verts[j]] );
 			}
+			glEnd();
 		}
-		glEnd();
 	}
 	// draw normals
 	if(show_normals) {
@@ -189,11 +378,6 @@ void DrGlmModel::render_solid_and_wire() {
  * 			'b': both
  */
 void DrGlmModel::draw_normals(char which, GLfloat size) {
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-	glDisable(GL_LIGHTING);
-	glLineWidth(1);
-	glPointSize(1);
-	glEnable(GL_POINT_SMOOTH);
 	if(size < 0) {
 		if(draw_normals_length > 0) {
 			size = draw_normals_length;
@@ -201,45 +385,24 @@ void DrGlmModel::draw_normals(char which, GLfloat size) {
 			size = (longest_side_len + shortest_side_len) / 2;
 		}
 	}
-	if(which == 'v' || which == 'b') {
-		glColor3fv(Util::cyan);
+	if(!normals_overlay.is_built() || which != normals_which || size != normals_size) {
+		normals_overlay.clear();
+		normals_which = which;
+		normals_size = size;
 		for (size_t i = 0; i < polygons.size(); ++i) {
 			const Polygon *p = polygons[i];
-
-			for (int j = 0; j < p->size; ++j) {
-				Vec v(vertices[p->verts[j]]), vn(normals[p->norms[j]]);
-				Vec end = v + size * vn;
-
-				glBegin(GL_LINES);
-				v.glVertex();
-				end.glVertex();
-				glEnd();
-				glBegin(GL_POINTS);
-				end.glVertex();
-				glEnd();
+			if(which == 'v' || which == 'b') {
+				for (int j = 0; j < p->size; ++j) {
+					normals_overlay.add_normal(vertices[p->verts[j]], normals[p->norms[j]], size, Util::cyan);
+				}
+			}
+			if(which == 'f' || which == 'b') {
+				normals_overlay.add_normal(p->center, p->facetnorm, size, Util::magenta);
 			}
 		}
+		normals_overlay.done();
 	}
-	if(which == 'f' || which == 'b') {
-		glColor3fv(Util::magenta);
-		for (size_t i = 0; i < polygons.size(); ++i) {
-			const Polygon *p = polygons[i];
-			Vec c(p->center), fn(p->facetnorm);
-			Vec end = c + size * fn;
-
-			glBegin(GL_LINES);
-			c.glVertex();
-			end.glVertex();
-			glEnd();
-			glBegin(GL_POINTS);
-			end.glVertex();
-			glEnd();
-
-		}
-	}
-
-	glPopAttrib();
-
+	normals_overlay.draw(1, 1, true);
 }
 void DrGlmModel::draw_normals_diff_colors(GLfloat size, bool vertex) {
 
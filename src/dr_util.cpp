@@ -6,6 +6,7 @@
  */
 
 #include "dr_util.h"
+#include "linalg.h"
 #include <cstring>
 #include <cstdio>
 #include <cmath>
@@ -13,6 +14,7 @@
 #include <fstream>
 #include <algorithm>
 #include <string>
+#include <chrono>
 
 static const GLfloat PI = 3.14159265358979;
 
@@ -29,6 +31,19 @@ void DR::err_exit(string msg) {
 	exit(1);
 }
 
+static long long now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Stopwatch::reset() {
+	start_ns = now_ns();
+}
+
+double Stopwatch::elapsed_ms() const {
+	return (now_ns() - start_ns) * 1e-6;
+}
+
 //*********************************************************************************************
 //***********
 //***********    Opengl and glsl utility stuff
@@ -775,10 +790,7 @@ void DR::copym(GLfloat copy_to[16], GLfloat copy_from[16]) {
 	}
 }
 void DR::transform_vec(vec3 vOut, const vec3 v, const GLfloat m[16]) {
-	vOut[0] = m[0] * v[0] + m[4] * v[1] + m[8] *  v[2] + m[12];// * v[3];
-	vOut[1] = m[1] * v[0] + m[5] * v[1] + m[9] *  v[2] + m[13];// * v[3];
-	vOut[2] = m[2] * v[0] + m[6] * v[1] + m[10] * v[2] + m[14];// * v[3];
-	//vOut[3] = m[3] * v[0] + m[7] * v[1] + m[11] * v[2] + m[15] * v[3];
+	linalg::as_vec3(vOut) = linalg::as_mat4(m).transform_point(linalg::as_vec3(v));
 }
 void DR::transform_vec(vec3 vOut, const vec3 v, const GLdouble m[16]) {
 	vOut[0] = m[0] * v[0] + m[4] * v[1] + m[8] *  v[2] + m[12];// * v[3];
@@ -792,39 +804,9 @@ void DR::transform_vec(vec3 vOut, const vec3 v, const GLdouble m[16]) {
  * ie: out <-- left right
  */
 void DR::mult_matrixf(GLfloat out[16], GLfloat left[16], GLfloat right[16]) {
-	GLfloat rows[4][4], cols[4][4];
-	for (int i = 0; i < 4; ++i) {
-
-		for (int j = 0; j < 4; ++j) {
-			rows[i][j] = left[i*4 + j];
-			cols[i][j] = right[i + 4*j];
-		}
-	}
-//	cout << "left:" << endl;
-//	cout << "[";
-//	for (int i = 0; i < 4; ++i) {
-//		cout << "[";
-//		for (int j = 0; j < 4; ++j) {
-//			cout << rows[i][j] << ", ";
-//		}
-//		cout << "]" << endl;
-//	}
-//	cout << "right:" << endl;
-//	cout << "[";
-//	for (int i = 0; i < 4; ++i) {
-//		cout << "[";
-//		for (int j = 0; j < 4; ++j) {
-//			cout << cols[j][i] << ", ";
-//		}
-//		cout << "]" << endl;
-//	}
-
-	for (int i = 0; i < 4; ++i) {
-		for (int j = 0; j < 4; ++j) {
-			out[i*4 + j] = dot(rows[i], cols[j], 4);
-		}
-	}
-
+	// row major left * right is column major right * left
+	// the product is a temporary, so out may alias left or right
+	linalg::as_mat4(out) = linalg::as_mat4(right) * linalg::as_mat4(left);
 }
 
 void DR::to2d(const GLfloat matrix[16], GLfloat out[4][4]) {
@@ -845,27 +827,6 @@ void DR::to1d(const GLfloat matrix[4][4], GLfloat out[16]) {
 }
 
 //********* inversion of matrices and related *************//
-/**
- * rotate vec with 3x3
- */
-void _vec_rotate (const GLfloat vin[3], const GLfloat mtx[4][4], GLfloat vout[3])
-{
-	vout[0] = vin[0]*mtx[0][0] + vin[1]*mtx[1][0] + vin[2]*mtx[2][0];
-	vout[1] = vin[0]*mtx[0][1] + vin[1]*mtx[1][1] + vin[2]*mtx[2][1];
-	vout[2] = vin[0]*mtx[0][2] + vin[1]*mtx[1][2] + vin[2]*mtx[2][2];
-}
-/**
- * Invert the rotation submatrix in an opengl mat. by transposing.
- */
-void _mat_inv_rotate(const GLfloat mtxin[4][4], GLfloat mtxout[4][4])
-{
-  for(int i=0 ; i<3; i++) {
-    for(int j=0; j<3; j++) {
-      mtxout[j][i] = mtxin[i][j];
-    }
-  }
-}
-
 /**
  * Invert from Nate Robins' lightposition.c.
  * returns false if not invertible
@@ -932,38 +893,12 @@ GLboolean DR::invert(const GLdouble src[16], GLdouble inverse[16]) {
 
 /**
  * Invert an opengl invertible matrix.
+ * Leaves inverse alone and complains if matrix is singular.
  */
 void DR::invert(const GLfloat matrix[16], GLfloat inverse[16]) {
-	GLfloat mat[4][4];
-	GLfloat inv[4][4];
-	to2d(matrix, mat);
-//	to2d(inverse, inv);
-
-	//Step 1. Transpose the 3x3 rotation portion of the 4x4 matrix to get the inverse rotation
-	_mat_inv_rotate(mat, inv);
-
-	//Step 2. negate the translation vector portion of the 4x4 matrix and then rotate it using the newly constructed 3x3 rotation matrix
-	GLfloat vTmp[3], vTmp2[3];
-
-	vTmp[0] = -mat[3][0];
-	vTmp[1] = -mat[3][1];
-	vTmp[2] = -mat[3][2];
-
-	_vec_rotate(vTmp, inv, vTmp2);
-
-	//Step 3. put the new translation vector into the new 4x4 matrix
-
-	inv[3][0] = vTmp2[0];
-	inv[3][1] = vTmp2[1];
-	inv[3][2] = vTmp2[2];
-
-
-	//Step 4. do some house cleaning so that the matrix can be used with OpenGL
-
-	inv[0][3] = inv[1][3] = inv[2][3] = 0.0f;
-	inv[3][3] = 1.0f;
-
-	to1d(inv, inverse);
+	if(!linalg::as_mat4(matrix).inverse(linalg::as_mat4(inverse))) {
+		cerr << "invert: singular matrix" << endl;
+	}
 }
 
 //The VectorRotate code is straight forward:
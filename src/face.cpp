@@ -24,13 +24,13 @@ using namespace std;
 using namespace DR;
 
 
-bool Region::contains(const Polygon *poly) {
-	return DR::contains(polygons, *poly);
+bool Region::contains(const Polygon *poly) const {
+	return id_contains(poly_ids, poly->id);
 }
 
-bool Region::contains(GLint vert) {
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		if(polygons[i]->contains(vert)) {
+bool Region::contains(GLint vert) const {
+	for (size_t i = 0; i < poly_ids.size(); ++i) {
+		if(poly(i)->contains(vert)) {
 			return true;
 		}
 	}
@@ -39,13 +39,22 @@ bool Region::contains(GLint vert) {
 
 Face::Face() {
 	parent = NULL;
+	arena = NULL;
 	center_index = -1;
 }
-Face::Face(Syllable3D *syll) {
+Face::Face(Syllable3D *syll, Arena *arena) {
 	parent = syll;
+	this->arena = arena;
 	center_index = -1;
 }
 
+Region* Face::new_region() {
+	if(arena) {
+		return arena->create<Region>(this, arena);
+	}
+	return new Region(this);
+}
+
 // assumes that the face is centered at the origin
 // and is in the xz plane with up being positive y
 // creates perimeters starting with minvert being the vertex
@@ -72,8 +81,8 @@ void Face::create_perimeters(Region& region,
 
 	// check all edges in region for those contained by only one polygon
 	// this is the unordered set of edges on all perimeters
-	for (size_t i = 0; i < region.polygons.size(); ++i) {
-		Polygon *poly = region.polygons[i];
+	for (size_t i = 0; i < region.poly_ids.size(); ++i) {
+		Polygon *poly = region.poly(i);
 //		cout << i << "  " << poly->to_string() << endl;
 		for (int j = 0; j < poly->size; ++j) {
 //			GLint vert = poly->verts[j];
@@ -119,12 +128,12 @@ void Face::create_perimeters(Region& region,
 		for (size_t i = 0; i < remaining_edges.size(); ++i) {
 			vec3 vert;
 			IndexedEdge e = remaining_edges[i];
-			parent->get_vert(e.u, vert);
+			parent->get_layout_vert(e.u, vert);
 			if(vert[0] < minx) {
 				minx = vert[0];
 				minvert = e.u;
 			}
-			parent->get_vert(e.v, vert);
+			parent->get_layout_vert(e.v, vert);
 			if(vert[0] < minx) {
 				minx = vert[0];
 				minvert = e.v;
@@ -149,13 +158,13 @@ void Face::create_perimeters(Region& region,
 			cout << "create_perimeters: minx vert not in 2 edges, exiting " << endl;
 			exit(1);
 		}
-		parent->get_vert(minvert, minv);
+		parent->get_layout_vert(minvert, minv);
 		e1 = temp_edges[0];
 		e2 = temp_edges[1];
 		vert1 = e1.u == minvert ? e1.v : e1.u;
 		vert2 = e2.u == minvert ? e2.v : e2.u;
-		parent->get_vert(vert1, v1);
-		parent->get_vert(vert2, v2);
+		parent->get_layout_vert(vert1, v1);
+		parent->get_layout_vert(vert2, v2);
 		if(debug) cout << "minv: " << stringv(minv) << "  v1: " << stringv(v1) << " v2: " << stringv(v2) << endl;
 		if(debug) cout << "minvert: " << minvert << "  vert1: " << vert1 << "  vert2: " << vert2 << endl;
 
@@ -206,7 +215,7 @@ void Face::create_perimeters(Region& region,
 			curr_vert = next.other_end(curr_vert);
 			curr_edge = next;
 			//*** debug
-			//			vec3 tempv; parent->get_vert(curr_vert, tempv);
+			//			vec3 tempv; parent->get_layout_vert(curr_vert, tempv);
 			//			cout << "curr_edge: " << curr_edge.to_string() << "  curr_vert: " << curr_vert
 			//					<< "   " << stringv(tempv) << endl;
 
@@ -232,7 +241,7 @@ void Face::create_perimeters(Region& region,
 		perimeters.push_back(perim_copy);
 
 		if(debug) cout << "perim.size(): " << perim.size() << endl;
-		// ** debug - these are added at the end of init_regions,
+		// ** debug - get_perimeter_verts() gives these for the debug display,
 		// so not necessary even for debug, unless we want to check something
 		// else out
 		//		for (size_t i = 0; /*i < 200 &&*/ i < perim.size(); ++i) {
@@ -297,46 +306,84 @@ void Face::reverse_perimeter_windings() {
 }
 
 Face::~Face() {
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		delete polygons[i];
+	if(!arena) {
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			delete polygons[i];
+		}
+		for (size_t i = 0; i < regions.size(); ++i) {
+			delete regions[i];
+		}
 	}
 	polygons.clear();
-	for (size_t i = 0; i < regions.size(); ++i) {
-		delete regions[i];
-	}
 	regions.clear();
 }
 
 void Face::add_polygon(Polygon *p) {
+	p->id = polygons.size();
 	polygons.push_back(p);
+	vert_polys.clear();
+	poly_lookup.clear();
 }
 
 // remove all polygons and regions from this face, clearing storage
 void Face::clear() {
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		delete polygons[i];
+	if(!arena) {
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			delete polygons[i];
+		}
+		for (size_t i = 0; i < regions.size(); ++i) {
+			delete regions[i];
+		}
 	}
 	polygons.clear();
 	regions.clear();
+	vert_polys.clear();
+	poly_lookup.clear();
+	center_index = -1;
 
 	debug_edges.clear();
 	debug_polygons.clear();
 	debug_verts.clear();
+	debug_points.clear();
+}
+
+const PolyIdSet& Face::polys_containing(GLint vert) {
+	if(vert_polys.empty() && !polygons.empty()) {
+		GLint max_vert = 0;
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			for (int j = 0; j < polygons[i]->size; ++j) {
+				max_vert = max(max_vert, polygons[i]->verts[j]);
+			}
+		}
+		vert_polys.resize(max_vert + 1);
+		// ids go in ascending, so each set comes out sorted
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			Polygon *p = polygons[i];
+			for (int j = 0; j < p->size; ++j) {
+				PolyIdSet& s = vert_polys[p->verts[j]];
+				if(s.empty() || s.back() != p->id) {
+					s.push_back(p->id);
+				}
+			}
+		}
+	}
+	static const PolyIdSet none;
+	if(vert < 0 || vert >= (GLint)vert_polys.size()) {
+		return none;
+	}
+	return vert_polys[vert];
 }
 
 void Face::find_polys_containing(vector<Polygon *>& out, GLint vert) {
+	const PolyIdSet& ids = polys_containing(vert);
 	out.clear();
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		Polygon *p = polygons[i];
-		if(p->contains(vert)) {
-			out.push_back(polygons[i]);
-		}
+	for (size_t i = 0; i < ids.size(); ++i) {
+		out.push_back(polygons[ids[i]]);
 	}
-	uniq(out);
 }
 // returns polygon containing all verts
 // if not found or error, does nothing
-void Face::get_poly(vector<GLint> verts, Polygon& out) {
+void Face::get_poly(const vector<GLint>& verts, Polygon& out) {
 	if((GLint)verts.size() != out.size) {
 		return;
 	}
@@ -360,87 +407,82 @@ void Face::get_poly(vector<GLint> verts, Polygon& out) {
 // returns index of poly in face.polygons vector
 // returns -1 if poly not found
 GLint Face::get_poly_index(const Polygon *poly) const {
-	GLint index = -1;
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		if(*poly == *polygons[i]) {
-			index = i;
-			break;
+	if(poly->id >= 0 && poly->id < (GLint)polygons.size() &&
+			(polygons[poly->id] == poly || *polygons[poly->id] == *poly)) {
+		return poly->id;
+	}
+	if(poly_lookup.empty()) {
+		poly_lookup.reserve(polygons.size());
+		// first of any equal polys wins, as the old linear search
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			poly_lookup.insert(std::make_pair(polygons[i], (GLint)i));
 		}
 	}
-	return index;
+	auto found = poly_lookup.find(poly);
+	return found == poly_lookup.end() ? -1 : found->second;
 }
 
 void Face::find_polys_containing(vector<Polygon *>& out, const IndexedEdge& edge) {
+	// only polys with both ends can have the edge
+	PolyIdSet both;
+	id_intersection(polys_containing(edge.u), polys_containing(edge.v), both);
 	out.clear();
-	for (size_t i = 0; i < polygons.size(); ++i) {
-		if(polygons[i]->contains(edge)) {
-			out.push_back(polygons[i]);
+	for (size_t i = 0; i < both.size(); ++i) {
+		if(polygons[both[i]]->contains(edge)) {
+			out.push_back(polygons[both[i]]);
 		}
 	}
-	uniq(out);
 }
 
-// put neighboring polys in out
-// runs uniq on out and removes poly from it
-void Face::get_neighbors(vector<Polygon *>& out, const Polygon *poly) {
-	vector<Polygon *> working, temp;
+void Face::get_neighbor_ids(PolyIdSet& out, GLint id) {
+	const Polygon *poly = polygons[id];
 	out.clear();
 	for (int i = 0; i < poly->size; ++i) {
-		GLint vert = poly->verts[i];
-		find_polys_containing(working, vert);
-		for (size_t j = 0; j < working.size(); ++j) {
-			out.push_back(working[j]);
-		}
-		working.clear();
+		const PolyIdSet& ids = polys_containing(poly->verts[i]);
+		out.insert(out.end(), ids.begin(), ids.end());
 	}
-	uniq(out);
-	// remove original poly from neighbors
-	for (size_t i = 0; i < out.size(); ++i) {
-		if(*out[i] == *poly) {
-			out.erase(out.begin()+i);
-		}
+	sort(out.begin(), out.end());
+	out.erase(unique(out.begin(), out.end()), out.end());
+	PolyIdSet::iterator self = lower_bound(out.begin(), out.end(), id);
+	if(self != out.end() && *self == id) {
+		out.erase(self);
+	}
+}
+
+// put neighboring polys in out, poly is not included
+void Face::get_neighbors(vector<Polygon *>& out, const Polygon *poly) {
+	assert(poly->id >= 0 && polygons[poly->id] == poly);
+	PolyIdSet ids;
+	get_neighbor_ids(ids, poly->id);
+	out.clear();
+	for (size_t i = 0; i < ids.size(); ++i) {
+		out.push_back(polygons[ids[i]]);
 	}
 }
+
 void Face::grow_region(Region& region, Polygon *start) {
-	vector<Polygon*> fringe, neighbors, temp_polys, temp_polys2;
-	vector<Polygon*>::iterator poly_it;
-	get_neighbors(fringe, start);
-//	int i=0;
+	PolyIdSet region_ids, fringe, neighbors, temp;
+	get_neighbor_ids(fringe, start->id);
 	do {
-//		cout << "i = " << i++ << "  fringe.size(): " << fringe.size() << endl;
-//		cout << "grow_region: polys in fringe: " << endl;
-//		print_polys(fringe, 100);
-//		cout << "************************ end fringe ************" << endl;
-
-		// remove duplicate polys from the fringe
-		uniq(fringe);
-		// add the fringe to the region, uniq it
-		add_all(fringe, region.polygons);
-		uniq(region.polygons);
-//		copy(fringe.begin(), fringe.end(), back_inserter(region.polygons));
+		// add the fringe to the region
+		id_union(region_ids, fringe, temp);
+		region_ids.swap(temp);
 		// find neighbors of all the fringe
 		neighbors.clear();
 		for (size_t i = 0; i < fringe.size(); ++i) {
-			get_neighbors(temp_polys, fringe[i]);
-			add_all(temp_polys, neighbors);
-			uniq(neighbors);
+			get_neighbor_ids(temp, fringe[i]);
+			neighbors.insert(neighbors.end(), temp.begin(), temp.end());
 		}
-		temp_polys.clear();
-		// the difference between the old fringe and the neighbors
-		// is the new fringe
-		difference(fringe, neighbors, temp_polys);
-		fringe.clear();
-		add_all(temp_polys, fringe);
-		// subtract fringe intersection with region
-		intersection(fringe, region.polygons, temp_polys);
-		difference(fringe, temp_polys, temp_polys2);
-		fringe.clear();
-		add_all(temp_polys2, fringe);
-
-//		cout << "neighbors.size(): " << neighbors.size() << endl;
-
+		sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+		// polys in just one of the old fringe and its neighbors,
+		// less those already in the region, are the new fringe
+		id_symmetric_difference(fringe, neighbors, temp);
+		id_difference(temp, region_ids, fringe);
 	} while(!fringe.empty());
 
+	region.poly_ids.swap(region_ids);
+
 //	cout << "region: polys: " << endl;
 //	print_polys(region.polygons);
 //	cout << "************************ end region **********************" << endl;
@@ -450,23 +492,26 @@ void Face::grow_region(Region& region, Polygon *start) {
 // find regions of connected polygons in this face
 // initialize the regions with outer and possibly inner perimeters
 void Face::init_regions(GLint start_vert) {
-	vector<Polygon*> in_region, temp_polys;
+	PolyIdSet in_region, all_ids, temp;
 	Polygon *start;
 	bool all_polys = false;
 
 	// start with connected polygons sharing starting vertex
-	find_polys_containing(in_region, start_vert);
-	if(in_region.empty()) {
+	const PolyIdSet& at_start = polys_containing(start_vert);
+	if(at_start.empty()) {
 		cout << "init_regions: no polys containing start vert: " << start_vert << endl;
 		return;
 	}
 //	cout << "init regions: polys containing vert: " << start_vert << in_region.size() << endl;
 
-	start = in_region[0];
+	start = polygons[at_start[0]];
+	for (size_t i = 0; i < polygons.size(); ++i) {
+		all_ids.push_back(i);
+	}
 
 	int rcount = 0;
 	while(!all_polys) {
-		Region *r = new Region();
+		Region *r = new_region();
 		grow_region(*r, start);
 		//** debug
 //		cout << "region " << rcount++ <<  " polys: " << r->polygons.size() << endl;
@@ -475,19 +520,15 @@ void Face::init_regions(GLint start_vert) {
 		regions.push_back(r);
 
 		// account for all polys already in a region
-		in_region.clear();
-		for (size_t i = 0; i < regions.size(); ++i) {
-			add_all(regions[i]->polygons, in_region);
-		}
-		uniq(in_region); // shouldn't be nec.
-
+		id_union(in_region, r->poly_ids, temp);
+		in_region.swap(temp);
 
 		// if any polys not in a region, start another with the first
-		difference(in_region, polygons, temp_polys);
-		if(temp_polys.empty()) {
+		id_difference(all_ids, in_region, temp);
+		if(temp.empty()) {
 			all_polys = true;
 		} else {
-			start = temp_polys[0];
+			start = polygons[temp[0]];
 		}
 	}
 
@@ -508,11 +549,9 @@ void Face::init_regions(GLint start_vert) {
 			cout << "Face.init_regions: no perimeters for region: " << i << endl;
 			exit(1);
 		}
-		add_all(perimeters[0], r->perimeter);
+		r->perimeter.assign(perimeters[0].begin(), perimeters[0].end());
 		for (size_t j = 1; j < perimeters.size(); ++j) {
-			vector<GLint> inner_p;
-			r->inner_perimeters.push_back(inner_p);
-			add_all(perimeters[j], r->inner_perimeters[j-1]);
+			r->add_inner_perimeter().assign(perimeters[j].begin(), perimeters[j].end());
 		}
 	}
 	// set longest and shortest poly side lengths
@@ -520,12 +559,11 @@ void Face::init_regions(GLint start_vert) {
 	GLfloat minlen = 10000, maxlen = 0;
 	for (size_t i = 0; i < polygons.size(); ++i) {
 		const Polygon *p = polygons[i];
-//		for (size_t j = 0; j < p->size; ++j) {
-//		}
-		vector<Vec> verts;
-		p->get_actual_verts(verts);
-		for (size_t j = 0; j < verts.size(); ++j) {
-			GLfloat sidelen = dist(verts[j], verts[(j+1)%verts.size()]);
+		for (int j = 0; j < p->size; ++j) {
+			vec3 a, b;
+			parent->get_layout_vert(p->verts[j], a);
+			parent->get_layout_vert(p->verts[(j+1)%p->size], b);
+			GLfloat sidelen = dist(a, b);
 			minlen = min(minlen, sidelen);
 			maxlen = max(maxlen, sidelen);
 		}
@@ -545,19 +583,6 @@ void Face::init_regions(GLint start_vert) {
 //			cout << j << " perim size = " << r->inner_perimeters[j].size() << endl;
 //		}
 //	}
-	//** debug
-	// put all the perimeter vertices into debug_verts
-	for (size_t i = 0; i < regions.size(); ++i) {
-		Region *r = regions[i];
-		for (size_t j = 0; j < r->perimeter.size(); j++) {
-			debug_verts.push_back(r->perimeter[j]);
-		}
-		for (size_t j = 0; j < r->inner_perimeters.size(); ++j) {
-			for (size_t k = 0; k < r->inner_perimeters[j].size(); ++k) {
-				debug_verts.push_back(r->inner_perimeters[j][k]);
-			}
-		}
-	}
 //	for (size_t i = 0; i < regions.size(); ++i) {
 //		cout << "region "<< i << " polys: " << endl;
 //		print_polys(regions[i]->polygons, 100);
@@ -565,6 +590,17 @@ void Face::init_regions(GLint start_vert) {
 //	}
 }
 
+// outer then inner perimeters, region by region
+void Face::get_perimeter_verts(vector<GLint>& out) const {
+	for (size_t i = 0; i < regions.size(); ++i) {
+		const Region *r = regions[i];
+		out.insert(out.end(), r->perimeter.begin(), r->perimeter.end());
+		for (size_t j = 0; j < r->inner_perimeters.size(); ++j) {
+			out.insert(out.end(), r->inner_perimeters[j].begin(), r->inner_perimeters[j].end());
+		}
+	}
+}
+
 /**
  * Get center of center polygon.
  * Sets out to {0, 0, 0} if no center poly is set.
@@ -585,7 +621,7 @@ void Face::get_center(Polygon& out) {
  * Get the index of center poly.
  * Asserts center poly is set.
  */
-GLint Face::get_center_index() {
+GLint Face::get_center_index() const {
 	assert(center_index != -1);
 	return center_index;
 }
@@ -620,7 +656,7 @@ void Face::set_center(Vec up) {
 		Region *r = regions[i];
 		for (size_t j = 0; j < r->perimeter.size(); ++j) {
 			GLint vert_index = r->perimeter[j];
-			parent->get_vert(vert_index, vert);
+			parent->get_layout_vert(vert_index, vert);
 			minx = min(minx, vert[0]);
 			maxx = max(maxx, vert[0]);
 			minz = min(minz, vert[2]);
@@ -646,7 +682,16 @@ void Face::set_center(Vec up) {
 	GLint cindex = -1;
 	for (size_t i = 0; i < polygons.size(); ++i) {
 		Polygon *p = polygons[i];
-		dist_center = dist(centerpt, p->center);
+		// centroid as laid out, p->center may have moved since
+		Vec c;
+		for (int j = 0; j < p->size; ++j) {
+			parent->get_layout_vert(p->verts[j], vert);
+			c = c + Vec(vert);
+		}
+		c = c * (1.0f / p->size);
+		vec3 poly_center;
+		c.array_out(poly_center);
+		dist_center = dist(centerpt, poly_center);
 		if(dist_center < mindist) {
 			cindex = i;
 			mindist = dist_center;
@@ -0,0 +1,58 @@
+/*
+ * force_field.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "force_field.h"
+
+using namespace DR;
+
+ForceFields::ForceFields()
+: enabled(FORCE_NONE), radial_strength(1.0f), curl_strength(1.0f),
+  curl_scale(0.25f), drag(0.5f) {
+	setv(gravity, 0.0f, -1.0f, 0.0f);
+	zero(center);
+}
+
+// offsets decorrelate the 3 components of the potential
+static const GLfloat CURL_OFFSETS[3][3] = {
+		{ 0.0f, 0.0f, 0.0f },
+		{ 31.416f, 47.853f, 12.793f },
+		{ 101.127f, 23.456f, 71.911f }
+};
+// step for central differences, in noise space
+static const GLfloat CURL_EPS = 0.01f;
+
+// the 6 partials in the curl, as (component of potential, axis)
+static const int PARTIALS[6][2] = {
+		{ 2, 1 }, { 1, 2 }, { 0, 2 }, { 2, 0 }, { 1, 0 }, { 0, 1 }
+};
+
+void DR::curl_noise(const NoiseEngine& noise, const GLfloat pos[3], GLfloat scale,
+		GLfloat out[3]) {
+	// sample points: +eps and -eps for each partial
+	GLfloat x[12], y[12], z[12], n[12];
+	for (int i = 0; i < 6; ++i) {
+		int c = PARTIALS[i][0], axis = PARTIALS[i][1];
+		for (int s = 0; s < 2; ++s) {
+			GLfloat p[3];
+			for (int j = 0; j < 3; ++j) {
+				p[j] = pos[j] * scale + CURL_OFFSETS[c][j];
+			}
+			p[axis] += s == 0 ? CURL_EPS : -CURL_EPS;
+			x[2*i+s] = p[0];
+			y[2*i+s] = p[1];
+			z[2*i+s] = p[2];
+		}
+	}
+	noise.perlin(x, y, z, n, 12);
+	GLfloat d[6];
+	for (int i = 0; i < 6; ++i) {
+		d[i] = (n[2*i] - n[2*i+1]) / (2.0f * CURL_EPS);
+	}
+	// curl = (dPz/dy - dPy/dz, dPx/dz - dPz/dx, dPy/dx - dPx/dy)
+	out[0] = d[0] - d[1];
+	out[1] = d[2] - d[3];
+	out[2] = d[4] - d[5];
+}
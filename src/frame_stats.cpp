@@ -0,0 +1,278 @@
+/*
+ * frame_stats.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "frame_stats.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+void TimeHistogram::clear() {
+	memset(counts, 0, sizeof(counts));
+	total = 0;
+	min_us = max_us = 0;
+	sum_us = 0;
+}
+
+int TimeHistogram::bucket_of(unsigned long long us) {
+	int msb = 0;
+	while(msb < 63 && (us >> (msb + 1))) {
+		++msb;
+	}
+	int shift = max(0, msb - SUB_BITS);
+	if(shift > MAX_SHIFT) {
+		return NUM_BUCKETS - 1;
+	}
+	return shift * SUB_BUCKETS + (int)(us >> shift);
+}
+
+unsigned long long TimeHistogram::bucket_top(int b) {
+	if(b < 2 * SUB_BUCKETS) {
+		return b;
+	}
+	int shift = b / SUB_BUCKETS - 1;
+	unsigned long long mantissa = b - shift * SUB_BUCKETS;
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void TimeHistogram::record(double ms) {
+	unsigned long long us = ms > 0 ? (unsigned long long)llround(ms * 1000) : 0;
+	++counts[bucket_of(us)];
+	min_us = total ? min(min_us, us) : us;
+	max_us = max(max_us, us);
+	sum_us += us;
+	++total;
+}
+
+double TimeHistogram::percentile(double p) const {
+	if(!total) {
+		return 0;
+	}
+	// less a hair, so 99.9 of 1000 is rank 999 despite rounding
+	size_t rank = (size_t)ceil(p / 100 * total - 1e-9);
+	rank = min(max(rank, (size_t)1), total);
+	size_t seen = 0;
+	for (int b = 0; b < NUM_BUCKETS; ++b) {
+		seen += counts[b];
+		if(seen >= rank) {
+			// the last bucket has no top
+			return b == NUM_BUCKETS - 1 ? max_ms() : min(bucket_top(b), max_us) * 0.001;
+		}
+	}
+	return max_ms();
+}
+
+void TimeHistogram::buckets(vector<pair<double, size_t> >& out) const {
+	out.clear();
+	for (int b = 0; b < NUM_BUCKETS; ++b) {
+		if(counts[b]) {
+			out.push_back(make_pair(bucket_top(b) * 0.001, counts[b]));
+		}
+	}
+}
+
+static const char *part_names[] = { "frame", "simulate", "render", "swap" };
+// percentiles reported, and their column names
+static const double report_pcts[] = { 50, 90, 99, 99.9 };
+static const char *report_names[] = { "p50", "p90", "p99", "p99.9" };
+static const int num_report_pcts = 4;
+
+const char* FrameStats::part_name(int part) {
+	return part_names[part];
+}
+
+void FrameStats::clear() {
+	for (int i = 0; i < NUM_PARTS; ++i) {
+		parts[i].clear();
+	}
+	streamed.clear();
+}
+
+static void print_header(ostream& out) {
+	out << setw(10) << left << "" << right << setw(8) << "count" << setw(10) << "mean";
+	for (int k = 0; k < num_report_pcts; ++k) {
+		out << setw(10) << report_names[k];
+	}
+	out << setw(10) << "worst" << endl;
+}
+
+static void print_row(ostream& out, const char *name, const TimeHistogram& h) {
+	out << setw(10) << left << name << right << setw(8) << h.count() << setw(10) << h.mean_ms();
+	for (int k = 0; k < num_report_pcts; ++k) {
+		out << setw(10) << h.percentile(report_pcts[k]);
+	}
+	out << setw(10) << h.max_ms() << endl;
+}
+
+void FrameStats::print(ostream& out) const {
+	ios_base::fmtflags flags = out.flags();
+	streamsize precision = out.precision();
+	out << fixed << setprecision(3);
+	out << "******* Frame Time Stats (ms) ********" << endl;
+	print_header(out);
+	for (int i = 0; i < NUM_PARTS; ++i) {
+		print_row(out, part_names[i], parts[i]);
+	}
+	out << "******* Streamed per Frame (KB) ********" << endl;
+	print_header(out);
+	print_row(out, "streamed", streamed);
+	out.flags(flags);
+	out.precision(precision);
+}
+
+// columns named with unit after them
+static void csv_header(ostream& out, const char *first, const char *unit) {
+	out << first << ",count,mean_" << unit;
+	for (int k = 0; k < num_report_pcts; ++k) {
+		out << "," << report_names[k] << "_" << unit;
+	}
+	out << ",worst_" << unit << endl;
+}
+
+static void csv_row(ostream& out, const char *name, const TimeHistogram& h) {
+	out << name << "," << h.count() << "," << h.mean_ms();
+	for (int k = 0; k < num_report_pcts; ++k) {
+		out << "," << h.percentile(report_pcts[k]);
+	}
+	out << "," << h.max_ms() << endl;
+}
+
+void FrameStats::write_csv(ostream& out) const {
+	csv_header(out, "part", "ms");
+	for (int i = 0; i < NUM_PARTS; ++i) {
+		csv_row(out, part_names[i], parts[i]);
+	}
+}
+
+void FrameStats::write_streamed_csv(ostream& out) const {
+	csv_header(out, "what", "kb");
+	csv_row(out, "streamed", streamed);
+}
+
+void FrameStats::write_json(ostream& out) const {
+	vector<pair<double, size_t> > b;
+	out << "{" << endl << "  \"frames\": " << frames() << "," << endl;
+	out << "  \"parts\": {" << endl;
+	for (int i = 0; i < NUM_PARTS; ++i) {
+		const TimeHistogram& h = parts[i];
+		out << "    \"" << part_names[i] << "\": {\"count\": " << h.count()
+				<< ", \"mean_ms\": " << h.mean_ms();
+		for (int k = 0; k < num_report_pcts; ++k) {
+			out << ", \"" << report_names[k] << "_ms\": " << h.percentile(report_pcts[k]);
+		}
+		out << ", \"worst_ms\": " << h.max_ms() << "," << endl;
+		// [top of bucket ms, count]
+		out << "      \"histogram\": [";
+		h.buckets(b);
+		for (size_t j = 0; j < b.size(); ++j) {
+			out << (j ? ", " : "") << "[" << b[j].first << ", " << b[j].second << "]";
+		}
+		out << "]}" << (i + 1 < NUM_PARTS ? "," : "") << endl;
+	}
+	out << "  }," << endl;
+	// [top of bucket KB, count]
+	out << "  \"streamed_kb\": {\"count\": " << streamed.count() << ", \"mean\": " << streamed.mean_ms();
+	for (int k = 0; k < num_report_pcts; ++k) {
+		out << ", \"" << report_names[k] << "\": " << streamed.percentile(report_pcts[k]);
+	}
+	out << ", \"worst\": " << streamed.max_ms() << ", \"histogram\": [";
+	streamed.buckets(b);
+	for (size_t j = 0; j < b.size(); ++j) {
+		out << (j ? ", " : "") << "[" << b[j].first << ", " << b[j].second << "]";
+	}
+	out << "]}" << endl << "}" << endl;
+}
+
+bool FrameStats::write(const string& base) const {
+	ofstream csv((base + ".csv").c_str());
+	write_csv(csv);
+	ofstream streamed_csv((base + "_streamed.csv").c_str());
+	write_streamed_csv(streamed_csv);
+	ofstream json((base + ".json").c_str());
+	write_json(json);
+	return csv.good() && streamed_csv.good() && json.good();
+}
+
+void TimeHistogram::test() {
+	cout <<  "\n******************** TimeHistogram::test() **************************" << endl;
+	// every bucket's top maps back to it, and the next time to the next one
+	for (int b = 0; b < NUM_BUCKETS - 1; ++b) {
+		if(bucket_of(bucket_top(b)) != b || bucket_of(bucket_top(b) + 1) != b + 1) {
+			cout << "!=: bucket " << b << " top " << bucket_top(b) << endl;
+			break;
+		}
+	}
+	// 1 to 1000 ms
+	TimeHistogram h;
+	for (int i = 1; i <= 1000; ++i) {
+		h.record(i);
+	}
+	const double want[] = { 500, 900, 990, 999 };
+	for (int k = 0; k < num_report_pcts; ++k) {
+		double got = h.percentile(report_pcts[k]);
+		if(got < want[k] || got > want[k] * 1.016) {
+			cout << "!=: " << report_names[k] << " " << got << ", want " << want[k] << endl;
+		}
+	}
+	if(h.count() != 1000 || h.min_ms() != 1 || h.max_ms() != 1000 || fabs(h.mean_ms() - 500.5) > 1e-9
+			|| h.percentile(100) != 1000) {
+		cout << "!=: count " << h.count() << ", min " << h.min_ms() << ", max " << h.max_ms()
+				<< ", mean " << h.mean_ms() << endl;
+	}
+	// one hitch in a thousand smooth frames, the median hides it, p99.9 doesn't
+	TimeHistogram smooth;
+	for (int i = 0; i < 999; ++i) {
+		smooth.record(16.6);
+	}
+	smooth.record(250);
+	if(smooth.percentile(50) > 16.6 * 1.016 || smooth.percentile(99.9) > 16.6 * 1.016
+			|| smooth.max_ms() != 250) {
+		cout << "!=: smooth p50 " << smooth.percentile(50) << ", p99.9 " << smooth.percentile(99.9)
+				<< ", worst " << smooth.max_ms() << endl;
+	}
+	smooth.record(250);
+	if(smooth.percentile(99.9) != 250) {
+		cout << "!=: two hitches p99.9 " << smooth.percentile(99.9) << endl;
+	}
+	// too long for the buckets still counts, the worst is exact
+	TimeHistogram huge;
+	huge.record(1e12);
+	if(huge.count() != 1 || huge.max_ms() != 1e12 || huge.percentile(50) != 1e12) {
+		cout << "!=: huge " << huge.percentile(50) << ", worst " << huge.max_ms() << endl;
+	}
+
+	FrameStats fs;
+	fs.record(FrameStats::FRAME, 16);
+	fs.record(FrameStats::SIMULATE, 2);
+	// 1.5 MB and a byte, exactly
+	fs.record_streamed(1500001);
+	ostringstream csv, streamed_csv, json;
+	fs.write_csv(csv);
+	fs.write_streamed_csv(streamed_csv);
+	fs.write_json(json);
+	string c = csv.str(), s = streamed_csv.str(), j = json.str();
+	if(std::count(c.begin(), c.end(), '\n') != 1 + FrameStats::NUM_PARTS || c.find("simulate,1,2,2,2,2,2,2") == string::npos
+			|| c.find("_kb") != string::npos || c.find("streamed") != string::npos) {
+		cout << "!=: csv\n" << c << endl;
+	}
+	if(fs.get_streamed().max_ms() != 1500.001 || s.find("what,count,mean_kb,p50_kb,") != 0
+			|| s.find("_ms") != string::npos || s.find("\nstreamed,1,1500") == string::npos) {
+		cout << "!=: streamed csv\n" << s << endl;
+	}
+	if(j.find("\"frames\": 1,") == string::npos || j.find("\"swap\": {\"count\": 0") == string::npos
+			|| j.find("\"streamed_kb\": {\"count\": 1") == string::npos
+			|| std::count(j.begin(), j.end(), '{') != std::count(j.begin(), j.end(), '}')) {
+		cout << "!=: json\n" << j << endl;
+	}
+	cout << "\n***************** Done:  TimeHistogram::test() ***********************" << endl;
+}
@@ -8,8 +8,11 @@
  */
 
 #include "glut_app.h"
+#include "stream_buffer.h"
 
 #include <cmath>
+#include <chrono>
+#include <thread>
 
 using namespace std;
 using namespace DR;
@@ -17,23 +20,100 @@ using namespace DR;
 GlutApp::GlutApp()
 : win_width(100), win_height(100),
   frame(0), last_frame(0), framerate(0), show_framerate(false),
+  stats_warmup_secs(5), frame_stats_file("frame_stats"),
   output_file("gl_info.txt"), curr_time_ms(0), start_time_ms(0),
+  sim_step(1.0 / 120), max_sim_steps(8), sim_time(0), sim_alpha(0),
+  frame_rate_cap(60), vsync(false),
   headsup_announce("Hit k for Keybindings"), update_headsup_freq(0),
   show_keybindings(false), keybindings_width_right_side(0),
-  z_start(0), z_zoom(0), z_zoom_delta(0), z_zoom_max(0) {
+  z_start(0), z_zoom(0), z_zoom_delta(0), z_zoom_max(0),
+  sim_owed(0), last_advance_secs(0), last_frame_secs(0),
+  frame_sim_ms(0), render_start_ms(0) {
 	setv(light_model_ambient, 0, 0, 0, 1);
 }
 
 GlutApp::GlutApp(int window_width, int window_height)
 : win_width(window_width), win_height(window_height),
   frame(0), last_frame(0), framerate(0), show_framerate(false),
+  stats_warmup_secs(5), frame_stats_file("frame_stats"),
   output_file("gl_info.txt"), curr_time_ms(0), start_time_ms(0),
+  sim_step(1.0 / 120), max_sim_steps(8), sim_time(0), sim_alpha(0),
+  frame_rate_cap(60), vsync(false),
   headsup_announce("Hit k for Keybindings"), update_headsup_freq(0),
   show_keybindings(false), keybindings_width_right_side(0),
-  z_start(0), z_zoom(0), z_zoom_delta(0), z_zoom_max(0) {
+  z_start(0), z_zoom(0), z_zoom_delta(0), z_zoom_max(0),
+  sim_owed(0), last_advance_secs(0), last_frame_secs(0),
+  frame_sim_ms(0), render_start_ms(0) {
 	setv(light_model_ambient, 0, 0, 0, 1);
 }
 
+void GlutApp::start_clock() {
+	clock.reset();
+	sim_time = sim_owed = 0;
+	sim_alpha = 0;
+	last_advance_secs = last_frame_secs = 0;
+}
+
+int GlutApp::advance() {
+	GLdouble now = elapsed_secs();
+	GLdouble elapsed = now - last_advance_secs;
+	last_advance_secs = now;
+	return advance(elapsed);
+}
+
+int GlutApp::advance(GLdouble elapsed) {
+	sim_owed += elapsed;
+	GLdouble start_ms = elapsed_ms();
+	int steps = 0;
+	while(sim_owed >= sim_step) {
+		if(steps == max_sim_steps) {
+			// can't keep up, drop the whole steps still owed
+			sim_owed = fmod(sim_owed, sim_step);
+			break;
+		}
+		simulate(sim_step);
+		sim_time += sim_step;
+		sim_owed -= sim_step;
+		++steps;
+	}
+	sim_alpha = sim_owed / sim_step;
+	frame_sim_ms += elapsed_ms() - start_ms;
+	return steps;
+}
+
+void GlutApp::pace_frame() {
+	if(frame_rate_cap > 0 && !vsync) {
+		GLdouble wait = last_frame_secs + 1.0 / frame_rate_cap - elapsed_secs();
+		if(wait > 0) {
+			this_thread::sleep_for(chrono::duration<double>(wait));
+		}
+	}
+	last_frame_secs = elapsed_secs();
+	glutPostRedisplay();
+}
+
+void GlutApp::begin_render() {
+	render_start_ms = elapsed_ms();
+	frame_stream().begin_frame();
+}
+
+void GlutApp::swap_buffers() {
+	GLdouble swap_start_ms = elapsed_ms();
+	StreamBuffer& stream = frame_stream();
+	stream.end_frame();
+	glutSwapBuffers();
+	GLdouble end_ms = elapsed_ms();
+	if(elapsed_secs() >= stats_warmup_secs) {
+		GLdouble render_ms = swap_start_ms - render_start_ms, swap_ms = end_ms - swap_start_ms;
+		frame_stats.record(FrameStats::SIMULATE, frame_sim_ms);
+		frame_stats.record(FrameStats::RENDER, render_ms);
+		frame_stats.record(FrameStats::SWAP, swap_ms);
+		frame_stats.record(FrameStats::FRAME, frame_sim_ms + render_ms + swap_ms);
+		frame_stats.record_streamed(stream.bytes_used());
+	}
+	frame_sim_ms = 0;
+}
+
 GlutTrackballApp::GlutTrackballApp()
 : GlutApp() {
 	set_to_ident(trackball_transform_mat);
@@ -0,0 +1,327 @@
+/*
+ * hud.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "hud.h"
+#include "stream_buffer.h"
+
+#include <cmath>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+GlyphAtlas::GlyphAtlas() : texture(0) {
+	clear();
+}
+
+GlyphAtlas::~GlyphAtlas() {
+	if(texture) {
+		glDeleteTextures(1, &texture);
+	}
+}
+
+void GlyphAtlas::clear() {
+	if(texture) {
+		glDeleteTextures(1, &texture);
+		texture = 0;
+	}
+	fill(has_glyph, has_glyph + LAST_CHAR + 1, false);
+	pixels.clear();
+	pen_x = pen_y = row_height = 0;
+	line_h = tex_height = 0;
+	finished = false;
+}
+
+void GlyphAtlas::add_glyph(unsigned char c, int width, int height, int left, int descent, int advance,
+		const unsigned char *glyph_pixels) {
+	assert(!finished && c <= LAST_CHAR && width <= WIDTH);
+	// a pixel apart, so neighbors never bleed in
+	if(pen_x + width > WIDTH) {
+		pen_x = 0;
+		pen_y += row_height + 1;
+		row_height = 0;
+	}
+	pixels.resize(max(pixels.size(), (size_t)WIDTH * (pen_y + height)), 0);
+	for (int row = 0; row < height; ++row) {
+		copy(glyph_pixels + row * width, glyph_pixels + (row + 1) * width,
+				&pixels[(pen_y + row) * WIDTH + pen_x]);
+	}
+	Glyph& g = glyphs[c];
+	g.x = pen_x;
+	g.y = pen_y;
+	g.width = width;
+	g.height = height;
+	g.left = left;
+	g.descent = descent;
+	g.advance = advance;
+	has_glyph[c] = true;
+	pen_x += width + 1;
+	row_height = max(row_height, height);
+	line_h = max(line_h, height);
+}
+
+void GlyphAtlas::finish() {
+	GLint rows = pixels.size() / WIDTH;
+	tex_height = 1;
+	while(tex_height < rows) {
+		tex_height *= 2;
+	}
+	pixels.resize(WIDTH * tex_height, 0);
+	finished = true;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::glyph(unsigned char c) const {
+	return c <= LAST_CHAR && has_glyph[c] ? &glyphs[c] : NULL;
+}
+
+void GlyphAtlas::rasterize_glut(void *font, int line_height, int descent) {
+	clear();
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	glUseProgram(0);
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	gluOrtho2D(0, viewport[2], 0, viewport[3]);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_BLEND);
+	glDrawBuffer(GL_BACK);
+	glReadBuffer(GL_BACK);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glClearColor(0, 0, 0, 0);
+	glColor3f(1, 1, 1);
+	// drawn a pixel in, with a pixel to spare on the right, italics overhang
+	const int left = 1;
+	vector<unsigned char> glyph_pixels;
+	for (int c = FIRST_CHAR; c <= LAST_CHAR; ++c) {
+		int advance = glutBitmapWidth(font, c);
+		int width = advance + 2 * left;
+		glClear(GL_COLOR_BUFFER_BIT);
+		glRasterPos2i(left, descent);
+		glutBitmapCharacter(font, c);
+		glyph_pixels.resize(width * line_height);
+		glReadPixels(0, 0, width, line_height, GL_RED, GL_UNSIGNED_BYTE, &glyph_pixels[0]);
+		add_glyph(c, width, line_height, left, descent, advance, &glyph_pixels[0]);
+	}
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	glPopClientAttrib();
+	glPopAttrib();
+	glUseProgram(program);
+	gl_error("GlyphAtlas::rasterize_glut");
+	finish();
+}
+
+void GlyphAtlas::bind() {
+	if(texture) {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		return;
+	}
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	// pixel for pixel, nothing to filter
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, WIDTH, tex_height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &pixels[0]);
+	glPopClientAttrib();
+}
+
+void HudText::set_text(size_t run, GLfloat x, GLfloat y, const string& text,
+		const GLfloat *color, GLfloat line_spacing) {
+	if(run >= runs.size()) {
+		runs.resize(run + 1);
+	}
+	Run& r = runs[run];
+	GLfloat white[] = { 1, 1, 1, 1 };
+	if(!color) {
+		color = white;
+	}
+	if(r.text == text && r.x == x && r.y == y && r.line_spacing == line_spacing
+			&& std::equal(color, color + 4, r.color)) {
+		return;
+	}
+	r.text = text;
+	r.x = x;
+	r.y = y;
+	r.line_spacing = line_spacing;
+	copyv(r.color, color, 4);
+	layout(r);
+	dirty = true;
+}
+
+void HudText::clear() {
+	runs.clear();
+	vertices.clear();
+	dirty = false;
+}
+
+void HudText::layout(Run& r) {
+	assert(atlas.is_finished());
+	++layouts;
+	r.vertices.clear();
+	GLfloat spacing = r.line_spacing < 0 ? atlas.line_height() : r.line_spacing;
+	// whole pixels, so texels land on pixels
+	GLfloat pen_x = floor(r.x + 0.5f), pen_y = floor(r.y + 0.5f);
+	GLfloat tex_w = atlas.width(), tex_h = atlas.height();
+	for (size_t i = 0; i < r.text.size(); ++i) {
+		unsigned char c = r.text[i];
+		if(c == '\n') {
+			pen_x = floor(r.x + 0.5f);
+			pen_y -= floor(spacing + 0.5f);
+			continue;
+		}
+		const GlyphAtlas::Glyph *g = atlas.glyph(c);
+		if(!g) {
+			continue;
+		}
+		if(c != ' ') {
+			GLfloat x0 = pen_x - g->left, y0 = pen_y - g->descent;
+			GLfloat x1 = x0 + g->width, y1 = y0 + g->height;
+			GLfloat s0 = g->x / tex_w, t0 = g->y / tex_h;
+			GLfloat s1 = (g->x + g->width) / tex_w, t1 = (g->y + g->height) / tex_h;
+			GLfloat quad[4][4] = { { x0, y0, s0, t0 }, { x1, y0, s1, t0 }, { x1, y1, s1, t1 }, { x0, y1, s0, t1 } };
+			for (int k = 0; k < 4; ++k) {
+				r.vertices.insert(r.vertices.end(), quad[k], quad[k] + 4);
+				r.vertices.insert(r.vertices.end(), r.color, r.color + 4);
+			}
+		}
+		pen_x += g->advance;
+	}
+}
+
+size_t HudText::num_quads() const {
+	size_t n = 0;
+	for (size_t i = 0; i < runs.size(); ++i) {
+		n += runs[i].vertices.size() / (4 * FLOATS_PER_VERTEX);
+	}
+	return n;
+}
+
+void HudText::draw(int width, int height) {
+	if(dirty) {
+		vertices.clear();
+		for (size_t i = 0; i < runs.size(); ++i) {
+			vertices.insert(vertices.end(), runs[i].vertices.begin(), runs[i].vertices.end());
+		}
+		dirty = false;
+	}
+	if(vertices.empty()) {
+		return;
+	}
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	gluOrtho2D(0, width, 0, height);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_TEXTURE_2D);
+	atlas.bind();
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	GLsizei stride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+	// into the frame's stream, or drawn from client memory if it's full
+	StreamBuffer& stream = frame_stream();
+	size_t offset;
+	GLfloat *v = stream.alloc_floats(vertices.size(), offset);
+	const GLfloat *from = &vertices[0];
+	if(v) {
+		copy(vertices.begin(), vertices.end(), v);
+		stream.bind();
+		from = (const GLfloat*)stream.pointer(offset);
+	}
+	glVertexPointer(2, GL_FLOAT, stride, from);
+	glTexCoordPointer(2, GL_FLOAT, stride, from + 2);
+	glColorPointer(4, GL_FLOAT, stride, from + 4);
+	glDrawArrays(GL_QUADS, 0, vertices.size() / FLOATS_PER_VERTEX);
+	stream.unbind();
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	glPopClientAttrib();
+	glPopAttrib();
+}
+
+void HudText::test() {
+	cout <<  "\n******************** HudText::test() **************************" << endl;
+	// every glyph a 6 x 10 box, a pixel in, 2 below the baseline, 7 apart
+	GlyphAtlas atlas;
+	vector<unsigned char> box(6 * 10, 255);
+	for (int c = GlyphAtlas::FIRST_CHAR; c <= GlyphAtlas::LAST_CHAR; ++c) {
+		atlas.add_glyph(c, 6, 10, 1, 2, 7, &box[0]);
+	}
+	atlas.finish();
+	// 36 boxes to a row
+	if(atlas.height() != 32 || atlas.line_height() != 10 || atlas.glyph('\n') || !atlas.glyph('~')) {
+		cout << "!=: atlas " << atlas.width() << " x " << atlas.height() << ", line " << atlas.line_height() << endl;
+	}
+	const GlyphAtlas::Glyph *a = atlas.glyph('A');
+	if(a->x != ('A' - 32) % 36 * 7 || a->y != ('A' - 32) / 36 * 11
+			|| atlas.get_pixels()[a->y * GlyphAtlas::WIDTH + a->x] != 255
+			|| atlas.get_pixels()[a->y * GlyphAtlas::WIDTH + a->x + 6] != 0) {
+		cout << "!=: A at " << a->x << ", " << a->y << endl;
+	}
+
+	HudText hud(atlas);
+	hud.set_text(0, 10.4f, 20, "AB\nC D");
+	const vector<GLfloat>& v = hud.get_vertices(0);
+	// the corners of each quad, bottom left first
+	GLfloat want[][2] = { { 9, 18 }, { 16, 18 }, { 9, 8 }, { 23, 8 } };
+	if(hud.num_quads() != 4 || v.size() != 4 * 4 * FLOATS_PER_VERTEX) {
+		cout << "!=: " << hud.num_quads() << " quads" << endl;
+	} else {
+		for (int q = 0; q < 4; ++q) {
+			const GLfloat *bl = &v[q * 4 * FLOATS_PER_VERTEX], *tr = bl + 2 * FLOATS_PER_VERTEX;
+			if(bl[0] != want[q][0] || bl[1] != want[q][1] || tr[0] != want[q][0] + 6 || tr[1] != want[q][1] + 10) {
+				cout << "!=: quad " << q << " at " << bl[0] << ", " << bl[1] << " to " << tr[0] << ", " << tr[1] << endl;
+			}
+		}
+		if(v[2] != a->x / 256.0f || v[3] != a->y / 32.0f || v[2 * FLOATS_PER_VERTEX + 2] != (a->x + 6) / 256.0f
+				|| v[7] != 1) {
+			cout << "!=: A texture coords " << v[2] << ", " << v[3] << endl;
+		}
+	}
+	// laid out again only when something changes
+	size_t layouts = hud.num_layouts();
+	hud.set_text(0, 10.4f, 20, "AB\nC D");
+	GLfloat red[] = { 1, 0, 0, 1 };
+	hud.set_text(1, 0, 0, "x", red, 12);
+	if(hud.num_layouts() != layouts + 1 || hud.num_quads() != 5 || hud.get_vertices(1)[5] != 0) {
+		cout << "!=: " << hud.num_layouts() - layouts << " more layouts, " << hud.num_quads() << " quads" << endl;
+	}
+	hud.set_text(0, 10.4f, 20, "");
+	if(hud.num_quads() != 1) {
+		cout << "!=: hidden run left " << hud.num_quads() << " quads" << endl;
+	}
+	cout << "\n***************** Done:  HudText::test() ***********************" << endl;
+}
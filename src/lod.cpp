@@ -0,0 +1,482 @@
+/*
+ * lod.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "lod.h"
+
+#include <cmath>
+#include <cfloat>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+typedef linalg::Vec<3, double> Vec3d;
+
+// weight of the planes holding boundary edges in place, against 1 for faces
+static const double BOUNDARY_WEIGHT = 10.0;
+
+void QemSimplifier::Quadric::add_plane(double a, double b, double c, double d, double w) {
+	q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+	q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+	q[7] += w * c * c; q[8] += w * c * d;
+	q[9] += w * d * d;
+}
+
+double QemSimplifier::Quadric::eval(const Vec3d& v) const {
+	double x = v[0], y = v[1], z = v[2];
+	return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+			+ q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+			+ q[7] * z * z + 2 * q[8] * z + q[9];
+}
+
+QemSimplifier::QemSimplifier(const vec3 *verts, size_t num_verts, const vector<GLint>& in)
+: pos(num_verts), vert_tris(num_verts), quadrics(num_verts), locked(num_verts, false),
+  boundary(num_verts, false), merged_into(num_verts), version(num_verts, 0),
+  live_tris(0), max_cost(0), heap_built(false) {
+	for (size_t i = 0; i < num_verts; ++i) {
+		pos[i] = Vec3d(verts[i][0], verts[i][1], verts[i][2]);
+		merged_into[i] = i;
+	}
+	for (size_t i = 0; i + 2 < in.size(); i += 3) {
+		GLint a = in[i], b = in[i+1], c = in[i+2];
+		if(a == b || b == c || a == c) {
+			continue;
+		}
+		GLint t = tris.size() / 3;
+		tris.push_back(a);
+		tris.push_back(b);
+		tris.push_back(c);
+		vert_tris[a].push_back(t);
+		vert_tris[b].push_back(t);
+		vert_tris[c].push_back(t);
+	}
+	live_tris = tris.size() / 3;
+	tri_alive.assign(live_tris, true);
+
+	for (size_t t = 0; t < live_tris; ++t) {
+		const GLint *c = &tris[3 * t];
+		Vec3d n = linalg::cross(pos[c[1]] - pos[c[0]], pos[c[2]] - pos[c[0]]);
+		double len = linalg::length(n);
+		if(len == 0) {
+			continue;
+		}
+		n /= len;
+		double d = -linalg::dot(n, pos[c[0]]);
+		for (int k = 0; k < 3; ++k) {
+			quadrics[c[k]].add_plane(n[0], n[1], n[2], d, 1.0);
+		}
+		// edges with only this triangle get a plane through them,
+		// perpendicular to the triangle
+		for (int k = 0; k < 3; ++k) {
+			GLint a = c[k], b = c[(k + 1) % 3];
+			int count = edge_count(a, b);
+			if(count != 1) {
+				if(count > 2) {
+					// non manifold, leave it be
+					locked[a] = locked[b] = true;
+				}
+				continue;
+			}
+			boundary[a] = boundary[b] = true;
+			Vec3d bn = linalg::normalized(linalg::cross(pos[b] - pos[a], n));
+			double bd = -linalg::dot(bn, pos[a]);
+			quadrics[a].add_plane(bn[0], bn[1], bn[2], bd, BOUNDARY_WEIGHT);
+			quadrics[b].add_plane(bn[0], bn[1], bn[2], bd, BOUNDARY_WEIGHT);
+		}
+	}
+}
+
+GLfloat QemSimplifier::error() const {
+	return sqrt(max_cost);
+}
+
+GLint QemSimplifier::find(GLint v) const {
+	while(merged_into[v] != v) {
+		v = merged_into[v];
+	}
+	return v;
+}
+
+void QemSimplifier::get_remap(vector<GLint>& out) const {
+	out.resize(merged_into.size());
+	for (size_t i = 0; i < merged_into.size(); ++i) {
+		out[i] = find(i);
+	}
+}
+
+void QemSimplifier::neighbors(GLint v, vector<GLint>& out) const {
+	out.clear();
+	const vector<GLint>& around = vert_tris[v];
+	for (size_t i = 0; i < around.size(); ++i) {
+		if(!tri_alive[around[i]]) {
+			continue;
+		}
+		const GLint *c = &tris[3 * around[i]];
+		for (int k = 0; k < 3; ++k) {
+			if(c[k] != v && std::find(out.begin(), out.end(), c[k]) == out.end()) {
+				out.push_back(c[k]);
+			}
+		}
+	}
+}
+
+int QemSimplifier::edge_count(GLint a, GLint b) const {
+	int count = 0;
+	const vector<GLint>& around = vert_tris[a];
+	for (size_t i = 0; i < around.size(); ++i) {
+		const GLint *c = &tris[3 * around[i]];
+		if(tri_alive[around[i]] && (c[0] == b || c[1] == b || c[2] == b)) {
+			++count;
+		}
+	}
+	return count;
+}
+
+void QemSimplifier::push_candidates(GLint v) {
+	vector<GLint> nb;
+	neighbors(v, nb);
+	for (size_t i = 0; i < nb.size(); ++i) {
+		GLint w = nb[i];
+		Quadric q = quadrics[v];
+		q.add(quadrics[w]);
+		if(!locked[w]) {
+			Candidate c = { q.eval(pos[v]), w, v, version[w], version[v] };
+			heap.push_back(c);
+			push_heap(heap.begin(), heap.end());
+		}
+		if(!locked[v]) {
+			Candidate c = { q.eval(pos[w]), v, w, version[v], version[w] };
+			heap.push_back(c);
+			push_heap(heap.begin(), heap.end());
+		}
+	}
+}
+
+bool QemSimplifier::can_collapse(GLint u, GLint v) const {
+	if(locked[u]) {
+		return false;
+	}
+	// triangles on edge u-v, and their third vertices
+	int shared = 0;
+	GLint opposite = -1;
+	const vector<GLint>& around = vert_tris[u];
+	for (size_t i = 0; i < around.size(); ++i) {
+		const GLint *c = &tris[3 * around[i]];
+		if(tri_alive[around[i]] && (c[0] == v || c[1] == v || c[2] == v)) {
+			opposite = c[0] != u && c[0] != v ? c[0] : (c[1] != u && c[1] != v ? c[1] : c[2]);
+			++shared;
+		}
+	}
+	// boundary vertices only move along the boundary
+	if(shared != (boundary[u] ? 1 : 2)) {
+		return false;
+	}
+	// link condition, the only common neighbors are the third vertices
+	vector<GLint> nu, nv;
+	neighbors(u, nu);
+	neighbors(v, nv);
+	int common = 0;
+	for (size_t i = 0; i < nu.size(); ++i) {
+		common += std::find(nv.begin(), nv.end(), nu[i]) != nv.end() ? 1 : 0;
+	}
+	if(common != shared) {
+		return false;
+	}
+	// an ear would leave its tip on two boundary edges, or go altogether
+	if(shared == 1 && edge_count(u, opposite) == 1 && edge_count(v, opposite) == 1) {
+		return false;
+	}
+	// no triangle may flip or go flat
+	for (size_t i = 0; i < around.size(); ++i) {
+		if(!tri_alive[around[i]]) {
+			continue;
+		}
+		const GLint *c = &tris[3 * around[i]];
+		if(c[0] == v || c[1] == v || c[2] == v) {
+			continue;
+		}
+		Vec3d p[3], q[3];
+		for (int k = 0; k < 3; ++k) {
+			p[k] = q[k] = pos[c[k]];
+			if(c[k] == u) {
+				q[k] = pos[v];
+			}
+		}
+		Vec3d before = linalg::cross(p[1] - p[0], p[2] - p[0]);
+		Vec3d after = linalg::cross(q[1] - q[0], q[2] - q[0]);
+		double before2 = linalg::length2(before), after2 = linalg::length2(after);
+		if(after2 <= 1e-12 * before2 || linalg::dot(before, after) <= 0.2 * sqrt(before2 * after2)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void QemSimplifier::collapse(GLint u, GLint v) {
+	vector<GLint>& around = vert_tris[u];
+	for (size_t i = 0; i < around.size(); ++i) {
+		GLint t = around[i];
+		if(!tri_alive[t]) {
+			continue;
+		}
+		GLint *c = &tris[3 * t];
+		if(c[0] == v || c[1] == v || c[2] == v) {
+			tri_alive[t] = false;
+			--live_tris;
+			continue;
+		}
+		for (int k = 0; k < 3; ++k) {
+			if(c[k] == u) {
+				c[k] = v;
+			}
+		}
+		vert_tris[v].push_back(t);
+	}
+	around.clear();
+	merged_into[u] = v;
+	quadrics[v].add(quadrics[u]);
+	++version[v];
+	// drop the dead ones
+	vector<GLint>& vt = vert_tris[v];
+	size_t kept = 0;
+	for (size_t i = 0; i < vt.size(); ++i) {
+		if(tri_alive[vt[i]]) {
+			vt[kept++] = vt[i];
+		}
+	}
+	vt.resize(kept);
+}
+
+size_t QemSimplifier::simplify(size_t target, GLfloat max_error) {
+	if(!heap_built) {
+		for (size_t v = 0; v < vert_tris.size(); ++v) {
+			push_candidates(v);
+		}
+		heap_built = true;
+	}
+	double limit = (double)max_error * max_error;
+	vector<GLint> nb;
+	while(live_tris > target && !heap.empty()) {
+		// costs only grow as quadrics add up, so a stale top is a lower bound
+		if(heap.front().cost > limit) {
+			break;
+		}
+		Candidate c = heap.front();
+		pop_heap(heap.begin(), heap.end());
+		heap.pop_back();
+		if(merged_into[c.u] != c.u || merged_into[c.v] != c.v
+				|| version[c.u] != c.u_version || version[c.v] != c.v_version
+				|| !can_collapse(c.u, c.v)) {
+			continue;
+		}
+		collapse(c.u, c.v);
+		max_cost = max(max_cost, c.cost);
+		push_candidates(c.v);
+		// collapses around v may have stopped folding over
+		neighbors(c.v, nb);
+		for (size_t i = 0; i < nb.size(); ++i) {
+			push_candidates(nb[i]);
+		}
+	}
+	return live_tris;
+}
+
+void DR::vertex_normals(const vector<Polygon*>& polys, size_t num_verts, vector<GLint>& out) {
+	out.assign(num_verts, -1);
+	for (size_t i = 0; i < polys.size(); ++i) {
+		const Polygon *p = polys[i];
+		for (int k = 0; k < p->size; ++k) {
+			if(out[p->verts[k]] < 0) {
+				out[p->verts[k]] = p->norms[k];
+			}
+		}
+	}
+}
+
+void DR::remap_triangles(const vector<Polygon*>& polys, const vector<GLint>& remap,
+		const vector<GLint>& vert_norm, GLint offset, LodLevel& out) {
+	out.verts.clear();
+	out.norms.clear();
+	for (size_t i = 0; i < polys.size(); ++i) {
+		const Polygon *p = polys[i];
+		if(p->size != 3) {
+			continue;
+		}
+		GLint v[3], n[3];
+		for (int k = 0; k < 3; ++k) {
+			GLint orig = p->verts[k];
+			v[k] = remap[orig - offset] + offset;
+			n[k] = v[k] == orig ? p->norms[k] : vert_norm[v[k]];
+		}
+		if(v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) {
+			continue;
+		}
+		out.verts.insert(out.verts.end(), v, v + 3);
+		out.norms.insert(out.norms.end(), n, n + 3);
+	}
+}
+
+void DR::build_lod_chain(const vector<Polygon*>& polys, const vec3 *verts, size_t num_verts,
+		vector<LodLevel>& chain, GLfloat max_error, GLfloat ratio, size_t max_levels) {
+	chain.clear();
+	vector<GLint> tris, remap(num_verts), vert_norm;
+	tris.reserve(3 * polys.size());
+	for (size_t i = 0; i < polys.size(); ++i) {
+		if(polys[i]->size == 3) {
+			tris.insert(tris.end(), polys[i]->verts, polys[i]->verts + 3);
+		}
+	}
+	for (size_t i = 0; i < num_verts; ++i) {
+		remap[i] = i;
+	}
+	vertex_normals(polys, num_verts, vert_norm);
+	chain.push_back(LodLevel());
+	remap_triangles(polys, remap, vert_norm, 0, chain[0]);
+
+	QemSimplifier qem(verts, num_verts, tris);
+	size_t last = qem.num_triangles();
+	while(chain.size() < max_levels) {
+		size_t got = qem.simplify((size_t)(last * ratio), max_error);
+		// not worth another level
+		if(got * 10 > last * 9) {
+			break;
+		}
+		qem.get_remap(remap);
+		chain.push_back(LodLevel());
+		remap_triangles(polys, remap, vert_norm, 0, chain.back());
+		chain.back().error = qem.error();
+		last = got;
+	}
+}
+
+GLfloat DR::pixels_per_unit(const linalg::Mat4f& modelview, const linalg::Mat4f& projection,
+		GLint viewport_height, const vec3 p) {
+	linalg::Vec3f eye = modelview.transform_point(linalg::as_vec3(p));
+	GLfloat dist = -eye[2];
+	if(dist <= 1e-6f) {
+		return FLT_MAX;
+	}
+	// projection(1, 1) is cot(fovy / 2)
+	return projection(1, 1) * viewport_height / (2.0f * dist);
+}
+
+GLfloat DR::pixels_per_unit(const vec3 p) {
+	linalg::Mat4f modelview, projection;
+	GLint viewport[4];
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview.m);
+	glGetFloatv(GL_PROJECTION_MATRIX, projection.m);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	return pixels_per_unit(modelview, projection, viewport[3], p);
+}
+
+int DR::select_lod(const vector<LodLevel>& chain, GLfloat pixels_per_unit, GLfloat max_pixels) {
+	int level = 0;
+	for (size_t i = 1; i < chain.size(); ++i) {
+		if(chain[i].error * pixels_per_unit > max_pixels) {
+			break;
+		}
+		level = i;
+	}
+	return level;
+}
+
+// n x n grid of quads in the unit square, minus a square hole of
+// hole x hole quads in the middle, bumped up by bump * sin
+static void lod_grid(int n, int hole, GLfloat bump, vector<GLfloat>& verts, vector<GLint>& tris) {
+	verts.clear();
+	tris.clear();
+	for (int i = 0; i <= n; ++i) {
+		for (int j = 0; j <= n; ++j) {
+			GLfloat x = (GLfloat)j / n, y = (GLfloat)i / n;
+			verts.push_back(x);
+			verts.push_back(y);
+			verts.push_back(bump * sin(6 * x) * sin(5 * y));
+		}
+	}
+	int lo = (n - hole) / 2, hi = lo + hole;
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			if(i >= lo && i < hi && j >= lo && j < hi) {
+				continue;
+			}
+			GLint a = i * (n + 1) + j;
+			GLint quad[] = { a, a + 1, a + n + 2, a, a + n + 2, a + n + 1 };
+			tris.insert(tris.end(), quad, quad + 6);
+		}
+	}
+}
+
+void QemSimplifier::test() {
+	cout <<  "\n******************** QemSimplifier::test() **************************" << endl;
+	vector<GLfloat> verts;
+	vector<GLint> tris, remap;
+	// flat: everything but the corners of the outline and hole goes
+	lod_grid(16, 4, 0, verts, tris);
+	const vec3 *v = (const vec3*)&verts[0];
+	size_t num_verts = verts.size() / 3;
+	QemSimplifier flat(v, num_verts, tris);
+	size_t left = flat.simplify(0, 1e-4f);
+	flat.get_remap(remap);
+	double area = 0;
+	int down = 0;
+	for (size_t t = 0; t < flat.tris.size(); t += 3) {
+		if(!flat.tri_alive[t / 3]) {
+			continue;
+		}
+		const GLint *c = &flat.tris[t];
+		Vec3d n = linalg::cross(flat.pos[c[1]] - flat.pos[c[0]], flat.pos[c[2]] - flat.pos[c[0]]);
+		area += 0.5 * linalg::length(n);
+		down += n[2] <= 0 ? 1 : 0;
+		for (int k = 0; k < 3; ++k) {
+			if(remap[c[k]] != c[k]) {
+				++down;
+			}
+		}
+	}
+	// 8 corners, 2 loops, genus 0 annulus: 8 triangles
+	if(left != 8 || fabs(area - 0.9375) > 1e-6 || down || flat.error() > 1e-4f) {
+		cout << "!=: QEM flat grid: " << left << " triangles, area " << area
+				<< ", bad " << down << ", error " << flat.error() << endl;
+	}
+
+	// bumpy: error grows with each level, counts drop
+	lod_grid(32, 8, 0.05f, verts, tris);
+	v = (const vec3*)&verts[0];
+	num_verts = verts.size() / 3;
+	vector<Polygon*> polys;
+	for (size_t t = 0; t < tris.size(); t += 3) {
+		Triangle *p = new Triangle((vec3*)v, (vec3*)v);
+		for (int k = 0; k < 3; ++k) {
+			p->verts[k] = p->norms[k] = tris[t + k];
+		}
+		polys.push_back(p);
+	}
+	vector<LodLevel> chain;
+	build_lod_chain(polys, v, num_verts, chain, 1.0f);
+	bool ok = chain.size() >= 3 && chain[0].num_triangles() == polys.size();
+	for (size_t i = 1; ok && i < chain.size(); ++i) {
+		ok = chain[i].num_triangles() < chain[i-1].num_triangles() && chain[i].error >= chain[i-1].error
+				&& chain[i].norms.size() == chain[i].verts.size();
+	}
+	if(!ok) {
+		cout << "!=: QEM chain: " << chain.size() << " levels" << endl;
+	}
+	if(select_lod(chain, 1e6f) != 0 || select_lod(chain, 1e-6f) != (int)chain.size() - 1) {
+		cout << "!=: select_lod" << endl;
+	}
+	linalg::Mat4f proj = linalg::Mat4f::identity(), mv = linalg::Mat4f::translate(0, 0, -10);
+	proj(1, 1) = 2;
+	vec3 origin = { 0, 0, 0 };
+	// 2 * 600 / (2 * 10)
+	if(fabs(pixels_per_unit(mv, proj, 600, origin) - 60) > 1e-4f) {
+		cout << "!=: pixels_per_unit " << pixels_per_unit(mv, proj, 600, origin) << endl;
+	}
+	for (size_t i = 0; i < polys.size(); ++i) {
+		delete polys[i];
+	}
+	cout << "\n***************** Done:  QemSimplifier::test() ***********************" << endl;
+}
@@ -0,0 +1,293 @@
+/*
+ * mesh_buffer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "mesh_buffer.h"
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+size_t MeshBuffer::KeyHash::operator()(const Key& k) const {
+	size_t seed = 0;
+	for (int i = 0; i < FLOATS_PER_VERTEX; ++i) {
+		hash_combine(seed, std::hash<GLfloat>()(k.v[i]));
+	}
+	return seed;
+}
+
+MeshBuffer::MeshBuffer() : vbo(0), ibo(0), uploaded(false) {
+}
+
+MeshBuffer::~MeshBuffer() {
+	free_buffers();
+}
+
+void MeshBuffer::free_buffers() {
+	if(vbo) {
+		glDeleteBuffers(1, &vbo);
+		glDeleteBuffers(1, &ibo);
+	}
+	vbo = ibo = 0;
+	uploaded = false;
+}
+
+void MeshBuffer::clear() {
+	free_buffers();
+	data.clear();
+	indices.clear();
+	ranges.clear();
+	lookup.clear();
+}
+
+void MeshBuffer::begin_range() {
+	Range r;
+	r.first = indices.size();
+	r.count = 0;
+	ranges.push_back(r);
+}
+
+GLuint MeshBuffer::add_vertex(const GLfloat *pos, const GLfloat *norm) {
+	Key k;
+	copyv(k.v, pos);
+	copyv(k.v + 3, norm);
+	unordered_map<Key, GLuint, KeyHash>::iterator it = lookup.find(k);
+	if(it != lookup.end()) {
+		return it->second;
+	}
+	GLuint v = num_vertices();
+	data.insert(data.end(), k.v, k.v + FLOATS_PER_VERTEX);
+	lookup[k] = v;
+	return v;
+}
+
+void MeshBuffer::add_polygon(const vec3 *verts, const GLint *vi, int size,
+		const vec3 *norms, const GLint *ni, const GLfloat *normal) {
+	if(ranges.empty()) {
+		begin_range();
+	}
+	GLuint first = add_vertex(verts[vi[0]], ni ? norms[ni[0]] : normal);
+	GLuint prev = add_vertex(verts[vi[1]], ni ? norms[ni[1]] : normal);
+	for (int k = 2; k < size; ++k) {
+		GLuint v = add_vertex(verts[vi[k]], ni ? norms[ni[k]] : normal);
+		indices.push_back(first);
+		indices.push_back(prev);
+		indices.push_back(v);
+		prev = v;
+	}
+	ranges.back().count = indices.size() - ranges.back().first;
+}
+
+void MeshBuffer::optimize(size_t cache_size) {
+	if(indices.empty()) {
+		return;
+	}
+	size_t num_verts = num_vertices();
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		if(ranges[i].count) {
+			optimize_vertex_cache(&indices[ranges[i].first], ranges[i].count, num_verts, cache_size);
+		}
+	}
+	vector<GLint> remap;
+	size_t used = optimize_vertex_fetch(&indices[0], indices.size(), num_verts, remap);
+	vector<GLfloat> fetched(used * FLOATS_PER_VERTEX);
+	for (size_t v = 0; v < num_verts; ++v) {
+		if(remap[v] >= 0) {
+			copy(&data[v * FLOATS_PER_VERTEX], &data[(v + 1) * FLOATS_PER_VERTEX],
+					&fetched[remap[v] * FLOATS_PER_VERTEX]);
+		}
+	}
+	data.swap(fetched);
+	// vertex numbers changed
+	lookup.clear();
+	free_buffers();
+}
+
+VertexCacheStats MeshBuffer::cache_stats(size_t cache_size) const {
+	return analyze_vertex_cache(indices.empty() ? NULL : &indices[0], indices.size(), num_vertices(), cache_size);
+}
+
+void MeshBuffer::upload() {
+	uploaded = true;
+	if(!GLEW_VERSION_1_5 || indices.empty()) {
+		return;
+	}
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ibo);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat), &data[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffer::draw(const char *visible) {
+	if(indices.empty()) {
+		return;
+	}
+	if(!uploaded) {
+		upload();
+	}
+	// offsets into the buffer objects, or pointers into the arrays
+	const char *vertex_base = vbo ? NULL : (const char*)&data[0];
+	const char *index_base = ibo ? NULL : (const char*)&indices[0];
+	if(vbo) {
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	}
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	GLsizei stride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+	glVertexPointer(3, GL_FLOAT, stride, vertex_base);
+	glNormalPointer(GL_FLOAT, stride, vertex_base + 3 * sizeof(GLfloat));
+	// one call for each run of visible ranges
+	for (size_t i = 0; i < ranges.size(); ) {
+		if(visible && !visible[i]) {
+			++i;
+			continue;
+		}
+		GLuint first = ranges[i].first, count = 0;
+		for (; i < ranges.size() && (!visible || visible[i]); ++i) {
+			count += ranges[i].count;
+		}
+		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, index_base + first * sizeof(GLuint));
+	}
+	glPopClientAttrib();
+	if(vbo) {
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+}
+
+bool DR::upload_buffers(const vector<MeshBuffer*>& buffers, int& budget) {
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		if(buffers[i]->is_uploaded()) {
+			continue;
+		}
+		if(budget <= 0) {
+			return false;
+		}
+		buffers[i]->upload();
+		--budget;
+	}
+	return true;
+}
+
+// corners of each triangle by position, rotated to start at the least so
+// windings compare, sorted
+static void triangle_keys(const MeshBuffer& mb, size_t first, size_t count, vector<vector<int> >& out) {
+	out.clear();
+	const vector<GLfloat>& d = mb.get_data();
+	const vector<GLuint>& ix = mb.get_indices();
+	for (size_t i = first; i < first + count; i += 3) {
+		vector<int> key(3);
+		for (int k = 0; k < 3; ++k) {
+			const GLfloat *p = &d[ix[i + k] * MeshBuffer::FLOATS_PER_VERTEX];
+			key[k] = (int)lround(p[0]) * 1000 + (int)lround(p[2]);
+		}
+		rotate(key.begin(), min_element(key.begin(), key.end()), key.end());
+		out.push_back(key);
+	}
+	sort(out.begin(), out.end());
+}
+
+void MeshBuffer::test() {
+	cout <<  "\n******************** MeshBuffer::test() **************************" << endl;
+	GLuint twice[] = { 0, 1, 2, 0, 1, 2 };
+	VertexCacheStats s = analyze_vertex_cache(twice, 6, 3);
+	if(s.misses != 3 || s.acmr != 1.5f || s.atvr != 1) {
+		cout << "!=: analyze_vertex_cache " << s << endl;
+	}
+
+	// a grid of quads in y = 0, added in a scrambled order
+	const int n = 24;
+	vec3 verts[(n + 1) * (n + 1)];
+	for (int i = 0; i <= n; ++i) {
+		for (int j = 0; j <= n; ++j) {
+			setv(verts[i * (n + 1) + j], j, 0, i);
+		}
+	}
+	vec3 up = { 0, 1, 0 };
+	MeshBuffer mb;
+	unsigned int lcg = 12345;
+	vector<int> order;
+	for (int q = 0; q < n * n; ++q) {
+		order.push_back(q);
+	}
+	for (int q = n * n - 1; q > 0; --q) {
+		lcg = lcg * 1103515245 + 12345;
+		swap(order[q], order[(lcg >> 8) % (q + 1)]);
+	}
+	// a range for each half, like meshlets
+	for (int half = 0; half < 2; ++half) {
+		mb.begin_range();
+		for (int q = 0; q < n * n; ++q) {
+			int i = order[q] / n, j = order[q] % n;
+			if((i < n / 2) != (half == 0)) {
+				continue;
+			}
+			GLint v = i * (n + 1) + j;
+			GLint quad[] = { v, v + n + 1, v + n + 2, v + 1 };
+			mb.add_polygon(verts, quad, 4, NULL, NULL, up);
+		}
+	}
+	if(mb.num_vertices() != (size_t)(n + 1) * (n + 1) || mb.num_triangles() != (size_t)2 * n * n
+			|| mb.num_ranges() != 2) {
+		cout << "!=: grid " << mb.num_vertices() << " vertices, " << mb.num_triangles() << " triangles, "
+				<< mb.num_ranges() << " ranges" << endl;
+	}
+	vector<vector<int> > before[2], after[2];
+	for (int r = 0; r < 2; ++r) {
+		triangle_keys(mb, mb.ranges[r].first, mb.ranges[r].count, before[r]);
+	}
+	VertexCacheStats scrambled = mb.cache_stats();
+	mb.optimize();
+	VertexCacheStats optimized = mb.cache_stats();
+	if(scrambled.acmr < 1.5f || optimized.acmr > 0.8f || optimized.atvr > 1.6f) {
+		cout << "!=: grid before " << scrambled << ", after " << optimized << endl;
+	}
+	for (int r = 0; r < 2; ++r) {
+		triangle_keys(mb, mb.ranges[r].first, mb.ranges[r].count, after[r]);
+		if(before[r] != after[r]) {
+			cout << "!=: range " << r << " triangles changed" << endl;
+		}
+	}
+	// vertices in order of first use
+	GLuint next = 0;
+	for (size_t i = 0; i < mb.indices.size(); ++i) {
+		if(mb.indices[i] > next) {
+			cout << "!=: index " << i << " is " << mb.indices[i] << " before " << next << endl;
+			break;
+		}
+		next = max(next, mb.indices[i] + 1);
+	}
+	if(next != mb.num_vertices()) {
+		cout << "!=: " << next << " of " << mb.num_vertices() << " vertices used" << endl;
+	}
+	cout << "grid of " << mb.num_triangles() << " triangles, before " << scrambled << ", after " << optimized << endl;
+
+	// empty, so no GL, 2 a frame for 3 buffers
+	MeshBuffer empty[3];
+	vector<MeshBuffer*> pending;
+	for (int i = 0; i < 3; ++i) {
+		pending.push_back(&empty[i]);
+	}
+	int budget = 2;
+	bool done = upload_buffers(pending, budget);
+	if(done || budget != 0 || !empty[1].is_uploaded() || empty[2].is_uploaded()) {
+		cout << "!=: upload_buffers first frame, budget left " << budget << endl;
+	}
+	budget = 2;
+	done = upload_buffers(pending, budget);
+	if(!done || budget != 1 || !empty[2].is_uploaded()) {
+		cout << "!=: upload_buffers second frame, budget left " << budget << endl;
+	}
+	cout << "\n***************** Done:  MeshBuffer::test() ***********************" << endl;
+}
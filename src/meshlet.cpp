@@ -0,0 +1,299 @@
+/*
+ * meshlet.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "meshlet.h"
+
+#include <cmath>
+#include <cfloat>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+using linalg::Vec3f;
+
+void MeshletSet::clear() {
+	meshlets.clear();
+	vertices.clear();
+	triangles.clear();
+	prims.clear();
+}
+
+// Moller Trumbore, either side, dist along dir
+static bool ray_triangle(const Vec3f& origin, const Vec3f& dir,
+		const Vec3f& a, const Vec3f& b, const Vec3f& c, GLfloat& dist) {
+	Vec3f e1 = b - a, e2 = c - a;
+	Vec3f p = linalg::cross(dir, e2);
+	GLfloat det = linalg::dot(e1, p);
+	if(fabs(det) < 1e-12f) {
+		return false;
+	}
+	GLfloat inv = 1.0f / det;
+	Vec3f s = origin - a;
+	GLfloat u = linalg::dot(s, p) * inv;
+	if(u < 0 || u > 1) {
+		return false;
+	}
+	Vec3f q = linalg::cross(s, e1);
+	GLfloat v = linalg::dot(dir, q) * inv;
+	if(v < 0 || u + v > 1) {
+		return false;
+	}
+	dist = linalg::dot(e2, q) * inv;
+	return dist >= 0;
+}
+
+GLint MeshletSet::ray_intersect(const vec3 *verts, const Vec3f& origin, const Vec3f& dir,
+		GLfloat& dist) const {
+	GLint hit = -1;
+	dist = FLT_MAX;
+	GLfloat dir2 = linalg::length2(dir);
+	if(dir2 == 0) {
+		return hit;
+	}
+	for (size_t i = 0; i < meshlets.size(); ++i) {
+		const Meshlet& m = meshlets[i];
+		// closest approach to the sphere's center, and whether it is behind or past the best
+		Vec3f oc = m.bounds.center - origin;
+		GLfloat along = linalg::dot(oc, dir) / dir2;
+		GLfloat r2 = m.bounds.radius * m.bounds.radius;
+		if(linalg::length2(oc - dir * along) > r2) {
+			continue;
+		}
+		GLfloat reach = m.bounds.radius / sqrt(dir2);
+		if(along + reach < 0 || along - reach > dist) {
+			continue;
+		}
+		for (GLuint t = 0; t < m.triangle_count; ++t) {
+			GLfloat d;
+			if(ray_triangle(origin, dir, linalg::as_vec3(verts[vertex(m, t, 0)]),
+					linalg::as_vec3(verts[vertex(m, t, 1)]), linalg::as_vec3(verts[vertex(m, t, 2)]), d)
+					&& d < dist) {
+				dist = d;
+				hit = m.triangle_offset + t;
+			}
+		}
+	}
+	return hit;
+}
+
+/**
+ * tri_verts: 3 per triangle, prims and norms: 1 per triangle.
+ */
+static void build(const vector<GLint>& tri_verts, const vector<GLint>& prims, const vector<Vec3f>& norms,
+		const vec3 *verts, size_t max_vertices, size_t max_triangles, MeshletSet& out) {
+	assert(max_vertices >= 3 && max_vertices <= 256 && max_triangles >= 1);
+	out.clear();
+	size_t num_tris = prims.size();
+	GLint num_verts = 0;
+	for (size_t i = 0; i < tri_verts.size(); ++i) {
+		num_verts = max(num_verts, tri_verts[i] + 1);
+	}
+	vector<vector<GLint> > vert_tris(num_verts);
+	for (size_t t = 0; t < num_tris; ++t) {
+		for (int k = 0; k < 3; ++k) {
+			vert_tris[tri_verts[3 * t + k]].push_back(t);
+		}
+	}
+	vector<bool> used(num_tris, false);
+	// index in the current meshlet, -1 if not in it
+	vector<GLint> local(num_verts, -1);
+	vector<GLint> candidates;
+	vector<Vec3f> normals;
+	size_t seed = 0;
+	while(true) {
+		while(seed < num_tris && used[seed]) {
+			++seed;
+		}
+		if(seed == num_tris) {
+			break;
+		}
+		Meshlet m;
+		m.vertex_offset = out.vertices.size();
+		m.vertex_count = 0;
+		m.triangle_offset = out.prims.size();
+		m.triangle_count = 0;
+		candidates.clear();
+		normals.clear();
+		GLint t = seed;
+		while(t >= 0) {
+			used[t] = true;
+			for (int k = 0; k < 3; ++k) {
+				GLint v = tri_verts[3 * t + k];
+				if(local[v] < 0) {
+					local[v] = m.vertex_count++;
+					out.vertices.push_back(v);
+					candidates.insert(candidates.end(), vert_tris[v].begin(), vert_tris[v].end());
+				}
+				out.triangles.push_back(local[v]);
+			}
+			out.prims.push_back(prims[t]);
+			normals.push_back(norms[t]);
+			if(++m.triangle_count == max_triangles) {
+				break;
+			}
+			// the neighbor bringing the fewest new vertices, that still fits
+			t = -1;
+			int best = 4;
+			size_t kept = 0;
+			for (size_t i = 0; i < candidates.size(); ++i) {
+				GLint c = candidates[i];
+				if(used[c]) {
+					continue;
+				}
+				candidates[kept++] = c;
+				int fresh = 0;
+				for (int k = 0; k < 3; ++k) {
+					fresh += local[tri_verts[3 * c + k]] < 0 ? 1 : 0;
+				}
+				if(fresh < best && m.vertex_count + fresh <= max_vertices) {
+					best = fresh;
+					t = c;
+				}
+			}
+			candidates.resize(kept);
+		}
+		const GLint *mv = &out.vertices[m.vertex_offset];
+		for (GLuint i = 0; i < m.vertex_count; ++i) {
+			local[mv[i]] = -1;
+		}
+		Aabb box;
+		bounds_of(verts, mv, m.vertex_count, box, m.bounds);
+		m.cone = normal_cone(normals);
+		out.meshlets.push_back(m);
+	}
+}
+
+// a quad is split (0, 1, 2), (0, 2, 3)
+static void add_prim(const GLint *p, int size, GLint prim, const Vec3f& norm,
+		vector<GLint>& tri_verts, vector<GLint>& prims, vector<Vec3f>& norms) {
+	assert(size == 3 || size == 4);
+	for (int half = 0; half < size - 2; ++half) {
+		tri_verts.push_back(p[0]);
+		tri_verts.push_back(p[half + 1]);
+		tri_verts.push_back(p[half + 2]);
+		prims.push_back(prim * 2 + half);
+		norms.push_back(norm);
+	}
+}
+
+void DR::build_meshlets(const vector<Polygon*>& polys, const vec3 *verts, GLfloat outward,
+		MeshletSet& out, size_t max_vertices, size_t max_triangles) {
+	vector<GLint> tri_verts, prims;
+	vector<Vec3f> norms;
+	for (size_t i = 0; i < polys.size(); ++i) {
+		add_prim(polys[i]->verts, polys[i]->size, i, linalg::as_vec3(polys[i]->facetnorm) * outward,
+				tri_verts, prims, norms);
+	}
+	build(tri_verts, prims, norms, verts, max_vertices, max_triangles, out);
+}
+
+void DR::build_meshlets(const vector<GLint>& indices, int prim_size, const vec3 *verts,
+		GLfloat outward, MeshletSet& out, size_t max_vertices, size_t max_triangles) {
+	vector<GLint> tri_verts, prims;
+	vector<Vec3f> norms;
+	size_t num_prims = indices.size() / prim_size;
+	for (size_t i = 0; i < num_prims; ++i) {
+		const GLint *p = &indices[i * prim_size];
+		const Vec3f& a = linalg::as_vec3(verts[p[0]]);
+		// diagonals for a quad
+		Vec3f n = prim_size == 4 ?
+				linalg::cross(linalg::as_vec3(verts[p[2]]) - a, linalg::as_vec3(verts[p[3]]) - linalg::as_vec3(verts[p[1]])) :
+				linalg::cross(linalg::as_vec3(verts[p[1]]) - a, linalg::as_vec3(verts[p[2]]) - a);
+		GLfloat len = linalg::length(n);
+		add_prim(p, prim_size, i, len > 0 ? n * (outward / len) : n, tri_verts, prims, norms);
+	}
+	build(tri_verts, prims, norms, verts, max_vertices, max_triangles, out);
+}
+
+// an n by n grid of quads in y = 0, wound down
+static void grid(int n, vec3 *verts, vector<GLint>& quads) {
+	for (int i = 0; i <= n; ++i) {
+		for (int j = 0; j <= n; ++j) {
+			GLfloat *v = verts[i * (n + 1) + j];
+			v[0] = j;
+			v[1] = 0;
+			v[2] = i;
+		}
+	}
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			GLint v = i * (n + 1) + j;
+			GLint q[] = { v, v + 1, v + n + 2, v + n + 1 };
+			quads.insert(quads.end(), q, q + 4);
+		}
+	}
+}
+
+// limits, every half quad once, corners and bounds right
+static void check(const MeshletSet& set, const vector<GLint>& quads, const vec3 *verts,
+		size_t max_vertices, size_t max_triangles) {
+	vector<int> seen(quads.size() / 2, 0);
+	for (size_t i = 0; i < set.size(); ++i) {
+		const Meshlet& m = set.meshlets[i];
+		if(m.vertex_count > max_vertices || m.triangle_count > max_triangles || m.triangle_count == 0) {
+			cout << "!=: meshlet " << i << " has " << m.vertex_count << " vertices, "
+					<< m.triangle_count << " triangles" << endl;
+		}
+		for (GLuint t = 0; t < m.triangle_count; ++t) {
+			GLint prim = set.prims[m.triangle_offset + t];
+			++seen[prim];
+			const GLint *q = &quads[(prim >> 1) * 4];
+			GLint want[] = { q[0], q[(prim & 1) + 1], q[(prim & 1) + 2] };
+			for (int k = 0; k < 3; ++k) {
+				GLint v = set.vertex(m, t, k);
+				if(set.triangles[3 * (m.triangle_offset + t) + k] >= m.vertex_count || v != want[k]) {
+					cout << "!=: meshlet " << i << " triangle " << t << " corner " << k << endl;
+				}
+				if(linalg::distance(linalg::as_vec3(verts[v]), m.bounds.center) > m.bounds.radius + 1e-4f) {
+					cout << "!=: meshlet " << i << " bounds miss vertex " << v << endl;
+				}
+			}
+		}
+	}
+	for (size_t i = 0; i < seen.size(); ++i) {
+		if(seen[i] != 1) {
+			cout << "!=: half quad " << i << " in " << seen[i] << " meshlets" << endl;
+		}
+	}
+}
+
+void MeshletSet::test() {
+	cout <<  "\n******************** MeshletSet::test() **************************" << endl;
+	const int n = 20;
+	vec3 verts[(n + 1) * (n + 1)];
+	vector<GLint> quads;
+	grid(n, verts, quads);
+	MeshletSet set;
+	build_meshlets(quads, 4, verts, -1, set);
+	check(set, quads, verts, MAX_VERTICES, MAX_TRIANGLES);
+	// 800 triangles, about 2 per vertex so vertices fill up first
+	if(set.size() < 800 / MAX_TRIANGLES + 1 || set.size() > 800 / 40) {
+		cout << "!=: " << set.size() << " meshlets for 800 triangles" << endl;
+	}
+	for (size_t i = 0; i < set.size(); ++i) {
+		const NormalCone& c = set.meshlets[i].cone;
+		if(c.cutoff > 1e-3f || c.axis[1] < 0.999f) {
+			cout << "!=: meshlet " << i << " cone " << c.axis[1] << " " << c.cutoff << endl;
+		}
+	}
+	MeshletSet small;
+	build_meshlets(quads, 4, verts, 1, small, 8, 6);
+	check(small, quads, verts, 8, 6);
+
+	// straight down onto quad (5, 7), just off its diagonal
+	GLfloat dist;
+	GLint hit = set.ray_intersect(verts, Vec3f(7.7f, 3, 5.2f), Vec3f(0, -2, 0), dist);
+	if(hit < 0 || set.prims[hit] != (5 * n + 7) * 2 || fabs(dist - 1.5f) > 1e-5f) {
+		cout << "!=: ray_intersect " << hit << " " << (hit < 0 ? -1 : set.prims[hit]) << " " << dist << endl;
+	}
+	if(set.ray_intersect(verts, Vec3f(7.7f, 3, 5.2f), Vec3f(0, 1, 0), dist) >= 0
+			|| set.ray_intersect(verts, Vec3f(-1, 3, 5), Vec3f(0, -1, 0), dist) >= 0) {
+		cout << "!=: ray_intersect should miss" << endl;
+	}
+	cout << "\n***************** Done:  MeshletSet::test() ***********************" << endl;
+}
@@ -0,0 +1,170 @@
+/*
+ * noise_cache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "noise_cache.h"
+#include "noise_engine.h"
+#include "dr_util.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace DR;
+
+// bump when NoiseEngine output changes, so old files get rebuilt
+static const unsigned GENERATOR_VERSION = 1;
+static const char MAGIC[4] = { 'D', 'R', 'N', 'V' };
+
+// file layout: header then texels
+struct VolumeHeader {
+	char magic[4];
+	unsigned version;
+	int size;
+	int octaves;
+	int start_frequency;
+	unsigned seed;
+	unsigned long long num_bytes;
+	// pads header to 64 bytes so texels start aligned
+	char pad[32];
+};
+
+bool NoiseVolumeCache::open(const string& path, const NoiseVolumeParams& params) {
+	close();
+	regenerated = false;
+	if(map(path, params)) {
+		return true;
+	}
+	regenerated = true;
+	if(!write(path, params)) {
+		cerr << "NoiseVolumeCache: couldn't write " << path << endl;
+		return false;
+	}
+	return map(path, params);
+}
+
+bool NoiseVolumeCache::map(const string& path, const NoiseVolumeParams& params) {
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		return false;
+	}
+	struct stat st;
+	size_t expected = sizeof(VolumeHeader) + params.num_bytes();
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size != expected) {
+		::close(fd);
+		return false;
+	}
+	void *base = mmap(NULL, expected, PROT_READ, MAP_PRIVATE, fd, 0);
+	// mapping stays valid after the descriptor is closed
+	::close(fd);
+	if(base == MAP_FAILED) {
+		return false;
+	}
+	const VolumeHeader *h = (const VolumeHeader*)base;
+	NoiseVolumeParams file_params(h->size, h->octaves, h->start_frequency, h->seed);
+	if(memcmp(h->magic, MAGIC, 4) != 0 || h->version != GENERATOR_VERSION ||
+			!(file_params == params) || h->num_bytes != params.num_bytes()) {
+		munmap(base, expected);
+		return false;
+	}
+	map_base = base;
+	map_len = expected;
+	this->params = params;
+	return true;
+}
+
+bool NoiseVolumeCache::write(const string& path, const NoiseVolumeParams& params) {
+	VolumeHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, MAGIC, 4);
+	h.version = GENERATOR_VERSION;
+	h.size = params.size;
+	h.octaves = params.octaves;
+	h.start_frequency = params.start_frequency;
+	h.seed = params.seed;
+	h.num_bytes = params.num_bytes();
+
+	vector<GLubyte> texels(params.num_bytes(), 0);
+	Stopwatch sw;
+	NoiseEngine(params.seed).bake_texture(&texels[0], params.size,
+			params.start_frequency, params.octaves);
+	cout << "NoiseVolumeCache: baked " << params.size << "^3 volume in "
+			<< sw.elapsed_ms() << " ms" << endl;
+
+	// write to a temp file and rename, so a reader never sees half a file
+	string tmp = path + ".tmp";
+	FILE *f = fopen(tmp.c_str(), "wb");
+	if(!f) {
+		return false;
+	}
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+			fwrite(&texels[0], 1, texels.size(), f) == texels.size();
+	ok = (fclose(f) == 0) && ok;
+	if(!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+		remove(tmp.c_str());
+		return false;
+	}
+	return true;
+}
+
+void NoiseVolumeCache::close() {
+	if(map_base) {
+		munmap(map_base, map_len);
+	}
+	map_base = NULL;
+	map_len = 0;
+}
+
+const GLubyte* NoiseVolumeCache::texels() const {
+	if(!map_base) {
+		return NULL;
+	}
+	return (const GLubyte*)map_base + sizeof(VolumeHeader);
+}
+
+void NoiseVolumeCache::test() {
+	cout <<  "\n******************** NoiseVolumeCache::test() **************************" << endl;
+	const char *path = "/tmp/show_mantra_noise_cache_test.vol";
+	remove(path);
+	NoiseVolumeParams params(16, 4, 4, 99);
+	NoiseVolumeCache cache;
+	if(!cache.open(path, params) || !cache.regenerated) {
+		cout << "!=: first open should bake" << endl;
+	}
+	vector<GLubyte> baked(params.num_bytes());
+	NoiseEngine(params.seed).bake_texture(&baked[0], params.size, params.start_frequency,
+			params.octaves, 1);
+	if(!cache.is_open() || memcmp(cache.texels(), &baked[0], baked.size()) != 0) {
+		cout << "!=: mapped texels differ from bake" << endl;
+	}
+	cache.close();
+
+	NoiseVolumeCache again;
+	if(!again.open(path, params) || again.regenerated) {
+		cout << "!=: second open should map without baking" << endl;
+	}
+	again.close();
+
+	NoiseVolumeParams other(16, 3, 4, 99);
+	if(!again.open(path, other) || !again.regenerated) {
+		cout << "!=: changed params should rebake" << endl;
+	}
+	again.close();
+
+	// truncated file gets rebuilt
+	if(truncate(path, 100) != 0 || !again.open(path, other) || !again.regenerated) {
+		cout << "!=: truncated file should rebake" << endl;
+	}
+	again.close();
+	remove(path);
+	cout << "\n***************** Done:  NoiseVolumeCache::test() ***********************" << endl;
+}
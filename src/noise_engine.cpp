@@ -0,0 +1,595 @@
+/*
+ * noise_engine.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "noise_engine.h"
+#include "Noise.h"
+#include "dr_util.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+using namespace DR;
+
+//***** scalar kernels
+// the batch kernels below do the same float operations in the same order,
+// so both paths give identical results
+
+static const float F3 = 1.0f / 3.0f;
+static const float G3 = 1.0f / 6.0f;
+
+// lattice hash: seed ^ per axis products, then a multiply/xorshift finalizer
+static const unsigned HX = 0x8da6b343u, HY = 0xd8163841u, HZ = 0xcb1ab31fu;
+
+static inline unsigned finalize(unsigned h) {
+	h ^= h >> 16;
+	h *= 0x7feb352du;
+	h ^= h >> 15;
+	h *= 0x846ca68bu;
+	h ^= h >> 16;
+	return h;
+}
+
+static inline unsigned hash3(unsigned seed, int ix, int iy, int iz) {
+	return finalize(seed ^ ((unsigned)ix * HX) ^ ((unsigned)iy * HY) ^ ((unsigned)iz * HZ));
+}
+
+// Perlin's 12 cube edge gradients, padded to 16
+static const float GRADS[16][3] = {
+		{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+		{ 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+		{ 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 },
+		{ 1, 1, 0 }, { 0, -1, 1 }, { -1, 1, 0 }, { 0, -1, -1 }
+};
+
+// gradient h dotted with (x, y, z)
+// the batch version picks the same gradients with masks instead of a lookup
+static inline float grad(unsigned h, float x, float y, float z) {
+	const float *g = GRADS[h & 15];
+	return g[0] * x + g[1] * y + g[2] * z;
+}
+
+static inline float floorf_(float x) {
+	float t = (float)(int)x;
+	return t > x ? t - 1.0f : t;
+}
+
+static inline float fade(float t) {
+	return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float lerpf(float t, float a, float b) {
+	return a + t * (b - a);
+}
+
+static inline int wrap(int i, int period) {
+	int r = i % period;
+	return r < 0 ? r + period : r;
+}
+
+float NoiseEngine::perlin(float x, float y, float z) const {
+	float fx = floorf_(x), fy = floorf_(y), fz = floorf_(z);
+	int ix0 = (int)fx, iy0 = (int)fy, iz0 = (int)fz;
+	int ix1 = ix0 + 1, iy1 = iy0 + 1, iz1 = iz0 + 1;
+	if(period > 0) {
+		ix0 = wrap(ix0, period); ix1 = wrap(ix1, period);
+		iy0 = wrap(iy0, period); iy1 = wrap(iy1, period);
+		iz0 = wrap(iz0, period); iz1 = wrap(iz1, period);
+	}
+	unsigned hx0 = seed ^ ((unsigned)ix0 * HX), hx1 = seed ^ ((unsigned)ix1 * HX);
+	unsigned hy0 = (unsigned)iy0 * HY, hy1 = (unsigned)iy1 * HY;
+	unsigned hz0 = (unsigned)iz0 * HZ, hz1 = (unsigned)iz1 * HZ;
+	float x0 = x - fx, y0 = y - fy, z0 = z - fz;
+	float x1 = x0 - 1.0f, y1 = y0 - 1.0f, z1 = z0 - 1.0f;
+	float u = fade(x0), v = fade(y0), w = fade(z0);
+
+	float a = lerpf(u, grad(finalize(hx0 ^ hy0 ^ hz0), x0, y0, z0),
+			grad(finalize(hx1 ^ hy0 ^ hz0), x1, y0, z0));
+	float b = lerpf(u, grad(finalize(hx0 ^ hy1 ^ hz0), x0, y1, z0),
+			grad(finalize(hx1 ^ hy1 ^ hz0), x1, y1, z0));
+	float c = lerpf(v, a, b);
+	a = lerpf(u, grad(finalize(hx0 ^ hy0 ^ hz1), x0, y0, z1),
+			grad(finalize(hx1 ^ hy0 ^ hz1), x1, y0, z1));
+	b = lerpf(u, grad(finalize(hx0 ^ hy1 ^ hz1), x0, y1, z1),
+			grad(finalize(hx1 ^ hy1 ^ hz1), x1, y1, z1));
+	float d = lerpf(v, a, b);
+	return lerpf(w, c, d);
+}
+
+// contribution of one simplex corner at offset (x, y, z)
+static inline float corner(unsigned h, float x, float y, float z) {
+	float t = 0.6f - (x * x + y * y + z * z);
+	t = t > 0.0f ? t : 0.0f;
+	t = t * t;
+	return t * t * grad(h, x, y, z);
+}
+
+float NoiseEngine::simplex(float x, float y, float z) const {
+	float s = (x + y + z) * F3;
+	float fi = floorf_(x + s), fj = floorf_(y + s), fk = floorf_(z + s);
+	float t = (fi + fj + fk) * G3;
+	float x0 = x - (fi - t), y0 = y - (fj - t), z0 = z - (fk - t);
+	int i = (int)fi, j = (int)fj, k = (int)fk;
+
+	// which simplex we are in
+	bool gx = x0 >= y0, gy = y0 >= z0, gz = z0 >= x0;
+	int i1 = gx && !gz, j1 = gy && !gx, k1 = gz && !gy;
+	int i2 = gx || !gz, j2 = gy || !gx, k2 = gz || !gy;
+
+	float x1 = x0 - (float)i1 + G3, y1 = y0 - (float)j1 + G3, z1 = z0 - (float)k1 + G3;
+	float x2 = x0 - (float)i2 + 2.0f * G3, y2 = y0 - (float)j2 + 2.0f * G3,
+			z2 = z0 - (float)k2 + 2.0f * G3;
+	float x3 = x0 - 1.0f + 3.0f * G3, y3 = y0 - 1.0f + 3.0f * G3, z3 = z0 - 1.0f + 3.0f * G3;
+
+	float n = corner(hash3(seed, i, j, k), x0, y0, z0);
+	n += corner(hash3(seed, i + i1, j + j1, k + k1), x1, y1, z1);
+	n += corner(hash3(seed, i + i2, j + j2, k + k2), x2, y2, z2);
+	n += corner(hash3(seed, i + 1, j + 1, k + 1), x3, y3, z3);
+	return 32.0f * n;
+}
+
+//***** batch kernels
+
+#if defined(__SSE2__)
+
+typedef __m128 f4;
+typedef __m128i i4;
+
+static inline i4 mullo(i4 a, i4 b) {
+	// no _mm_mullo_epi32 before sse4.1
+	i4 even = _mm_mul_epu32(a, b);
+	i4 odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+			_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static inline f4 floor4(f4 x) {
+	f4 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+static inline i4 finalize4(i4 h) {
+	h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+	h = mullo(h, _mm_set1_epi32(0x7feb352d));
+	h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+	h = mullo(h, _mm_set1_epi32((int)0x846ca68bu));
+	h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+	return h;
+}
+
+static inline i4 axis4(i4 i, unsigned mult) {
+	return mullo(i, _mm_set1_epi32((int)mult));
+}
+
+static inline i4 hash4(i4 seed, i4 ix, i4 iy, i4 iz) {
+	return finalize4(_mm_xor_si128(_mm_xor_si128(seed, axis4(ix, HX)),
+			_mm_xor_si128(axis4(iy, HY), axis4(iz, HZ))));
+}
+
+static inline i4 xor3(i4 a, i4 b, i4 c) {
+	return _mm_xor_si128(_mm_xor_si128(a, b), c);
+}
+
+static inline f4 select4(f4 mask, f4 a, f4 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// same gradients as GRADS: u is x or y, v is y, x or z, each possibly negated
+static inline f4 grad4(i4 h, f4 x, f4 y, f4 z) {
+	h = _mm_and_si128(h, _mm_set1_epi32(15));
+	f4 lt8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+	f4 lt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+	f4 is14 = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_or_si128(h, _mm_set1_epi32(2)),
+			_mm_set1_epi32(14)));
+	f4 u = select4(lt8, x, y);
+	f4 v = select4(lt4, y, select4(is14, x, z));
+	f4 su = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+	f4 sv = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+	return _mm_add_ps(_mm_xor_ps(u, su), _mm_xor_ps(v, sv));
+}
+
+static inline f4 fade4(f4 t) {
+	f4 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+	f4 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)),
+			_mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+	return _mm_mul_ps(t3, inner);
+}
+
+static inline f4 lerp4(f4 t, f4 a, f4 b) {
+	return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+// i mod period for |i| well under 2^20
+static inline i4 wrap4(i4 i, f4 period) {
+	f4 fi = _mm_cvtepi32_ps(i);
+	f4 q = floor4(_mm_div_ps(fi, period));
+	return _mm_cvttps_epi32(_mm_sub_ps(fi, _mm_mul_ps(q, period)));
+}
+
+static void perlin4(unsigned seed_u, int period, const float *x, const float *y,
+		const float *z, float *out) {
+	i4 seed = _mm_set1_epi32((int)seed_u);
+	i4 one = _mm_set1_epi32(1);
+	f4 onef = _mm_set1_ps(1.0f);
+	f4 px = _mm_loadu_ps(x), py = _mm_loadu_ps(y), pz = _mm_loadu_ps(z);
+	f4 fx = floor4(px), fy = floor4(py), fz = floor4(pz);
+	i4 ix0 = _mm_cvttps_epi32(fx), iy0 = _mm_cvttps_epi32(fy), iz0 = _mm_cvttps_epi32(fz);
+	i4 ix1 = _mm_add_epi32(ix0, one), iy1 = _mm_add_epi32(iy0, one),
+			iz1 = _mm_add_epi32(iz0, one);
+	if(period > 0) {
+		f4 p = _mm_set1_ps((float)period);
+		ix0 = wrap4(ix0, p); ix1 = wrap4(ix1, p);
+		iy0 = wrap4(iy0, p); iy1 = wrap4(iy1, p);
+		iz0 = wrap4(iz0, p); iz1 = wrap4(iz1, p);
+	}
+	f4 x0 = _mm_sub_ps(px, fx), y0 = _mm_sub_ps(py, fy), z0 = _mm_sub_ps(pz, fz);
+	f4 x1 = _mm_sub_ps(x0, onef), y1 = _mm_sub_ps(y0, onef), z1 = _mm_sub_ps(z0, onef);
+	f4 u = fade4(x0), v = fade4(y0), w = fade4(z0);
+
+	i4 hx0 = _mm_xor_si128(seed, axis4(ix0, HX)), hx1 = _mm_xor_si128(seed, axis4(ix1, HX));
+	i4 hy0 = axis4(iy0, HY), hy1 = axis4(iy1, HY);
+	i4 hz0 = axis4(iz0, HZ), hz1 = axis4(iz1, HZ);
+
+	f4 a = lerp4(u, grad4(finalize4(xor3(hx0, hy0, hz0)), x0, y0, z0),
+			grad4(finalize4(xor3(hx1, hy0, hz0)), x1, y0, z0));
+	f4 b = lerp4(u, grad4(finalize4(xor3(hx0, hy1, hz0)), x0, y1, z0),
+			grad4(finalize4(xor3(hx1, hy1, hz0)), x1, y1, z0));
+	f4 c = lerp4(v, a, b);
+	a = lerp4(u, grad4(finalize4(xor3(hx0, hy0, hz1)), x0, y0, z1),
+			grad4(finalize4(xor3(hx1, hy0, hz1)), x1, y0, z1));
+	b = lerp4(u, grad4(finalize4(xor3(hx0, hy1, hz1)), x0, y1, z1),
+			grad4(finalize4(xor3(hx1, hy1, hz1)), x1, y1, z1));
+	f4 d = lerp4(v, a, b);
+	_mm_storeu_ps(out, lerp4(w, c, d));
+}
+
+static inline f4 corner4(i4 h, f4 x, f4 y, f4 z) {
+	f4 t = _mm_sub_ps(_mm_set1_ps(0.6f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x),
+			_mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+	t = _mm_max_ps(t, _mm_setzero_ps());
+	t = _mm_mul_ps(t, t);
+	return _mm_mul_ps(_mm_mul_ps(t, t), grad4(h, x, y, z));
+}
+
+static void simplex4(unsigned seed_u, const float *x, const float *y,
+		const float *z, float *out) {
+	i4 seed = _mm_set1_epi32((int)seed_u);
+	f4 onef = _mm_set1_ps(1.0f);
+	f4 g3 = _mm_set1_ps(G3), g3_2 = _mm_set1_ps(2.0f * G3), g3_3 = _mm_set1_ps(3.0f * G3);
+	f4 px = _mm_loadu_ps(x), py = _mm_loadu_ps(y), pz = _mm_loadu_ps(z);
+	f4 s = _mm_mul_ps(_mm_add_ps(_mm_add_ps(px, py), pz), _mm_set1_ps(F3));
+	f4 fi = floor4(_mm_add_ps(px, s)), fj = floor4(_mm_add_ps(py, s)),
+			fk = floor4(_mm_add_ps(pz, s));
+	f4 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(fi, fj), fk), g3);
+	f4 x0 = _mm_sub_ps(px, _mm_sub_ps(fi, t)), y0 = _mm_sub_ps(py, _mm_sub_ps(fj, t)),
+			z0 = _mm_sub_ps(pz, _mm_sub_ps(fk, t));
+	i4 i = _mm_cvttps_epi32(fi), j = _mm_cvttps_epi32(fj), k = _mm_cvttps_epi32(fk);
+
+	f4 gx = _mm_cmpge_ps(x0, y0), gy = _mm_cmpge_ps(y0, z0), gz = _mm_cmpge_ps(z0, x0);
+	f4 i1 = _mm_and_ps(_mm_andnot_ps(gz, gx), onef);
+	f4 j1 = _mm_and_ps(_mm_andnot_ps(gx, gy), onef);
+	f4 k1 = _mm_and_ps(_mm_andnot_ps(gy, gz), onef);
+	f4 all = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	f4 i2 = _mm_and_ps(_mm_or_ps(gx, _mm_xor_ps(gz, all)), onef);
+	f4 j2 = _mm_and_ps(_mm_or_ps(gy, _mm_xor_ps(gx, all)), onef);
+	f4 k2 = _mm_and_ps(_mm_or_ps(gz, _mm_xor_ps(gy, all)), onef);
+
+	f4 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g3), y1 = _mm_add_ps(_mm_sub_ps(y0, j1), g3),
+			z1 = _mm_add_ps(_mm_sub_ps(z0, k1), g3);
+	f4 x2 = _mm_add_ps(_mm_sub_ps(x0, i2), g3_2), y2 = _mm_add_ps(_mm_sub_ps(y0, j2), g3_2),
+			z2 = _mm_add_ps(_mm_sub_ps(z0, k2), g3_2);
+	f4 x3 = _mm_add_ps(_mm_sub_ps(x0, onef), g3_3), y3 = _mm_add_ps(_mm_sub_ps(y0, onef), g3_3),
+			z3 = _mm_add_ps(_mm_sub_ps(z0, onef), g3_3);
+
+	i4 one = _mm_set1_epi32(1);
+	f4 n = corner4(hash4(seed, i, j, k), x0, y0, z0);
+	n = _mm_add_ps(n, corner4(hash4(seed, _mm_add_epi32(i, _mm_cvttps_epi32(i1)),
+			_mm_add_epi32(j, _mm_cvttps_epi32(j1)), _mm_add_epi32(k, _mm_cvttps_epi32(k1))),
+			x1, y1, z1));
+	n = _mm_add_ps(n, corner4(hash4(seed, _mm_add_epi32(i, _mm_cvttps_epi32(i2)),
+			_mm_add_epi32(j, _mm_cvttps_epi32(j2)), _mm_add_epi32(k, _mm_cvttps_epi32(k2))),
+			x2, y2, z2));
+	n = _mm_add_ps(n, corner4(hash4(seed, _mm_add_epi32(i, one), _mm_add_epi32(j, one),
+			_mm_add_epi32(k, one)), x3, y3, z3));
+	_mm_storeu_ps(out, _mm_mul_ps(_mm_set1_ps(32.0f), n));
+}
+
+void NoiseEngine::perlin8(const float *x, const float *y, const float *z, float *out) const {
+	perlin4(seed, period, x, y, z, out);
+	perlin4(seed, period, x + 4, y + 4, z + 4, out + 4);
+}
+
+void NoiseEngine::simplex8(const float *x, const float *y, const float *z, float *out) const {
+	simplex4(seed, x, y, z, out);
+	simplex4(seed, x + 4, y + 4, z + 4, out + 4);
+}
+
+#else // no sse2, batches are just loops
+
+void NoiseEngine::perlin8(const float *x, const float *y, const float *z, float *out) const {
+	for (int i = 0; i < BATCH; ++i) {
+		out[i] = perlin(x[i], y[i], z[i]);
+	}
+}
+
+void NoiseEngine::simplex8(const float *x, const float *y, const float *z, float *out) const {
+	for (int i = 0; i < BATCH; ++i) {
+		out[i] = simplex(x[i], y[i], z[i]);
+	}
+}
+
+#endif
+
+void NoiseEngine::perlin(const float *x, const float *y, const float *z, float *out, size_t n) const {
+	size_t i = 0;
+	for ( ; i + BATCH <= n; i += BATCH) {
+		perlin8(x + i, y + i, z + i, out + i);
+	}
+	for ( ; i < n; ++i) {
+		out[i] = perlin(x[i], y[i], z[i]);
+	}
+}
+
+void NoiseEngine::simplex(const float *x, const float *y, const float *z, float *out, size_t n) const {
+	size_t i = 0;
+	for ( ; i + BATCH <= n; i += BATCH) {
+		simplex8(x + i, y + i, z + i, out + i);
+	}
+	for ( ; i < n; ++i) {
+		out[i] = simplex(x[i], y[i], z[i]);
+	}
+}
+
+float NoiseEngine::fractal(float x, float y, float z, float alpha, float beta, int octaves) const {
+	float sum = 0.0f, scale = 1.0f;
+	for (int i = 0; i < octaves; ++i) {
+		sum += perlin(x, y, z) / scale;
+		scale *= alpha;
+		x *= beta;
+		y *= beta;
+		z *= beta;
+	}
+	return sum;
+}
+
+//***** texture baking
+
+void NoiseEngine::bake_slices(GLubyte *texPtr, int size, int frequency, int channel,
+		float amp, int slice_begin, int slice_end) const {
+	NoiseEngine octave(seed, frequency);
+	float inc = (float)frequency / size;
+	vector<float> xs(size), ys(size), zs(size), out(size);
+	for (int k = 0; k < size; ++k) {
+		zs[k] = k * inc;
+	}
+	// same axis order as make3DNoiseTexture: i is ni[0], k varies fastest
+	for (int i = slice_begin; i < slice_end; ++i) {
+		std::fill(xs.begin(), xs.end(), i * inc);
+		for (int j = 0; j < size; ++j) {
+			std::fill(ys.begin(), ys.end(), j * inc);
+			octave.perlin(&xs[0], &ys[0], &zs[0], &out[0], size);
+			GLubyte *ptr = texPtr + 4 * ((size_t)(i * size + j) * size) + channel;
+			for (int k = 0; k < size; ++k, ptr += 4) {
+				float val = (out[k] + 1.0f) * amp * 128.0f;
+				*ptr = (GLubyte) std::min(std::max(val, 0.0f), 255.0f);
+			}
+		}
+	}
+}
+
+void NoiseEngine::bake_texture(GLubyte *texPtr, int size, int start_frequency,
+		int octaves, int threads) const {
+	if(threads <= 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = std::min(threads, size);
+	int frequency = start_frequency;
+	float amp = 0.5f;
+	for (int f = 0; f < octaves && f < 4; ++f, frequency *= 2, amp *= 0.5f) {
+		if(threads == 1) {
+			bake_slices(texPtr, size, frequency, f, amp, 0, size);
+			continue;
+		}
+		vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t) {
+			int begin = size * t / threads, end = size * (t + 1) / threads;
+			workers.push_back(std::thread(&NoiseEngine::bake_slices, this, texPtr, size,
+					frequency, f, amp, begin, end));
+		}
+		for (size_t t = 0; t < workers.size(); ++t) {
+			workers[t].join();
+		}
+	}
+}
+
+//***** tests and benchmarks
+
+// uniform random float in [lo, hi)
+static float frand(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / (RAND_MAX + 1.0f));
+}
+
+void NoiseEngine::test() {
+	cout <<  "\n******************** NoiseEngine::test() **************************" << endl;
+	const int n = 4096;
+	vector<float> x(n), y(n), z(n), scalar(n), batch(n);
+	srand(1234);
+	for (int i = 0; i < n; ++i) {
+		x[i] = frand(-50, 50);
+		y[i] = frand(-50, 50);
+		z[i] = frand(-50, 50);
+	}
+	NoiseEngine eng(7), tiled(7, 8);
+	const NoiseEngine *engines[] = { &eng, &tiled };
+	for (int e = 0; e < 2; ++e) {
+		// batch == scalar
+		for (int i = 0; i < n; ++i) {
+			scalar[i] = engines[e]->perlin(x[i], y[i], z[i]);
+		}
+		engines[e]->perlin(&x[0], &y[0], &z[0], &batch[0], n);
+		for (int i = 0; i < n; ++i) {
+			if(!almost_equal(scalar[i], batch[i], 1e-6) || fabs(scalar[i]) > 1.1f) {
+				cout << "!=: perlin batch: " << i << "  " << scalar[i] << " " << batch[i] << endl;
+			}
+		}
+	}
+	for (int i = 0; i < n; ++i) {
+		scalar[i] = eng.simplex(x[i], y[i], z[i]);
+	}
+	eng.simplex(&x[0], &y[0], &z[0], &batch[0], n);
+	for (int i = 0; i < n; ++i) {
+		if(!almost_equal(scalar[i], batch[i], 1e-6) || fabs(scalar[i]) > 1.1f) {
+			cout << "!=: simplex batch: " << i << "  " << scalar[i] << " " << batch[i] << endl;
+		}
+	}
+	// zero on the lattice
+	for (int i = -3; i < 3; ++i) {
+		if(eng.perlin(i, 2*i, -i) != 0.0f) {
+			cout << "!=: perlin lattice: " << i << endl;
+		}
+	}
+	// tiling
+	for (int i = 0; i < 256; ++i) {
+		float a = tiled.perlin(x[i], y[i], z[i]);
+		float b = tiled.perlin(x[i] + 8, y[i] - 16, z[i] + 24);
+		if(!almost_equal(a, b, 1e-4)) {
+			cout << "!=: perlin tiling: " << i << "  " << a << " " << b << endl;
+		}
+	}
+	// threaded bake matches single threaded
+	int size = 32;
+	vector<GLubyte> one(size*size*size*4), many(size*size*size*4);
+	eng.bake_texture(&one[0], size, 4, 4, 1);
+	eng.bake_texture(&many[0], size, 4, 4, 4);
+	if(memcmp(&one[0], &many[0], one.size()) != 0) {
+		cout << "!=: bake_texture threads" << endl;
+	}
+	// texture wraps: the first and last slices should be close
+	int diff = 0;
+	for (int k = 0; k < size; ++k) {
+		diff = max(diff, abs((int)one[4*k] - (int)one[4*((size-1)*size*size + k)]));
+	}
+	if(diff > 32) {
+		cout << "!=: bake_texture tiling, max diff at seam: " << diff << endl;
+	}
+	cout << "\n***************** Done:  NoiseEngine::test() ***********************" << endl;
+}
+
+// mean, rms, min, max of values
+static void print_stats(const char *name, const vector<float>& vals) {
+	double sum = 0, sq = 0;
+	float lo = vals[0], hi = vals[0];
+	for (size_t i = 0; i < vals.size(); ++i) {
+		sum += vals[i];
+		sq += vals[i] * vals[i];
+		lo = min(lo, vals[i]);
+		hi = max(hi, vals[i]);
+	}
+	cout << "\t" << name << ": mean " << sum / vals.size() << ", rms "
+			<< sqrt(sq / vals.size()) << ", range [" << lo << ", " << hi << "]" << endl;
+}
+
+static void print_rate(const char *name, size_t n, double ms) {
+	cout << "\t" << name << ": " << ms << " ms, " << n / (ms * 1000.0) << " Msamples/s" << endl;
+}
+
+void NoiseEngine::bench() {
+	cout <<  "\n******************** NoiseEngine::bench() **************************" << endl;
+	const size_t n = 1 << 20;
+	vector<float> x(n), y(n), z(n), out(n), ref(n);
+	srand(4321);
+	for (size_t i = 0; i < n; ++i) {
+		x[i] = frand(0, 64);
+		y[i] = frand(0, 64);
+		z[i] = frand(0, 64);
+	}
+	NoiseEngine eng;
+	Stopwatch sw;
+	double v[3];
+
+	cout << n << " samples:" << endl;
+	SetNoiseFrequency(64);
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		v[0] = x[i]; v[1] = y[i]; v[2] = z[i];
+		ref[i] = (float)noise3(v);
+	}
+	print_rate("noise3", n, sw.elapsed_ms());
+	print_stats("noise3", ref);
+
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		out[i] = eng.perlin(x[i], y[i], z[i]);
+	}
+	print_rate("perlin scalar", n, sw.elapsed_ms());
+	sw.reset();
+	eng.perlin(&x[0], &y[0], &z[0], &ref[0], n);
+	print_rate("perlin batch", n, sw.elapsed_ms());
+	float err = 0;
+	for (size_t i = 0; i < n; ++i) {
+		err = max(err, (float)fabs(out[i] - ref[i]));
+	}
+	print_stats("perlin", out);
+	cout << "\tperlin max |scalar - batch|: " << err << endl;
+
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		out[i] = eng.simplex(x[i], y[i], z[i]);
+	}
+	print_rate("simplex scalar", n, sw.elapsed_ms());
+	sw.reset();
+	eng.simplex(&x[0], &y[0], &z[0], &ref[0], n);
+	print_rate("simplex batch", n, sw.elapsed_ms());
+	err = 0;
+	for (size_t i = 0; i < n; ++i) {
+		err = max(err, (float)fabs(out[i] - ref[i]));
+	}
+	print_stats("simplex", out);
+	cout << "\tsimplex max |scalar - batch|: " << err << endl;
+
+	// 4 octave sums
+	size_t nf = n / 4;
+	out.resize(nf);
+	ref.resize(nf);
+	cout << nf << " 4 octave sums:" << endl;
+	sw.reset();
+	for (size_t i = 0; i < nf; ++i) {
+		ref[i] = (float)PerlinNoise3D(x[i], y[i], z[i], 2.0, 2.0, 4);
+	}
+	print_rate("PerlinNoise3D", nf, sw.elapsed_ms());
+	print_stats("PerlinNoise3D", ref);
+	sw.reset();
+	for (size_t i = 0; i < nf; ++i) {
+		out[i] = eng.fractal(x[i], y[i], z[i]);
+	}
+	print_rate("fractal", nf, sw.elapsed_ms());
+	print_stats("fractal", out);
+
+	// textures
+	int size = 64;
+	vector<GLubyte> tex(size*size*size*4);
+	cout << size << "^3 texture, 4 octaves:" << endl;
+	sw.reset();
+	make3DNoiseTextureScalar(size, &tex[0]);
+	cout << "\tnoise3: " << sw.elapsed_ms() << " ms" << endl;
+	sw.reset();
+	eng.bake_texture(&tex[0], size, 4, 4, 1);
+	cout << "\tbake_texture, 1 thread: " << sw.elapsed_ms() << " ms" << endl;
+	sw.reset();
+	eng.bake_texture(&tex[0], size);
+	cout << "\tbake_texture, " << std::thread::hardware_concurrency() << " threads: "
+			<< sw.elapsed_ms() << " ms" << endl;
+	cout << "\n***************** Done:  NoiseEngine::bench() ***********************" << endl;
+}
@@ -0,0 +1,131 @@
+/*
+ * overlay.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "overlay.h"
+#include "stream_buffer.h"
+
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+void DebugOverlay::clear() {
+	lines.clear();
+	points.clear();
+	triangles.clear();
+	built = false;
+}
+
+void DebugOverlay::add_vertex(vector<GLfloat>& to, const GLfloat *p, const GLfloat *color) {
+	to.insert(to.end(), p, p + 3);
+	to.insert(to.end(), color, color + 3);
+}
+
+void DebugOverlay::add_line(const GLfloat *a, const GLfloat *b, const GLfloat *color) {
+	add_vertex(lines, a, color);
+	add_vertex(lines, b, color);
+	built = true;
+}
+
+void DebugOverlay::add_point(const GLfloat *p, const GLfloat *color) {
+	add_vertex(points, p, color);
+	built = true;
+}
+
+void DebugOverlay::add_normal(const GLfloat *p, const GLfloat *n, GLfloat size, const GLfloat *color) {
+	GLfloat end[3] = { p[0] + size * n[0], p[1] + size * n[1], p[2] + size * n[2] };
+	add_line(p, end, color);
+	add_point(end, color);
+}
+
+void DebugOverlay::add_polygon(const vec3 *verts, const GLint *index, int size, const GLfloat *color) {
+	for (int k = 2; k < size; ++k) {
+		add_vertex(triangles, verts[index[0]], color);
+		add_vertex(triangles, verts[index[k - 1]], color);
+		add_vertex(triangles, verts[index[k]], color);
+	}
+	built = true;
+}
+
+void DebugOverlay::draw_array(const vector<GLfloat>& from, GLenum mode) {
+	if(from.empty()) {
+		return;
+	}
+	GLsizei stride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+	// into the frame's stream, or drawn from client memory if it's full
+	StreamBuffer& stream = frame_stream();
+	size_t offset;
+	GLfloat *v = stream.alloc_floats(from.size(), offset);
+	const GLfloat *p = &from[0];
+	if(v) {
+		copy(from.begin(), from.end(), v);
+		stream.bind();
+		p = (const GLfloat*)stream.pointer(offset);
+	}
+	glVertexPointer(3, GL_FLOAT, stride, p);
+	glColorPointer(3, GL_FLOAT, stride, p + 3);
+	glDrawArrays(mode, 0, from.size() / FLOATS_PER_VERTEX);
+	stream.unbind();
+}
+
+void DebugOverlay::draw(GLfloat line_width, GLfloat point_size, bool smooth_points) const {
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glDisable(GL_LIGHTING);
+	glLineWidth(line_width);
+	glPointSize(point_size);
+	if(smooth_points) {
+		glEnable(GL_POINT_SMOOTH);
+	}
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	draw_array(triangles, GL_TRIANGLES);
+	draw_array(lines, GL_LINES);
+	draw_array(points, GL_POINTS);
+	glPopClientAttrib();
+	glPopAttrib();
+}
+
+void DebugOverlay::test() {
+	cout <<  "\n******************** DebugOverlay::test() **************************" << endl;
+	GLfloat red[] = { 1, 0, 0 }, blue[] = { 0, 0, 1 };
+	vec3 square[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+	GLint quad[] = { 0, 1, 2, 3 };
+	vec3 up = { 0, 0, 1 };
+	DebugOverlay o;
+	if(o.is_built()) {
+		cout << "!=: new overlay is built" << endl;
+	}
+	o.add_normal(square[2], up, 0.5f, red);
+	o.add_line(square[0], square[1], blue);
+	o.add_polygon(square, quad, 4, blue);
+	if(!o.is_built() || o.num_lines() != 2 || o.num_points() != 1 || o.num_triangles() != 2) {
+		cout << "!=: " << o.num_lines() << " lines, " << o.num_points() << " points, "
+				<< o.num_triangles() << " triangles" << endl;
+	}
+	// the normal's end, then its color
+	const GLfloat want[] = { 1, 1, 0.5f, 1, 0, 0 };
+	if(!std::equal(want, want + FLOATS_PER_VERTEX, &o.lines[FLOATS_PER_VERTEX])
+			|| !std::equal(want, want + FLOATS_PER_VERTEX, &o.points[0])) {
+		cout << "!=: normal end " << o.lines[FLOATS_PER_VERTEX] << ", " << o.lines[FLOATS_PER_VERTEX + 1]
+				<< ", " << o.lines[FLOATS_PER_VERTEX + 2] << endl;
+	}
+	// second triangle of the fan is 0, 2, 3
+	if(o.triangles[3 * FLOATS_PER_VERTEX + 6 + 1] != 1 || o.triangles[3 * FLOATS_PER_VERTEX + 12 + 1] != 1
+			|| o.triangles[3 * FLOATS_PER_VERTEX + 12] != 0) {
+		cout << "!=: fan corners" << endl;
+	}
+	o.clear();
+	if(o.is_built() || o.num_lines() || o.num_points() || o.num_triangles()) {
+		cout << "!=: cleared overlay not empty" << endl;
+	}
+	o.done();
+	if(!o.is_built()) {
+		cout << "!=: done() overlay not built" << endl;
+	}
+	cout << "\n***************** Done:  DebugOverlay::test() ***********************" << endl;
+}
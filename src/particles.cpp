@@ -6,6 +6,7 @@
  */
 
 #include "particles.h"
+#include "stream_buffer.h"
 #include <algorithm>
 #include <iostream>
 #include <cassert>
@@ -15,21 +16,16 @@ using namespace DR;
 
 Particle::Particle()
 : size(1.0), age(0), alive(false) {
+	zero(position);
+	zero(velocity);
+	setv(color, 1.0f, 1.0f, 1.0f, 1.0f);
 }
 
 Particle::Particle(vec4 color, GLfloat size, bool alive)
 : size(size), age(0), alive(alive) {
-	copyv(this->color, color);
-}
-
-Particle::Particle(const Particle& other) {
-	this->size = other.size;
-	this->age = other.age;
-	this->alive = other.alive;
-	copyv(this->color, other.color);
-	copyv(this->position, other.position);
-	copyv(this->velocity, other.velocity);
-
+	copyv(this->color, color, 4);
+	zero(position);
+	zero(velocity);
 }
 
 bool Particle::operator ==(const Particle& other) const {
@@ -42,6 +38,63 @@ bool Particle::operator ==(const Particle& other) const {
 	);
 }
 
+void ParticleArrays::assign(size_t n, const Particle& p) {
+	px.assign(n, p.position[0]);
+	py.assign(n, p.position[1]);
+	pz.assign(n, p.position[2]);
+	vx.assign(n, p.velocity[0]);
+	vy.assign(n, p.velocity[1]);
+	vz.assign(n, p.velocity[2]);
+	age.assign(n, p.age);
+	size.assign(n, p.size);
+	color.resize(4*n);
+	for (size_t i = 0; i < n; ++i) {
+		copyv(&color[4*i], p.color, 4);
+	}
+	spawn_alpha.assign(n, p.color[3]);
+	alive.assign(n, p.alive);
+}
+
+void ParticleArrays::push_back(const Particle& p) {
+	px.push_back(0); py.push_back(0); pz.push_back(0);
+	vx.push_back(0); vy.push_back(0); vz.push_back(0);
+	age.push_back(0);
+	size.push_back(0);
+	color.resize(color.size() + 4);
+	spawn_alpha.push_back(0);
+	alive.push_back(false);
+	set(count()-1, p);
+}
+
+void ParticleArrays::set(size_t i, const Particle& p) {
+	px[i] = p.position[0]; py[i] = p.position[1]; pz[i] = p.position[2];
+	vx[i] = p.velocity[0]; vy[i] = p.velocity[1]; vz[i] = p.velocity[2];
+	age[i] = p.age;
+	size[i] = p.size;
+	copyv(&color[4*i], p.color, 4);
+	spawn_alpha[i] = p.color[3];
+	alive[i] = p.alive;
+}
+
+void ParticleArrays::get(size_t i, Particle& out) const {
+	setv(out.position, px[i], py[i], pz[i]);
+	setv(out.velocity, vx[i], vy[i], vz[i]);
+	out.age = age[i];
+	out.size = size[i];
+	copyv(out.color, &color[4*i], 4);
+	out.alive = alive[i];
+}
+
+void ParticleArrays::erase(size_t i) {
+	px.erase(px.begin()+i); py.erase(py.begin()+i); pz.erase(pz.begin()+i);
+	vx.erase(vx.begin()+i); vy.erase(vy.begin()+i); vz.erase(vz.begin()+i);
+	age.erase(age.begin()+i);
+	size.erase(size.begin()+i);
+	color.erase(color.begin()+4*i, color.begin()+4*i+4);
+	spawn_alpha.erase(spawn_alpha.begin()+i);
+	alive.erase(alive.begin()+i);
+}
+
 ParticleSet::ParticleSet(int num_particles, GLfloat start_time_ms)
 : life_span(4.0), old_time_ms(start_time_ms) {
 	Particle p;
@@ -49,9 +102,6 @@ ParticleSet::ParticleSet(int num_particles, GLfloat start_time_ms)
 	for (int i = num_particles-1; i >= 0 ; --i) {
 		dead_particles.push(i);
 	}
-	//		std::vector<Particle>::iterator it;
-	//		for(it=particles.begin; it != particles.end; ++it) {
-	//		}
 }
 
 void ParticleSet::init(int num_particles) {
@@ -59,15 +109,27 @@ void ParticleSet::init(int num_particles) {
 	cout << "particle set init" << endl;
 	particles.assign(num_particles, p);
 	cout << "num_particles: " << num_particles << endl;
-	int j=0;
+	dead_particles = std::stack<int>();
 	for (int i = num_particles-1; i >= 0 ; --i) {
 		dead_particles.push(i);
 	}
 }
 
 void ParticleSet::remove(const Particle& p) {
-	particles.erase( std::remove( particles.begin(), particles.end(), p),
-			particles.end());
+	Particle q;
+	for (int i = (int)particles.count()-1; i >= 0; --i) {
+		particles.get(i, q);
+		if(q == p) {
+			particles.erase(i);
+		}
+	}
+	// indices have shifted
+	dead_particles = std::stack<int>();
+	for (int i = (int)particles.count()-1; i >= 0; --i) {
+		if(!particles.alive[i]) {
+			dead_particles.push(i);
+		}
+	}
 }
 
 /**
@@ -78,78 +140,262 @@ bool ParticleSet::reincarnate(vec4 color, vec3 pos, vec3 vel, GLfloat size) {
 		return false;
 	}
 	int i = dead_particles.top();  dead_particles.pop();
-	particles[i].alive = true;
-	particles[i].age = 0.0f;
-	copyv(particles[i].color, color, 4);
-	copyv(particles[i].position, pos);
-	copyv(particles[i].velocity, vel);
-	particles[i].size = size;
+	particles.alive[i] = true;
+	particles.age[i] = 0.0f;
+	copyv(&particles.color[4*i], color, 4);
+	particles.spawn_alpha[i] = color[3];
+	particles.px[i] = pos[0]; particles.py[i] = pos[1]; particles.pz[i] = pos[2];
+	particles.vx[i] = vel[0]; particles.vy[i] = vel[1]; particles.vz[i] = vel[2];
+	particles.size[i] = size;
 	return true;
 }
 
+namespace {
+
 /**
- * Update position of particles, kill particles if past life span
+ * The fused update pass, instantiated for every combination of fields and fading.
+ * Semi-implicit Euler: velocity from forces first, then position from velocity.
  */
-void ParticleSet::update(GLfloat time_ms) {
-	GLfloat dt = 0.001 * (time_ms - old_time_ms);
-	for (int i = 0; i < (int)particles.size(); ++i) {
-		if(!particles[i].alive) continue;
+template<unsigned FIELDS, bool FADE>
+void update_pass(ParticleArrays& pa, const ForceFields& f, GLfloat dt,
+		GLfloat life_span, std::stack<int>& dead) {
+	const int n = (int)pa.count();
+	GLfloat *px = &pa.px[0], *py = &pa.py[0], *pz = &pa.pz[0];
+	GLfloat *vx = &pa.vx[0], *vy = &pa.vy[0], *vz = &pa.vz[0];
+	GLfloat *age = &pa.age[0], *color = &pa.color[0], *spawn_alpha = &pa.spawn_alpha[0];
+	unsigned char *alive = &pa.alive[0];
+	GLfloat acc[3];
+	for (int i = 0; i < n; ++i) {
+		if(!alive[i]) continue;
 		// kill dead particles
-		if(particles[i].age > life_span) {
-			particles[i].alive = false;
-			dead_particles.push(i);
-		} else {
-			for (int j = 0; j < 3; ++j) {
-				particles[i].position[j] += dt * particles[i].velocity[j];
-				// add force effect here
+		if(age[i] > life_span) {
+			alive[i] = false;
+			dead.push(i);
+			continue;
+		}
+		if(FIELDS != FORCE_NONE) {
+			accumulate_forces<FIELDS>(f, px[i], py[i], pz[i], vx[i], vy[i], vz[i], acc);
+			vx[i] += dt * acc[0];
+			vy[i] += dt * acc[1];
+			vz[i] += dt * acc[2];
+		}
+		px[i] += dt * vx[i];
+		py[i] += dt * vy[i];
+		pz[i] += dt * vz[i];
+		age[i] += dt;
+		if(FADE) {
+			color[4*i+3] = spawn_alpha[i] * max(0.0f, 1.0f - age[i] / life_span);
+		}
+	}
+}
+
+typedef void (*UpdatePass)(ParticleArrays&, const ForceFields&, GLfloat, GLfloat, std::stack<int>&);
+
+// index into the table is FIELDS | (FADE << 4)
+const int NUM_PASSES = 2 * (FORCE_ALL + 1);
+
+// fills table[0..I] with the pass instantiations
+template<int I>
+struct PassTable {
+	static void fill(UpdatePass *table) {
+		table[I] = &update_pass<I & FORCE_ALL, (I > FORCE_ALL)>;
+		PassTable<I-1>::fill(table);
+	}
+};
+template<>
+struct PassTable<-1> {
+	static void fill(UpdatePass *) {}
+};
+
+UpdatePass get_pass(unsigned fields, bool fade) {
+	static UpdatePass table[NUM_PASSES];
+	static bool filled = false;
+	if(!filled) {
+		PassTable<NUM_PASSES-1>::fill(table);
+		filled = true;
+	}
+	return table[(fields & FORCE_ALL) | (fade ? FORCE_ALL + 1 : 0)];
+}
+
+} // end anonymous namespace
+
+void ParticleSet::step(GLfloat dt, bool fade) {
+	if(particles.empty()) {
+		return;
+	}
+	get_pass(forces.enabled, fade)(particles, forces, dt, life_span, dead_particles);
+}
+
+namespace {
+// checks get_pass gives update_pass<F, FADE> for F and every field set below it
+template<unsigned F, bool FADE>
+struct PassCheck {
+	static int wrong() {
+		return (get_pass(F, FADE) != &update_pass<F, FADE>) + PassCheck<F-1, FADE>::wrong();
+	}
+};
+template<bool FADE>
+struct PassCheck<0, FADE> {
+	static int wrong() { return get_pass(0, FADE) != &update_pass<FORCE_NONE, FADE>; }
+};
+
+// set with one live particle, at pos moving at vel, fields all off
+void one_particle(ParticleSet& ps, GLfloat x, GLfloat y, GLfloat z,
+		GLfloat vx, GLfloat vy, GLfloat vz, GLfloat alpha=1.0f) {
+	vec4 color = {1, 1, 1, alpha};
+	vec3 pos = {x, y, z}, vel = {vx, vy, vz};
+	ps.reincarnate(color, pos, vel);
+}
+}
+
+void ParticleSet::test() {
+	cout <<  "\n******************** ParticleSet::test() **************************" << endl;
+	int wrong = PassCheck<FORCE_ALL, false>::wrong() + PassCheck<FORCE_ALL, true>::wrong();
+	// bits beyond the fields are ignored
+	wrong += get_pass(FORCE_DRAG | 0x100, true) != &update_pass<FORCE_DRAG, true>;
+	if(wrong) {
+		cout << "!=: " << wrong << " pass table entries" << endl;
+	}
 
-			} // update age
-			particles[i].age += dt;
+	Particle q;
+	// gravity: v = (1, -10 * .1, 0), then p = .1 * v
+	{
+		ParticleSet ps(1);
+		ps.forces.enable(FORCE_GRAVITY);
+		setv(ps.forces.gravity, 0, -10, 0);
+		one_particle(ps, 0, 0, 0, 1, 0, 0);
+		ps.step(0.1f, false);
+		ps.particles.get(0, q);
+		vec3 pos = {0.1f, -0.1f, 0}, vel = {1, -1, 0};
+		if(!equal(q.position, pos, 1e-5f) || !equal(q.velocity, vel, 1e-5f)) {
+			cout << "!=: gravity step " << stringv(q.position) << ", " << stringv(q.velocity) << endl;
 		}
 	}
+	// drag: v = 2 - .1 * .5 * 2, then p = .1 * v
+	{
+		ParticleSet ps(1);
+		ps.forces.enable(FORCE_DRAG);
+		ps.forces.drag = 0.5f;
+		one_particle(ps, 0, 0, 0, 2, 0, 0);
+		ps.step(0.1f, false);
+		ps.particles.get(0, q);
+		vec3 pos = {0.19f, 0, 0}, vel = {1.9f, 0, 0};
+		if(!equal(q.position, pos, 1e-5f) || !equal(q.velocity, vel, 1e-5f)) {
+			cout << "!=: drag step " << stringv(q.position) << ", " << stringv(q.velocity) << endl;
+		}
+	}
+	// radial: pulled in toward the center, as a syllable's assigned_center
+	{
+		ParticleSet ps(1);
+		ps.forces.enable(FORCE_RADIAL);
+		ps.forces.radial_strength = 2.0f;
+		vec3 assigned_center = {1, 2, 3};
+		ps.forces.set_center(assigned_center);
+		one_particle(ps, 3, 2, 3, 0, 0, 0);
+		GLfloat last = 2.0f;
+		bool closer = true;
+		for (int i = 0; i < 5; ++i) {
+			ps.step(0.05f, false);
+			ps.particles.get(0, q);
+			GLfloat d = dist(q.position, assigned_center);
+			closer = closer && d < last && almost_equal(q.position[1], 2.0f, 1e-5f) && almost_equal(q.position[2], 3.0f, 1e-5f);
+			last = d;
+		}
+		if(!closer) {
+			cout << "!=: radial pull, " << stringv(q.position) << " from " << stringv(assigned_center) << endl;
+		}
+	}
+	// fade: spawn alpha scaled down to 0 at life_span
+	{
+		ParticleSet ps(1);
+		ps.life_span = 1.0f;
+		one_particle(ps, 0, 0, 0, 0, 0, 0, 0.5f);
+		GLfloat alphas[4];
+		for (int i = 0; i < 4; ++i) {
+			ps.step(0.25f, true);
+			ps.particles.get(0, q);
+			alphas[i] = q.color[3];
+		}
+		bool alive = q.alive;
+		// killed by the step after it's past its life span
+		ps.step(0.25f, true);
+		ps.step(0.25f, true);
+		if(!almost_equal(alphas[1], 0.25f, 1e-5f) || alphas[3] != 0.0f || !alive || ps.live_particles() != 0) {
+			cout << "!=: fade, alpha " << alphas[1] << " at half life, " << alphas[3] << " at life span, "
+					<< ps.live_particles() << " live after" << endl;
+		}
+	}
+	cout << "\n***************** Done:  ParticleSet::test() ***********************" << endl;
+}
+
+/**
+ * Update position of particles, kill particles if past life span
+ */
+void ParticleSet::update(GLfloat time_ms) {
+	GLfloat dt = 0.001 * (time_ms - old_time_ms);
+	step(dt, false);
 	// reset millisec time
 	old_time_ms = time_ms;
-	glutPostRedisplay();
 }
 /**
  * Update position of particles, with alpha fading
  */
 void ParticleSet::update_w_fade(GLfloat time_ms) {
 	GLfloat dt = 0.001 * (time_ms - old_time_ms);
-	for (int i = 0; i < (int)particles.size(); ++i) {
-		if(!particles[i].alive) continue;
-		// kill dead particles
-		if(particles[i].age > life_span) {
-			particles[i].alive = false;
-			dead_particles.push(i);
-		} else {
-			for (int j = 0; j < 3; ++j) {
-				particles[i].position[j] += dt * particles[i].velocity[j];
-				// add force effect here
-
-			} // update age
-			particles[i].age += dt;
-		}
-	}
+	step(dt, true);
 	// reset millisec time
 	old_time_ms = time_ms;
-	glutPostRedisplay();
 }
 
-void ParticleSet::render() {
-	glPushAttrib(GL_POINT_BIT);
-	glEnable(GL_POINT_SMOOTH);
-	vector<Particle>::iterator it = particles.begin();
-	for( ; it != particles.end(); ++it) {
-		if(!(it->alive)) {
+void ParticleSet::render(GLfloat ahead) {
+	size_t live = live_particles();
+	if(!live) {
+		return;
+	}
+	// into the frame's stream, or drawn from client memory if it's full
+	StreamBuffer& stream = frame_stream();
+	size_t offset;
+	GLfloat *v = stream.alloc_floats(live * FLOATS_PER_VERTEX, offset);
+	bool streamed = v != NULL;
+	if(!streamed) {
+		client_verts.resize(live * FLOATS_PER_VERTEX);
+		v = &client_verts[0];
+	}
+	GLint n = 0;
+	size_runs.clear();
+	for (size_t i = 0; i < particles.count() && n < (GLint)live; ++i) {
+		if(!particles.alive[i]) {
 			continue;
 		}
-		glPointSize(it->size);
-		glBegin(GL_POINTS);
-		glColor4fv(it->color);
-		glVertex3fv(it->position);
-		glEnd();
+		if(size_runs.empty() || size_runs.back().first != particles.size[i]) {
+			size_runs.push_back(make_pair(particles.size[i], n));
+		}
+		v[0] = particles.px[i] + ahead * particles.vx[i];
+		v[1] = particles.py[i] + ahead * particles.vy[i];
+		v[2] = particles.pz[i] + ahead * particles.vz[i];
+		copyv(v + 3, &particles.color[4*i], 4);
+		v += FLOATS_PER_VERTEX;
+		++n;
+	}
+	glPushAttrib(GL_POINT_BIT | GL_CURRENT_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnable(GL_POINT_SMOOTH);
+	GLsizei stride = FLOATS_PER_VERTEX * sizeof(GLfloat);
+	const GLfloat *from = streamed ? (const GLfloat*)stream.pointer(offset) : &client_verts[0];
+	if(streamed) {
+		stream.bind();
+	}
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, stride, from);
+	glColorPointer(4, GL_FLOAT, stride, from + 3);
+	for (size_t r = 0; r < size_runs.size(); ++r) {
+		GLint end = r + 1 < size_runs.size() ? size_runs[r + 1].second : n;
+		glPointSize(size_runs[r].first);
+		glDrawArrays(GL_POINTS, size_runs[r].second, end - size_runs[r].second);
 	}
+	stream.unbind();
+	glPopClientAttrib();
 	glPopAttrib();
 }
 
@@ -185,9 +431,9 @@ bool LightBeamSet::get_beam(vec4 color, vec3 pos, vec3 vel,
 	for (int i = 0; i < 4; ++i) {
 		beams[b].color[i] = color[i];
 	}
-	beams[b].front = Vec(pos);
-	beams[b].tail = Vec(pos);
-	beams[b].velocity = Vec(vel);
+	beams[b].front = linalg::Vec3f::from(pos);
+	beams[b].tail = beams[b].front;
+	beams[b].velocity = linalg::Vec3f::from(vel);
 	beams[b].front_life_span = life_span;
 	beams[b].width = width;
 	beams[b].max_length = length;
@@ -202,17 +448,21 @@ void LightBeamSet::update(GLfloat time_ms) {
 		old_time_ms = time_ms;
 		return;
 	}
-	GLfloat dt = 0.001 * (time_ms - old_time_ms);
+	step(0.001 * (time_ms - old_time_ms));
+	// reset millisec time
+	old_time_ms = time_ms;
+}
 
+void LightBeamSet::step(GLfloat dt) {
 	for (int i = 0; i < (int)beams.size(); ++i) {
 		if(!beams[i].alive) continue;
 
-		Vec pos_delta = dt * beams[i].velocity;
-		Vec rayvec; // = beams[i].front - beams[i].tail;
-		beams[i].as_vec(rayvec);
+		linalg::Vec3f pos_delta = dt * beams[i].velocity;
+		linalg::Vec3f rayvec = beams[i].as_vec();
 
 		// check if ray/beam is long enough to free tail
-		if(rayvec.magnitude() >= beams[i].max_length) {
+		// compare squared lengths, saves the sqrt
+		if(linalg::length2(rayvec) >= beams[i].max_length * beams[i].max_length) {
 			beams[i].tail_free = true;
 		}
 
@@ -221,7 +471,7 @@ void LightBeamSet::update(GLfloat time_ms) {
 		if(beams[i].age > beams[i].front_life_span) {
 			// check if tail has caught up to front and
 			// beam should die
-			if(rayvec.dot(beams[i].velocity) < 0) {
+			if(linalg::dot(rayvec, beams[i].velocity) < 0) {
 				beams[i].kill();
 				dead_beams.push_back(i);
 				continue;
@@ -248,40 +498,80 @@ void LightBeamSet::update(GLfloat time_ms) {
 		assert(alpha <= 1.0f);
 		beams[i].color[3] = alpha;
 	}
-
-	// reset millisec time
-	old_time_ms = time_ms;
-	glutPostRedisplay();
 }
 
 
-void LightBeamSet::render() {
+void LightBeamSet::render(GLfloat ahead) {
+	size_t live = live_beams();
+	if(!live) {
+		return;
+	}
+	// into the frame's stream, or drawn from client memory if it's full
+	StreamBuffer& stream = frame_stream();
+	size_t offset;
+	GLfloat *v = stream.alloc_floats(2 * live * ParticleSet::FLOATS_PER_VERTEX, offset);
+	bool streamed = v != NULL;
+	if(!streamed) {
+		client_verts.resize(2 * live * ParticleSet::FLOATS_PER_VERTEX);
+		v = &client_verts[0];
+	}
+	// a random width for each beam, then grouped by width
+	GLint first[NUM_WIDTHS + 1] = {0};
+	widths.resize(beams.size());
+	size_t n = 0;
+	for (size_t i = 0; i < beams.size() && n < live; ++i) {
+		if(beams[i].alive) {
+			widths[i] = rand() % NUM_WIDTHS;
+			++first[widths[i] + 1];
+			++n;
+		}
+	}
+	for (int w = 0; w < NUM_WIDTHS; ++w) {
+		first[w + 1] += first[w];
+	}
+	GLint next[NUM_WIDTHS];
+	copy(first, first + NUM_WIDTHS, next);
+	const int floats = 2 * ParticleSet::FLOATS_PER_VERTEX;
+	n = 0;
+	for (size_t i = 0; i < beams.size() && n < live; ++i) {
+		const LightBeam& b = beams[i];
+		if(!b.alive) {
+			continue;
+		}
+		++n;
+		GLfloat *line = v + floats * next[widths[i]]++;
+		// as step() moves them
+		linalg::Vec3f delta = ahead * b.velocity;
+		linalg::Vec3f tail = b.tail_free ? b.tail + delta : b.tail;
+		linalg::Vec3f front = b.age <= b.front_life_span ? b.front + delta : b.front;
+		copyv(line, tail.data(), 3);
+		copyv(line + 3, b.color, 4);
+		copyv(line + 7, front.data(), 3);
+		copyv(line + 10, b.color, 4);
+	}
 	glPushAttrib(GL_LINE_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 	glDisable(GL_LIGHTING);
 	glEnable(GL_LINE_SMOOTH);
 	glEnable(GL_LINE_STIPPLE);
-	GLint factor;
-	GLint i=0;
-	GLfloat width;
-	vec3 v;
-	vector<LightBeam>::iterator it = beams.begin();
-	for( ; it != beams.end(); ++it) {
-		if(!(it->alive)) {
-			continue;
+	glLineStipple (5, 0x1C47);  //  dash/dot/dash * 5
+	GLsizei stride = ParticleSet::FLOATS_PER_VERTEX * sizeof(GLfloat);
+	const GLfloat *from = streamed ? (const GLfloat*)stream.pointer(offset) : &client_verts[0];
+	if(streamed) {
+		stream.bind();
+	}
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, stride, from);
+	glColorPointer(4, GL_FLOAT, stride, from + 3);
+	for (int w = 0; w < NUM_WIDTHS; ++w) {
+		if(first[w + 1] > first[w]) {
+			glLineWidth(w * 0.5 + 0.5);
+			glDrawArrays(GL_LINES, 2 * first[w], 2 * (first[w + 1] - first[w]));
 		}
-		++i;
-		factor = rand() % 15 + 5;
-		width = (rand() % 6) * 0.5 + 0.5;
-		glLineStipple (5, 0x1C47);  //  dash/dot/dash * 5
-		glLineWidth(width); //it->width);
-		glBegin(GL_LINES);
-		glColor4fv(it->color);
-		it->tail.array_out(v);
-		glVertex3fv(v);
-		it->front.array_out(v);
-		glVertex3fv(v);
-		glEnd();
 	}
+	stream.unbind();
+	glPopClientAttrib();
 	glPopAttrib();
 }
 
@@ -11,12 +11,14 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <iterator>
 #include <cmath>
 #include <cassert>
 #include <cerrno>
 
 #include "poly.h"
 #include "vec.h"
+#include "linalg.h"
 #include "dr_util.h"
 
 using namespace std;
@@ -31,6 +33,36 @@ ostream& operator<<(ostream& out, const Polygon& p) {
 	return out;
 }
 
+void DR::to_id_set(const vector<Polygon*>& polys, PolyIdSet& out) {
+	out.clear();
+	out.reserve(polys.size());
+	for (size_t i = 0; i < polys.size(); ++i) {
+		out.push_back(polys[i]->id);
+	}
+	sort(out.begin(), out.end());
+	out.erase(unique(out.begin(), out.end()), out.end());
+}
+
+void DR::id_union(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out) {
+	out.clear();
+	set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(out));
+}
+
+void DR::id_intersection(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out) {
+	out.clear();
+	set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(out));
+}
+
+void DR::id_difference(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out) {
+	out.clear();
+	set_difference(a.begin(), a.end(), b.begin(), b.end(), back_inserter(out));
+}
+
+void DR::id_symmetric_difference(const PolyIdSet& a, const PolyIdSet& b, PolyIdSet& out) {
+	out.clear();
+	set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), back_inserter(out));
+}
+
 bool DR::contains(const vector<Polygon*>& v, const Polygon& p) {
 	for (size_t i = 0; i < v.size(); ++i) {
 		if(p == *v[i]) {
@@ -102,64 +134,130 @@ string IndexedEdge::to_string() {
 }
 
 Polygon::Polygon()
-: size(0), verts(NULL), norms(NULL), edges(NULL),
-  actual_verts(NULL), actual_norms(NULL), max_side_length(0) {
+: size(0), id(-1), verts(NULL), norms(NULL), edges(NULL),
+  actual_verts(NULL), actual_norms(NULL), max_side_length(0), arena_storage(false) {
 	setv(facetnorm, 0, 0, 0);
 	setv(center, 0, 0, 0);
 }
 
-Polygon::Polygon(GLint sz, vec3 *vertices, vec3 *normals)
-: size(sz), max_side_length(0) {
-	verts = new GLint[size];
-	norms = new GLint[size];
-	edges = new IndexedEdge[size];
+Polygon::Polygon(GLint sz, vec3 *vertices, vec3 *normals, Arena *arena)
+: size(sz), id(-1), max_side_length(0) {
+	alloc_indices(arena);
 	actual_verts = vertices;
 	actual_norms = normals;
 	setv(facetnorm, 0, 0, 0);
 	setv(center, 0, 0, 0);
 }
 
-Polygon::Polygon(const Polygon& p) {
-	size = p.size;
-	verts = new GLint[size];
-	norms = new GLint[size];
-	edges = new IndexedEdge[size];
-	for (int i = 0; i < size; ++i) {
-		verts[i] = p.verts[i];
-		norms[i] = p.norms[i];
-		edges[i] = p.edges[i];
+Polygon::Polygon(const Polygon& p)
+: size(p.size), id(p.id) {
+	alloc_indices(NULL);
+	copy_from(p);
+}
+
+Polygon::Polygon(Polygon&& p)
+: size(p.size), id(p.id) {
+	if(p.heap_storage()) {
+		take_indices(p);
+	} else {
+		// inline or arena storage, copying is as cheap as it gets
+		alloc_indices(NULL);
+		copy_from(p);
 	}
-	copyv(facetnorm, p.facetnorm);
-	copyv(center, p.center);
-	actual_verts = p.actual_verts;
-	actual_norms = p.actual_norms;
-	max_side_length = p.max_side_length;
 }
+
 // assignment makes a deep copy of everything
 // but actual_verts and actual_norms point to same storage
 const Polygon& Polygon::operator=(const Polygon& other) {
 	if(&other != this) {
-		size = other.size;
+		if(size != other.size) {
+			free_indices();
+			size = other.size;
+			alloc_indices(NULL);
+		}
+		copy_from(other);
+	}
+	return *this;
+}
+
+const Polygon& Polygon::operator=(Polygon&& other) {
+	if(&other != this) {
+		if(other.heap_storage()) {
+			free_indices();
+			size = other.size;
+			take_indices(other);
+		} else {
+			*this = other;
+		}
+	}
+	return *this;
+}
+
+Polygon::~Polygon() {
+	free_indices();
+}
+
+void Polygon::alloc_indices(Arena *arena) {
+	arena_storage = false;
+	if(size <= INLINE_SIZE) {
+		verts = inline_verts;
+		norms = inline_norms;
+		edges = inline_edges;
+	} else if(arena) {
+		arena_storage = true;
+		verts = arena->allocate_array<GLint>(size);
+		norms = arena->allocate_array<GLint>(size);
+		edges = arena->allocate_array<IndexedEdge>(size);
+		for (int i = 0; i < size; ++i) {
+			new (&edges[i]) IndexedEdge();
+		}
+	} else {
 		verts = new GLint[size];
 		norms = new GLint[size];
 		edges = new IndexedEdge[size];
+	}
+}
+
+void Polygon::free_indices() {
+	if(heap_storage()) {
+		delete [] verts;
+		delete [] norms;
+		delete [] edges;
+	}
+	verts = norms = NULL;
+	edges = NULL;
+	arena_storage = false;
+}
+
+// everything but the index storage itself, sizes must match
+void Polygon::copy_from(const Polygon& p) {
+	assert(size == p.size);
+	if(verts != p.verts) {
 		for (int i = 0; i < size; ++i) {
-			verts[i] = other.verts[i];
-			norms[i] = other.norms[i];
-			edges[i] = other.edges[i];
+			verts[i] = p.verts[i];
+			norms[i] = p.norms[i];
+			edges[i] = p.edges[i];
 		}
-		copyv(facetnorm, other.facetnorm);
-		copyv(center, other.center);
-		actual_verts = other.actual_verts;
-		actual_norms = other.actual_norms;
 	}
-	return *this;
+	copyv(facetnorm, p.facetnorm);
+	copyv(center, p.center);
+	actual_verts = p.actual_verts;
+	actual_norms = p.actual_norms;
+	max_side_length = p.max_side_length;
+	precomputed = p.precomputed;
+	id = p.id;
 }
 
-Polygon::~Polygon() {
-	delete [] verts;
-	delete [] norms;
-	delete [] edges;
+// steal p's heap arrays, p is left with size 0
+void Polygon::take_indices(Polygon& p) {
+	verts = p.verts;
+	norms = p.norms;
+	edges = p.edges;
+	arena_storage = false;
+	copy_from(p);
+	p.verts = p.norms = NULL;
+	p.edges = NULL;
+	p.size = 0;
 }
 
 void Polygon::set_edges() {
@@ -185,11 +283,16 @@ void Polygon::set_facetnorm(GLint *vertices) {
 		v1 = actual_verts[vertices[1]];
 		v2 = actual_verts[vertices[2]];
 	}
-	Vec vec1 =  Vec(v1) - Vec(v0);
-	Vec vec2 =  Vec(v2) - Vec(v1);
-	Vec n = vec1.cross(vec2);
-	n.normalize();
-	n.array_out(facetnorm);
+	using namespace linalg;
+	const Vec3f &p0 = as_vec3(v0), &p1 = as_vec3(v1), &p2 = as_vec3(v2);
+	as_vec3(facetnorm) = normalized(cross(p1 - p0, p2 - p1));
+}
+
+void Polygon::bake_transform(const linalg::Mat4f& m, const linalg::Mat4f& nm) {
+	using namespace linalg;
+	as_vec3(center) = m.transform_point(as_vec3(center));
+	as_vec3(facetnorm) = normalized(nm.transform_dir(as_vec3(facetnorm)));
+	set_edges();
 }
 
 /**
@@ -382,7 +485,7 @@ void Polygon::get_actual_verts(vector<Vec>& out) const {
 // at this point == compares verts and norms by index
 // not by actual vertex or normal contents
 bool Polygon::operator==(const Polygon& other) const {
-
+	if(size != other.size) return false;
 	for (int i = 0; i < size; ++i) {
 		if(verts[i] != other.verts[i]) return false;
 		if(norms[i] != other.norms[i]) return false;
@@ -396,14 +499,12 @@ bool PolygonCompare::operator()(const Polygon *lhs, const Polygon *rhs) const {
 		return (lhs->size < rhs->size);
 	}
 	for (int i = 0; i < lhs->size; ++i) {
-		if(lhs->verts[i] < rhs->verts[i]) {
-			return true;
+		if(lhs->verts[i] != rhs->verts[i]) {
+			return lhs->verts[i] < rhs->verts[i];
 		}
 	}
 	Vec3Compare vec3less;
-	if( vec3less(lhs->facetnorm, rhs->facetnorm) ) {
-		return true;
-	}
+	return vec3less(lhs->facetnorm, rhs->facetnorm);
 }
 
 /**
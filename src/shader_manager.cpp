@@ -0,0 +1,331 @@
+/*
+ * shader_manager.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "shader_manager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace std;
+using namespace DR;
+
+// first word after leading blanks, and where the rest of the line starts
+static string first_word(const string& line, size_t& rest) {
+	size_t start = line.find_first_not_of(" \t");
+	if(start == string::npos) {
+		rest = line.size();
+		return "";
+	}
+	size_t end = line.find_first_of(" \t", start);
+	rest = end == string::npos ? line.size() : end;
+	return line.substr(start, rest - start);
+}
+
+string DR::specialize_shader(const string& src, const ShaderDefines& defines) {
+	vector<string> lines;
+	istringstream in(src);
+	string line;
+	while(getline(in, line)) {
+		line.erase(remove(line.begin(), line.end(), '\r'), line.end());
+		lines.push_back(line);
+	}
+	vector<bool> used(defines.size(), false);
+	// after the #version line, which has to come first
+	size_t insert_at = 0;
+	for (size_t i = 0; i < lines.size(); ++i) {
+		size_t rest;
+		string word = first_word(lines[i], rest);
+		if(word == "#version") {
+			insert_at = i + 1;
+		}
+		if(word != "#define") {
+			continue;
+		}
+		string tail = lines[i].substr(rest);
+		string name = first_word(tail, rest);
+		for (size_t d = 0; d < defines.size(); ++d) {
+			if(defines[d].first == name) {
+				lines[i] = "#define " + name + " " + defines[d].second;
+				used[d] = true;
+			}
+		}
+	}
+	vector<string> added;
+	for (size_t d = 0; d < defines.size(); ++d) {
+		if(!used[d]) {
+			added.push_back("#define " + defines[d].first + " " + defines[d].second);
+		}
+	}
+	lines.insert(lines.begin() + insert_at, added.begin(), added.end());
+	string out;
+	for (size_t i = 0; i < lines.size(); ++i) {
+		out += lines[i];
+		out += '\n';
+	}
+	return out;
+}
+
+unsigned long long DR::fnv1a(const string& s, unsigned long long seed) {
+	unsigned long long h = seed;
+	for (size_t i = 0; i < s.size(); ++i) {
+		h ^= (unsigned char)s[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+unsigned long long DR::shader_program_key(const string& vert, const string& frag, const string& driver) {
+	// lengths between, so moving text from one to the other changes the key
+	ostringstream sizes;
+	sizes << vert.size() << "," << frag.size() << "," << driver.size();
+	unsigned long long h = fnv1a(sizes.str());
+	h = fnv1a(vert, h);
+	h = fnv1a(frag, h);
+	return fnv1a(driver, h);
+}
+
+static const char BINARY_MAGIC[4] = { 'D', 'R', 'P', 'B' };
+static const unsigned int BINARY_VERSION = 1;
+
+bool DR::write_program_binary(const string& path, GLenum format, const vector<char>& binary) {
+	ofstream out(path.c_str(), ios_base::binary);
+	unsigned int header[3] = { BINARY_VERSION, (unsigned int)format, (unsigned int)binary.size() };
+	out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	out.write((const char*)header, sizeof(header));
+	if(!binary.empty()) {
+		out.write(&binary[0], binary.size());
+	}
+	return out.good();
+}
+
+bool DR::read_program_binary(const string& path, GLenum& format, vector<char>& binary) {
+	ifstream in(path.c_str(), ios_base::binary);
+	char magic[4];
+	unsigned int header[3];
+	if(!in.read(magic, sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0
+			|| !in.read((char*)header, sizeof(header)) || header[0] != BINARY_VERSION || header[2] == 0) {
+		return false;
+	}
+	binary.resize(header[2]);
+	if(!in.read(&binary[0], binary.size()) || in.peek() != EOF) {
+		return false;
+	}
+	format = header[1];
+	return true;
+}
+
+ShaderManager::ShaderManager(const string& cache_dir)
+: cache_dir(cache_dir), loaded(0), compiled(0) {
+}
+
+ShaderManager::~ShaderManager() {
+	for (map<unsigned long long, GLuint>::iterator it = programs.begin(); it != programs.end(); ++it) {
+		glDeleteProgram(it->second);
+	}
+}
+
+bool ShaderManager::read_file(const string& path, string& out) {
+	ifstream in(path.c_str());
+	if(!in) {
+		return false;
+	}
+	ostringstream ss;
+	ss << in.rdbuf();
+	out = ss.str();
+	return true;
+}
+
+bool ShaderManager::binaries_supported() {
+	if(!GLEW_ARB_get_program_binary) {
+		return false;
+	}
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+GLuint ShaderManager::program(const string& vert_file, const string& frag_file,
+		const ShaderDefines& defines) {
+	string vert, frag;
+	if(!read_file(vert_file, vert) || !read_file(frag_file, frag)) {
+		cerr << "ShaderManager: can't read " << vert_file << " or " << frag_file << endl;
+		return 0;
+	}
+	vert = specialize_shader(vert, defines);
+	frag = specialize_shader(frag, defines);
+	string driver;
+	GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (int i = 0; i < 3; ++i) {
+		const char *s = (const char*)glGetString(names[i]);
+		driver += s ? s : "";
+		driver += '\n';
+	}
+	unsigned long long key = shader_program_key(vert, frag, driver);
+	map<unsigned long long, GLuint>::iterator it = programs.find(key);
+	if(it != programs.end()) {
+		return it->second;
+	}
+	bool binaries = !cache_dir.empty() && binaries_supported();
+	char name[32];
+	sprintf(name, "%016llx.bin", key);
+	string path = cache_dir + name;
+	GLuint prog = binaries ? load_binary(path) : 0;
+	if(prog) {
+		++loaded;
+	} else {
+		prog = compile(vert, frag, binaries);
+		if(!prog) {
+			return 0;
+		}
+		++compiled;
+		if(binaries) {
+			save_binary(prog, path);
+		}
+	}
+	programs[key] = prog;
+	return prog;
+}
+
+GLuint ShaderManager::load_binary(const string& path) {
+	GLenum format;
+	vector<char> binary;
+	if(!read_program_binary(path, format, binary)) {
+		return 0;
+	}
+	GLuint prog = glCreateProgram();
+	glProgramBinary(prog, format, &binary[0], binary.size());
+	GLint status = 0;
+	glGetProgramiv(prog, GL_LINK_STATUS, &status);
+	if(!status) {
+		// driver changed under the same name, compile again
+		glDeleteProgram(prog);
+		return 0;
+	}
+	return prog;
+}
+
+GLuint ShaderManager::compile(const string& vert, const string& frag, bool retrievable) {
+	GLuint shaders[2] = { glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER) };
+	const char *srcs[2] = { vert.c_str(), frag.c_str() };
+	GLuint prog = glCreateProgram();
+	for (int i = 0; i < 2; ++i) {
+		glShaderSource(shaders[i], 1, &srcs[i], NULL);
+		compile_shader(shaders[i]);
+		glAttachShader(prog, shaders[i]);
+	}
+	if(retrievable) {
+		glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(prog);
+	for (int i = 0; i < 2; ++i) {
+		glDetachShader(prog, shaders[i]);
+		glDeleteShader(shaders[i]);
+	}
+	GLint status = 0;
+	glGetProgramiv(prog, GL_LINK_STATUS, &status);
+	if(!status) {
+		cout << "Shader link error.." << endl;
+		print_program_info_log(prog);
+		glDeleteProgram(prog);
+		return 0;
+	}
+	return prog;
+}
+
+void ShaderManager::save_binary(GLuint prog, const string& path) {
+	GLint length = 0;
+	glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &length);
+	if(length <= 0) {
+		return;
+	}
+	vector<char> binary(length);
+	GLenum format;
+	glGetProgramBinary(prog, length, NULL, &format, &binary[0]);
+	mkdir(cache_dir.c_str(), 0755);
+	if(!write_program_binary(path, format, binary)) {
+		cerr << "ShaderManager: couldn't save " << path << endl;
+	}
+}
+
+int ShaderManager::resolve(GLuint program, const ShaderBinding *bindings, size_t n) {
+	int missing = 0;
+	for (size_t i = 0; i < n; ++i) {
+		const ShaderBinding& b = bindings[i];
+		*b.location = b.attribute ? glGetAttribLocation(program, b.name) : glGetUniformLocation(program, b.name);
+		if(*b.location < 0) {
+			cout << "ShaderManager: program " << program << " has no " << (b.attribute ? "attribute " : "uniform ")
+					<< b.name << endl;
+			++missing;
+		}
+	}
+	return missing;
+}
+
+void ShaderManager::test() {
+	cout <<  "\n******************** ShaderManager::test() **************************" << endl;
+	string src = "#version 120\r\n// lights\r\n#define MAX_LIGHTS 8\r\n  #define NUM_LIGHTS 2\r\nvoid main() {}\r\n";
+	ShaderDefines defines;
+	defines.push_back(make_pair(string("NUM_LIGHTS"), string("3")));
+	defines.push_back(make_pair(string("SHADOWS"), string("1")));
+	string got = specialize_shader(src, defines);
+	string want = "#version 120\n#define SHADOWS 1\n// lights\n#define MAX_LIGHTS 8\n#define NUM_LIGHTS 3\nvoid main() {}\n";
+	if(got != want) {
+		cout << "!=: specialized\n" << got << "want\n" << want << endl;
+	}
+	// no #version, added defines go first
+	got = specialize_shader("void main() {}", defines);
+	if(got != "#define NUM_LIGHTS 3\n#define SHADOWS 1\nvoid main() {}\n") {
+		cout << "!=: specialized without #version\n" << got << endl;
+	}
+	// same with either line ending, and the shader shipped with the app
+	ifstream vp("shaders/lighting.vp");
+	ostringstream ss;
+	ss << vp.rdbuf();
+	string lights = specialize_shader(ss.str(), ShaderDefines(1, make_pair(string("NUM_LIGHTS"), string("4"))));
+	if(lights.find("#define NUM_LIGHTS 4\n") == string::npos || lights.find("NUM_LIGHTS 2") != string::npos) {
+		cout << "!=: lighting.vp NUM_LIGHTS not 4" << endl;
+	}
+
+	unsigned long long k = shader_program_key(want, "f", "driver");
+	if(k != shader_program_key(specialize_shader(src, defines), "f", "driver")
+			|| k == shader_program_key(want, "f", "other driver")
+			|| k == shader_program_key(specialize_shader(src, ShaderDefines()), "f", "driver")
+			|| shader_program_key("ab", "c", "") == shader_program_key("a", "bc", "")) {
+		cout << "!=: program keys" << endl;
+	}
+	// published FNV-1a values
+	if(fnv1a("") != 14695981039346656037ULL || fnv1a("a") != 0xaf63dc4c8601ec8cULL) {
+		cout << "!=: fnv1a(\"a\") " << hex << fnv1a("a") << dec << endl;
+	}
+
+	string path = "/tmp/shader_manager_test.bin";
+	vector<char> binary(1000);
+	for (size_t i = 0; i < binary.size(); ++i) {
+		binary[i] = (char)(i * 7);
+	}
+	GLenum format = 0;
+	vector<char> back;
+	if(!write_program_binary(path, 0x1234, binary) || !read_program_binary(path, format, back)
+			|| format != 0x1234 || back != binary) {
+		cout << "!=: program binary round trip" << endl;
+	}
+	// cut short
+	{
+		ofstream out(path.c_str(), ios_base::binary);
+		out.write("DRPB", 4);
+	}
+	if(read_program_binary(path, format, back) || read_program_binary("/tmp/no_such_binary.bin", format, back)) {
+		cout << "!=: read a truncated or missing binary" << endl;
+	}
+	remove(path.c_str());
+	cout << "\n***************** Done:  ShaderManager::test() ***********************" << endl;
+}
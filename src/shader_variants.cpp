@@ -0,0 +1,212 @@
+/*
+ * shader_variants.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "shader_variants.h"
+#include "uniform_blocks.h"
+
+#include <set>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+using namespace DR;
+
+static bool is_black(const GLfloat *color) {
+	return color[0] == 0 && color[1] == 0 && color[2] == 0;
+}
+
+// variants that compile the same made equal, so they share a program
+static ShaderVariant canonical(const ShaderVariant& v) {
+	ShaderVariant c = v;
+	if(c.wireframe) {
+		c.num_lights = 0;
+		c.uniform_blocks = false;
+	}
+	if(c.num_lights == 0) {
+		c.per_pixel = c.specular = false;
+	}
+	return c;
+}
+
+ShaderVariant ShaderVariant::lit(const vector<const GLlight*>& lights,
+		const GLfloat *material_specular, bool per_pixel, bool fog, bool uniform_blocks) {
+	ShaderVariant v;
+	v.num_lights = min((int)lights.size(), MAX_LIGHTS);
+	v.per_pixel = per_pixel;
+	v.fog = fog;
+	v.uniform_blocks = uniform_blocks;
+	v.specular = false;
+	if(material_specular != NULL && !is_black(material_specular)) {
+		for (int i = 0; i < v.num_lights; ++i) {
+			v.specular = v.specular || !is_black(lights[i]->specular);
+		}
+	}
+	return v;
+}
+
+ShaderVariant ShaderVariant::wire(bool fog) {
+	ShaderVariant v;
+	v.wireframe = true;
+	v.fog = fog;
+	return v;
+}
+
+ShaderDefines ShaderVariant::defines() const {
+	ShaderVariant c = canonical(*this);
+	ShaderDefines d;
+	ostringstream n;
+	n << c.num_lights;
+	d.push_back(make_pair(string("NUM_LIGHTS"), n.str()));
+	d.push_back(make_pair(string("PER_PIXEL"), string(c.per_pixel ? "1" : "0")));
+	d.push_back(make_pair(string("SPECULAR"), string(c.specular ? "1" : "0")));
+	d.push_back(make_pair(string("FOG"), string(c.fog ? "1" : "0")));
+	d.push_back(make_pair(string("WIREFRAME"), string(c.wireframe ? "1" : "0")));
+	d.push_back(make_pair(string("UNIFORM_BLOCKS"), string(c.uniform_blocks ? "1" : "0")));
+	return d;
+}
+
+int ShaderVariant::key() const {
+	ShaderVariant c = canonical(*this);
+	return c.num_lights | c.per_pixel << 4 | c.specular << 5 | c.fog << 6 | c.wireframe << 7
+			| c.uniform_blocks << 8;
+}
+
+string ShaderVariant::name() const {
+	ShaderVariant c = canonical(*this);
+	ostringstream s;
+	if(c.wireframe) {
+		s << "wireframe";
+	} else {
+		s << c.num_lights << " lights" << (c.per_pixel ? " per pixel" : " per vertex");
+		if(c.specular) {
+			s << " specular";
+		}
+	}
+	if(c.fog) {
+		s << " fog";
+	}
+	if(c.uniform_blocks) {
+		s << " blocks";
+	}
+	return s.str();
+}
+
+GLuint LightingShaders::use(const ShaderVariant& variant) {
+	int key = variant.key();
+	map<int, GLuint>::iterator it = programs.find(key);
+	if(it == programs.end()) {
+		GLuint prog = shaders.program(vert_file, frag_file, variant.defines());
+		if(!prog) {
+			cerr << "LightingShaders: no program for " << variant.name() << ", using fixed pipeline" << endl;
+		} else if(variant.uniform_blocks) {
+			bind_uniform_blocks(prog);
+		}
+		it = programs.insert(make_pair(key, prog)).first;
+	}
+	bind(it->second);
+	return it->second;
+}
+
+void LightingShaders::release() {
+	bind(0);
+}
+
+void LightingShaders::bind(GLuint program) {
+	if(program == bound) {
+		return;
+	}
+	glUseProgram(program);
+	bound = program;
+	++switches;
+}
+
+void LightingShaders::test() {
+	cout <<  "\n******************** LightingShaders::test() **************************" << endl;
+	GLlight l0, l1;
+	setv(l0.specular, 1, 1, 1, 1);
+	setv(l1.specular, 0, 0, 0, 1);
+	vector<const GLlight*> lights;
+	lights.push_back(&l0);
+	lights.push_back(&l1);
+	vec4 shiny = {0.5, 0.5, 0.5, 1};
+	vec4 matte = {0, 0, 0, 1};
+
+	ShaderVariant v = ShaderVariant::lit(lights, shiny, true, false);
+	if(v.num_lights != 2 || !v.per_pixel || !v.specular || v.fog || v.wireframe) {
+		cout << "!=: lit variant " << v.name() << endl;
+	}
+	if(ShaderVariant::lit(lights, matte, true, false).specular
+			|| ShaderVariant::lit(lights, NULL, true, false).specular) {
+		cout << "!=: specular variant for a matte material" << endl;
+	}
+	// only the dark light
+	vector<const GLlight*> dark(1, &l1);
+	if(ShaderVariant::lit(dark, shiny, true, false).specular) {
+		cout << "!=: specular variant with dark lights" << endl;
+	}
+	vector<const GLlight*> many(20, &l0);
+	if(ShaderVariant::lit(many, shiny, false, false).num_lights != ShaderVariant::MAX_LIGHTS) {
+		cout << "!=: lights past MAX_LIGHTS" << endl;
+	}
+	if(v.name() != "2 lights per pixel specular" || ShaderVariant::wire(true).name() != "wireframe fog") {
+		cout << "!=: names " << v.name() << ", " << ShaderVariant::wire(true).name() << endl;
+	}
+
+	// every variant that compiles differently has its own key
+	set<int> keys;
+	set<string> sources;
+	int variants = 0;
+	for (int n = 0; n <= ShaderVariant::MAX_LIGHTS; ++n) {
+		for (int bits = 0; bits < 16; ++bits) {
+			ShaderVariant s;
+			s.num_lights = n;
+			s.per_pixel = bits & 1;
+			s.specular = (bits & 2) != 0;
+			s.fog = (bits & 4) != 0;
+			s.uniform_blocks = (bits & 8) != 0;
+			keys.insert(s.key());
+			ShaderDefines d = s.defines();
+			string src;
+			for (size_t i = 0; i < d.size(); ++i) {
+				src += d[i].first + "=" + d[i].second + ";";
+			}
+			sources.insert(src);
+			++variants;
+		}
+	}
+	keys.insert(ShaderVariant::wire(false).key());
+	keys.insert(ShaderVariant::wire(true).key());
+	// 0 lights ignore per pixel and specular, wireframe all but fog
+	size_t distinct = ShaderVariant::MAX_LIGHTS * 16 + 4 + 2;
+	if(keys.size() != distinct || sources.size() != distinct - 2) {
+		cout << "!=: " << keys.size() << " keys and " << sources.size() << " sources for "
+				<< variants << " variants, want " << distinct << endl;
+	}
+	ShaderVariant w = ShaderVariant::wire(false);
+	w.num_lights = 3;
+	if(w.key() != ShaderVariant::wire(false).key()) {
+		cout << "!=: wireframe key depends on lights" << endl;
+	}
+
+	// the shipped source takes the defines
+	ifstream in("shaders/lighting.vp");
+	ostringstream ss;
+	ss << in.rdbuf();
+	ShaderVariant pv = ShaderVariant::lit(vector<const GLlight*>(3, &l0), shiny, false, true);
+	string src = specialize_shader(ss.str(), pv.defines());
+	const char *want[] = { "#define NUM_LIGHTS 3\n", "#define PER_PIXEL 0\n", "#define SPECULAR 1\n",
+			"#define FOG 1\n", "#define WIREFRAME 0\n", "#define UNIFORM_BLOCKS 0\n" };
+	for (int i = 0; i < 6; ++i) {
+		if(src.find(want[i]) == string::npos) {
+			cout << "!=: lighting.vp missing " << want[i];
+		}
+	}
+	if(src.find("NUM_LIGHTS 2") != string::npos || src.find("PER_PIXEL 1") != string::npos) {
+		cout << "!=: lighting.vp kept a default define" << endl;
+	}
+	cout << "\n***************** Done:  LightingShaders::test() ***********************" << endl;
+}
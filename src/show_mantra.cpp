@@ -18,6 +18,7 @@
 #include "cylinder_model.h"
 #include "particles.h"
 #include "test.h"
+#include "alloc_stats.h"
 
 
 #include <cstdio>
@@ -53,10 +54,14 @@ PolyTest polytest;
  */
 void test_display();
 
+const char *ShowMantraApp::LIGHTING_VP = "shaders/lighting.vp";
+const char *ShowMantraApp::LIGHTING_FP = "shaders/lighting.fp";
+
 ShowMantraApp::ShowMantraApp(int window_width, int window_height,
 		int glut_button, int glut_modifier)
 : GlutTrackballApp(window_width, window_height,
-		glut_button, glut_modifier), NUM_SYLLS(6) {
+		glut_button, glut_modifier), NUM_SYLLS(6),
+		lighting(shaders, LIGHTING_VP, LIGHTING_FP), hud(hud_font) {
 	// set up light0 and light1
 	light0.id = GL_LIGHT0;
 	setv(light0.pos, 0.0f, 0.0f, 15.0f, 0.0f);
@@ -73,11 +78,14 @@ ShowMantraApp::ShowMantraApp(int window_width, int window_height,
 	setv(light1.ambient, 0.15f, 0.15f, 0.15f, 1.0f);
 	setv(light1.diffuse, 0.35f, 0.35f, 0.35f, 1.0f);
 	setv(light1.specular, 1.0, 1.0, 1.0, 1.0f);
+	lights_on.push_back(&light0);
+	lights_on.push_back(&light1);
 //	setv(light1.ambient, 0.3f, 0.3f, 0.3f, 1.0f);
 //	setv(light1.diffuse, 0.7f, 0.7f, 0.7f, 1.0f);
 //	setv(light1.specular, 1.0, 1.0, 1.0, 1.0f);
 
 	output_file = "show_mantra_glinfo.txt";
+	frame_stats_file = "show_mantra_frames";
 
 	wireframe = false;
 	render_debug = false;
@@ -97,6 +105,10 @@ ShowMantraApp::ShowMantraApp(int window_width, int window_height,
 	show_facet_norms = true;
 	show_vert_norms = false;
 
+	bake_placements = true;
+	use_lods = true;
+	use_culling = true;
+
 	syllnames.push_back("pay");
 	syllnames.push_back("ni");
 	syllnames.push_back("ma");
@@ -112,7 +124,15 @@ ShowMantraApp::ShowMantraApp(int window_width, int window_height,
 	LightBeamSet beams;
 	beam_ct = 0;
 	shader_on = false;
+	per_pixel_lighting = true;
+	use_fog = false;
+	use_uniform_blocks = false;
+	for (int i = 0; i < 16; ++i) {
+		light_view[i] = i % 5 == 0 ? 1 : 0;
+	}
 	debug = false;
+	uploads_per_frame = 4;
+	seed_job = lotus_moon_job = NULL;
 
 	glm_lotus_moon = NULL;
 	// lotus moon color
@@ -135,18 +155,31 @@ void ShowMantraApp::toggle_normal_display(bool& normal_flag) {
 	} else if(app.use_single_syll) {
 		// implement if desired
 	} else {
-		hrih->show_normals = app.show_normals;
-		hrih->show_facet_norms = app.show_facet_norms;
-		hrih->show_vert_norms = app.show_vert_norms;
-		for (size_t i = 0; i < syllables.size(); ++i) {
-			syllables[i]->show_normals = app.show_normals;
-			syllables[i]->show_facet_norms = app.show_facet_norms;
-			syllables[i]->show_vert_norms = app.show_vert_norms;
-		}
-		lotus_moon.show_normals = app.show_normals;
-		lotus_moon.show_facet_norms = app.show_facet_norms;
-		lotus_moon.show_vert_norms = app.show_vert_norms;
+		// those still loading get them from pump_loading() once ready
+		apply_normal_display();
+	}
+}
+
+// copy the app's normal flags to model
+template<class Model>
+static void set_normal_display(Model& model, const ShowMantraApp& from) {
+	model.show_normals = from.show_normals;
+	model.show_facet_norms = from.show_facet_norms;
+	model.show_vert_norms = from.show_vert_norms;
+}
 
+void ShowMantraApp::apply_normal_display() {
+	// the loader's threads are done with what's ready
+	if(seed_job && seed_job->ready()) {
+		set_normal_display(*hrih, *this);
+	}
+	for (size_t i = 0; i < syllables.size(); ++i) {
+		if(syllables[i]) {
+			set_normal_display(*syllables[i], *this);
+		}
+	}
+	if(lotus_moon_job && lotus_moon_job->ready()) {
+		set_normal_display(lotus_moon, *this);
 	}
 }
 
@@ -167,83 +200,60 @@ void ShowMantraApp::heads_up_display(bool show_keys, bool show_particles,
 	GLfloat line_height = .45;
 	GLfloat right_start = 7.0;
 	GLint numlines = (int)floor(height / line_height);
-
-	glPushMatrix();
-	glLoadIdentity();
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-
-//	if(frame % 150 == 0) {
-//		cout << "shader_on = " << shader_on << endl;
-//	}
-	glDisable(GL_LIGHTING);
-	// disable shader
-	if(shader_on) {
-		glUseProgram(0);
+	// those in window pixels, text is laid out again only if they change
+	GLfloat sx = win_width / width, sy = win_height / height;
+	GLfloat left = margin * sx, right = (margin + right_start) * sx;
+	GLfloat top = (height - (margin + line_height)) * sy;
+	GLfloat line = line_height * sy;
+
+	// keybinding display
+	if(show_keys) {
+		const std::vector<const char*> *sides[] = { &app.keybindings, &app.keybindings_right_side };
+		for (int k = 0; k < 2; ++k) {
+			hud_keys[k].clear();
+			for (size_t i = 0; i < sides[k]->size(); ++i) {
+				hud_keys[k] += (*sides[k])[i];
+				hud_keys[k] += '\n';
+			}
+		}
+		hud.set_text(HUD_KEYS, left, top, hud_keys[0], NULL, line);
+		hud.set_text(HUD_KEYS_RIGHT, right, top, hud_keys[1], NULL, line);
+		hud.set_text(HUD_ANNOUNCE, left, top, "");
+	} else {
+		hud.set_text(HUD_KEYS, left, top, "");
+		hud.set_text(HUD_KEYS_RIGHT, right, top, "");
+		string announce = app.headsup_announce;
+		if(loading()) {
+			char progress[80];
+			sprintf(progress, "\nLoading: %d of %d", (int)loader.num_done(), (int)loader.num_jobs());
+			announce += progress;
+		}
+		hud.set_text(HUD_ANNOUNCE, left, top, announce, NULL, line);
 	}
-	// disable lighting in shader
-//	glUniform1i(loc_disable_lighting, 1);
-	glDisable(GL_DEPTH_TEST);
-    glLineWidth(3);
-    glColor3f(1.0, 1.0, 1.0);
-
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    gluOrtho2D(0, width, 0, height);
-    glTranslatef(margin, height-(margin+line_height), 0);
-
-    glMatrixMode(GL_MODELVIEW);
-    // keybinding display
-    if(show_keys) {
-    	// left side
-    	for(size_t i=0; i<app.keybindings.size(); i++) {
-    		bitmap_output(0, (-line_height)*i, app.keybindings[i],
-    				GLUT_BITMAP_TIMES_ROMAN_24);
-    	}
-    	// right side
-    	for(size_t i=0; i<app.keybindings_right_side.size(); i++) {
-    		bitmap_output(right_start, (-line_height)*i, app.keybindings_right_side[i],
-    				GLUT_BITMAP_TIMES_ROMAN_24);
-    	}
-
-    } else {
-    	bitmap_output(0, 0, app.headsup_announce.c_str(),
-    			GLUT_BITMAP_TIMES_ROMAN_24);
-    }
-    // particle/beam count and framerate
-    if(show_particles) {
-    	// either show particles or beams for now - occupy same text space
-    	if(app.show_particle_ct) {
-    		char plabel[40];
-    		sprintf(plabel, "Particles: %d", particle_ct);
-    		bitmap_output(right_start, (-line_height)*(numlines-4), plabel,
-    				GLUT_BITMAP_TIMES_ROMAN_24);
-    	} else if(app.show_beam_ct) {
-    		char blabel[40];
-    		sprintf(blabel, "Beams: %d", beam_ct);
-    		bitmap_output(right_start, (-line_height)*(numlines-4), blabel,
-    				GLUT_BITMAP_TIMES_ROMAN_24);
-    	}
-    }
-    if(show_framerate) {
-    	char flabel[40];
-    	sprintf(flabel, "Framerate: %.2f", app.framerate);
-    	bitmap_output(right_start, (-line_height)*(numlines-3), flabel,
-    			GLUT_BITMAP_TIMES_ROMAN_24);
-    }
-
-    if(shader_on) {
-    	// reenable shader
-    	glUseProgram(shader_prog);
-    }
-	// reenable lighting in shader
-//	glUniform1i(loc_disable_lighting, 0);
-//	glEnable(GL_LIGHTING);
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
-	glPopAttrib();
-	glMatrixMode(GL_MODELVIEW);
-	glPopMatrix();
+	// particle/beam count and framerate
+	// either show particles or beams for now - occupy same text space
+	char label[80] = "";
+	if(show_particles && app.show_particle_ct) {
+		sprintf(label, "Particles: %d", particle_ct);
+	} else if(show_particles && app.show_beam_ct) {
+		sprintf(label, "Beams: %d", beam_ct);
+	}
+	hud.set_text(HUD_COUNT, right, top - line * (numlines-4), label);
+	label[0] = '\0';
+	if(show_framerate) {
+		sprintf(label, "Framerate: %.2f", app.framerate);
+	}
+	hud.set_text(HUD_FRAMERATE, right, top - line * (numlines-3), label);
+	label[0] = '\0';
+	if(show_framerate && app.use_culling) {
+		sprintf(label, "Drawn: %d/%d polys, %d/%d objects",
+				(int)cull_stats.polygons_drawn, (int)cull_stats.polygons,
+				(int)(cull_stats.objects - cull_stats.objects_culled), (int)cull_stats.objects);
+	}
+	hud.set_text(HUD_CULLED, right - 3 * sx, top - line * (numlines-2), label);
+
+	use_fixed_pipeline();
+	hud.draw(win_width, win_height);
 }
 
 // apply tweaks to 2d unit space for each syllable
@@ -284,7 +294,7 @@ void ShowMantraApp::tweak_2d(GLint syll_index, UnitSpace2D& syll_space) { // { "
 /**
  * initialize the lotus flower and moon seat below mantra
  */
-void ShowMantraApp::init_lotus_moon() {
+void ShowMantraApp::build_lotus_moon() {
 	char lotus_moon_obj[80] = "data/lotus_moon_seat.obj";
 	glm_lotus_moon = glmReadOBJ(lotus_moon_obj);
 //	glmUnitize(lotus_seat_model);
@@ -300,7 +310,47 @@ void ShowMantraApp::init_lotus_moon() {
 	// set length to draw normals for the lotus moon
 	// (default is too long because of huge triangles in model)
 	lotus_moon.draw_normals_length = .1;
+	if(bake_placements) {
+		lotus_moon.bake_transform(lotus_placement());
+	}
+	lotus_moon.build_lods();
+	lotus_moon.build_meshlets();
+	lotus_moon.build_buffers();
+}
+
+DR::linalg::Mat4f ShowMantraApp::lotus_placement() {
+	using DR::linalg::Mat4f;
+	return Mat4f::translate(0.0, -2.5, 0.0) * Mat4f::rotate(30, 0, 1, 0) *
+			Mat4f::scale(1.6, 1.6, 1.6);
+}
+
+DR::linalg::Mat4f ShowMantraApp::seed_placement() {
+	using DR::linalg::Mat4f;
+//	Mat4f::translate(0.25, 0.2, 0.0) // orig
+	return Mat4f::rotate(90, 1, 0, 0) * Mat4f::translate(0.25, 0.2, -0.5) *
+			Mat4f::rotate(-30, 0, 0, 1) * Mat4f::scale(2.5, 2.5, 2.5);
+}
+// pick model's level of detail by its size on screen, under the current modelview
+template<class Model>
+static void pick_lod(Model& model, bool use_lods) {
+	if(!use_lods) {
+		model.set_lod(0);
+		return;
+	}
+	vec3 c;
+	model.get_center(c);
+	model.select_lod(DR::pixels_per_unit(c));
+}
+
+void ShowMantraApp::cull_syllable(Syllable3D *syll) {
+	if(!use_culling) {
+		syll->clear_cull();
+		return;
+	}
+	// back faces show through in wireframe
+	syll->cull(Frustum::from_gl(), eye_position(), !wireframe, cull_stats);
 }
+
 /**
  * render the lotus flower and moon seat below mantra
  */
@@ -308,19 +358,22 @@ void ShowMantraApp::draw_lotus_moon() {
 	glPushAttrib(GL_ENABLE_BIT);
 	glEnable(GL_NORMALIZE);
 	glPushMatrix();
-	glTranslatef(0.0, -2.5, 0.0);
-	glRotatef(30, 0, 1, 0);
-	glScalef(1.6, 1.6, 1.6);
+	if(!bake_placements) {
+		glMultMatrixf(lotus_placement().data());
+	}
+	pick_lod(lotus_moon, use_lods);
+	if(use_culling) {
+		lotus_moon.cull(Frustum::from_gl(), cull_stats);
+	} else {
+		lotus_moon.clear_cull();
+	}
 
 	if(wireframe) {
-		GLint curr_prog;
-		glGetIntegerv(GL_CURRENT_PROGRAM, &curr_prog);
-		glUseProgram(0);
-		lotus_moon.render(wireframe);
-		glUseProgram(curr_prog);
+		use_wire_shader();
 	} else {
-		lotus_moon.render(wireframe);
+		use_lit_shader(lotus_moon.specular);
 	}
+	lotus_moon.render(wireframe);
 
 	glPopAttrib();
 	glPopMatrix();
@@ -375,15 +428,51 @@ void ShowMantraApp::init_syllable(const char *name, Syllable3D* &syll) {
 	syll->extrude(0.2, true);
 }
 
-// initialize the syllables, transforming the mantra syllables
-// with a cylinder model
-void ShowMantraApp::init_syllables() {
-	if(!syllables.empty() ) {
-		for (size_t i = 0; i < syllables.size(); ++i) {
-			delete syllables[i];
+namespace {
+/**
+ * A step of ShowMantraApp::load_models(), on a loader thread, then the
+ * buffer uploads of the syllable or model it finishes, if any.
+ */
+class ModelJob : public DR::LoadJob {
+public:
+	enum Step { SEED, BASE, CYLINDER, ON_CYLINDER, LOTUS_MOON };
+	ModelJob(const string& name, ShowMantraApp& app, Step step, size_t index=0,
+			Syllable3D *syll=NULL, DR::DrGlmModel *model=NULL)
+	: LoadJob(name), app(app), step(step), index(index), syll(syll), model(model) {}
+
+	bool load() {
+		switch (step) {
+		case SEED: app.build_seed_syllable(syll); break;
+		case BASE: app.build_syllable_base(index, syll); break;
+		case CYLINDER: app.map_bases_to_cylinder(app.mantra, app.do_2d_tweak); break;
+		case ON_CYLINDER: app.build_on_cylinder(index, syll); break;
+		case LOTUS_MOON: app.build_lotus_moon(); break;
+		}
+		return true;
+	}
+	bool upload(int& budget) {
+		if(step == BASE || step == CYLINDER) {
+			return true;
 		}
-		syllables.clear();
+		return syll ? syll->upload_buffers(budget) : model->upload_buffers(budget);
 	}
+
+private:
+	ShowMantraApp& app;
+	Step step;
+	size_t index;
+	Syllable3D *syll;
+	DR::DrGlmModel *model;
+};
+}
+
+/**
+ * The seed syllable, and each mantra syllable's base in parallel, then
+ * the bases mapped to the cylinder together, then each extruded in
+ * parallel.  The lotus moon alongside.
+ */
+void ShowMantraApp::load_models() {
+	load_time.reset();
 	// adjustable colors for syllables
 	vec3 white, green, yellow, blue, red, black;
 	GLfloat *colors[] = {blue, yellow, green, white, black, red};
@@ -395,40 +484,29 @@ void ShowMantraApp::init_syllables() {
 	setv(black, .114, .047, .071);  // 0.0, 0.0, 0.0);
 
 	// seed syllable is not part of the cylinder
-	delete hrih;
 	hrih = new AnimatedSyllable3D();
 	copyv(hrih->ambient_diffuse, white);
 	copyv(hrih->specular, white);
 //	copyv(hrih->emissive, white);
-	cout << "********* seed syllable: hrih **********" << endl;
-	hrih->initFromObj("data/hrih.obj");
-	hrih->init_base();
-//	cout << "done hrih init_base" << endl;
-	//***debug
-//	cout << "******* hrih after init_base ************" << endl;
-//	hrih->print_polygons(Syllable3D::BASE, 30);
-//	cout << "******* end hrih after init_base ************" << endl;
-
-	hrih->extrude(0.25, true);
-	hrih->check_normals();
-	cout << "** hrih: polygons: " << hrih->num_polygons() << endl;
+	seed_job = loader.submit(new ModelJob("hrih", *this, ModelJob::SEED, 0, hrih));
 
 	// create mantra syllables
 	om = new AnimatedSyllable3D(); ma = new AnimatedSyllable3D(); ni = new AnimatedSyllable3D();
 	pay = new AnimatedSyllable3D(); may = new AnimatedSyllable3D(); hung = new AnimatedSyllable3D();
 	// want this order: { "pay", "ni", "ma", "om", "hung", "may" };
-	syllables.push_back(pay);
-	syllables.push_back(ni);
-	syllables.push_back(ma);
-	syllables.push_back(om);
-	syllables.push_back(hung);
-	syllables.push_back(may);
+	mantra.push_back(pay);
+	mantra.push_back(ni);
+	mantra.push_back(ma);
+	mantra.push_back(om);
+	mantra.push_back(hung);
+	mantra.push_back(may);
+	syllables.assign(mantra.size(), NULL);
 
-	assert(NUM_SYLLS == (int)syllables.size());
+	assert(NUM_SYLLS == (int)mantra.size());
 
-	// set material properties and add to syllables[]
+	// set material properties
 	for (int i = 0; i < NUM_SYLLS; ++i) {
-		Syllable3D *s = syllables[i];
+		Syllable3D *s = mantra[i];
 		GLfloat *c = colors[i];
 		// in this case, add a specular component that is the
 		// same color as the letter
@@ -436,24 +514,65 @@ void ShowMantraApp::init_syllables() {
 		copyv(s->specular, c);
 //		copyv(s->emissive, c);
 	}
+	ModelJob *mapped = new ModelJob("cylinder", *this, ModelJob::CYLINDER);
+	for (size_t s = 0; s < mantra.size(); ++s) {
+		mapped->after(loader.submit(new ModelJob(syllnames[s], *this, ModelJob::BASE, s, mantra[s])));
+	}
+	loader.submit(mapped);
+	for (size_t s = 0; s < mantra.size(); ++s) {
+		ModelJob *job = new ModelJob(syllnames[s], *this, ModelJob::ON_CYLINDER, s, mantra[s]);
+		job->after(mapped);
+		syllable_jobs.push_back(loader.submit(job));
+	}
+	lotus_moon_job = loader.submit(new ModelJob("lotus moon", *this, ModelJob::LOTUS_MOON, 0, NULL, &lotus_moon));
+}
 
-	for (size_t s = 0; s < syllables.size(); ++s) {
-		Syllable3D *syll = syllables[s];
-//		cout << "pointer before: " << s << "  " << syll << endl;
+void ShowMantraApp::pump_loading() {
+	if(!loading()) {
+		return;
 	}
-	char filename[80];
-	for (size_t s = 0; s < syllables.size(); ++s) {
-		Syllable3D *syll = syllables[s];
-//		cout << "pointer syll: " << syll << endl;
-		cout << "***** syllable: " << syllnames[s] << " *****" << endl;
-		// the name of the syllable indicates the correct file
-		sprintf(filename, "data/%s.obj", syllnames[s]);
-		syll->initFromObj(filename, true);
-		syll->init_base();
+	loader.pump(uploads_per_frame);
+	for (size_t s = 0; s < syllable_jobs.size(); ++s) {
+		if(!syllables[s] && syllable_jobs[s]->ready()) {
+			syllables[s] = mantra[s];
+		}
+	}
+	// keys pressed while loading
+	apply_normal_display();
+	if(!loading()) {
+		cout << "**** Models Loaded: " << 0.001 * load_time.elapsed_ms() << " s on "
+				<< loader.num_threads() << " threads ****" << endl;
 	}
-	// ready to map sylls to cylinder
-	map_to_cylinder(do_2d_tweak);
+}
+
+void ShowMantraApp::build_seed_syllable(Syllable3D *syll) {
+	cout << "********* seed syllable: hrih **********" << endl;
+	syll->initFromObj("data/hrih.obj");
+	syll->init_base();
+//	cout << "done hrih init_base" << endl;
+	//***debug
+//	cout << "******* hrih after init_base ************" << endl;
+//	hrih->print_polygons(Syllable3D::BASE, 30);
+//	cout << "******* end hrih after init_base ************" << endl;
+
+	syll->extrude(0.25, true);
+	if(bake_placements) {
+		syll->bake_transform(seed_placement());
+	}
+	syll->build_lods();
+	syll->build_meshlets();
+	syll->build_buffers();
+	syll->check_normals();
+	cout << "** hrih: polygons: " << syll->num_polygons() << endl;
+}
 
+void ShowMantraApp::build_syllable_base(size_t s, Syllable3D *syll) {
+	char filename[80];
+	cout << "***** syllable: " << syllnames[s] << " *****" << endl;
+	// the name of the syllable indicates the correct file
+	sprintf(filename, "data/%s.obj", syllnames[s]);
+	syll->initFromObj(filename, true);
+	syll->init_base();
 }
 
 /**
@@ -463,9 +582,20 @@ void ShowMantraApp::init_syllables() {
  * pre: syllables have initialized their bases
  */
 void ShowMantraApp::map_to_cylinder(bool do_2d_tweak) {
-	cylinder.clear();
+	map_bases_to_cylinder(syllables, do_2d_tweak);
 	for (size_t s = 0; s < syllables.size(); ++s) {
-		Syllable3D *syll = syllables[s];
+		build_on_cylinder(s, syllables[s]);
+	}
+}
+
+/**
+ * the syllables' base vertices and normals mapped to their
+ * location on the cylinder, ready for build_on_cylinder()
+ */
+void ShowMantraApp::map_bases_to_cylinder(const vector<Syllable3D*>& sylls, bool do_2d_tweak) {
+	cylinder.clear();
+	for (size_t s = 0; s < sylls.size(); ++s) {
+		Syllable3D *syll = sylls[s];
 //		cout << "mapping to cylinder:  pointer syll: " << syll << endl;
 //		cout << "***** syllable: " << g_syllnames[s] << " *****" << endl;
 
@@ -492,15 +622,15 @@ void ShowMantraApp::map_to_cylinder(bool do_2d_tweak) {
 //				<< syll_space.element.verts2d.size() << endl;
 		// syll_index is the same as the syllable's index in syllables
 		// so don't need it for now
-		int syll_index = cylinder.add_unit_space(syll_space);
+		int syll_index = cylinder.add_unit_space(std::move(syll_space));
 	}
 //	cout << "syllables.size(): " << syllables.size() << endl;
 	// map the new 3d verts and normals
 	cylinder.map();
 //	cout << "cylinder map done" << endl;
-	// copy them to the syllables and extrude
-	for (size_t s = 0; s < syllables.size(); ++s) {
-		Syllable3D *syll = syllables[s];
+	// copy them to the syllables
+	for (size_t s = 0; s < sylls.size(); ++s) {
+		Syllable3D *syll = sylls[s];
 		int num_vertices = syll->num_vertices_base;
 
 		// copy transformed vertices and normals into syllable
@@ -536,28 +666,33 @@ void ShowMantraApp::map_to_cylinder(bool do_2d_tweak) {
 //			}
 //		}
 		syll->reset_base_windings();
-//		//***debug
-//		continue;
-		GLfloat thickness = 0.25;
-		syll->extrude(thickness, false);
-		// adjust vertex normals
-		syll->average_vertex_normals();
-		// sanity check on normals
-		syll->check_normals();
-
-		// ad hoc - set another center
-		vec3 c;
-		cylinder.map_point(s, .5, .5, c);
-		Vec cent(c);
-		Vec radial(cent.x, 0, cent.z);
-		cent = cent + radial.unit_vec() * ( .5 * thickness);
-		cent.array_out(c);
-		copyv(syll->assigned_center, c);
-
-		cout << "** finished: " << syllnames[s] << ": polygons: " <<
-				syll->num_polygons() << endl;// << "**" << endl;
 	}
 }
+
+// extrude syllable s, its base on the cylinder, and build its levels of detail
+void ShowMantraApp::build_on_cylinder(size_t s, Syllable3D *syll) {
+	GLfloat thickness = 0.25;
+	syll->extrude(thickness, false);
+	// adjust vertex normals
+	syll->average_vertex_normals();
+	// sanity check on normals
+	syll->check_normals();
+	syll->build_lods();
+	syll->build_meshlets();
+	syll->build_buffers();
+
+	// ad hoc - set another center
+	vec3 c;
+	cylinder.map_point(s, .5, .5, c);
+	Vec cent(c);
+	Vec radial(cent.x, 0, cent.z);
+	cent = cent + radial.unit_vec() * ( .5 * thickness);
+	cent.array_out(c);
+	copyv(syll->assigned_center, c);
+
+	cout << "** finished: " << syllnames[s] << ": polygons: " <<
+			syll->num_polygons() << endl;// << "**" << endl;
+}
 // debug - work with single syllable on cylinder
 void ShowMantraApp::init_single_syll() {
 	single_syll = new AnimatedSyllable3D();
@@ -593,12 +728,13 @@ void ShowMantraApp::init_single_syll() {
 //	return;
 
 //	g_render_debug = true;
-	int syll_index;
+	// om goes in the 5th space
+	int syll_index = 4;
 	for (size_t i = 0; i < empty_spaces.size(); ++i) {
-		if(i == 4) {
-			syll_index = cylinder.add_unit_space(syll_space);
+		if((int)i == syll_index) {
+			cylinder.add_unit_space(std::move(syll_space));
 		} else {
-			cylinder.add_unit_space(empty_spaces[i]);
+			cylinder.add_unit_space(std::move(empty_spaces[i]));
 		}
 	}
 //	return;
@@ -628,47 +764,50 @@ void ShowMantraApp::init_single_syll() {
 }
 
 void ShowMantraApp::init_shaders() {
-	vert_shader = glCreateShader(GL_VERTEX_SHADER);
-	frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
-	string shader_dir = "shaders/";
-	string vert_name, frag_name;
-	// shaders for 1 light
-//	vert_name = shader_dir + "vert.fp";
-//	frag_name = shader_dir + "frag.fp";
-
-	// shaders for 2 directional lights
-//	vert_name = shader_dir + "directional_lights.vp";
-//	frag_name = shader_dir + "directional_lights.fp";
-
-	// shaders for 2 directional lights with per pixel lighting
-	vert_name = shader_dir + "directional_lights_per_pixel.vp";
-	frag_name = shader_dir + "directional_lights_per_pixel.fp";
-
-	load_shader_src(vert_shader, vert_name.c_str() );
-	load_shader_src(frag_shader, frag_name.c_str() );
-	compile_shader(vert_shader);
-	compile_shader(frag_shader);
-
-	shader_prog = glCreateProgram();
-	glAttachShader(shader_prog, vert_shader);
-	glAttachShader(shader_prog, frag_shader);
-	glLinkProgram(shader_prog);
-
-	GLint status;
-	glGetProgramiv(shader_prog, GL_LINK_STATUS, &status);
-	if(!status) {
-		cout << "Shader link error.." << endl;
+	// build the variants drawn at start up now rather than on the first frame
+	vec4 shiny = {1, 1, 1, 1};
+	use_uniform_blocks = GLEW_ARB_uniform_buffer_object;
+	GLuint prog = lighting.use(DR::ShaderVariant::lit(lights_on, shiny, per_pixel_lighting, use_fog,
+			use_uniform_blocks));
+	if(!prog && use_uniform_blocks) {
+		cout << "** lighting shaders without uniform blocks" << endl;
+		use_uniform_blocks = false;
+		prog = lighting.use(DR::ShaderVariant::lit(lights_on, shiny, per_pixel_lighting, use_fog));
+	}
+	lighting.use(DR::ShaderVariant::wire(use_fog));
+	lighting.release();
+	shader_on = prog != 0;
+	DR::set_material_blocks(shader_on && use_uniform_blocks);
+	cout << "** shaders: " << shaders.num_loaded() << " loaded from cache, "
+			<< shaders.num_compiled() << " compiled" << endl;
+}
+
+void ShowMantraApp::use_lit_shader(const GLfloat *specular) {
+	if(shader_on) {
+		lighting.use(DR::ShaderVariant::lit(lights_on, specular, per_pixel_lighting, use_fog,
+				use_uniform_blocks));
 	}
+}
+
+void ShowMantraApp::use_wire_shader() {
+	if(shader_on) {
+		lighting.use(DR::ShaderVariant::wire(use_fog));
+	}
+}
 
-	// uniforms
-	loc_front_light_model_product = glGetUniformLocation(shader_prog,
-			"FrontLightModelProduct");
-	// to turn off lighting in shader, use the actual location of
-	// the boolean flag in the shader itself
-	loc_disable_lighting = glGetUniformLocation(shader_prog,
-			"DisableLighting");
-	glUseProgram(shader_prog);
-	shader_on = true;
+void ShowMantraApp::use_fixed_pipeline() {
+	lighting.release();
+}
+
+void ShowMantraApp::upload_lights() {
+	if(!shader_on || !use_uniform_blocks) {
+		return;
+	}
+	// only uploaded when a light changed
+	DR::Std140Packer& p = lights_block.packer();
+	DR::pack_lights(p, lights_on, light_model_ambient, light_view);
+	lights_block.upload(p);
+	lights_block.bind(DR::LIGHTS_BINDING);
 }
 
 void ShowMantraApp::init() {
@@ -688,7 +827,7 @@ void ShowMantraApp::init() {
 	setv(light_model_ambient, .2, .2, .2, 1);
 
 	// start the clock
-	curr_time_ms = start_time_ms = glutGet(GLUT_ELAPSED_TIME);
+	curr_time_ms = start_time_ms = elapsed_ms();
 
 	// heads up display init
 	show_keybindings = false;
@@ -721,6 +860,10 @@ void ShowMantraApp::init() {
 	keybindings_right_side.push_back("p    emit particles from");
 	keybindings_right_side.push_back("     selected syllable");
 	keybindings_right_side.push_back("0-5  select syllable");
+	keybindings_right_side.push_back("l    toggle levels of detail");
+	keybindings_right_side.push_back("c    toggle culling");
+	keybindings_right_side.push_back("x    toggle per pixel lighting");
+	keybindings_right_side.push_back("F    toggle fog");
 
 	int major, minor;
 	get_gl_version( &major, &minor );
@@ -734,6 +877,9 @@ void ShowMantraApp::init() {
 	gl_info.print(output_file.c_str());
 	cout << "*** OpenGL info written to " << output_file << endl;
 
+	// Times Roman 24 is 29 pixels a line, 7 below the baseline
+	hud_font.rasterize_glut(GLUT_BITMAP_TIMES_ROMAN_24, 29, 7);
+
 //	glClearColor ( 0.0, 0.0, 0.0, 1.0);
 	glClearColor ( .2, .2, .2, 1.0);
 //	glClearColor ( .3, .3, .3, 1.0);
@@ -753,6 +899,13 @@ void ShowMantraApp::init() {
 
 	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, light_model_ambient);
 
+	// fades to the background over the far half of the view, F key toggles
+	vec4 fog_color = {.2, .2, .2, 1.0};
+	glFogi(GL_FOG_MODE, GL_LINEAR);
+	glFogfv(GL_FOG_COLOR, fog_color);
+	glFogf(GL_FOG_START, 15.0);
+	glFogf(GL_FOG_END, 30.0);
+
 //	glShadeModel(GL_SMOOTH);
 
 	// Setup and enable lights 0 and 1
@@ -772,14 +925,8 @@ void ShowMantraApp::init() {
 
 
 	// ** normal execution - create seed syllable and mantra syllables
-	// initialize syllables
-	GLfloat before_ms = glutGet(GLUT_ELAPSED_TIME);
-	init_syllables();
-
-	GLfloat after_ms = glutGet(GLUT_ELAPSED_TIME);
-	cout << "**** Syllables Initialized: ****" << endl;
-	GLfloat elapsed = 0.001 * (after_ms - before_ms);
-	cout << "**   " << elapsed << " s  **" << endl << endl;
+	// and the lotus moon, drawn as each is ready
+	load_models();
 
 	//** debug - just create and display one syllable on cylinder
 //	init_single_syll();
@@ -790,41 +937,9 @@ void ShowMantraApp::init() {
 	init_shaders();
 	cout << "** init shaders" << endl;
 
-	// init the extra light model stuff for the shader
-	// this is taken from the approach used in the orange book
-//#   This gets the contribution of material + environment not
-//#   obtained from the other FrontMaterial properties
-//#   FrontMaterial.emissive + FrontMaterial.ambient * LightModel.ambient
-//    frontLightModelProduct = (0 + can.material_props['GL_AMBIENT']
-//                              * glGetFloatv(GL_LIGHT_MODEL_AMBIENT))
-
-	//**** big assumption:  this is consistent for all syllables
-	//** for now this is true, otherwise have to update as necessary
-	//** at render time
-	//*** UPDATED NOTE
-	//*** need to fix the whole front light model product deal -- adds too much light
-	//*** for now it's disregarded in shader anyway
-//	GLfloat *front_emissive = om->emissive;
-//	GLfloat *front_ambient = om->ambient_diffuse;
-	vec4 front_emissive = {0, 0, 0, 1};
-	vec4 front_ambient = {1, 1, 1, 1};
-	GLfloat *ambient = light_model_ambient;
-	for (int i = 0; i < 4; ++i) {
-		front_light_model_product[i] = front_emissive[i] +
-				front_ambient[i] * ambient[i];
-	}
-	cout << "front_light_model_product: "
-			<< stringv(front_light_model_product, 4) << endl;
-	glUniform4fv(loc_front_light_model_product, 1,
-			front_light_model_product);
-
-	// set lighting enabled
-	glUniform1i(loc_disable_lighting, 0);
-
-	// set starting time for particles
-	particles.old_time_ms = glutGet(GLUT_ELAPSED_TIME);
-
-	init_lotus_moon();
+	// simulation starts now, not counting the time compiling
+	start_clock();
+	curr_time_ms = start_time_ms = elapsed_ms();
 	cout << "*** end init" << endl;
 }
 
@@ -832,87 +947,29 @@ void ShowMantraApp::init() {
  * Things to do after glut main loop.
  */
 void ShowMantraApp::cleanup() {
-	// get statistics from framerate distribution
-	if(framerate_samples.empty()) {
+	if(!frame_stats.frames()) {
 		cout << "no stats to report" << endl;
 		return;
 	}
-	vector<GLfloat>::iterator it;
-	GLint numsamples = framerate_samples.size();
-	sort(framerate_samples.begin(), framerate_samples.end());
-	GLfloat minfr, maxfr, avgfr, sumfr;
-	minfr = framerate_samples[0];
-	maxfr = framerate_samples[numsamples-1];
-	sumfr = accumulate(framerate_samples.begin(), framerate_samples.end(), 0);
-	avgfr = sumfr/numsamples;
-	cout << "******* Framerate Stats ********" << endl;
-	cout << "min: " << minfr << endl << "max: " << maxfr << endl << "avg: " << avgfr << endl;
-	cout << "num samples: " << numsamples << endl;
-
-	// simple histogram of distribution
-	int numbins = 5;
-	vector<GLint> bins(numbins, 0);
-	int which = 0;
-	GLfloat bin_spread = (maxfr - minfr)/ numbins;
-//	cout << "bin_spread: " << bin_spread << endl;
-	for (int i = 0; i < numsamples; ++i) {
-		if( framerate_samples[i] > minfr + (which+1)*bin_spread ) {
-			which++;
-		}
-		bins[which]++;
-	}
-	// calculate ratio of each bin to sum for cheap graphics
-	GLfloat total = (GLfloat)accumulate(bins.begin(), bins.end(), 0);
-//	cout << "total = " << total << endl;
-//	cout << "bins:" << endl;
-//	for (size_t i = 0; i < bins.size(); ++i) {
-//		cout << i << ": " << bins[i] << endl;
-//	}
-	cout << "Distribution:" << endl
-			<< setw(10) << left << "Range" << "Count   Graph" << endl;
-	cout << fixed << right;
-	cout << setw(6) << "0.0" << endl;
-	for (size_t i = 0; i < bins.size(); ++i) {
-		GLfloat bin_part = (GLfloat)bins[i] / total;
-		cout << setw(6) << setprecision(1) << minfr + (i+1)*bin_spread
-				<< setw(8) << bins[i] << "    ";
-		// output horizontal bar graph of chars
-		// 50 chars would equal 100 %
-		GLint numchars = (GLint)(bin_part * 50);
-		for (int j = 0; j < numchars; ++j) {
-			cout << '#';
-		}
-		cout << endl;
-	}
+	frame_stats.print(cout);
 	cout << endl;
 	time_t now;
 	time(&now);
 	cout << "End time: " << ctime(&now) << endl;
 
-	// append all to output_file
+	// append all to output_file, and the numbers next to it
 	ofstream out;
 	out.open(output_file.c_str(), ios_base::app);
 	out << endl;
-	out << "******* Framerate Stats ********" << endl;
-	out << "min: " << minfr << endl << "max: " << maxfr << endl << "avg: " << avgfr << endl;
-	out << "num samples: " << numsamples << endl;
-	out << "Distribution:" << endl
-			<< setw(10) << left << "Range" << "Count" << endl;
-	out << fixed << right;
-	out << setw(6) << "0.0" << endl;
-	for (size_t i = 0; i < bins.size(); ++i) {
-		GLfloat bin_part = (GLfloat)bins[i] / total;
-		out << setw(6) << setprecision(1) << minfr + (i+1)*bin_spread
-				<< setw(8) << bins[i] << "    ";
-		GLint numchars = (GLint)(bin_part * 50);
-		for (int j = 0; j < numchars; ++j) {
-			out << '#';
-		}
-		out << endl;
-	}
+	frame_stats.print(out);
 	out << endl;
 	out << "End time: " << ctime(&now) << endl;
 	out.close();
+	if(frame_stats.write(frame_stats_file)) {
+		cout << "*** frame times written to " << frame_stats_file << ".csv, _streamed.csv and .json" << endl;
+	} else {
+		cerr << "couldn't write " << frame_stats_file << ".csv, _streamed.csv or .json" << endl;
+	}
 }
 
 // draw the seed syllable in the center on a vertical plane facing first
@@ -921,26 +978,24 @@ void ShowMantraApp::cleanup() {
 void ShowMantraApp::draw_seed_syllable(Syllable3D *syll, bool wire) {
 	GLfloat *color = Util::white;
 	glPushMatrix();
-	glRotatef(90, 1, 0, 0);
-//	glTranslatef(0.25, 0.2, 0.0); // orig
-	glTranslatef(0.25, 0.2, -0.5);
-	glRotatef(-30, 0, 0, 1);
-
-	glScalef(2.5, 2.5, 2.5);
+	// when baked, the placement is already in the vertices
+	if(!bake_placements) {
+		glMultMatrixf(seed_placement().data());
+	}
+	pick_lod(*syll, use_lods);
+	cull_syllable(syll);
 
 //	g_render_debug = false;
+	if(wire) {
+		use_wire_shader();
+	} else {
+		use_lit_shader(syll->specular);
+	}
 	if(render_debug) {
 		syll->render_debug();
 	} else {
 		if(wire) {
-			// disable lighting in shader
-//			glUniform1i(loc_disable_lighting, 1);
-			GLint curr_prog;
-			glGetIntegerv(GL_CURRENT_PROGRAM, &curr_prog);
-			glUseProgram(0);
 			syll->render_wire(color);
-//			glUniform1i(loc_disable_lighting, 0);
-			glUseProgram(curr_prog);
 		} else {
 			syll->render(color);
 		}
@@ -956,6 +1011,11 @@ void ShowMantraApp::draw_debug_syllable(Syllable3D *syll, bool wire) {
 //	glRotatef(-20, 0, 0, 1);
 //	glTranslatef(0.5, 0, 0);
 	glScalef(3.0, 3.0, 3.0);
+	if(wire) {
+		use_wire_shader();
+	} else {
+		use_lit_shader(syll->specular);
+	}
 	if(render_debug) {
 		syll->render_debug();
 	} else {
@@ -987,7 +1047,7 @@ void ShowMantraApp::draw_debug_syllable(Syllable3D *syll, bool wire) {
  */
 void ShowMantraApp::idle() {
 	frame++;
-	GLfloat time_ms = glutGet(GLUT_ELAPSED_TIME);
+	GLfloat time_ms = elapsed_ms();
 	GLfloat elapsed_secs = 0.001 * (time_ms - curr_time_ms);
 //	if (frame % 100 == 0) {
 //		cout << "time: " << time_ms << ", elapsed: " << elapsed_secs << ", frame: " << frame << endl;
@@ -1003,19 +1063,10 @@ void ShowMantraApp::idle() {
 
 		curr_time_ms = time_ms;
 		last_frame = frame;
-		// sample framerate starting from 5 secs after prog start
-		if(time_ms > 5000) {
-			framerate_samples.push_back(framerate);
-		}
 	}
 
 	// particles stuff
-	if( !particles.is_empty() ) {
-		particles.update( glutGet(GLUT_ELAPSED_TIME) );
-	}
-	if( !beams.is_empty() ) {
-		beams.update( glutGet(GLUT_ELAPSED_TIME));
-	}
+	advance();
 	// debug
 	if(debug && frame % (long)framerate == 0) {
 //		cout << "live beams: " << beams.live_beams() << endl;
@@ -1029,10 +1080,21 @@ void ShowMantraApp::idle() {
 			}
 		}
 	}
-	glutPostRedisplay();
+	pace_frame();
+}
+
+void ShowMantraApp::simulate(GLdouble dt) {
+	if( !particles.is_empty() ) {
+		particles.step(dt, false);
+	}
+	if( !beams.is_empty() ) {
+		beams.step(dt);
+	}
 }
 
 void ShowMantraApp::display() {
+	begin_render();
+	pump_loading();
 	glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
 	glPushMatrix();
@@ -1040,6 +1102,7 @@ void ShowMantraApp::display() {
 	// apply zoom, trackball transformation
 	glTranslatef(0, 0, z_zoom);
 	glMultMatrixf(trackball_transform_mat);
+	upload_lights();
 
 	// this takes it from obj up to opengl up
 //	glRotatef ( 90, 1, 0, 0 );
@@ -1052,19 +1115,21 @@ void ShowMantraApp::display() {
 	if(use_debug_shape) {
 		// just show a glut shape
 //		glColor3f(1.0, 0.0, 0.0);
-		glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, pay->ambient_diffuse);
-		glMaterialfv(GL_FRONT, GL_SPECULAR, pay->specular);
-		glMaterialfv(GL_FRONT, GL_SHININESS, pay->shininess);
+		// pay's colors are set before it loads
+		apply_material(debug_material, pay->ambient_diffuse, pay->specular, pay->shininess, pay->emissive);
+		use_lit_shader(pay->specular);
 		glutSolidTorus(1.5, 3.0, 12, 24);
 	} else if(use_debug_syll) {
 //		if(frame % 100 == 0) cout << "display debug syll" << endl;
 		// just display debug_syll as seed
-		// disable lighting in shader
-//		glUniform1i(loc_disable_lighting, 1);
 //		draw_debug_syllable(debug_syll, wireframe);
-//		glUniform1i(loc_disable_lighting, 0);
 
 	} else if(use_single_syll) {		//** debug - individual rendering
+		if(wireframe) {
+			use_wire_shader();
+		} else {
+			use_lit_shader(single_syll->specular);
+		}
 		if(render_debug) {
 			single_syll->render_debug();
 		} else if(wireframe) {
@@ -1075,53 +1140,54 @@ void ShowMantraApp::display() {
 			single_syll->render();
 		}
 	} else { 	// normal execution
-		draw_lotus_moon();
+		cull_stats.clear();
+		if(lotus_moon_job->ready()) {
+			draw_lotus_moon();
+		}
 //		goto PastDrawing;
-		draw_seed_syllable(hrih, wireframe);
+		if(seed_job->ready()) {
+			draw_seed_syllable(hrih, wireframe);
+		}
 //		cout << "rendered hrih" << endl;
 		for (size_t i = 0; i < syllables.size(); ++i) {
 			Syllable3D *syll = syllables[i];
+			if(!syll) {
+				continue;
+			}
+			pick_lod(*syll, use_lods);
+			cull_syllable(syll);
 
+			if(wireframe) {
+				use_wire_shader();
+			} else {
+				use_lit_shader(syll->specular);
+			}
 			if(render_debug) {
 				syll->render_debug();
 			} else if(wireframe) {
-				// disable lighting in shader
-				if(shader_on) glUseProgram(0);
-//				glUniform1i(loc_disable_lighting, 1);
 				syll->render_wire(Util::white);
-//				glUniform1i(loc_disable_lighting, 0);
-				if(shader_on) glUseProgram(shader_prog);
 			} else {
 				syll->render(Util::white);
 			}
 		}
 	}
 	if(show_grid) {
-		if(shader_on) glUseProgram(0);
-//		glUniform1i(loc_disable_lighting, 1);
+		use_wire_shader();
 		cyl_grid.render(Util::magenta, 2.0);
-		if(shader_on) glUseProgram(shader_prog);
-//		glUniform1i(loc_disable_lighting, 0);
 	}
 
 	// render any light particles
 	if(!particles.is_empty()) {
-		if(shader_on) glUseProgram(0);
-//		glUniform1i(loc_disable_lighting, 1);
-		particles.render();
-		if(shader_on) glUseProgram(shader_prog);
-//		glUniform1i(loc_disable_lighting, 0);
+		use_fixed_pipeline();
+		particles.render(sim_alpha * sim_step);
 	}
 	glEnable(GL_BLEND);
 	glDepthMask(GL_FALSE);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	// render any light beams
 	if(!beams.is_empty()) {
-		if(shader_on) glUseProgram(0);
-//		glUniform1i(loc_disable_lighting, 1);
-		beams.render();
-		if(shader_on) glUseProgram(shader_prog);
-//		glUniform1i(loc_disable_lighting, 0);
+		use_fixed_pipeline();
+		beams.render(sim_alpha * sim_step);
 	}
 	glDepthMask(GL_TRUE);
 	glDisable(GL_BLEND);
@@ -1139,7 +1205,7 @@ void ShowMantraApp::display() {
 	heads_up_display(show_keybindings, show_beam_ct,
 			show_framerate);
 
-	glutSwapBuffers();
+	swap_buffers();
 }
 
 void ShowMantraApp::keyboard(unsigned char key, int x, int y) {
@@ -1155,6 +1221,9 @@ void ShowMantraApp::keyboard(unsigned char key, int x, int y) {
 			break;
 		case 'p': {// do particles for a syllable
 			AnimatedSyllable3D *syll = (AnimatedSyllable3D *)syllables[particle_syll];
+			if(!syll) {
+				break;
+			}
 //			syll->get_particles(particles, 3.0);
 //			cout << "particles: " << particles.live_particles() << endl;
 
@@ -1193,6 +1262,10 @@ void ShowMantraApp::keyboard(unsigned char key, int x, int y) {
 			break;
 		case 't': // toggle showing syllables with 2d tweaking
 					// by default tweaking is on
+			if(loading()) {
+				// the loader is mapping them
+				break;
+			}
 			do_2d_tweak = ! do_2d_tweak;
 			for (size_t i = 0; i < syllables.size(); ++i) {
 				Syllable3D *s = syllables[i];
@@ -1241,11 +1314,9 @@ void ShowMantraApp::keyboard(unsigned char key, int x, int y) {
 		}
 		case 's': {// toggle shader off/on
 			shader_on = !shader_on;
-			if(shader_on) {
-				glUseProgram(shader_prog);
-			} else {
-				glUseProgram(0);
-			}
+			// the next draw picks its program
+			use_fixed_pipeline();
+			DR::set_material_blocks(shader_on && use_uniform_blocks);
 			const char *strval = shader_on ? "on" : "off";
 			keybindings.pop_back();
 			keybindings.push_back(strval);
@@ -1287,6 +1358,27 @@ void ShowMantraApp::keyboard(unsigned char key, int x, int y) {
 			}
 			break;
 		}
+		case 'c': // toggle culling
+			use_culling = !use_culling;
+			cout << "culling " << (use_culling ? "on" : "off") << endl;
+			break;
+		case 'l': // toggle levels of detail
+			use_lods = !use_lods;
+			cout << "levels of detail " << (use_lods ? "on" : "off") << endl;
+			break;
+		case 'x': // per pixel or per vertex lighting
+			per_pixel_lighting = !per_pixel_lighting;
+			cout << "lighting per " << (per_pixel_lighting ? "pixel" : "vertex") << endl;
+			break;
+		case 'F': // toggle fog, the shaders follow
+			use_fog = !use_fog;
+			if(use_fog) {
+				glEnable(GL_FOG);
+			} else {
+				glDisable(GL_FOG);
+			}
+			cout << "fog " << (use_fog ? "on" : "off") << endl;
+			break;
 //		case 'l': {// toggle light1
 //			bool enabled1 = glIsEnabled(GL_LIGHT1);
 //			if(enabled1) {
@@ -1328,6 +1420,7 @@ void ShowMantraApp::reshape(int w, int h) {
 	glTranslatef (0.0, 0.0, z_start);
 	glLightfv(light0.id, GL_POSITION, light0.pos);
 	glLightfv(light1.id, GL_POSITION, light1.pos);
+	glGetFloatv(GL_MODELVIEW_MATRIX, light_view);
 	//cout << "reshape" << endl
 	//		<< "light 0: " << stringv(light0.pos, 4) << endl;;
 //	glLightfv(GL_LIGHT1, GL_POSITION, g_light1_pos);
@@ -1337,6 +1430,7 @@ void ShowMantraApp::reshape(int w, int h) {
 
 //**** test stuff ***
 void ShowMantraApp::test_init() {
+	hud_font.rasterize_glut(GLUT_BITMAP_TIMES_ROMAN_24, 29, 7);
 	glClearColor ( .2, .2, .2, 1.0);
 //	glClearColor ( .3, .3, .3, 1.0);
 	glEnable ( GL_DEPTH_TEST );
@@ -1390,13 +1484,31 @@ void keyboard(unsigned char key, int x, int y) {
 // ** usage for main
 void usage(string progname) {
 	cout << "Usage: " << progname << " [width height]" << endl
-			<< "\twidth, height: screen size " << endl;
+			<< "\twidth, height: screen size " << endl
+			<< "       " << progname << " --test" << endl
+			<< "\trun headless tests" << endl
+			<< "       " << progname << " --bench [name]" << endl
+			<< "\trun headless benchmarks, all or just name" << endl;
 }
 int main(int argc, char** argv)
 {
 	// set to true to run test_init and test_display with polytest
 	bool test_only = false;
 
+	// headless, no window
+	if(argc >= 2 && string(argv[1]) == "--test") {
+		DR::test();
+		return 0;
+	}
+	if(argc >= 2 && string(argv[1]) == "--bench") {
+		DR::bench(argc >= 3 ? argv[2] : "");
+		return 0;
+	}
+	if(argc >= 2 && string(argv[1]) == "--help") {
+		usage(argv[0]);
+		return 0;
+	}
+
 	if(argc == 3) {
 		// width and height params
 		int w = atoi(argv[1]), h = atoi(argv[2]);
@@ -0,0 +1,208 @@
+/*
+ * stream_buffer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "stream_buffer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+using namespace DR;
+
+StreamBuffer::StreamBuffer(size_t frame_bytes, Mode mode)
+: mode(mode), frame_bytes(frame_bytes), buffer(0), mapped(NULL), made(false),
+  region(0), used(0), last_used(0), total(0), num_frames(0), failed(0), waits(0) {
+	for (int i = 0; i < NUM_FRAMES; ++i) {
+		fences[i] = 0;
+	}
+	if(mode == CPU) {
+		make();
+	}
+}
+
+StreamBuffer::~StreamBuffer() {
+	if(mode == PERSISTENT && buffer) {
+		for (int i = 0; i < NUM_FRAMES; ++i) {
+			if(fences[i]) {
+				glDeleteSync(fences[i]);
+			}
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+void StreamBuffer::make() {
+	made = true;
+	size_t bytes = frame_bytes * NUM_FRAMES;
+	if(mode == PERSISTENT && GLEW_ARB_buffer_storage && GLEW_ARB_sync) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferStorage(GL_ARRAY_BUFFER, bytes, NULL, flags);
+		mapped = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		if(mapped) {
+			return;
+		}
+		cerr << "StreamBuffer: couldn't map " << bytes << " bytes, using client memory" << endl;
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+	mode = CPU;
+	memory.assign(bytes, 0);
+}
+
+void StreamBuffer::begin_frame() {
+	if(!made) {
+		make();
+	}
+	last_used = used;
+	total += used;
+	used = 0;
+	++num_frames;
+	region = (region + 1) % NUM_FRAMES;
+	GLsync fence = fences[region];
+	if(!fence) {
+		return;
+	}
+	// drawn from NUM_FRAMES ago, almost always done
+	GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if(status == GL_TIMEOUT_EXPIRED) {
+		++waits;
+		while(status == GL_TIMEOUT_EXPIRED) {
+			status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		}
+	}
+	glDeleteSync(fence);
+	fences[region] = 0;
+}
+
+void StreamBuffer::end_frame() {
+	if(mode == PERSISTENT) {
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
+
+void* StreamBuffer::alloc(size_t bytes, size_t& offset, size_t align) {
+	if(!made) {
+		make();
+	}
+	size_t start = (used + align - 1) / align * align;
+	if(start + bytes > frame_bytes) {
+		if(failed++ == 0) {
+			cerr << "StreamBuffer: " << bytes << " bytes don't fit in what's left of a " << frame_bytes
+					<< " byte frame, skipping" << endl;
+		}
+		return NULL;
+	}
+	used = start + bytes;
+	offset = region * frame_bytes + start;
+	return base() + offset;
+}
+
+void StreamBuffer::bind() const {
+	glBindBuffer(GL_ARRAY_BUFFER, mode == CPU ? 0 : buffer);
+}
+
+void StreamBuffer::unbind() const {
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+const GLvoid* StreamBuffer::pointer(size_t offset) const {
+	if(mode == CPU) {
+		return &memory[offset];
+	}
+	return (const char*)NULL + offset;
+}
+
+StreamBuffer& DR::frame_stream() {
+	// particles and beams at their most, with the hud and overlays
+	static StreamBuffer stream(4 << 20);
+	return stream;
+}
+
+void StreamBuffer::test() {
+	cout <<  "\n******************** StreamBuffer::test() **************************" << endl;
+	const size_t cap = 4096;
+	StreamBuffer s(cap, CPU);
+	size_t offset = 0;
+	s.begin_frame();
+	int r = s.frame_region();
+	s.alloc(10, offset, 4);
+	size_t second;
+	s.alloc(8, second, 16);
+	if(offset != r * cap || second != r * cap + 16 || s.bytes_used() != 24) {
+		cout << "!=: offsets " << offset << ", " << second << ", used " << s.bytes_used() << endl;
+	}
+	// full
+	if(s.alloc(cap, offset) != NULL || s.failed_allocs() != 1) {
+		cout << "!=: allocated past the region" << endl;
+	}
+	s.end_frame();
+	s.begin_frame();
+	if(s.frame_region() == r || s.last_frame_bytes() != 24 || s.alloc(cap, offset) == NULL) {
+		cout << "!=: next frame region " << s.frame_region() << ", last frame " << s.last_frame_bytes() << endl;
+	}
+	s.end_frame();
+
+	/*
+	 * Random allocations for many frames, each filled with its frame's
+	 * number.  Nothing written since should touch the frames the GPU could
+	 * still be drawing, the NUM_FRAMES - 1 before.
+	 */
+	struct Block {
+		unsigned char *p;
+		size_t bytes;
+		unsigned char mark;
+	};
+	StreamBuffer ring(cap, CPU);
+	vector<vector<Block> > frames(NUM_FRAMES);
+	srand(7);
+	unsigned long long requested = 0;
+	bool clobbered = false, misaligned = false;
+	for (int f = 0; f < 1000; ++f) {
+		ring.begin_frame();
+		vector<Block>& mine = frames[f % NUM_FRAMES];
+		mine.clear();
+		unsigned char mark = (unsigned char)f;
+		for (int n = rand() % 40; n > 0; --n) {
+			size_t bytes = rand() % 300 + 1;
+			size_t align = (size_t)4 << (rand() % 3);
+			unsigned char *p = (unsigned char*)ring.alloc(bytes, offset, align);
+			if(!p) {
+				continue;
+			}
+			misaligned = misaligned || offset % align != 0
+					|| offset / cap != (size_t)ring.frame_region() || (offset + bytes - 1) / cap != offset / cap;
+			memset(p, mark, bytes);
+			Block b = { p, bytes, mark };
+			mine.push_back(b);
+			requested += bytes;
+		}
+		for (int k = 0; k < NUM_FRAMES && !clobbered; ++k) {
+			for (size_t i = 0; i < frames[k].size(); ++i) {
+				const Block& b = frames[k][i];
+				for (size_t j = 0; j < b.bytes; ++j) {
+					clobbered = clobbered || b.p[j] != b.mark;
+				}
+			}
+		}
+		ring.end_frame();
+	}
+	ring.begin_frame();
+	if(clobbered || misaligned) {
+		cout << "!=: ring " << (clobbered ? "overwrote a frame in flight" : "misplaced an allocation") << endl;
+	}
+	if(ring.frames() != 1001 || ring.total_bytes() < requested || ring.failed_allocs() == 0) {
+		cout << "!=: " << ring.frames() << " frames, " << ring.total_bytes() << " bytes for "
+				<< requested << " requested, " << ring.failed_allocs() << " too big" << endl;
+	}
+	cout << "\n***************** Done:  StreamBuffer::test() ***********************" << endl;
+}
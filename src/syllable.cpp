@@ -10,13 +10,22 @@
 #include "syllable.h"
 #include "dr_util.h"
 #include "vec.h"
-
+#include "linalg.h"
+#include "transform.h"
+#include "arena.h"
+#include "alloc_stats.h"
+#include "dr_glm.h"
+#include "lod.h"
+
+#include <cfloat>
+#include <cstring>
 #include <cstdio>
 #include <cassert>
 #include <iostream>
 #include <ostream>
 #include <fstream>
 #include <algorithm>
+#include <sstream>
 
 using namespace std;
 using namespace DR;
@@ -66,11 +75,13 @@ void Syllable3D::initFromObj(const char *objfile, bool unitize) {
 Syllable3D::Syllable3D()
 :  num_vertices(0), num_normals(0), num_normals_sides(0),
    show_normals(false), show_facet_norms(false), show_vert_norms(false),
-   base2d(), vertices(NULL), normals(NULL),
-   base_face(this), extruded_face(this), side_normals(NULL) {
-	start_time = clock();
+   base2d(), vertices(NULL), normals(NULL), mesh_arena(),
+   base_face(this, use_mesh_arenas ? &mesh_arena : NULL),
+   extruded_face(this, use_mesh_arenas ? &mesh_arena : NULL), side_normals(NULL), lod(0),
+   meshlet_vertices(0), meshlet_triangles(0), culled_lod(0), culled(false),
+   buffers_optimized(true), normals_which('f'), normals_size(0), debug_color(NULL),
+   topology_dirty(false), base_perimeters_reversed(false), debug_dirty(false) {
 	srand ( time(NULL) );
-//	cout << "start_time: " << start_time << endl;
 	// materials
 	ambient_diffuse[3] = specular[3] = 1.0f;
 	setv(ambient_diffuse, .1, .5, .8);
@@ -83,6 +94,8 @@ Syllable3D::Syllable3D()
 	emissive[3] = 0.0f;
 	// center is at origin by default
 	setv(center, 0, 0, 0);
+	outward[BASE] = outward[EXTRUDED] = outward[SIDES] = 1;
+	setv(assigned_center, 0, 0, 0);
 }
 
 /**
@@ -90,34 +103,60 @@ Syllable3D::Syllable3D()
  * param: secs: if true, return secs rather than ms
  */
 GLdouble Syllable3D::age(bool secs) {
-	clock_t now = clock();
-	GLdouble elapsed = ((double)(now - start_time)) / (double)CLOCKS_PER_SEC;
-	if(!secs) {
-		elapsed *= 1000.0;
+	GLdouble elapsed = lifetime.elapsed_ms();
+	if(secs) {
+		elapsed *= 0.001;
 	}
 	return  elapsed;
 }
 
 Syllable3D::~Syllable3D() {
+	free_buffers();
 	delete [] vertices;
 	delete [] normals;
 	delete [] side_normals;
 	// change this if sides are handled differently
-	for (size_t i = 0; i < sides.size(); ++i) {
-		delete sides[i];
+	// arena polygons go when mesh_arena does
+	if(!base_face.get_arena()) {
+		for (size_t i = 0; i < sides.size(); ++i) {
+			delete sides[i];
+		}
+	}
+}
+
+Triangle* Syllable3D::new_triangle() {
+	Arena *arena = base_face.get_arena();
+	if(arena) {
+		return arena->create<Triangle>(vertices, normals, arena);
+	}
+	return new Triangle(vertices, normals);
+}
+
+Quad* Syllable3D::new_quad() {
+	Arena *arena = base_face.get_arena();
+	if(arena) {
+		return arena->create<Quad>(vertices, normals, arena);
 	}
+	return new Quad(vertices, normals);
 }
 
 void Syllable3D::render(GLfloat *color, bool no_mat) {
 //	render_model();
-	glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, ambient_diffuse);
-	glMaterialfv(GL_FRONT, GL_SPECULAR, specular);
-	glMaterialfv(GL_FRONT, GL_SHININESS, shininess);
-	glMaterialfv(GL_FRONT, GL_EMISSION, emissive);
-
-	render_face(base_face, color, false, no_mat);
-	render_face(extruded_face, color, false, no_mat);
-	render_sides(color, false, no_mat);
+	if(culled) {
+		return;
+	}
+	apply_material(material_block, ambient_diffuse, specular, shininess, emissive);
+
+	size_t level = lod > 0 && lod < (int)lods.size() ? lod : 0;
+	if(level < buffers.size() && (!no_mat || color != NULL)) {
+		render_buffer(level, color, no_mat);
+	} else if(level > 0) {
+		render_lod(lods[lod], color, false, no_mat);
+	} else {
+		render_face(base_face, color, false, no_mat);
+		render_face(extruded_face, color, false, no_mat);
+		render_sides(color, false, no_mat);
+	}
 	// draw normals
 	if(show_normals) {
 		if(show_facet_norms && show_vert_norms) {
@@ -134,10 +173,17 @@ void Syllable3D::render(GLfloat *color, bool no_mat) {
 // render using wireframe
 // color: defaults to white
 void Syllable3D::render_wire(GLfloat *color, bool no_mat, GLfloat line_sz) {
+	if(culled) {
+		return;
+	}
 	GLfloat *col = color == NULL ? Util::white : color;
-	render_face(base_face, col, true, no_mat, line_sz);
-	render_face(extruded_face, col, true, no_mat, line_sz);
-	render_sides(col, true, no_mat, line_sz);
+	if(lod > 0 && lod < (int)lods.size()) {
+		render_lod(lods[lod], col, true, no_mat, line_sz);
+	} else {
+		render_face(base_face, col, true, no_mat, line_sz);
+		render_face(extruded_face, col, true, no_mat, line_sz);
+		render_sides(col, true, no_mat, line_sz);
+	}
 	// draw normals
 	if(show_normals) {
 		if(show_facet_norms && show_vert_norms) {
@@ -249,12 +295,26 @@ void Syllable3D::render_model() {
  * clears all debug stuff as well
  */
 void Syllable3D::reinit() {
+	invalidate_overlays();
 	extruded_face.clear();
 	base_face.clear();
-	for (size_t i = 0; i < sides.size(); ++i) {
-		delete sides[i];
+	if(!base_face.get_arena()) {
+		for (size_t i = 0; i < sides.size(); ++i) {
+			delete sides[i];
+		}
 	}
 	sides.clear();
+	lods.clear();
+	lod_errors.clear();
+	lod = 0;
+	for (int s = 0; s < 3; ++s) {
+		meshlets[s].clear();
+	}
+	meshlet_vertices = meshlet_triangles = 0;
+	free_buffers();
+	clear_cull();
+	// frees all polygons and regions at once
+	mesh_arena.reset();
 
 	// clear debug stuff
 	debug_edges.clear();
@@ -264,6 +324,14 @@ void Syllable3D::reinit() {
 
 	GLMmodel* model = getBase2dModel();
 
+	// back to the model's counts if retessellate_base added vertices,
+	// the arrays only grew
+	num_vertices_base = model->numvertices;
+	num_vertices = 2 * num_vertices_base;
+	num_normals_base = model->numnormals;
+	num_normals = 2 * num_normals_base;
+	added_layout.clear();
+
 	for (int i = 0; i < num_vertices; ++i) {
 		for (int j = 0; j < 3; ++j) {
 			vertices[i][j] = model->vertices[(i+1)*3 + j];
@@ -277,7 +345,7 @@ void Syllable3D::reinit() {
 	int num_triangles = model->numtriangles;
 	for (int i = 0; i < num_triangles; ++i) {
 		GLMtriangle *f=&(model->triangles[i]);
-		Triangle *t = new Triangle(vertices, normals);
+		Triangle *t = new_triangle();
 		for (int j = 0; j < 3; ++j) {
 			t->verts[j] = f->vindices[j] - 1;
 			t->norms[j] = f->nindices[j] - 1;
@@ -289,16 +357,17 @@ void Syllable3D::reinit() {
 		base_face.add_polygon(t);
 	}
 	cout << "reinit:   " << base_face.polygons.size() << endl;
-	base_face.init_regions(0);
+	topology_dirty = debug_dirty = true;
 }
 
 // copy base2d model vertices to member vertices
 // and triangles to base_face, initializes base face polys
-// sets base face center
+// regions, perimeters and center wait for update_topology()
 // note -- glm has 1-based arrays for vertices, norms, texcoords
 // I'm using zero based
 void Syllable3D::init_base() {
 	GLdouble start = age();
+	invalidate_overlays();
 	GLMmodel* model = getBase2dModel();
 
 	// at this point, vertices and normals will only have
@@ -335,7 +404,7 @@ void Syllable3D::init_base() {
 	int num_triangles = model->numtriangles;
 	for (int i = 0; i < num_triangles; ++i) {
 		GLMtriangle *f=&(model->triangles[i]);
-		Triangle *t = new Triangle(vertices, normals);
+		Triangle *t = new_triangle();
 		//**debug for printing out vindices
 		//cout << i;
 		for (int j = 0; j < 3; ++j) {
@@ -362,31 +431,9 @@ void Syllable3D::init_base() {
 	// ** debug
 //	check_base_model();
 
-	// find regions and perimeters in base face
-	base_face.init_regions(0);
-
-	// tell base face to set center polygon
-	// so we have it available for later
-	base_face.set_center( Vec(0, 0, 1) );
-
-//	Polygon cpoly;
-//	base_face.get_center(cpoly);
-//	cout << "** init_base: base center after set center:" << endl
-//			<< cpoly.to_string() << endl;
-
-	// set syllable's center to the base_face's center
-	// until extruded, mapped, etc
-	base_face.get_center(center);
-
-//	cout << "** init_base: syll center: " << stringv(center) << endl;
-
-	// debug
-	add_all(base_face.debug_polygons, debug_polygons);
-	add_all(base_face.debug_points, debug_points);
-	add_all(base_face.debug_verts, debug_verts);
-	add_all(base_face.debug_edges, debug_edges);
-//	cout << "debug_polygons:" << endl;
-//	print_polys(debug_polygons);
+	// regions, perimeters and the center polygon are found from the
+	// layout when first needed, rendering alone never needs them
+	topology_dirty = debug_dirty = true;
 
 	//** timing
 //	GLdouble end = age();
@@ -399,6 +446,7 @@ void Syllable3D::init_base() {
 // for now uses set_winding_from_normal()
 //** resets facet normal **
 void Syllable3D::reset_base_windings() {
+	invalidate_overlays();
 	for (size_t i = 0; i < base_face.polygons.size(); ++i) {
 		Polygon *poly = base_face.polygons[i];
 		poly->set_winding_from_normal();
@@ -412,6 +460,7 @@ void Syllable3D::reset_base_windings() {
 // param: rev_side_winding [false], if true, will reverse vertex order
 //		of polygons in sides and set facetnorms accordingly
 void Syllable3D::extrude(GLfloat thickness, bool rev_side_winding) {
+	invalidate_overlays();
 	// memory is already allocated for vertices and vertex normals
 	// need to initialize vertices and vertex normals for extruded face
 	// note we rely on the vertex normals having the same index as their vertex
@@ -422,21 +471,16 @@ void Syllable3D::extrude(GLfloat thickness, bool rev_side_winding) {
 	// the opposite way (the extruded face points the same way as the
 	// the base face did
 	GLdouble start = age();
+	update_topology();
 	for (int i = num_vertices_base; i < num_vertices; ++i) {
-		GLfloat *basev = vertices[i - num_vertices_base];
-		GLfloat *basen = normals[i - num_vertices_base];
-		Vec basevec(basev), basenorm(basen), newvec;
-		newvec = basevec + thickness * basenorm;
-		vec3 newv, newn;
-		newvec.array_out(newv);
-		// copy new vertex
-		copyv(vertices[i], newv);
-		// copy new normal (same as base vertex normal)
-		copyv(normals[i], basen);
+		linalg::Vec3f &basev = linalg::as_vec3(vertices[i - num_vertices_base]);
+		linalg::Vec3f &basen = linalg::as_vec3(normals[i - num_vertices_base]);
+		// new vertex
+		linalg::as_vec3(vertices[i]) = basev + thickness * basen;
+		// new normal (same as base vertex normal)
+		linalg::as_vec3(normals[i]) = basen;
 		// flip base normal
-		Vec newbasenorm = -1 * basenorm;
-		newbasenorm.array_out(newn);
-		copyv(basen, newn);
+		basen = -basen;
 	}
 
 	// similar process with copying the polygons to the extruded face
@@ -446,7 +490,7 @@ void Syllable3D::extrude(GLfloat thickness, bool rev_side_winding) {
 	bool base_center_found = false;
 	for (size_t i = 0; i < base_face.polygons.size(); ++i) {
 		Polygon *basep = base_face.polygons[i];
-		Triangle *t = new Triangle(vertices, normals);
+		Triangle *t = new_triangle();
 		for (int j = 0; j < t->size; ++j) {
 			t->verts[j] = basep->verts[j] + num_vertices_base;
 			t->norms[j] = basep->norms[j] + num_vertices_base;
@@ -469,10 +513,8 @@ void Syllable3D::extrude(GLfloat thickness, bool rev_side_winding) {
 		// then set syllable's center as the midpoint
 		if(i == (size_t)base_center_index) {
 			base_center_found = true;
-			Polygon base_center;
-			base_face.get_center(base_center);
 //			cout << "*** extrude: found center: " << endl
-//					<< "i = " << i << ", " << base_center.to_string() << endl;
+//					<< "i = " << i << ", " << base_face.center_poly().to_string() << endl;
 			extruded_face.set_center(t->center);
 			vec3 bc, ec;
 			base_face.get_center(bc);
@@ -490,82 +532,8 @@ void Syllable3D::extrude(GLfloat thickness, bool rev_side_winding) {
 	// getting serious about these centers .. :)
 	assert(base_center_found);
 
-	// initialize regions on extruded
-//	extruded_face.init_regions(num_vertices_base);
-	//** debug
-//	goto AFTER_REGIONS_INIT;
-
-	// copy regions and perimeters from base to extruded face
-	for (size_t i = 0; i < base_face.regions.size(); ++i) {
-		Region *basereg = base_face.regions[i];
-		Region *extreg = new Region();
-//		cout << "extrude: region " << i << "  basereg->polygons.size(): " << basereg->polygons.size() << endl;
-		// copy polygons
-		for (size_t j = 0; j < basereg->polygons.size(); ++j) {
-			Polygon *bp = basereg->polygons[j];
-//			cout << "base poly: " << j << "  "<< bp->to_string() << endl;
-			GLuint poly_index = base_face.get_poly_index(bp);
-			if(poly_index >= extruded_face.polygons.size()) {
-				cout << "***** extrude: poly index = " << poly_index << ", out of range" << endl
-						<< "extruded_face.polygons.size(): " << extruded_face.polygons.size() << endl;
-				cout << "base_face.polygons.size(): " << base_face.polygons.size() << endl;
-			}
-			extreg->polygons.push_back( extruded_face.polygons[poly_index]);
-//			cout << "extr poly: " << j << "  " << extruded_face.polygons[poly_index]->to_string() << endl;
-		}
-//		cout << "extreg->polygons.size(): " << extreg->polygons.size() << ", equals base polygons' size? = "
-//				<< (extreg->polygons.size() == basereg->polygons.size()) << endl;
-		// copy perimeter
-		for (size_t j = 0; j < basereg->perimeter.size(); ++j) {
-			GLint vert = basereg->perimeter[j] + num_vertices_base;
-			extreg->perimeter.push_back(vert);
-		}
-		// copy inner perimeters
-		for (size_t j = 0; j < basereg->inner_perimeters.size(); ++j) {
-			vector<GLint> new_inner;
-			for (size_t k = 0; k < basereg->inner_perimeters[j].size(); ++k) {
-				GLint vert = basereg->inner_perimeters[j][k] + num_vertices_base;
-				new_inner.push_back(vert);
-			}
-			extreg->inner_perimeters.push_back(new_inner);
-		}
-		extruded_face.regions.push_back(extreg);
-	}
-
-	//** debug
-//	AFTER_REGIONS_INIT:
-
-	//*** debug
-	for (size_t i = 0; i < extruded_face.regions.size(); ++i) {
-		Region *r = extruded_face.regions[i];
-		for (size_t j = 0; j < r->perimeter.size(); j++) {
-			extruded_face.debug_verts.push_back(r->perimeter[j]);
-		}
-		for (size_t j = 0; j < r->inner_perimeters.size(); ++j) {
-			for (size_t k = 0; k < r->inner_perimeters[j].size(); ++k) {
-				extruded_face.debug_verts.push_back(r->inner_perimeters[j][k]);
-			}
-		}
-	}
-//	cout << "** before adding extruded debug verts, "
-//			<< " debug_verts.size(): " << debug_verts.size() << endl;
-//
-//	// debug
-//	add_all(extruded_face.debug_polygons, debug_polygons);
-//	add_all(extruded_face.debug_verts, debug_verts);
-//	add_all(extruded_face.debug_edges, debug_edges);
-
-//	cout << "*** debug_verts.size(): " << debug_verts.size() << endl;
-//
-//	cout << "extruded face debug verts: " << extruded_face.debug_verts.size()
-//			<< ", base face debug verts: " << base_face.debug_verts.size() << endl;
-//	cout << "**** debug verts ****" << endl;
-	for (size_t i = 0; i < base_face.debug_verts.size(); ++i) {
-		vec3 basev, extrv;
-		get_vert(base_face.debug_verts[i], basev);
-		get_vert(extruded_face.debug_verts[i], extrv);
-//		cout << i << " base: " << stringv(basev) << ", extr: " << stringv(extrv) << endl;
-	}
+	// the extruded face's regions mirror the base face's,
+	// extruded_regions() copies them if anything needs them
 	// check for problems
 //	cout << "Checking extruded to base" << endl;
 //	check_extruded_to_base();
@@ -577,6 +545,7 @@ void Syllable3D::extrude(GLfloat thickness, bool rev_side_winding) {
 	// vertices mirroring each other, we can fix the base face
 	// perimeters to maintain right-handed winding direction
 	base_face.reverse_perimeter_windings();
+	base_perimeters_reversed = true;
 
 //	cout << endl << "Syllable3D::extrude():  extruded syllable polygons:" << endl;
 //	cout << "base face: " << base_face.polygons.size() << endl;
@@ -668,6 +637,7 @@ void Syllable3D::average_vertex_normals() {
 // set all vertex normals in face to be the average of the facet normals
 // of each polygon the vertex is contained in
 void Syllable3D::average_vertex_normals(Face& face) {
+	invalidate_overlays();
 	vector<Polygon *> polys_containing;
 	for (size_t i = 0; i < face.polygons.size(); ++i) {
 		Polygon *p = face.polygons[i];
@@ -688,6 +658,7 @@ void Syllable3D::average_vertex_normals(Face& face) {
 // confirm extruded face is properly initialized from base face
 // call this before reversing windings on base face
 void Syllable3D::check_extruded_to_base() {
+	extruded_regions();
 	if(base_face.polygons.size() != extruded_face.polygons.size()) {
 		cout << "check_base_to_extruded:  base and extruded have different number of polygons, exiting" << endl
 				<< "base_face.polygons.size(): " << base_face.polygons.size()
@@ -740,8 +711,8 @@ void Syllable3D::check_extruded_to_base() {
 			exit(1);
 		}
 		for (size_t j = 0; j < br->inner_perimeters.size(); ++j) {
-			vector<GLint> bper = br->inner_perimeters[j];
-			vector<GLint> eper = er->inner_perimeters[j];
+			const Perimeter& bper = br->inner_perimeters[j];
+			const Perimeter& eper = er->inner_perimeters[j];
 			if(bper.size() != eper.size()) {
 				cout << "!= inner_perimeters[" << j << "] size:  base size: "
 						<< bper.size() << " extr size: " << eper.size() << endl;
@@ -756,17 +727,19 @@ void Syllable3D::check_extruded_to_base() {
 			}
 
 		}
-		// check polygons of each, the vector of polygons in a region
-		// is a vector of pointers, so need to get indices
+		// check polygons of each
 		// as with the other face members, equivalent polygons
 		// should have the same index in each face
-		for (size_t j = 0; j < br->polygons.size(); ++j) {
-			Polygon *bp = br->polygons[j];
-			GLint bp_index = base_face.get_poly_index(bp);
-			if(*base_face.polygons[bp_index] != *bp) {
+		if(br->poly_ids != er->poly_ids) {
+			cout << "!= : check_base_to_extruded: region = " << i << " poly ids differ" << endl;
+		}
+		for (size_t j = 0; j < br->poly_ids.size(); ++j) {
+			Polygon *bp = br->poly(j);
+			GLint bp_index = br->poly_ids[j];
+			if(base_face.get_poly_index(bp) != bp_index) {
 				cout << "base face polygon from pointer not matching to index: bp_index=" << bp_index << endl;
 			}
-			Polygon *ep = extruded_face.polygons[bp_index];
+			Polygon *ep = er->poly(j);
 			bool eq = true;
 			for (int k = 0; k < bp->size; ++k) {
 				if(ep->verts[k] != bp->verts[k] + num_vertices_base) {
@@ -802,18 +775,20 @@ void Syllable3D::check_extruded_to_base() {
 // param: rev_winding [false], if true, will reverse vertex order
 //		  and set facetnorm accordingly
 void Syllable3D::create_sides(bool rev_winding) {
-	for (size_t i = 0; i < base_face.regions.size(); ++i) {
-		Region *breg = base_face.regions[i];
-		Region *ereg = extruded_face.regions[i];
+	const vector<Region*>& regions = base_regions();
+	// extruded perimeters are the base ones, offset, until the base's are reversed
+	GLint e = num_vertices_base;
+	for (size_t i = 0; i < regions.size(); ++i) {
+		Region *breg = regions[i];
 
 		// outer perim first
 		// set quad vertices with right hand winding
 		for (size_t j = 0; j < breg->perimeter.size()-1; ++j) {
-			Quad *q = new Quad(vertices, normals);
+			Quad *q = new_quad();
 			q->verts[0] = breg->perimeter[j];
 			q->verts[1] = breg->perimeter[j+1];
-			q->verts[2] = ereg->perimeter[j+1];
-			q->verts[3] = ereg->perimeter[j];
+			q->verts[2] = breg->perimeter[j+1] + e;
+			q->verts[3] = breg->perimeter[j] + e;
 			for (int k = 0; k < 4; ++k) {
 				q->norms[k] = -1;
 			}
@@ -827,11 +802,11 @@ void Syllable3D::create_sides(bool rev_winding) {
 		}
 		// set last quad
 		int last = breg->perimeter.size()-1;
-		Quad *q = new Quad(vertices, normals);
+		Quad *q = new_quad();
 		q->verts[0] = breg->perimeter[last];
 		q->verts[1] = breg->perimeter[0];
-		q->verts[2] = ereg->perimeter[0];
-		q->verts[3] = ereg->perimeter[last];
+		q->verts[2] = breg->perimeter[0] + e;
+		q->verts[3] = breg->perimeter[last] + e;
 		for (int k = 0; k < 4; ++k) {
 			q->norms[k] = -1;
 		}
@@ -847,11 +822,11 @@ void Syllable3D::create_sides(bool rev_winding) {
 		// note windings are reversed of outer perims
 		for (size_t p = 0; p < breg->inner_perimeters.size(); ++p) {
 			for (size_t j = 0; j < breg->inner_perimeters[p].size()-1; ++j) {
-				Quad *q = new Quad(vertices, normals);
+				Quad *q = new_quad();
 				q->verts[0] = breg->inner_perimeters[p][j];
 				q->verts[1] = breg->inner_perimeters[p][j+1];
-				q->verts[2] = ereg->inner_perimeters[p][j+1];
-				q->verts[3] = ereg->inner_perimeters[p][j];
+				q->verts[2] = breg->inner_perimeters[p][j+1] + e;
+				q->verts[3] = breg->inner_perimeters[p][j] + e;
 				for (int k = 0; k < 4; ++k) {
 					q->norms[k] = -1;
 				}
@@ -866,11 +841,11 @@ void Syllable3D::create_sides(bool rev_winding) {
 			}
 			// set last quad
 			last = breg->inner_perimeters[p].size()-1;
-			Quad *q = new Quad(vertices, normals);
+			Quad *q = new_quad();
 			q->verts[0] = breg->inner_perimeters[p][last];
 			q->verts[1] = breg->inner_perimeters[p][0];
-			q->verts[2] = ereg->inner_perimeters[p][0];
-			q->verts[3] = ereg->inner_perimeters[p][last];
+			q->verts[2] = breg->inner_perimeters[p][0] + e;
+			q->verts[3] = breg->inner_perimeters[p][last] + e;
 			for (int k = 0; k < 4; ++k) {
 				q->norms[k] = -1;
 			}
@@ -1046,8 +1021,12 @@ void Syllable3D::render_face(const Face& face, GLfloat *color, bool wire,
 
 	glPushAttrib(GL_ALL_ATTRIB_BITS);
 	int numcolors = Util::numcolors;
+	int surface = &face == &extruded_face ? EXTRUDED : BASE;
 
 	for (size_t p=0; p < face.polygons.size(); p++) {
+		if(!drawn(surface, p)) {
+			continue;
+		}
 
 		// if no materials set, set color and disable lighting
 		if(no_mat) {
@@ -1114,6 +1093,9 @@ void Syllable3D::render_sides(GLfloat *color, bool wire,
 	//				Util::grey, Util::magenta, Util::white, Util::cyan, Util::black };
 
 	for (size_t p=0; p < sides.size(); p++) {
+		if(!drawn(SIDES, p)) {
+			continue;
+		}
 
 		// if no materials set, set color and disable lighting
 		if(no_mat) {
@@ -1166,6 +1148,55 @@ void Syllable3D::render_sides(GLfloat *color, bool wire,
 	}
 	glPopAttrib();
 }
+void Syllable3D::render_lod(const Lod& l, GLfloat *color, bool wire,
+		bool no_mat, GLfloat line_sz) {
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	if(wire) {
+		glLineWidth(line_sz);
+		glDisable(GL_LIGHTING);
+		if(!no_mat) {
+			vec3 col = {ambient_diffuse[0], ambient_diffuse[1], ambient_diffuse[2]};
+			glColor3fv(col);
+		}
+	}
+	int numcolors = Util::numcolors;
+	const LodLevel *faces[] = { &l.base, &l.extruded };
+	for (int f = 0; f < 2; ++f) {
+		const LodLevel& face = *faces[f];
+		for (size_t p = 0; p < face.num_triangles(); ++p) {
+			if(!drawn(f, p)) {
+				continue;
+			}
+			if(no_mat) {
+				glDisable(GL_LIGHTING);
+				glColor3fv(color != NULL ? color : colors[p%numcolors]);
+			}
+			glBegin(wire ? GL_LINE_LOOP : GL_TRIANGLES);
+			for (int i = 0; i < 3; ++i) {
+				glNormal3fv( normals[ face.norms[3*p + i] ] );
+				glVertex3fv( vertices[ face.verts[3*p + i] ] );
+			}
+			glEnd();
+		}
+	}
+	for (size_t p = 0; p < l.side_norms.size(); ++p) {
+		if(!drawn(SIDES, p)) {
+			continue;
+		}
+		if(no_mat) {
+			glDisable(GL_LIGHTING);
+			glColor3fv(color != NULL ? color : colors[p%numcolors]);
+		}
+		glNormal3fv(l.side_norms[p].v);
+		glBegin(wire ? GL_LINE_LOOP : GL_QUADS);
+		for (int i = 0; i < 4; ++i) {
+			glVertex3fv( vertices[ l.side_verts[4*p + i] ] );
+		}
+		glEnd();
+	}
+	glPopAttrib();
+}
+
 /**
  * Draw all normals the same size, if not given, will use average of max/min base face poly
  * side lengths
@@ -1174,129 +1205,74 @@ void Syllable3D::render_sides(GLfloat *color, bool wire,
  * 					'b': both
  */
 void Syllable3D::draw_normals(char which, GLfloat size) {
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-	glDisable(GL_LIGHTING);
-	glLineWidth(1);
-	glPointSize(1);
-	glEnable(GL_POINT_SMOOTH);
-
-//	static GLfloat t = 0;
-//	GLfloat a = age(true);
-//	if(t < a - 1.0) {
-//		cout << "show_normals: " << show_normals << ", show_facet_norms: "
-//				<< show_facet_norms << ", show_vert_norms: " << show_vert_norms << endl;
-//		t = a;
-//	}
 	if(size < 0) {
+		update_topology();
 		size = (base_face.longest_side_len + base_face.shortest_side_len) / 2;
 	}
-	// do faces
+	if(!normals_overlay.is_built() || which != normals_which || size != normals_size) {
+		build_normals_overlay(which, size);
+	}
+	normals_overlay.draw(1, 1, true);
+}
+
+void Syllable3D::build_normals_overlay(char which, GLfloat size) {
+	normals_overlay.clear();
+	normals_which = which;
+	normals_size = size;
+	bool vert_norms = which == 'v' || which == 'b';
+	bool facet_norms = which == 'f' || which == 'b';
+	// do faces, then sides with their own normals
 	PolygonArray polys;
 	polys.insert(polys.end(), base_face.polygons.begin(), base_face.polygons.end());
 	polys.insert(polys.end(), extruded_face.polygons.begin(), extruded_face.polygons.end());
-	if(which == 'v' || which == 'b') {
-		glColor3fv(Util::cyan);
-		for (size_t i = 0; i < polys.size(); ++i) {
-			const Polygon *p = polys[i];
-
-			for (int j = 0; j < p->size; ++j) {
-				Vec v(vertices[p->verts[j]]), vn(normals[p->norms[j]]);
-				Vec end = v + size * vn;
-
-				glBegin(GL_LINES);
-				v.glVertex();
-				end.glVertex();
-				glEnd();
-				glBegin(GL_POINTS);
-				end.glVertex();
-				glEnd();
-			}
-		}
-	}
-	if(which == 'f' || which == 'b') {
-		glColor3fv(Util::magenta);
-		for (size_t i = 0; i < polys.size(); ++i) {
-			const Polygon *p = polys[i];
-			Vec c(p->center), fn(p->facetnorm);
-			Vec end = c + size * fn;
-
-			glBegin(GL_LINES);
-			c.glVertex();
-			end.glVertex();
-			glEnd();
-			glBegin(GL_POINTS);
-			end.glVertex();
-			glEnd();
-
-		}
-	}
-	// do sides separately
-	if(which == 'v' || which == 'b') {
-		glColor3fv(Util::cyan);
-		for (size_t i = 0; i < sides.size(); ++i) {
-			const Polygon *p = sides[i];
-
+	size_t num_face_polys = polys.size();
+	polys.insert(polys.end(), sides.begin(), sides.end());
+	for (size_t i = 0; i < polys.size(); ++i) {
+		const Polygon *p = polys[i];
+		vec3 *norms = i < num_face_polys ? normals : side_normals;
+		if(vert_norms) {
 			for (int j = 0; j < p->size; ++j) {
-				Vec v(vertices[p->verts[j]]), vn(side_normals[p->norms[j]]);
-				Vec end = v + size * vn;
-
-				glBegin(GL_LINES);
-				v.glVertex();
-				end.glVertex();
-				glEnd();
-				glBegin(GL_POINTS);
-				end.glVertex();
-				glEnd();
+				normals_overlay.add_normal(vertices[p->verts[j]], norms[p->norms[j]], size, Util::cyan);
 			}
 		}
-	}
-	if(which == 'f' || which == 'b') {
-		glColor3fv(Util::magenta);
-		for (size_t i = 0; i < sides.size(); ++i) {
-			const Polygon *p = sides[i];
-			Vec c(p->center), fn(p->facetnorm);
-			Vec end = c + size * fn;
-
-			glBegin(GL_LINES);
-			c.glVertex();
-			end.glVertex();
-			glEnd();
-			glBegin(GL_POINTS);
-			end.glVertex();
-			glEnd();
-
+		if(facet_norms) {
+			normals_overlay.add_normal(p->center, p->facetnorm, size, Util::magenta);
 		}
 	}
+	normals_overlay.done();
+}
 
-	glPopAttrib();
-
+void Syllable3D::invalidate_overlays() {
+	normals_overlay.clear();
+	debug_overlay.clear();
 }
+
 // just draw debug stuff
 void Syllable3D::render_debug(GLfloat *color) {
+	update_debug();
+	size_t counts[] = { debug_points.size(), debug_verts.size(), debug_polygons.size(), debug_edges.size() };
+	if(!debug_overlay.is_built() || color != debug_color || !std::equal(counts, counts + 4, debug_counts)) {
+		copy(counts, counts + 4, debug_counts);
+		debug_color = color;
+		build_debug_overlay(color);
+	}
+	debug_overlay.draw(2, 4);
+}
+
+void Syllable3D::build_debug_overlay(GLfloat *color) {
 	bool draw_edges = true;
 	bool draw_points = true;
 	bool draw_verts = true;
 	bool draw_polys = true;
 
-	glPushAttrib(GL_ALL_ATTRIB_BITS);
-	if( glIsEnabled(GL_LIGHTING) ) glDisable(GL_LIGHTING);
-	glPointSize(4);
-	glLineWidth(2);
-
+	debug_overlay.clear();
 	int numcolors = Util::numcolors;
 	if(draw_points) {
-		glBegin(GL_POINTS);
 		for (size_t i = 0; i < debug_points.size(); ++i) {
-			if(color != NULL) {
-				glColor3fv(color);
-			} else {
-				glColor3fv(colors[i%numcolors]);
-			}
 			vec3 vert;
 			debug_points[i].array_out(vert);
-			glVertex3fv(vert);
+			debug_overlay.add_point(vert, color != NULL ? color : colors[i%numcolors]);
 		}
-		glEnd();
 	}
 // color order: { Util::red, Util::purple, Util::blue, Util::green, Util::yellow,
 //				Util::grey, Util::magenta, Util::white, Util::cyan, Util::black };
@@ -1305,49 +1281,27 @@ void Syllable3D::render_debug(GLfloat *color) {
 		// to show sequence easier, show this many verts in order in each color
 		int verts_per_color = 20; //debug_verts.size()/20;
 				// for all:  debug_verts.size()/numcolors;
-		glBegin(GL_POINTS);
 		for (size_t i = 0; i < debug_verts.size()/3; ++i) {
-			if(color != NULL) {
-				glColor3fv(color);
-			} else {
-//				glColor3fv(colors[i%numcolors]);
-				// alternate colors over entire shape, 1 region per color
-				glColor3fv( colors[ (i/verts_per_color) % numcolors]);
-			}
-			glVertex3fv(vertices[debug_verts[i]]);
+			// alternate colors over entire shape, 1 region per color
+			GLfloat *c = color != NULL ? color : colors[ (i/verts_per_color) % numcolors];
+			debug_overlay.add_point(vertices[debug_verts[i]], c);
 		}
-		glEnd();
 	}
 	if(draw_polys) {
-//		cout << "debug_polygons.size(): " << debug_polygons.size() << endl;
 		int polys_per_color = 20;
 		for (size_t i = 0; i < debug_polygons.size(); ++i) {
 			Polygon *p = debug_polygons[i];
-			GLfloat *color = colors[ (i/polys_per_color) % numcolors];
-			render_poly(*p, color);
+			debug_overlay.add_polygon(vertices, p->verts, p->size, colors[ (i/polys_per_color) % numcolors]);
 		}
 	}
 	if(draw_edges) {
+		GLfloat blue[] = { 0, 0, 1 };
 		for (size_t i = 0; i < debug_edges.size(); ++i) {
 			IndexedEdge e = debug_edges[i];
-			glBegin(GL_LINES);
-			if(color == NULL) {
-				glColor3f(0, 0, 1);
-			} else {
-				glColor3fv(colors[i%numcolors]);
-			}
-			glVertex3fv(vertices[e.u]);
-			glVertex3fv(vertices[e.v]);
-			glEnd();
+			debug_overlay.add_line(vertices[e.u], vertices[e.v], color == NULL ? blue : colors[i%numcolors]);
 		}
 	}
-	// debug polygons if we need to see something
-//	GLfloat color[3] = { 5., 0, .5 };
-//	for (size_t i = 0; i < debug_polygons.size(); ++i) {
-//		render_poly(*debug_polygons[i], color);
-//	}
-	if( glIsEnabled(GL_LIGHTING) ) glEnable(GL_LIGHTING);
-	glPopAttrib();
+	debug_overlay.done();
 }
 
 void Syllable3D::print_verts(int start, int end) {
@@ -1369,6 +1323,54 @@ PolygonArray Syllable3D::get_all_polys() {
 	return polys;
 }
 
+// facet normals of the side quads from the vertices
+static void lod_side_norms(const vec3 *vertices, Syllable3D::Lod& l) {
+	l.side_norms.resize(l.side_verts.size() / 4);
+	for (size_t i = 0; i < l.side_norms.size(); ++i) {
+		const GLint *q = &l.side_verts[4 * i];
+		// diagonals, same direction as the quad's facetnorm
+		linalg::Vec3f d0 = linalg::as_vec3(vertices[q[2]]) - linalg::as_vec3(vertices[q[0]]);
+		linalg::Vec3f d1 = linalg::as_vec3(vertices[q[3]]) - linalg::as_vec3(vertices[q[1]]);
+		l.side_norms[i] = linalg::normalized(linalg::cross(d0, d1));
+	}
+}
+
+void Syllable3D::bake_transform(const DR::linalg::Mat4f& m) {
+	linalg::Mat4f nm = normal_matrix(m);
+	transform_points(m, vertices, vertices, num_vertices);
+	transform_normals(m, normals, normals, num_normals);
+	if(side_normals) {
+		transform_normals(m, side_normals, side_normals, num_normals_sides);
+	}
+	Face *faces[] = { &base_face, &extruded_face };
+	for (int f = 0; f < 2; ++f) {
+		for (size_t i = 0; i < faces[f]->polygons.size(); ++i) {
+			faces[f]->polygons[i]->bake_transform(m, nm);
+		}
+	}
+	for (size_t i = 0; i < sides.size(); ++i) {
+		sides[i]->bake_transform(m, nm);
+	}
+	transform_points(m, &center, &center, 1);
+	transform_points(m, &assigned_center, &assigned_center, 1);
+	invalidate_overlays();
+	if(!lods.empty()) {
+		// errors grow with the largest scale
+		GLfloat scale = max_scale(m);
+		for (size_t i = 0; i < lods.size(); ++i) {
+			lods[i].base.error *= scale;
+			lods[i].extruded.error *= scale;
+			lod_errors[i].error *= scale;
+			lod_side_norms(vertices, lods[i]);
+		}
+	}
+	if(meshlet_vertices) {
+		build_meshlets(meshlet_vertices, meshlet_triangles);
+	} else if(!buffers.empty()) {
+		build_buffers(buffers_optimized);
+	}
+}
+
 // get a copy of the actual vertex from its index
 void Syllable3D::get_vert(GLint index, vec3 out) {
 	copyv(out, vertices[index]);
@@ -1378,13 +1380,555 @@ void Syllable3D::get_norm(GLint index, vec3 out) {
 	copyv(out, normals[index]);
 }
 
+// position as in the obj, glm's arrays are 1 based
+void Syllable3D::get_layout_vert(GLint index, vec3 out) {
+	assert(index >= 0 && index < num_vertices_base);
+	GLint in_model = getBase2dModel()->numvertices;
+	if(index < in_model) {
+		copyv(out, &getBase2dModel()->vertices[(index+1)*3]);
+	} else {
+		added_layout[index - in_model].array_out(out);
+	}
+}
+
 void Syllable3D::get_center(vec3 out) {
+	if(extruded_face.polygons.empty()) {
+		update_topology();
+	}
 	copyv(out, center);
 }
 
+void Syllable3D::update_topology() {
+	if(!topology_dirty) {
+		return;
+	}
+	topology_dirty = false;
+	// find regions and perimeters in base face
+	base_face.init_regions(0);
+	base_perimeters_reversed = false;
+	// tell base face to set center polygon
+	// so we have it available for later
+	base_face.set_center( Vec(0, 0, 1) );
+	// set syllable's center to the base_face's center
+	// until extruded, mapped, etc
+	if(extruded_face.polygons.empty()) {
+		base_face.get_center(center);
+	}
+}
+
+const vector<Region*>& Syllable3D::base_regions() {
+	update_topology();
+	return base_face.regions;
+}
+
+const vector<Region*>& Syllable3D::extruded_regions() {
+	update_topology();
+	if(extruded_face.regions.empty() && !extruded_face.polygons.empty()) {
+		// copy regions and perimeters from base to extruded face
+		for (size_t i = 0; i < base_face.regions.size(); ++i) {
+			Region *basereg = base_face.regions[i];
+			Region *extreg = extruded_face.new_region();
+			// extruded polys were added in base order, so the ids are the same
+			assert(extruded_face.polygons.size() == base_face.polygons.size());
+			extreg->poly_ids = basereg->poly_ids;
+			extreg->perimeter.reserve(basereg->perimeter.size());
+			for (size_t j = 0; j < basereg->perimeter.size(); ++j) {
+				extreg->perimeter.push_back(basereg->perimeter[j] + num_vertices_base);
+			}
+			for (size_t j = 0; j < basereg->inner_perimeters.size(); ++j) {
+				const Perimeter& inner = basereg->inner_perimeters[j];
+				Perimeter& new_inner = extreg->add_inner_perimeter();
+				new_inner.reserve(inner.size());
+				for (size_t k = 0; k < inner.size(); ++k) {
+					new_inner.push_back(inner[k] + num_vertices_base);
+				}
+			}
+			extruded_face.regions.push_back(extreg);
+		}
+		// the extruded face keeps the windings the sides were made with
+		if(base_perimeters_reversed) {
+			extruded_face.reverse_perimeter_windings();
+		}
+	}
+	return extruded_face.regions;
+}
+
+void Syllable3D::update_debug() {
+	if(!debug_dirty) {
+		return;
+	}
+	debug_dirty = false;
+	update_topology();
+	debug_edges.clear();
+	debug_points.clear();
+	debug_polygons.clear();
+	debug_verts.clear();
+	add_all(base_face.debug_polygons, debug_polygons);
+	add_all(base_face.debug_points, debug_points);
+	add_all(base_face.debug_edges, debug_edges);
+	// all the base perimeter vertices
+	base_face.get_perimeter_verts(debug_verts);
+}
+
+// largest error for a level of detail, as a fraction of the syllable's radius
+static const GLfloat LOD_MAX_ERROR = 0.05f;
+
+void Syllable3D::build_lods(GLfloat ratio, size_t max_levels) {
+	lods.clear();
+	lod_errors.clear();
+	lod = 0;
+	vector<GLint> tris, remap(num_vertices_base), base_norm, extr_norm;
+	for (size_t i = 0; i < base_face.polygons.size(); ++i) {
+		const Polygon *p = base_face.polygons[i];
+		if(p->size == 3) {
+			tris.insert(tris.end(), p->verts, p->verts + 3);
+		}
+	}
+	GLfloat radius = 0;
+	for (GLint i = 0; i < num_vertices_base; ++i) {
+		radius = max(radius, linalg::distance(linalg::as_vec3(vertices[i]), linalg::as_vec3(center)));
+		remap[i] = i;
+	}
+	vertex_normals(base_face.polygons, num_vertices, base_norm);
+	vertex_normals(extruded_face.polygons, num_vertices, extr_norm);
+
+	// the extruded face follows the base face's collapses
+	QemSimplifier qem(vertices, num_vertices_base, tris);
+	size_t last = qem.num_triangles();
+	while(lods.size() < max_levels) {
+		if(!lods.empty()) {
+			size_t got = qem.simplify((size_t)(last * ratio), radius * LOD_MAX_ERROR);
+			if(got * 10 > last * 9) {
+				break;
+			}
+			last = got;
+			qem.get_remap(remap);
+		}
+		lods.push_back(Lod());
+		Lod& l = lods.back();
+		remap_triangles(base_face.polygons, remap, base_norm, 0, l.base);
+		remap_triangles(extruded_face.polygons, remap, extr_norm, num_vertices_base, l.extruded);
+		l.base.error = l.extruded.error = qem.error();
+		lod_errors.push_back(LodLevel());
+		lod_errors.back().error = l.base.error;
+		build_lod_sides(remap, l);
+	}
+	if(meshlet_vertices) {
+		build_meshlets(meshlet_vertices, meshlet_triangles);
+	} else if(!buffers.empty()) {
+		build_buffers(buffers_optimized);
+	}
+}
+
+// same order and winding as create_sides, skipping merged vertices
+void Syllable3D::build_lod_sides(const vector<GLint>& remap, Lod& l) {
+	l.side_verts.clear();
+	vector<size_t> kept;
+	// first side quad of the current perimeter
+	size_t first = 0;
+	const vector<Region*>& eregs = extruded_regions();
+	for (size_t i = 0; i < base_face.regions.size(); ++i) {
+		Region *breg = base_face.regions[i];
+		Region *ereg = eregs[i];
+		for (size_t p = 0; p <= breg->inner_perimeters.size(); ++p) {
+			const Perimeter& bper = p == 0 ? breg->perimeter : breg->inner_perimeters[p-1];
+			const Perimeter& eper = p == 0 ? ereg->perimeter : ereg->inner_perimeters[p-1];
+			kept.clear();
+			for (size_t j = 0; j < bper.size(); ++j) {
+				if(remap[bper[j]] == bper[j]) {
+					kept.push_back(j);
+				}
+			}
+			for (size_t k = 0; k < kept.size(); ++k) {
+				size_t a = kept[k], b = kept[(k + 1) % kept.size()];
+				// create_sides' quad for a starts at bper[a], and goes to
+				// bper[a+1] unless it was reversed
+				const Polygon *full = sides[first + a];
+				GLint quad[] = { bper[a], bper[b], eper[b], eper[a] };
+				if(full->verts[1] != bper[(a + 1) % bper.size()]) {
+					swap(quad[1], quad[3]);
+				}
+				l.side_verts.insert(l.side_verts.end(), quad, quad + 4);
+			}
+			first += bper.size();
+		}
+	}
+	assert(first == sides.size());
+	lod_side_norms(vertices, l);
+}
+
+// average of p's vertices
+static linalg::Vec3f poly_center(const Polygon *p, const vec3 *vertices) {
+	linalg::Vec3f c;
+	for (int k = 0; k < p->size; ++k) {
+		c += linalg::as_vec3(vertices[p->verts[k]]);
+	}
+	return c * (1.0f / p->size);
+}
+
+void Syllable3D::find_outward() {
+	// faces point away from each other, polygon i of each are opposite
+	int votes = 0;
+	for (size_t i = 0; i < base_face.polygons.size() && i < extruded_face.polygons.size(); ++i) {
+		const Polygon *bp = base_face.polygons[i];
+		linalg::Vec3f apart = poly_center(bp, vertices) - poly_center(extruded_face.polygons[i], vertices);
+		votes += linalg::dot(linalg::as_vec3(bp->facetnorm), apart) >= 0 ? 1 : -1;
+	}
+	outward[BASE] = votes >= 0 ? 1 : -1;
+	votes = 0;
+	for (size_t i = 0; i < extruded_face.polygons.size() && i < base_face.polygons.size(); ++i) {
+		const Polygon *ep = extruded_face.polygons[i];
+		linalg::Vec3f apart = poly_center(ep, vertices) - poly_center(base_face.polygons[i], vertices);
+		votes += linalg::dot(linalg::as_vec3(ep->facetnorm), apart) >= 0 ? 1 : -1;
+	}
+	outward[EXTRUDED] = votes >= 0 ? 1 : -1;
+	// sides point away from the base polygon on their base edge
+	votes = 0;
+	vector<GLint> edge;
+	for (size_t i = 0; i < sides.size(); ++i) {
+		const Polygon *q = sides[i];
+		edge.clear();
+		for (int k = 0; k < q->size; ++k) {
+			if(q->verts[k] < num_vertices_base) {
+				edge.push_back(q->verts[k]);
+			}
+		}
+		if(edge.size() != 2) {
+			continue;
+		}
+		const PolyIdSet& a = base_face.polys_containing(edge[0]);
+		const PolyIdSet& b = base_face.polys_containing(edge[1]);
+		for (size_t j = 0; j < a.size(); ++j) {
+			if(id_contains(b, a[j])) {
+				linalg::Vec3f mid = (linalg::as_vec3(vertices[edge[0]]) + linalg::as_vec3(vertices[edge[1]])) * 0.5f;
+				linalg::Vec3f away = mid - poly_center(base_face.polygons[a[j]], vertices);
+				votes += linalg::dot(linalg::as_vec3(q->facetnorm), away) >= 0 ? 1 : -1;
+				break;
+			}
+		}
+	}
+	outward[SIDES] = votes >= 0 ? 1 : -1;
+}
+
+void Syllable3D::build_meshlets(size_t max_vertices, size_t max_triangles) {
+	meshlet_vertices = max_vertices;
+	meshlet_triangles = max_triangles;
+	bounds_of(vertices, num_vertices, box, bounds);
+	find_outward();
+	DR::build_meshlets(base_face.polygons, vertices, outward[BASE], meshlets[BASE], max_vertices, max_triangles);
+	DR::build_meshlets(extruded_face.polygons, vertices, outward[EXTRUDED], meshlets[EXTRUDED],
+			max_vertices, max_triangles);
+	DR::build_meshlets(sides, vertices, outward[SIDES], meshlets[SIDES], max_vertices, max_triangles);
+	for (size_t i = 0; i < lods.size(); ++i) {
+		Lod& l = lods[i];
+		DR::build_meshlets(l.base.verts, 3, vertices, outward[BASE], l.meshlets[BASE], max_vertices, max_triangles);
+		DR::build_meshlets(l.extruded.verts, 3, vertices, outward[EXTRUDED], l.meshlets[EXTRUDED],
+				max_vertices, max_triangles);
+		DR::build_meshlets(l.side_verts, 4, vertices, outward[SIDES], l.meshlets[SIDES], max_vertices, max_triangles);
+	}
+	clear_cull();
+	if(!buffers.empty()) {
+		build_buffers(buffers_optimized);
+	}
+}
+
+void Syllable3D::cull(const Frustum& frustum, const linalg::Vec3f& eye, bool backface, CullStats& stats) {
+	bool at_lod = lod > 0 && lod < (int)lods.size();
+	const MeshletSet *ms = at_lod ? lods[lod].meshlets : meshlets;
+	size_t num_polys[] = { base_face.polygons.size(), extruded_face.polygons.size(), sides.size() };
+	if(at_lod) {
+		const Lod& l = lods[lod];
+		num_polys[BASE] = l.base.num_triangles();
+		num_polys[EXTRUDED] = l.extruded.num_triangles();
+		num_polys[SIDES] = l.side_verts.size() / 4;
+	}
+	culled_lod = at_lod ? lod : 0;
+	++stats.objects;
+	culled = !frustum.visible(bounds) || !frustum.visible(box);
+	stats.objects_culled += culled ? 1 : 0;
+	for (int s = 0; s < 3; ++s) {
+		stats.polygons += num_polys[s];
+		meshlet_visible[s].assign(ms[s].size(), 0);
+		// without meshlets all or nothing
+		poly_visible[s].assign(num_polys[s], ms[s].size() || culled ? 0 : 1);
+		for (size_t i = 0; i < ms[s].size(); ++i) {
+			const Meshlet& m = ms[s].meshlets[i];
+			++stats.meshlets;
+			if(culled || !frustum.visible(m.bounds)) {
+				++stats.meshlets_frustum;
+			} else if(backface && cone_backfacing(m.bounds, m.cone, eye)) {
+				++stats.meshlets_backface;
+			} else {
+				meshlet_visible[s][i] = 1;
+				for (GLuint t = 0; t < m.triangle_count; ++t) {
+					poly_visible[s][ms[s].prims[m.triangle_offset + t] >> 1] = 1;
+				}
+			}
+		}
+		for (size_t i = 0; i < num_polys[s]; ++i) {
+			stats.polygons_drawn += poly_visible[s][i];
+		}
+	}
+}
+
+void Syllable3D::clear_cull() {
+	culled = false;
+	culled_lod = 0;
+	for (int s = 0; s < 3; ++s) {
+		meshlet_visible[s].clear();
+		poly_visible[s].clear();
+	}
+}
+
+GLint Syllable3D::pick(const linalg::Vec3f& origin, const linalg::Vec3f& dir,
+		int& surface, GLfloat& dist) const {
+	GLint hit = -1;
+	dist = FLT_MAX;
+	for (int s = 0; s < 3; ++s) {
+		GLfloat d;
+		GLint t = meshlets[s].ray_intersect(vertices, origin, dir, d);
+		if(t >= 0 && d < dist) {
+			dist = d;
+			surface = s;
+			hit = meshlets[s].prims[t] >> 1;
+		}
+	}
+	return hit;
+}
+
+GLint Syllable3D::sample_polygon(int surface, bool visible_only) const {
+	size_t num_polys = surface == SIDES ? sides.size()
+			: surface == BASE ? base_face.polygons.size() : extruded_face.polygons.size();
+	if(num_polys == 0 || (visible_only && culled)) {
+		return -1;
+	}
+	const MeshletSet& ms = meshlets[surface];
+	if(ms.num_triangles() == 0) {
+		return rand() % num_polys;
+	}
+	const vector<char>& vis = meshlet_visible[surface];
+	bool all = !visible_only || culled_lod != 0 || vis.size() != ms.size();
+	// a triangle of the visible meshlets, then which meshlet it is in
+	size_t total = 0;
+	for (size_t i = 0; i < ms.size(); ++i) {
+		total += all || vis[i] ? ms.meshlets[i].triangle_count : 0;
+	}
+	if(total == 0) {
+		return -1;
+	}
+	size_t t = rand() % total;
+	for (size_t i = 0; i < ms.size(); ++i) {
+		if(!all && !vis[i]) {
+			continue;
+		}
+		const Meshlet& m = ms.meshlets[i];
+		if(t < m.triangle_count) {
+			return ms.prims[m.triangle_offset + t] >> 1;
+		}
+		t -= m.triangle_count;
+	}
+	return -1;
+}
+
+bool Syllable3D::upload_buffers(int& budget) {
+	return DR::upload_buffers(buffers, budget);
+}
+
+void Syllable3D::free_buffers() {
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		delete buffers[i];
+	}
+	buffers.clear();
+}
+
+void Syllable3D::buffer_polygon(MeshBuffer& mb, size_t level, int surface, GLint poly, int half) {
+	const GLint *pv, *pn = NULL;
+	const GLfloat *normal = NULL;
+	int size = 3;
+	if(level == 0) {
+		const Polygon *p = surface == SIDES ? sides[poly]
+				: surface == BASE ? base_face.polygons[poly] : extruded_face.polygons[poly];
+		pv = p->verts;
+		size = p->size;
+		// sides are flat shaded
+		if(surface == SIDES) {
+			normal = p->facetnorm;
+		} else {
+			pn = p->norms;
+		}
+	} else {
+		const Lod& l = lods[level];
+		if(surface == SIDES) {
+			pv = &l.side_verts[4 * poly];
+			normal = l.side_norms[poly].v;
+			size = 4;
+		} else {
+			const LodLevel& face = surface == BASE ? l.base : l.extruded;
+			pv = &face.verts[3 * poly];
+			pn = &face.norms[3 * poly];
+		}
+	}
+	if(half < 0) {
+		mb.add_polygon(vertices, pv, size, normals, pn, normal);
+		return;
+	}
+	GLint tv[] = { pv[0], pv[half + 1], pv[half + 2] };
+	GLint tn[] = { pn ? pn[0] : 0, pn ? pn[half + 1] : 0, pn ? pn[half + 2] : 0 };
+	mb.add_polygon(vertices, tv, 3, normals, pn ? tn : NULL, normal);
+}
+
+void Syllable3D::build_buffers(bool optimize) {
+	free_buffers();
+	buffers_optimized = optimize;
+	for (size_t level = 0; level < max((size_t)1, lods.size()); ++level) {
+		MeshBuffer *mb = new MeshBuffer();
+		const MeshletSet *ms = level ? lods[level].meshlets : meshlets;
+		for (int s = 0; s < 3; ++s) {
+			if(ms[s].size()) {
+				for (size_t i = 0; i < ms[s].size(); ++i) {
+					const Meshlet& m = ms[s].meshlets[i];
+					mb->begin_range();
+					for (GLuint t = 0; t < m.triangle_count; ++t) {
+						GLint prim = ms[s].prims[m.triangle_offset + t];
+						buffer_polygon(*mb, level, s, prim >> 1, prim & 1);
+					}
+				}
+				continue;
+			}
+			size_t num_polys = s == SIDES ? sides.size()
+					: s == BASE ? base_face.polygons.size() : extruded_face.polygons.size();
+			if(level) {
+				const Lod& l = lods[level];
+				num_polys = s == SIDES ? l.side_verts.size() / 4
+						: s == BASE ? l.base.num_triangles() : l.extruded.num_triangles();
+			}
+			mb->begin_range();
+			for (size_t p = 0; p < num_polys; ++p) {
+				buffer_polygon(*mb, level, s, p, -1);
+			}
+		}
+		if(optimize) {
+			mb->optimize();
+		}
+		buffers.push_back(mb);
+	}
+}
+
+void Syllable3D::render_buffer(size_t level, GLfloat *color, bool no_mat) {
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	if(no_mat) {
+		glDisable(GL_LIGHTING);
+		glColor3fv(color);
+	}
+	MeshBuffer *mb = buffers[level];
+	// ranges are the meshlets in order if cull() was for this level
+	range_visible.clear();
+	for (int s = 0; s < 3; ++s) {
+		range_visible.insert(range_visible.end(), meshlet_visible[s].begin(), meshlet_visible[s].end());
+	}
+	bool ranged = culled_lod == (int)level && !range_visible.empty() && range_visible.size() == mb->num_ranges();
+	mb->draw(ranged ? &range_visible[0] : NULL);
+	glPopAttrib();
+}
+
+int Syllable3D::select_lod(GLfloat pixels_per_unit, GLfloat max_pixels) {
+	lod = DR::select_lod(lod_errors, pixels_per_unit, max_pixels);
+	return lod;
+}
+
+void Syllable3D::triangulate_base(CDTMesh& out, const CDTOptions& opts, vector<GLint> *vert_index) {
+	CDT cdt;
+	// base vertex -> cdt point
+	vector<GLint> point(num_vertices_base, -1);
+	vector<GLint> loop;
+	if(vert_index) {
+		vert_index->clear();
+	}
+	update_topology();
+	for (size_t i = 0; i < base_face.regions.size(); ++i) {
+		Region *reg = base_face.regions[i];
+		for (size_t j = 0; j <= reg->inner_perimeters.size(); ++j) {
+			const Perimeter& perim = j == 0 ? reg->perimeter : reg->inner_perimeters[j-1];
+			loop.clear();
+			for (size_t k = 0; k < perim.size(); ++k) {
+				GLint v = perim[k];
+				if(point[v] < 0) {
+					point[v] = cdt.add_point(vertices[v][0], vertices[v][2]);
+					if(vert_index) {
+						vert_index->push_back(v);
+					}
+				}
+				loop.push_back(point[v]);
+			}
+			if(!loop.empty()) {
+				cdt.add_loop(&loop[0], loop.size());
+			}
+		}
+	}
+	cdt.triangulate(out, opts);
+}
+
+void Syllable3D::retessellate_base(const CDTOptions& opts) {
+	assert(extruded_face.polygons.empty());
+	CDTMesh mesh;
+	vector<GLint> index;
+	triangulate_base(mesh, opts, &index);
+	if(mesh.triangles.empty()) {
+		cout << "retessellate_base: no triangles, base face left as it was" << endl;
+		return;
+	}
+	invalidate_overlays();
+	// cdt point -> base vertex, refinement's points go after the old vertices
+	GLint old_base = num_vertices_base;
+	GLint n = old_base + (mesh.points.size() - index.size());
+	vector<GLint> vert(index);
+	for (GLint v = old_base; v < n; ++v) {
+		vert.push_back(v);
+	}
+	// the face's plane and normal, from a perimeter vertex
+	vec3 on_plane, up;
+	get_layout_vert(index[0], on_plane);
+	copyv(up, normals[index[0]]);
+
+	// room for the extruded face as in init_base, normals by vertex index
+	GLint nn = max(n, num_normals_base);
+	vec3 *verts = new vec3[2 * n], *norms = new vec3[2 * nn];
+	memcpy(verts, vertices, old_base * sizeof(vec3));
+	memcpy(norms, normals, num_normals_base * sizeof(vec3));
+	for (size_t i = index.size(); i < mesh.points.size(); ++i) {
+		GLint v = vert[i];
+		setv(verts[v], mesh.points[i][0], on_plane[1], mesh.points[i][1]);
+		copyv(norms[v], up);
+		added_layout.push_back(Vec(verts[v]));
+	}
+	// the old polygons point at the old arrays
+	base_face.clear();
+	delete [] vertices;
+	delete [] normals;
+	vertices = verts;
+	normals = norms;
+	num_vertices_base = n;
+	num_vertices = 2 * n;
+	num_normals_base = nn;
+	num_normals = 2 * nn;
+
+	for (size_t i = 0; i < mesh.triangles.size(); i += 3) {
+		Triangle *t = new_triangle();
+		for (int j = 0; j < 3; ++j) {
+			t->verts[j] = t->norms[j] = vert[mesh.triangles[i + j]];
+		}
+		// as init_base
+		t->set_winding_from_normal();
+		t->set_facetnorm();
+		base_face.add_polygon(t);
+	}
+	topology_dirty = debug_dirty = true;
+}
+
 // export all perimeters of base face to a .node file
 // assumes vertices are in xz plane
 void Syllable3D::export_node_file(const char *nodefile) {
+	update_topology();
 	ofstream out(nodefile);
 	vector<Vec> all_verts;
 	for (size_t i = 0; i < base_face.regions.size(); ++i) {
@@ -1417,6 +1961,7 @@ void Syllable3D::export_node_file(const char *nodefile) {
 // assumes 2d in xz plane,
 // assumes only one hole per region, and assumes that hole is convex (1 midpoint taken)
 void Syllable3D::export_poly_file(const char *polyfile) {
+	update_topology();
 	ofstream out(polyfile);
 	vector<Vec> all_verts;
 	vector<vector<int> > segments; // indexed to all_verts - inner vector has size 2
@@ -1539,8 +2084,103 @@ void Syllable3D::test() {
 
 	}
 
-
+	// extruded perimeters copied where check_extruded_to_base() would be,
+	// before extrude reverses the base's, match ones copied after
+	Syllable3D late;
+	late.initFromObj("data/om.obj");
+	late.init_base();
+	syll3d.extrude(0.2, true);
+	late.extrude(0.2, true);
+	syll3d.base_face.reverse_perimeter_windings();
+	syll3d.base_perimeters_reversed = false;
+	syll3d.extruded_regions();
+	syll3d.base_face.reverse_perimeter_windings();
+	syll3d.base_perimeters_reversed = true;
+	const vector<Region*>& early_regs = syll3d.extruded_regions();
+	const vector<Region*>& late_regs = late.extruded_regions();
+	bool same = early_regs.size() == late_regs.size();
+	for (size_t i = 0; same && i < early_regs.size(); ++i) {
+		same = early_regs[i]->perimeter == late_regs[i]->perimeter
+				&& early_regs[i]->inner_perimeters == late_regs[i]->inner_perimeters;
+	}
+	if(!same) {
+		cout << "!=: extruded perimeters depend on when they're copied" << endl;
+	}
 
 	cout << "\n***************** Done:  Syllable3D::test() ***********************"
 			<< endl;
 }
+
+// build all the mantra syllables, as show_mantra does
+static void build_syllables(vector<Syllable3D*>& sylls) {
+	const char *names[] = { "om", "ma", "ni", "pay", "may", "hung", "hrih" };
+	for (size_t i = 0; i < sizeof(names)/sizeof(names[0]); ++i) {
+		char filename[80];
+		sprintf(filename, "data/%s.obj", names[i]);
+		Syllable3D *syll = new Syllable3D();
+		syll->initFromObj(filename);
+		syll->init_base();
+		syll->extrude(0.2, true);
+		sylls.push_back(syll);
+	}
+}
+
+void Syllable3D::bench() {
+	cout <<  "\n******************** Syllable3D::bench() **************************" << endl;
+	bool saved = use_mesh_arenas;
+	// quiet the init chatter
+	streambuf *saved_buf = cout.rdbuf();
+	ostringstream chatter;
+	string report;
+	for (int arena = 1; arena >= 0; --arena) {
+		use_mesh_arenas = arena;
+		ostringstream out;
+		out << (arena ? "arena:" : "heap:") << endl;
+		vector<Syllable3D*> sylls;
+
+		cout.rdbuf(chatter.rdbuf());
+		AllocStats before = AllocStats::now();
+		Stopwatch sw;
+		build_syllables(sylls);
+		double ms = sw.elapsed_ms();
+		AllocStats build = AllocStats::now() - before;
+		out << "\tbuild:   " << ms << " ms, " << build << endl;
+
+		before = AllocStats::now();
+		sw.reset();
+		for (size_t i = 0; i < sylls.size(); ++i) {
+			sylls[i]->reinit();
+		}
+		ms = sw.elapsed_ms();
+		out << "\treinit:  " << ms << " ms, " << (AllocStats::now() - before) << endl;
+
+		before = AllocStats::now();
+		sw.reset();
+		for (size_t i = 0; i < sylls.size(); ++i) {
+			delete sylls[i];
+		}
+		ms = sw.elapsed_ms();
+		out << "\tfree:    " << ms << " ms, " << (AllocStats::now() - before) << endl;
+
+		GLMmodel *model = glmReadOBJ((char*)"data/lotus_moon_seat.obj");
+		glmFacetNormals(model);
+		glmVertexNormals(model, 90.0);
+		before = AllocStats::now();
+		sw.reset();
+		DrGlmModel *lotus = new DrGlmModel();
+		lotus->init(model);
+		ms = sw.elapsed_ms();
+		out << "\tlotus build: " << ms << " ms, " << (AllocStats::now() - before) << endl;
+		before = AllocStats::now();
+		sw.reset();
+		delete lotus;
+		ms = sw.elapsed_ms();
+		out << "\tlotus free:  " << ms << " ms, " << (AllocStats::now() - before) << endl;
+		glmDelete(model);
+		cout.rdbuf(saved_buf);
+		report += out.str();
+	}
+	use_mesh_arenas = saved;
+	cout << report;
+	cout << "\n***************** Done:  Syllable3D::bench() ***********************" << endl;
+}
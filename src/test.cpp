@@ -7,11 +7,1427 @@
 
 #include "test.h"
 #include "syllable.h"
+#include "noise_engine.h"
+#include "noise_cache.h"
+#include "linalg.h"
+#include "transform.h"
+#include "arena.h"
+#include "alloc_stats.h"
+#include "particles.h"
+#include "cylinder_model.h"
+#include "geo.h"
+#include "face.h"
+#include "cdt.h"
+#include "lod.h"
+#include "dr_glm.h"
+#include "culling.h"
+#include "meshlet.h"
+#include "mesh_buffer.h"
+#include "overlay.h"
+#include "glut_app.h"
+#include "frame_stats.h"
+#include "hud.h"
+#include "shader_manager.h"
+#include "shader_variants.h"
+#include "uniform_blocks.h"
+#include "stream_buffer.h"
+#include "async_loader.h"
 //#include "dr_util.h"
 
+#include <cmath>
+#include <dirent.h>
+#include <sstream>
+#include <set>
+#include <type_traits>
+#include <utility>
+
 using namespace std;
 using namespace DR;
 
+// compile time checks, these fail the build rather than the test run
+static_assert(linalg::dot(linalg::Vec3f(1, 2, 3), linalg::Vec3f(4, 5, 6)) == 32, "constexpr dot");
+static_assert(linalg::cross(linalg::Vec3f(1, 0, 0), linalg::Vec3f(0, 1, 0)) == linalg::Vec3f(0, 0, 1),
+		"constexpr cross");
+static_assert(linalg::Mat4f::translate(1, 2, 3).transform_point(linalg::Vec3f(1, 1, 1))
+		== linalg::Vec3f(2, 3, 4), "constexpr transform_point");
+// copied by value in update and build loops, keep them plain memcpy
+static_assert(std::is_trivially_copyable<Vec>::value, "Vec copy");
+static_assert(std::is_trivially_copyable<Vec2>::value, "Vec2 copy");
+static_assert(std::is_trivially_copyable<LineSeg>::value, "LineSeg copy");
+static_assert(std::is_trivially_copyable<IndexedEdge>::value, "IndexedEdge copy");
+static_assert(std::is_trivially_copyable<Particle>::value, "Particle copy");
+static_assert(std::is_trivially_copyable<LightBeam>::value, "LightBeam copy");
+static_assert(std::is_nothrow_move_constructible<UnitSpace2D>::value, "UnitSpace2D move");
+
+static bool near(const GLfloat *a, const GLfloat *b, int n, GLfloat tol=1e-5f) {
+	for (int i = 0; i < n; ++i) {
+		if(fabs(a[i] - b[i]) > tol) return false;
+	}
+	return true;
+}
+
+// linalg against the loops it replaced in dr_util and vec
+static void linalg_test() {
+	cout <<  "\n******************** linalg test **************************" << endl;
+	using namespace linalg;
+	Mat4f a = Mat4f::translate(1, -2, 3) * Mat4f::rotate(30, 1, 1, 0) * Mat4f::scale(2, 2, 2);
+	Mat4f b = Mat4f::rotate(-70, 0, 0, 1) * Mat4f::translate(0.5f, 4, -1);
+
+	// mult_matrixf is row major left * right
+	GLfloat ref[16], out[16];
+	for (int i = 0; i < 4; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			ref[i*4 + j] = 0;
+			for (int k = 0; k < 4; ++k) {
+				ref[i*4 + j] += a.m[i*4 + k] * b.m[k*4 + j];
+			}
+		}
+	}
+	mult_matrixf(out, a.m, b.m);
+	if(!near(ref, out, 16)) {
+		cout << "!=: mult_matrixf" << endl;
+	}
+	// template and SSE product agree
+	Mat4f ab = a * b;
+	Mat4f ab_generic = operator*<GLfloat>(a, b);
+	if(!near(ab.m, ab_generic.m, 16)) {
+		cout << "!=: Mat4f SSE product" << endl;
+	}
+
+	vec3 p = { 0.3f, -1.5f, 2.0f }, tp;
+	GLfloat ref_p[3];
+	for (int i = 0; i < 3; ++i) {
+		ref_p[i] = a.m[i] * p[0] + a.m[4+i] * p[1] + a.m[8+i] * p[2] + a.m[12+i];
+	}
+	transform_vec(tp, p, a.m);
+	if(!near(ref_p, tp, 3)) {
+		cout << "!=: transform_vec" << endl;
+	}
+	Vec4f hp = a * Vec4f(p[0], p[1], p[2], 1);
+	if(!near(ref_p, hp.data(), 3) || hp[3] != 1) {
+		cout << "!=: Mat4f * Vec4f" << endl;
+	}
+	Vec3f dir = a.transform_dir(as_vec3(p));
+	DR::Vec vdir = a.m * DR::Vec(p);
+	if(!almost_equal(dir, Vec3f(vdir.x, vdir.y, vdir.z), 1e-5f)) {
+		cout << "!=: transform_dir vs Vec matrix product" << endl;
+	}
+
+	Mat4f inv;
+	if(!a.inverse(inv) || !near((inv * a).m, Mat4f::identity().m, 16)) {
+		cout << "!=: Mat4f::inverse" << endl;
+	}
+	if(Mat4f().inverse(inv)) {
+		cout << "!=: zero matrix should be singular" << endl;
+	}
+	// glRotate about z by 90 takes x to y
+	if(!almost_equal(Mat4f::rotate(90, 0, 0, 1).transform_dir(Vec3f(1, 0, 0)), Vec3f(0, 1, 0))) {
+		cout << "!=: Mat4f::rotate" << endl;
+	}
+
+	// views write through to the array
+	vec3 v = { 1, 2, 3 };
+	as_vec3(v) += Vec3f(1, 1, 1);
+	if(v[0] != 2 || v[1] != 3 || v[2] != 4) {
+		cout << "!=: as_vec3 view" << endl;
+	}
+	if(!almost_equal(normalized(Vec3f(0, 3, 4)), Vec3f(0, 0.6f, 0.8f)) ||
+			normalized(Vec3f()) != Vec3f()) {
+		cout << "!=: normalized" << endl;
+	}
+	cout << "\n***************** Done:  linalg test ***********************" << endl;
+}
+
+// unit square in xz, and a hexagon
+static vec3 square_verts[] = { {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1},
+		{0.5f, 0, 1.5f}, {-0.5f, 0, 0.5f} };
+static vec3 square_norms[] = { {0, 1, 0}, {0, 1, 0}, {0, 1, 0}, {0, 1, 0},
+		{0, 1, 0}, {0, 1, 0} };
+
+static void set_indices(Polygon& p) {
+	for (int i = 0; i < p.size; ++i) {
+		p.verts[i] = p.norms[i] = i;
+		p.edges[i].u = i;
+		p.edges[i].v = (i + 1) % p.size;
+	}
+	setv(p.facetnorm, 0, 1, 0);
+}
+
+// polygon copies and moves, triangles and quads mustn't allocate
+static void poly_copy_test() {
+	cout <<  "\n******************** poly copy test **************************" << endl;
+	Quad q(square_verts, square_norms);
+	set_indices(q);
+	q.set_edges();
+
+	AllocStats before = AllocStats::now();
+	Quad copy(q);
+	Quad assigned(square_verts, square_norms);
+	assigned = q;
+	Quad moved(std::move(copy));
+	AllocStats d = AllocStats::now() - before;
+	if(d.allocs != 0) {
+		cout << "!=: quad copies allocated: " << d << endl;
+	}
+	if(assigned != q || moved != q || assigned.verts == q.verts || moved.verts == copy.verts) {
+		cout << "!=: quad copy" << endl;
+	}
+
+	Polygon hex(6, square_verts, square_norms);
+	set_indices(hex);
+	Polygon hex_copy(hex);
+	if(hex_copy != hex || hex_copy.verts == hex.verts) {
+		cout << "!=: polygon copy" << endl;
+	}
+	GLint *storage = hex_copy.verts;
+	before = AllocStats::now();
+	Polygon hex_moved(std::move(hex_copy));
+	d = AllocStats::now() - before;
+	if(d.allocs != 0 || hex_moved.verts != storage || hex_copy.size != 0 || hex_moved != hex) {
+		cout << "!=: polygon move: " << d << endl;
+	}
+	// same size reuses the arrays, different size swaps storage
+	hex_moved = hex;
+	if(hex_moved.verts != storage || hex_moved != hex) {
+		cout << "!=: polygon assign same size" << endl;
+	}
+	hex_moved = q;
+	if(hex_moved != q || hex_moved.size != 4) {
+		cout << "!=: polygon assign quad" << endl;
+	}
+	hex_moved = hex;
+	if(hex_moved != hex) {
+		cout << "!=: polygon assign back to hex" << endl;
+	}
+
+	// arena storage isn't stolen, moves out of it copy
+	Arena arena;
+	Polygon in_arena(6, square_verts, square_norms, &arena);
+	set_indices(in_arena);
+	Polygon out_of_arena(std::move(in_arena));
+	if(out_of_arena != hex || out_of_arena.verts == in_arena.verts) {
+		cout << "!=: polygon move from arena" << endl;
+	}
+	cout << "\n***************** Done:  poly copy test ***********************" << endl;
+}
+
+// irreflexive, asymmetric, and < and equivalence transitive, over all triples
+template<typename T, typename Less>
+static bool strict_weak(const vector<T>& items, Less less) {
+	size_t n = items.size();
+	for (size_t a = 0; a < n; ++a) {
+		if(less(items[a], items[a])) return false;
+		for (size_t b = 0; b < n; ++b) {
+			bool ab = less(items[a], items[b]), ba = less(items[b], items[a]);
+			if(ab && ba) return false;
+			for (size_t c = 0; c < n; ++c) {
+				bool bc = less(items[b], items[c]), cb = less(items[c], items[b]);
+				bool ac = less(items[a], items[c]), ca = less(items[c], items[a]);
+				if(ab && bc && !ac) return false;
+				if(!ab && !ba && !bc && !cb && (ac || ca)) return false;
+			}
+		}
+	}
+	return true;
+}
+
+// comparators and hashed containers for Vec, LineSeg and Polygon
+static void compare_test() {
+	cout <<  "\n******************** compare test **************************" << endl;
+	// lots of ties in each component
+	vector<Vec> vecs;
+	for (int i = 0; i < 27; ++i) {
+		vecs.push_back(Vec(i % 3, (i / 3) % 3, i / 9));
+	}
+	if(!strict_weak(vecs, VecCompare())) {
+		cout << "!=: VecCompare not a strict weak ordering" << endl;
+	}
+	VecSet vset;
+	VecHashSet vhash;
+	for (int pass = 0; pass < 2; ++pass) {
+		for (size_t i = 0; i < vecs.size(); ++i) {
+			vset.insert(vecs[i]);
+			vhash.insert(vecs[i]);
+		}
+	}
+	if(vset.size() != 27 || vhash.size() != 27) {
+		cout << "!=: Vec sets: " << vset.size() << ", " << vhash.size() << endl;
+	}
+	// same cell is the same key
+	Vec near = vecs[13];
+	near.x += 0.1f * FLOAT_TOLERANCE;
+	if(float_bucket(near.x) == float_bucket(vecs[13].x) && vhash.count(near) != 1) {
+		cout << "!=: VecHashSet same cell" << endl;
+	}
+	if(VecHash()(near) != VecHash()(vecs[13]) && VecKeyEqual()(near, vecs[13])) {
+		cout << "!=: VecHash disagrees with VecKeyEqual" << endl;
+	}
+
+	vector<LineSeg> segs;
+	for (int s = 0; s < 3; ++s) {
+		for (int e = 0; e < 3; ++e) {
+			for (int w = 1; w <= 2; ++w) {
+				segs.push_back(LineSeg(vecs[s], vecs[e], Util::grey, w));
+			}
+		}
+	}
+	if(!strict_weak(segs, LineSegCompare())) {
+		cout << "!=: LineSegCompare not a strict weak ordering" << endl;
+	}
+	LineSet lset(segs.begin(), segs.end());
+	LineHashSet lhash(segs.begin(), segs.end());
+	lhash.insert(segs.begin(), segs.end());
+	if(lset.size() != segs.size() || lhash.size() != segs.size()) {
+		cout << "!=: LineSeg sets: " << lset.size() << ", " << lhash.size() << endl;
+	}
+
+	// every ordering of 3 of 4 verts, as triangles
+	vector<Polygon*> polys;
+	GLint perm[4] = { 0, 1, 2, 3 };
+	do {
+		Polygon *p = new Polygon(3, square_verts, square_norms);
+		for (int i = 0; i < 3; ++i) {
+			p->verts[i] = p->norms[i] = perm[i];
+		}
+		setv(p->facetnorm, 0, 1, 0);
+		polys.push_back(p);
+	} while(std::next_permutation(perm, perm + 4));
+	vector<const Polygon*> cpolys(polys.begin(), polys.end());
+	if(!strict_weak(cpolys, PolygonCompare())) {
+		cout << "!=: PolygonCompare not a strict weak ordering" << endl;
+	}
+	PolygonSet pset(cpolys.begin(), cpolys.end());
+	PolygonHashSet phash(cpolys.begin(), cpolys.end());
+	// the first 3 of a permutation of 4 fix the 4th, so all 24 are distinct
+	if(pset.size() != 24 || phash.size() != 24) {
+		cout << "!=: Polygon sets: " << pset.size() << ", " << phash.size() << endl;
+	}
+	for (size_t i = 0; i < polys.size(); ++i) {
+		delete polys[i];
+	}
+	cout << "\n***************** Done:  compare test ***********************" << endl;
+}
+
+// two separate n x n vertex grids, 2 triangles per cell
+struct TestGrid {
+	vector<GLfloat> verts;
+	Face face;
+	TestGrid(int n) {
+		verts.resize(2 * n * n * 3);
+		vec3 *v = (vec3*)&verts[0];
+		for (int g = 0; g < 2; ++g) {
+			for (int i = 0; i < n * n; ++i) {
+				setv(v[g*n*n + i], i % n + g * (n + 1), 0, i / n);
+			}
+		}
+		for (int g = 0; g < 2; ++g) {
+			for (int r = 0; r + 1 < n; ++r) {
+				for (int c = 0; c + 1 < n; ++c) {
+					GLint a = g*n*n + r*n + c;
+					GLint tri[2][3] = { { a, a + 1, a + n + 1 }, { a, a + n + 1, a + n } };
+					for (int t = 0; t < 2; ++t) {
+						Triangle *p = new Triangle(v, v);
+						for (int k = 0; k < 3; ++k) {
+							p->verts[k] = p->norms[k] = tri[t][k];
+						}
+						p->set_edges();
+						face.add_polygon(p);
+					}
+				}
+			}
+		}
+	}
+};
+
+// grow_region as it was, with the by value set functions
+static void reference_grow(Face& face, vector<Polygon*>& region, Polygon *start) {
+	vector<Polygon*> fringe, neighbors, temp_polys, temp_polys2;
+	face.get_neighbors(fringe, start);
+	do {
+		uniq(fringe);
+		add_all(fringe, region);
+		uniq(region);
+		neighbors.clear();
+		for (size_t i = 0; i < fringe.size(); ++i) {
+			// neighbors by value: polys sharing a vertex
+			temp_polys.clear();
+			for (size_t j = 0; j < face.polygons.size(); ++j) {
+				Polygon *p = face.polygons[j];
+				for (int k = 0; k < fringe[i]->size; ++k) {
+					if(p->contains(fringe[i]->verts[k]) && *p != *fringe[i]) {
+						temp_polys.push_back(p);
+					}
+				}
+			}
+			add_all(temp_polys, neighbors);
+			uniq(neighbors);
+		}
+		difference(fringe, neighbors, temp_polys);
+		fringe.clear();
+		add_all(temp_polys, fringe);
+		intersection(fringe, region, temp_polys);
+		difference(fringe, temp_polys, temp_polys2);
+		fringe.clear();
+		add_all(temp_polys2, fringe);
+	} while(!fringe.empty());
+}
+
+// PolyIdSet functions and Face region growing against the by value versions
+static void poly_set_test() {
+	cout <<  "\n******************** poly set test **************************" << endl;
+	TestGrid grid(6);
+	vector<Polygon*>& polys = grid.face.polygons;
+	srand(97);
+	for (int trial = 0; trial < 20; ++trial) {
+		// random subsets, with repeats
+		vector<Polygon*> a, b, ref;
+		for (int i = 0; i < 30; ++i) {
+			a.push_back(polys[rand() % polys.size()]);
+			b.push_back(polys[rand() % polys.size()]);
+		}
+		PolyIdSet ia, ib, out, expect;
+		to_id_set(a, ia);
+		to_id_set(b, ib);
+		ref = a;
+		uniq(ref);
+		to_id_set(ref, expect);
+		if(expect != ia || ref.size() != ia.size()) {
+			cout << "!=: to_id_set vs uniq" << endl;
+		}
+		intersection(a, b, ref);
+		to_id_set(ref, expect);
+		id_intersection(ia, ib, out);
+		if(out != expect) {
+			cout << "!=: id_intersection" << endl;
+		}
+		difference(a, b, ref);
+		to_id_set(ref, expect);
+		id_symmetric_difference(ia, ib, out);
+		if(out != expect) {
+			cout << "!=: id_symmetric_difference" << endl;
+		}
+		id_difference(ia, ib, out);
+		for (size_t i = 0; i < ia.size(); ++i) {
+			bool in_b = DR::contains(b, *polys[ia[i]]);
+			if(in_b == id_contains(out, ia[i])) {
+				cout << "!=: id_difference" << endl;
+				break;
+			}
+		}
+	}
+
+	vector<Polygon*> containing, edge_polys;
+	grid.face.find_polys_containing(containing, 7);
+	IndexedEdge e;
+	e.u = 7;
+	e.v = 14;
+	grid.face.find_polys_containing(edge_polys, e);
+	// vertex 7 is inside the first grid, in 6 triangles, 2 on the diagonal 7-14
+	if(containing.size() != 6 || edge_polys.size() != 2) {
+		cout << "!=: find_polys_containing: " << containing.size() << ", " << edge_polys.size() << endl;
+	}
+
+	for (int g = 0; g < 2; ++g) {
+		Polygon *start = polys[g * polys.size() / 2 + 3];
+		Region region(&grid.face);
+		vector<Polygon*> ref_region;
+		grid.face.grow_region(region, start);
+		reference_grow(grid.face, ref_region, start);
+		PolyIdSet expect;
+		to_id_set(ref_region, expect);
+		if(region.poly_ids != expect || expect.size() != polys.size() / 2) {
+			cout << "!=: grow_region " << g << ": " << region.poly_ids.size() << " vs " << expect.size() << endl;
+		}
+		if(!region.contains(start) || region.contains(polys[(1 - g) * polys.size() / 2])
+				|| region.poly(0) != polys[region.poly_ids[0]] || !region.contains(polys[region.poly_ids[0]]->verts[0])) {
+			cout << "!=: Region::contains" << endl;
+		}
+	}
+
+	// get_poly_index: by id, and by value for polys from another face
+	TestGrid other(6);
+	for (size_t i = 0; i < polys.size(); ++i) {
+		if(grid.face.get_poly_index(polys[i]) != (GLint)i
+				|| grid.face.get_poly_index(other.face.polygons[i]) != (GLint)i) {
+			cout << "!=: get_poly_index " << i << endl;
+			break;
+		}
+	}
+	Triangle stray(*static_cast<Triangle*>(polys[5]));
+	stray.id = 9;
+	Triangle missing(stray);
+	missing.verts[0] = polys.size() * 10;
+	if(grid.face.get_poly_index(&stray) != 5 || grid.face.get_poly_index(&missing) != -1) {
+		cout << "!=: get_poly_index by value" << endl;
+	}
+	cout << "\n***************** Done:  poly set test ***********************" << endl;
+}
+
+// shoelace in xz over the base polygons
+static double base_face_area(Syllable3D& syll) {
+	vec3 *verts = syll.get_vertices();
+	double area = 0;
+	for (size_t j = 0; j < syll.get_base_face().polygons.size(); ++j) {
+		Polygon *p = syll.get_base_face().polygons[j];
+		double sum = 0;
+		for (int k = 0; k < p->size; ++k) {
+			GLfloat *a = verts[p->verts[k]], *b = verts[p->verts[(k + 1) % p->size]];
+			sum += a[0] * b[2] - b[0] * a[2];
+		}
+		area += fabs(sum) * 0.5;
+	}
+	return area;
+}
+
+// triangulate_base covers the same area as the obj's own triangulation
+static void triangulate_base_test() {
+	cout <<  "\n******************** triangulate_base test **************************" << endl;
+	const char *names[] = { "om", "hung" };
+	for (size_t i = 0; i < sizeof(names)/sizeof(names[0]); ++i) {
+		char filename[80];
+		sprintf(filename, "data/%s.obj", names[i]);
+		streambuf *saved_buf = cout.rdbuf();
+		ostringstream chatter;
+		cout.rdbuf(chatter.rdbuf());
+		Syllable3D syll;
+		syll.initFromObj(filename);
+		syll.init_base();
+		cout.rdbuf(saved_buf);
+
+		double base_area = base_face_area(syll);
+		CDTOptions opts;
+		for (int pass = 0; pass < 2; ++pass) {
+			CDTMesh mesh;
+			vector<GLint> index;
+			opts.min_angle = pass * 25;
+			syll.triangulate_base(mesh, opts, &index);
+			double area = 0;
+			for (size_t t = 0; t < mesh.triangles.size(); t += 3) {
+				const linalg::Vec2d& a = mesh.points[mesh.triangles[t]];
+				const linalg::Vec2d& b = mesh.points[mesh.triangles[t+1]];
+				const linalg::Vec2d& c = mesh.points[mesh.triangles[t+2]];
+				area += 0.5 * ((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]));
+			}
+			if(fabs(area - base_area) > 1e-4 * base_area || index.empty()
+					|| (pass == 0 && index.size() != mesh.points.size())) {
+				cout << "!=: triangulate_base " << names[i] << ", pass " << pass << ": area "
+						<< area << " vs " << base_area << ", " << index.size() << " perimeter points" << endl;
+			}
+			cout << names[i] << (pass ? " min angle 25: " : ": ") << mesh.num_triangles() << " triangles, was "
+					<< syll.get_base_face().polygons.size() << " polygons" << endl;
+		}
+	}
+	// rebuilt from the triangulation, it still covers the base and extrudes
+	{
+		streambuf *saved_buf = cout.rdbuf();
+		ostringstream chatter;
+		cout.rdbuf(chatter.rdbuf());
+		Syllable3D syll;
+		syll.initFromObj("data/om.obj");
+		syll.init_base();
+		size_t model_polys = syll.get_base_face().polygons.size();
+		GLint model_verts = syll.num_vertices_base;
+		double before = base_face_area(syll);
+		CDTOptions opts;
+		opts.min_angle = 25;
+		CDTMesh mesh;
+		syll.triangulate_base(mesh, opts);
+		syll.retessellate_base(opts);
+		double after = base_face_area(syll);
+		GLint verts = syll.num_vertices_base;
+		// facets all face the way the model's did
+		GLfloat up = syll.get_base_face().polygons[0]->facetnorm[1];
+		bool same_way = true;
+		for (size_t j = 0; j < syll.get_base_face().polygons.size(); ++j) {
+			same_way = same_way && syll.get_base_face().polygons[j]->facetnorm[1] * up > 0;
+		}
+		syll.extrude(0.2, true);
+		syll.build_lods();
+		size_t polys = syll.get_base_face().polygons.size();
+		size_t lods = syll.num_lods();
+		syll.reinit();
+		cout.rdbuf(saved_buf);
+		if(polys != mesh.num_triangles() || fabs(after - before) > 1e-4 * before || !same_way
+				|| verts <= model_verts || lods < 1) {
+			cout << "!=: retessellate_base: " << polys << " polygons for " << mesh.num_triangles()
+					<< " triangles, area " << after << " vs " << before << ", " << verts << " verts, "
+					<< lods << " lods" << endl;
+		}
+		if(syll.get_base_face().polygons.size() != model_polys || syll.num_vertices_base != model_verts) {
+			cout << "!=: reinit after retessellate_base" << endl;
+		}
+		cout << "om retessellated, min angle 25: " << polys << " polygons, was " << model_polys << endl;
+	}
+	cout << "\n***************** Done:  triangulate_base test ***********************" << endl;
+}
+
+static Syllable3D* lod_syllable(const char *name) {
+	char filename[80];
+	sprintf(filename, "data/%s.obj", name);
+	streambuf *saved_buf = cout.rdbuf();
+	ostringstream chatter;
+	cout.rdbuf(chatter.rdbuf());
+	Syllable3D *syll = new Syllable3D();
+	syll->initFromObj(filename);
+	syll->init_base();
+	syll->extrude(0.2, true);
+	syll->build_lods();
+	cout.rdbuf(saved_buf);
+	return syll;
+}
+
+// every level still closes up: the outline of the base triangles is
+// exactly the base edges of the side quads, and the extruded face matches
+static void syllable_lod_test() {
+	cout <<  "\n******************** syllable lod test **************************" << endl;
+	const char *names[] = { "om", "hung" };
+	for (size_t i = 0; i < sizeof(names)/sizeof(names[0]); ++i) {
+		Syllable3D *syll = lod_syllable(names[i]);
+		size_t num_base = syll->get_base_face().polygons.size();
+		size_t num_sides = syll->num_polygons() - 2 * num_base;
+		if(syll->num_lods() < 2 || syll->get_lod_level(0).base.num_triangles() != num_base
+				|| syll->get_lod_level(0).side_verts.size() != 4 * num_sides) {
+			cout << "!=: " << names[i] << " lods: " << syll->num_lods() << endl;
+		}
+		for (size_t l = 0; l < syll->num_lods(); ++l) {
+			const Syllable3D::Lod& lod = syll->get_lod_level(l);
+			// undirected base edges used once
+			set<pair<GLint, GLint> > outline, side_edges;
+			for (size_t t = 0; t < lod.base.verts.size(); t += 3) {
+				for (int k = 0; k < 3; ++k) {
+					GLint a = lod.base.verts[t + k], b = lod.base.verts[t + (k + 1) % 3];
+					pair<GLint, GLint> e(min(a, b), max(a, b));
+					if(!outline.insert(e).second) {
+						outline.erase(e);
+					}
+				}
+			}
+			for (size_t q = 0; q < lod.side_verts.size(); q += 4) {
+				GLint a = -1, b = -1;
+				for (int k = 0; k < 4; ++k) {
+					GLint v = lod.side_verts[q + k];
+					if(v < syll->num_vertices_base) {
+						(a < 0 ? a : b) = v;
+					}
+				}
+				side_edges.insert(make_pair(min(a, b), max(a, b)));
+			}
+			bool extruded_ok = lod.extruded.verts.size() == lod.base.verts.size();
+			// same corners, the base winding was reversed by extrude
+			for (size_t t = 0; extruded_ok && t < lod.base.verts.size(); t += 3) {
+				GLint b[3], e[3];
+				for (int k = 0; k < 3; ++k) {
+					b[k] = lod.base.verts[t + k] + syll->num_vertices_base;
+					e[k] = lod.extruded.verts[t + k];
+				}
+				sort(b, b + 3);
+				sort(e, e + 3);
+				extruded_ok = equal(b, b + 3, e);
+			}
+			if(outline != side_edges || !extruded_ok || lod.side_norms.size() * 4 != lod.side_verts.size()) {
+				cout << "!=: " << names[i] << " lod " << l << ": " << outline.size() << " outline edges, "
+						<< side_edges.size() << " side quads" << (extruded_ok ? "" : ", extruded differs") << endl;
+			}
+			if(l > 0 && (lod.num_triangles() >= syll->get_lod_level(l-1).num_triangles()
+					|| lod.base.error < syll->get_lod_level(l-1).base.error)) {
+				cout << "!=: " << names[i] << " lod " << l << " not coarser" << endl;
+			}
+		}
+		syll->select_lod(1e6f);
+		if(syll->current_lod() != 0 || syll->select_lod(0) != (int)syll->num_lods() - 1) {
+			cout << "!=: " << names[i] << " select_lod" << endl;
+		}
+		delete syll;
+	}
+	cout << "\n***************** Done:  syllable lod test ***********************" << endl;
+}
+
+// perimeters of regions, outer then inner, as plain vectors
+static vector<vector<GLint> > region_perimeters(const vector<Region*>& regions) {
+	vector<vector<GLint> > out;
+	for (size_t i = 0; i < regions.size(); ++i) {
+		out.push_back(vector<GLint>(regions[i]->perimeter.begin(), regions[i]->perimeter.end()));
+		for (size_t j = 0; j < regions[i]->inner_perimeters.size(); ++j) {
+			const Perimeter& inner = regions[i]->inner_perimeters[j];
+			out.push_back(vector<GLint>(inner.begin(), inner.end()));
+		}
+	}
+	return out;
+}
+
+// regions found only when needed, and after the vertices move
+// the same as found straight after init_base
+static void lazy_topology_test() {
+	cout <<  "\n******************** lazy topology test **************************" << endl;
+	streambuf *saved_buf = cout.rdbuf();
+	ostringstream chatter;
+	cout.rdbuf(chatter.rdbuf());
+	Syllable3D eager, lazy;
+	eager.initFromObj("data/om.obj", true);
+	eager.init_base();
+	lazy.initFromObj("data/om.obj", true);
+	lazy.init_base();
+	cout.rdbuf(saved_buf);
+
+	if(lazy.has_topology() || !lazy.get_base_face().regions.empty()) {
+		cout << "!=: regions found by init_base" << endl;
+	}
+	vector<vector<GLint> > perims = region_perimeters(eager.base_regions());
+	GLint center = eager.get_base_face().get_center_index();
+	GLfloat shortest = eager.get_base_face().shortest_side_len;
+
+	// stood up, scaled and moved, as mapping would
+	linalg::Mat4f m = linalg::Mat4f::translate(1, 2, 3) * linalg::Mat4f::rotate(90, 1, 0, 0)
+			* linalg::Mat4f::scale(2, 2, 2);
+	transform_points(m, lazy.get_vertices(), lazy.get_vertices(), lazy.num_vertices_base);
+	lazy.reset_base_windings();
+	if(region_perimeters(lazy.base_regions()) != perims || !lazy.has_topology()
+			|| lazy.get_base_face().get_center_index() != center
+			|| lazy.get_base_face().shortest_side_len != shortest) {
+		cout << "!=: regions after the vertices moved: " << lazy.get_base_face().regions.size()
+				<< " regions, center " << lazy.get_base_face().get_center_index() << " vs " << center << endl;
+	}
+
+	cout.rdbuf(chatter.rdbuf());
+	eager.extrude(0.2, true);
+	lazy.extrude(0.2, true);
+	cout.rdbuf(saved_buf);
+	if(lazy.num_polygons() != eager.num_polygons()) {
+		cout << "!=: " << lazy.num_polygons() << " polygons extruded, was " << eager.num_polygons() << endl;
+	}
+	// the extruded perimeters are the base ones before extrude reversed them
+	vector<vector<GLint> > extruded = region_perimeters(lazy.extruded_regions());
+	bool mirrored = extruded.size() == perims.size();
+	for (size_t i = 0; mirrored && i < perims.size(); ++i) {
+		mirrored = extruded[i].size() == perims[i].size();
+		for (size_t j = 0; mirrored && j < perims[i].size(); ++j) {
+			mirrored = extruded[i][j] == perims[i][j] + lazy.num_vertices_base;
+		}
+	}
+	if(!mirrored) {
+		cout << "!=: extruded perimeters don't mirror the base" << endl;
+	}
+
+	cout.rdbuf(chatter.rdbuf());
+	lazy.reinit();
+	cout.rdbuf(saved_buf);
+	if(lazy.has_topology() || region_perimeters(lazy.base_regions()) != perims) {
+		cout << "!=: regions after reinit" << endl;
+	}
+	cout << "\n***************** Done:  lazy topology test ***********************" << endl;
+}
+
+// om seen from above its base face, below it, and from behind the camera,
+// sampling what is left and picking
+static void syllable_cull_test() {
+	cout <<  "\n******************** syllable cull test **************************" << endl;
+	Syllable3D *syll = lod_syllable("om");
+	syll->build_meshlets();
+	size_t num_base = syll->get_base_face().polygons.size();
+	linalg::Mat4f proj = linalg::Mat4f::perspective(65, 1, 1, 30);
+	// base face normals are +y, extruded -y
+	linalg::Mat4f above = linalg::Mat4f::rotate(90, 1, 0, 0) * linalg::Mat4f::translate(0, -10, 0);
+	linalg::Mat4f below = linalg::Mat4f::rotate(-90, 1, 0, 0) * linalg::Mat4f::translate(0, 10, 0);
+	linalg::Mat4f away = linalg::Mat4f::rotate(-90, 1, 0, 0) * linalg::Mat4f::translate(0, -10, 0);
+	CullStats top, bottom, behind, wire;
+	syll->cull(Frustum(proj * above), eye_position(above), true, top);
+	syll->cull(Frustum(proj * below), eye_position(below), true, bottom);
+	syll->cull(Frustum(proj * above), eye_position(above), false, wire);
+	syll->cull(Frustum(proj * away), eye_position(away), true, behind);
+	// half the polygons face away, most of those in meshlets that can go
+	if(top.objects_culled || top.polygons_drawn < num_base || top.polygons_drawn > top.polygons - num_base / 2
+			|| bottom.polygons_drawn < num_base || bottom.meshlets_backface == 0) {
+		cout << "!=: cull om: above " << top << endl << "    below " << bottom << endl;
+	}
+	if(wire.polygons_drawn != wire.polygons || behind.objects_culled != 1 || behind.polygons_drawn) {
+		cout << "!=: cull om: no backface " << wire << endl << "    behind " << behind << endl;
+	}
+	// seen from below, emit from the extruded face only
+	syll->cull(Frustum(proj * below), eye_position(below), true, bottom);
+	if(syll->sample_polygon(Syllable3D::BASE, true) != -1 || syll->sample_polygon(Syllable3D::EXTRUDED, true) < 0) {
+		cout << "!=: sample_polygon om from below" << endl;
+	}
+	syll->clear_cull();
+	// straight down onto the middle of some base triangles
+	for (size_t i = 0; i < num_base; i += num_base / 7) {
+		const Polygon *p = syll->get_base_face().polygons[i];
+		linalg::Vec3f mid;
+		for (int k = 0; k < p->size; ++k) {
+			vec3 v;
+			syll->get_vert(p->verts[k], v);
+			mid += linalg::as_vec3(v);
+		}
+		mid = mid * (1.0f / p->size);
+		int surface = -1;
+		GLfloat dist;
+		GLint hit = syll->pick(mid + linalg::Vec3f(0, 5, 0), linalg::Vec3f(0, -1, 0), surface, dist);
+		if(hit != (GLint)i || surface != Syllable3D::BASE || fabs(dist - 5) > 1e-4f) {
+			cout << "!=: pick om base " << i << ": " << surface << " " << hit << " " << dist << endl;
+		}
+	}
+	delete syll;
+	cout << "\n***************** Done:  syllable cull test ***********************" << endl;
+}
+
+// every level's buffer has its triangles, a range per meshlet, in the meshlets' order
+static void syllable_buffer_test() {
+	cout <<  "\n******************** syllable buffer test **************************" << endl;
+	Syllable3D *syll = lod_syllable("hung");
+	syll->build_meshlets();
+	syll->build_buffers();
+	// level 0 is the full mesh
+	size_t full = syll->get_lod_level(0).num_triangles();
+	for (size_t level = 0; level < syll->num_lods(); ++level) {
+		const MeshBuffer *mb = syll->get_buffer(level);
+		size_t tris = syll->get_lod_level(level).num_triangles();
+		const MeshletSet *ms = level ? syll->get_lod_level(level).meshlets : NULL;
+		size_t ranges = 0;
+		bool counts = true;
+		for (int s = 0; s < 3; ++s) {
+			const MeshletSet& set = ms ? ms[s] : syll->get_meshlets(s);
+			for (size_t i = 0; i < set.size(); ++i, ++ranges) {
+				counts = counts && ranges < mb->num_ranges()
+						&& mb->get_ranges()[ranges].count == 3 * set.meshlets[i].triangle_count;
+			}
+		}
+		if(!mb || mb->num_triangles() != tris || mb->num_ranges() != ranges || !counts) {
+			cout << "!=: hung level " << level << " buffer " << (mb ? mb->num_triangles() : 0) << " triangles, want "
+					<< tris << ", " << (mb ? mb->num_ranges() : 0) << " ranges, want " << ranges << endl;
+		}
+	}
+	VertexCacheStats optimized = syll->get_buffer(0)->cache_stats();
+	syll->build_buffers(false);
+	VertexCacheStats loaded = syll->get_buffer(0)->cache_stats();
+	if(optimized.acmr >= loaded.acmr || syll->get_buffer(0)->num_triangles() != full) {
+		cout << "!=: hung buffer cache, optimized " << optimized << ", as loaded " << loaded << endl;
+	}
+	delete syll;
+	cout << "\n***************** Done:  syllable buffer test ***********************" << endl;
+}
+
+// counts the fixed steps GlutApp::advance() takes
+struct StepApp: public GlutApp {
+	int steps;
+	StepApp() : steps(0) { sim_step = 0.01; }
+	void simulate(GLdouble dt) { ++steps; }
+};
+
+static void fixed_step_test() {
+	cout <<  "\n******************** fixed step test **************************" << endl;
+	StepApp app;
+	int taken = app.advance(0.025);
+	if(taken != 2 || app.steps != 2 || fabs(app.sim_alpha - 0.5f) > 1e-4f) {
+		cout << "!=: advance(0.025) took " << taken << " steps, alpha " << app.sim_alpha << endl;
+	}
+	// the half step owed makes this one whole
+	taken = app.advance(0.006);
+	if(taken != 1 || fabs(app.sim_time - 0.03) > 1e-9) {
+		cout << "!=: advance(0.006) took " << taken << " steps, sim_time " << app.sim_time << endl;
+	}
+	// too far behind, only max_sim_steps and the rest dropped
+	taken = app.advance(1.0);
+	if(taken != app.max_sim_steps || app.sim_alpha < 0 || app.sim_alpha >= 1) {
+		cout << "!=: advance(1.0) took " << taken << " steps, alpha " << app.sim_alpha << endl;
+	}
+	// a second of frames at different rates simulates the same
+	const int rates[] = { 30, 60, 144 };
+	for (int r = 0; r < 3; ++r) {
+		StepApp at;
+		for (int f = 0; f < rates[r]; ++f) {
+			at.advance(1.0 / rates[r]);
+		}
+		if(abs(at.steps - 100) > 1 || fabs(at.sim_time + at.sim_alpha * at.sim_step - 1.0) > 1e-6) {
+			cout << "!=: " << rates[r] << " fps took " << at.steps << " steps, sim_time " << at.sim_time << endl;
+		}
+	}
+	cout << "\n***************** Done:  fixed step test ***********************" << endl;
+}
+
+// the float at offset in a packed block
+static GLfloat packed_float(const Std140Packer& p, size_t offset) {
+	GLfloat f;
+	memcpy(&f, &p.get_bytes()[offset], sizeof(f));
+	return f;
+}
+
+static void uniform_blocks_test() {
+	cout <<  "\n******************** uniform blocks test **************************" << endl;
+	// offsets from the std140 rules in the GL spec
+	Std140Packer p;
+	vec4 v = {1, 2, 3, 4};
+	GLfloat m[16] = {0};
+	size_t got[] = { p.add_float(1), p.add_vec(v, 3), p.add_float(2), p.add_vec(v, 2),
+			p.add_vec(v, 4), p.add_int(7), p.add_mat4(m) };
+	size_t want[] = { 0, 16, 28, 32, 48, 64, 80 };
+	for (int i = 0; i < 7; ++i) {
+		if(got[i] != want[i]) {
+			cout << "!=: member " << i << " at " << got[i] << ", want " << want[i] << endl;
+		}
+	}
+	if(p.size() != 144 || packed_float(p, 28) != 2 || packed_float(p, 56) != 3) {
+		cout << "!=: packed size " << p.size() << endl;
+	}
+	// a float rounds the block up to 16
+	p.clear();
+	p.add_vec(v, 3);
+	p.add_float(5);
+	p.add_float(6);
+	if(p.size() != 32 || packed_float(p, 16) != 6) {
+		cout << "!=: vec3 float float size " << p.size() << endl;
+	}
+
+	vec4 white = {1, 1, 1, 1}, black = {0, 0, 0, 1}, ambient = {.2, .2, .2, 1};
+	p.clear();
+	pack_material(p, ambient, white, white, black, 64);
+	if(p.size() != 80 || packed_float(p, 16) != 1 || packed_float(p, 60) != 1
+			|| packed_float(p, 64) != 64) {
+		cout << "!=: material block size " << p.size() << endl;
+	}
+
+	// a light at +z and one at +x, looked at down -z after turning 90 about y
+	GLlight front, side;
+	setv(front.pos, 0, 0, 1, 0);
+	setv(side.pos, 1, 0, 0, 0);
+	setv(side.diffuse, .5, .5, .5, 1);
+	vector<const GLlight*> lights;
+	lights.push_back(&front);
+	lights.push_back(&side);
+	GLfloat identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+	p.clear();
+	pack_lights(p, lights, ambient, identity);
+	const size_t light_size = 80;
+	if(p.size() != ShaderVariant::MAX_LIGHTS * light_size + 16) {
+		cout << "!=: lights block size " << p.size() << endl;
+	}
+	// half vectors, z, and between x and z
+	GLfloat h = sqrt(0.5f);
+	if(fabs(packed_float(p, 16 + 8) - 1) > 1e-6 || fabs(packed_float(p, light_size + 16) - h) > 1e-6
+			|| fabs(packed_float(p, light_size + 16 + 8) - h) > 1e-6
+			|| packed_float(p, light_size + 48) != .5f) {
+		cout << "!=: light half vectors or diffuse" << endl;
+	}
+	// unused lights zero, scene ambient last
+	if(packed_float(p, 2 * light_size + 48) != 0
+			|| fabs(packed_float(p, ShaderVariant::MAX_LIGHTS * light_size) - .2f) > 1e-6) {
+		cout << "!=: unused light or scene ambient" << endl;
+	}
+	DR::linalg::Mat4f turn = DR::linalg::Mat4f::rotate(90, 0, 1, 0);
+	p.clear();
+	pack_lights(p, lights, ambient, turn.data());
+	if(fabs(packed_float(p, 0) - 1) > 1e-5 || fabs(packed_float(p, 8)) > 1e-5) {
+		cout << "!=: light to eye space " << packed_float(p, 0) << ", " << packed_float(p, 8) << endl;
+	}
+	cout << "\n***************** Done:  uniform blocks test ***********************" << endl;
+}
+
+// headless tests, failures print lines starting with "!=:"
+void DR::test() {
+	linalg_test();
+	poly_copy_test();
+	compare_test();
+	poly_set_test();
+	transform_test();
+	CDT::test();
+	triangulate_base_test();
+	QemSimplifier::test();
+	syllable_lod_test();
+	lazy_topology_test();
+	Syllable3D::test();
+	Frustum::test();
+	MeshletSet::test();
+	MeshBuffer::test();
+	DebugOverlay::test();
+	syllable_cull_test();
+	syllable_buffer_test();
+	Arena::test();
+	NoiseEngine::test();
+	NoiseVolumeCache::test();
+	ParticleSet::test();
+	fixed_step_test();
+	TimeHistogram::test();
+	HudText::test();
+	ShaderManager::test();
+	LightingShaders::test();
+	uniform_blocks_test();
+	StreamBuffer::test();
+	AsyncLoader::test();
+}
+
+// the update passes without the glutPostRedisplay() in update()
+struct BenchParticles: public ParticleSet {
+	BenchParticles(int n) : ParticleSet(n) {}
+	using ParticleSet::step;
+};
+struct BenchBeams: public LightBeamSet {
+	using LightBeamSet::step;
+};
+
+static void print_allocs(const char *what, const AllocStats& d, size_t n, const char *per) {
+	cout << "\t" << what << ": " << d << ", " << (double)d.allocs / n
+			<< " allocs per " << per << endl;
+}
+
+// heap allocations per copy, per frame and per build
+static void alloc_bench() {
+	cout <<  "\n******************** alloc bench **************************" << endl;
+	const size_t copies = 100000;
+	Quad q(square_verts, square_norms);
+	set_indices(q);
+	q.set_edges();
+	Polygon hex(6, square_verts, square_norms);
+	set_indices(hex);
+
+	cout << copies << " copies:" << endl;
+	AllocStats before = AllocStats::now();
+	for (size_t i = 0; i < copies; ++i) {
+		Quad c(q);
+	}
+	print_allocs("Quad copy", AllocStats::now() - before, copies, "copy");
+	before = AllocStats::now();
+	{
+		Quad a(square_verts, square_norms);
+		for (size_t i = 0; i < copies; ++i) {
+			a = q;
+		}
+	}
+	print_allocs("Quad assign", AllocStats::now() - before, copies, "copy");
+	before = AllocStats::now();
+	{
+		Polygon a(hex);
+		for (size_t i = 0; i < copies; ++i) {
+			a = hex;
+		}
+	}
+	print_allocs("hexagon assign", AllocStats::now() - before, copies, "copy");
+	before = AllocStats::now();
+	{
+		Polygon a(hex);
+		for (size_t i = 0; i < copies; ++i) {
+			Polygon b(std::move(a));
+			a = std::move(b);
+		}
+	}
+	print_allocs("hexagon move", AllocStats::now() - before, copies, "move");
+
+	// syllable sized unit space
+	UnitSpace2D space;
+	for (int i = 0; i < 2000; ++i) {
+		space.element.add_vert(Vec(cos(i * 0.01f), 0, sin(i * 0.013f)));
+	}
+	space.element.map(1);
+	const size_t space_copies = 1000;
+	vector<UnitSpace2D> spaces;
+	spaces.reserve(space_copies);
+	before = AllocStats::now();
+	for (size_t i = 0; i < space_copies; ++i) {
+		spaces.push_back(space);
+	}
+	print_allocs("UnitSpace2D copy", AllocStats::now() - before, space_copies, "copy");
+	before = AllocStats::now();
+	for (size_t i = 0; i < space_copies; ++i) {
+		UnitSpace2D moved(std::move(spaces[i]));
+		spaces[i] = std::move(moved);
+	}
+	print_allocs("UnitSpace2D move", AllocStats::now() - before, space_copies, "move");
+	spaces.clear();
+
+	const size_t frames = 600;
+	cout << frames << " frames:" << endl;
+	BenchParticles particles(5000);
+	vec4 white = { 1, 1, 1, 1 };
+	vec3 origin = { 0, 0, 0 };
+	before = AllocStats::now();
+	for (size_t f = 0; f < frames; ++f) {
+		for (int i = 0; i < 50; ++i) {
+			vec3 vel = { cos(f + i * 0.1f), 1, sin(f + i * 0.1f) };
+			particles.reincarnate(white, origin, vel);
+		}
+		particles.step(1 / 60.0f, f % 2 == 1);
+	}
+	print_allocs("ParticleSet, 5000", AllocStats::now() - before, frames, "frame");
+
+	// init chatters
+	streambuf *saved_buf = cout.rdbuf();
+	ostringstream chatter;
+	cout.rdbuf(chatter.rdbuf());
+	BenchBeams beams;
+	beams.init(500);
+	cout.rdbuf(saved_buf);
+	before = AllocStats::now();
+	for (size_t f = 0; f < frames; ++f) {
+		for (int i = 0; i < 5; ++i) {
+			vec3 vel = { cos(f + i * 0.1f), 1, sin(f + i * 0.1f) };
+			cout.rdbuf(chatter.rdbuf());
+			beams.get_beam(white, origin, vel, 2.0f, 1.0f);
+			cout.rdbuf(saved_buf);
+		}
+		beams.step(1 / 60.0f);
+	}
+	print_allocs("LightBeamSet, 500", AllocStats::now() - before, frames, "frame");
+
+	const size_t builds = 20;
+	cout << builds << " builds:" << endl;
+	before = AllocStats::now();
+	for (size_t b = 0; b < builds; ++b) {
+		CylinderModel cylinder(3, 3);
+		for (int s = 0; s < 6; ++s) {
+			cylinder.add_unit_space(space);
+		}
+		cout.rdbuf(chatter.rdbuf());
+		cylinder.map();
+		cout.rdbuf(saved_buf);
+	}
+	print_allocs("CylinderModel, 6 spaces", AllocStats::now() - before, builds, "build");
+	cout << "\tsyllable and lotus builds: see the mesh bench" << endl;
+	cout << "\n***************** Done:  alloc bench ***********************" << endl;
+}
+
+// insert and lookup of 1M Vecs, ordered vs hashed
+static void hash_bench() {
+	cout <<  "\n******************** hash bench **************************" << endl;
+	const size_t n = 1 << 20;
+	vector<Vec> vecs(n);
+	srand(2468);
+	for (size_t i = 0; i < n; ++i) {
+		// mesh like, a lot of shared coordinates
+		vecs[i] = Vec((rand() % 2000) * 0.01f, (rand() % 2000) * 0.01f, (rand() % 2000) * 0.01f);
+	}
+	Stopwatch sw;
+	size_t found = 0;
+	cout << n << " vectors:" << endl;
+
+	VecSet vset;
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		vset.insert(vecs[i]);
+	}
+	cout << "\tVecSet insert: " << sw.elapsed_ms() << " ms, " << vset.size() << " unique" << endl;
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		found += vset.count(vecs[n - 1 - i]);
+	}
+	cout << "\tVecSet lookup: " << sw.elapsed_ms() << " ms" << endl;
+
+	VecHashSet vhash;
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		vhash.insert(vecs[i]);
+	}
+	cout << "\tVecHashSet insert: " << sw.elapsed_ms() << " ms, " << vhash.size() << " unique" << endl;
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		found += vhash.count(vecs[n - 1 - i]);
+	}
+	cout << "\tVecHashSet lookup: " << sw.elapsed_ms() << " ms" << endl;
+
+	VecHashSet reserved;
+	reserved.reserve(n);
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		reserved.insert(vecs[i]);
+	}
+	cout << "\tVecHashSet insert, reserved: " << sw.elapsed_ms() << " ms" << endl;
+	if(found != 2 * n) {
+		cout << "!=: hash bench lookups: " << found << endl;
+	}
+	cout << "\n***************** Done:  hash bench ***********************" << endl;
+}
+
+// region growing, sorted id sets vs the old by value functions
+static void region_bench() {
+	cout <<  "\n******************** region bench **************************" << endl;
+	TestGrid grid(30);
+	Polygon *start = grid.face.polygons[0];
+	cout << grid.face.polygons.size() << " triangles in 2 regions:" << endl;
+	Stopwatch sw;
+	Region region(&grid.face);
+	grid.face.grow_region(region, start);
+	cout << "\tgrow_region: " << sw.elapsed_ms() << " ms, " << region.poly_ids.size() << " polys" << endl;
+	sw.reset();
+	vector<Polygon*> ref_region;
+	reference_grow(grid.face, ref_region, start);
+	cout << "\tby value reference: " << sw.elapsed_ms() << " ms, " << ref_region.size() << " polys" << endl;
+	cout << "\n***************** Done:  region bench ***********************" << endl;
+}
+
+// level of detail chains for the lotus seat and syllables, each level's build
+// time is the chain with it less the chain without
+static void lod_bench() {
+	cout <<  "\n******************** lod bench **************************" << endl;
+	GLMmodel *model = glmReadOBJ((char*)"data/lotus_moon_seat.obj");
+	glmFacetNormals(model);
+	glmVertexNormals(model, 90.0);
+	DrGlmModel lotus;
+	lotus.init(model);
+	cout << "lotus seat:" << endl;
+	double prev_ms = 0;
+	for (size_t levels = 1; levels <= 6; ++levels) {
+		Stopwatch sw;
+		lotus.build_lods(0.5f, levels);
+		double ms = sw.elapsed_ms();
+		if(lotus.num_lods() < levels) {
+			break;
+		}
+		const LodLevel& l = lotus.get_lod_level(levels - 1);
+		cout << "\tlevel " << levels - 1 << ": " << l.num_triangles() << " triangles, error "
+				<< l.error << ", " << ms - prev_ms << " ms" << endl;
+		prev_ms = ms;
+	}
+	glmDelete(model);
+
+	const char *names[] = { "om", "ma", "ni", "pay", "may", "hung", "hrih" };
+	vector<Syllable3D*> sylls;
+	for (size_t i = 0; i < sizeof(names)/sizeof(names[0]); ++i) {
+		sylls.push_back(lod_syllable(names[i]));
+	}
+	cout << "syllables, all " << sylls.size() << ":" << endl;
+	prev_ms = 0;
+	for (size_t levels = 1; levels <= 5; ++levels) {
+		size_t tris = 0, have = 0;
+		GLfloat error = 0;
+		Stopwatch sw;
+		for (size_t i = 0; i < sylls.size(); ++i) {
+			sylls[i]->build_lods(0.5f, levels);
+		}
+		double ms = sw.elapsed_ms();
+		for (size_t i = 0; i < sylls.size(); ++i) {
+			// syllables out of levels count at their coarsest
+			const Syllable3D::Lod& l = sylls[i]->get_lod_level(min(levels, sylls[i]->num_lods()) - 1);
+			have += sylls[i]->num_lods() >= levels ? 1 : 0;
+			tris += l.num_triangles();
+			error = max(error, l.base.error);
+		}
+		if(!have) {
+			break;
+		}
+		cout << "\tlevel " << levels - 1 << ": " << tris << " triangles, max error " << error
+				<< ", " << ms - prev_ms << " ms, " << have << " syllables at this level" << endl;
+		prev_ms = ms;
+	}
+	for (size_t i = 0; i < sylls.size(); ++i) {
+		delete sylls[i];
+	}
+	cout << "\n***************** Done:  lod bench ***********************" << endl;
+}
+
+// the mantra ring of syllables seen orbiting around it, with and without
+// backface culling of meshlets
+static void cull_bench() {
+	cout <<  "\n******************** cull bench **************************" << endl;
+	const char *names[] = { "pay", "ni", "ma", "om", "hung", "may" };
+	const size_t num = sizeof(names)/sizeof(names[0]);
+	vector<Syllable3D*> sylls;
+	for (size_t i = 0; i < num; ++i) {
+		Syllable3D *syll = lod_syllable(names[i]);
+		// stood up facing out, on a circle like the cylinder
+		syll->bake_transform(linalg::Mat4f::rotate(360.0f * i / num, 0, 1, 0) *
+				linalg::Mat4f::translate(0, 0, 3.5f) * linalg::Mat4f::rotate(90, 1, 0, 0));
+		syll->build_meshlets();
+		sylls.push_back(syll);
+		size_t verts = 0, tris = 0, count = 0;
+		for (int s = 0; s < 3; ++s) {
+			const MeshletSet& ms = syll->get_meshlets(s);
+			count += ms.size();
+			verts += ms.vertices.size();
+			tris += ms.num_triangles();
+		}
+		cout << names[i] << ": " << count << " meshlets, " << tris << " triangles, "
+				<< (GLfloat)verts / count << " vertices and " << (GLfloat)tris / count << " triangles per meshlet" << endl;
+	}
+	// rays from outside the ring at its middle
+	const int rays = 1000;
+	int hits = 0;
+	Stopwatch pick_sw;
+	for (int r = 0; r < rays; ++r) {
+		GLfloat a = 2 * M_PI * r / rays;
+		linalg::Vec3f origin(10 * sin(a), 0.3f * (r % 7 - 3), 10 * cos(a));
+		for (size_t i = 0; i < sylls.size(); ++i) {
+			int surface;
+			GLfloat dist;
+			hits += sylls[i]->pick(origin, -origin, surface, dist) >= 0 ? 1 : 0;
+		}
+	}
+	cout << "pick: " << hits << " hits of " << rays * num << " rays at syllables, "
+			<< 1000 * pick_sw.elapsed_ms() / (rays * num) << " us per ray" << endl;
+	linalg::Mat4f proj = linalg::Mat4f::perspective(65, 4.0f / 3, 1, 30);
+	const int frames = 72;
+	// whole ring in view, and zoomed in to the near side
+	const GLfloat distances[] = { 9, 4 };
+	for (int d = 0; d < 2; ++d) {
+		for (int backface = 0; backface < 2; ++backface) {
+			CullStats total;
+			Stopwatch sw;
+			for (int f = 0; f < frames; ++f) {
+				linalg::Mat4f view = linalg::Mat4f::translate(0, 0, -distances[d]) * linalg::Mat4f::rotate(20, 1, 0, 0)
+						* linalg::Mat4f::rotate(360.0f * f / frames, 0, 1, 0);
+				Frustum frustum(proj * view);
+				linalg::Vec3f eye = eye_position(view);
+				for (size_t i = 0; i < sylls.size(); ++i) {
+					sylls[i]->cull(frustum, eye, backface, total);
+				}
+			}
+			double ms = sw.elapsed_ms();
+			cout << "distance " << distances[d] << (backface ? ", frustum and backface" : ", frustum only")
+					<< ", " << frames << " frames:" << endl
+					<< "\t" << total << endl
+					<< "\tper frame: " << total.polygons_drawn / frames << " of " << total.polygons / frames
+					<< " polygons, " << 1000 * ms / frames << " us" << endl;
+		}
+	}
+	for (size_t i = 0; i < sylls.size(); ++i) {
+		delete sylls[i];
+	}
+	cout << "\n***************** Done:  cull bench ***********************" << endl;
+}
+
+/**
+ * Post transform cache use of the full mesh of model, a fifo of 16, with
+ * triangles as loaded, optimized, and optimized in meshlets.
+ */
+template<class Model>
+static void report_cache(Model& model, const char *what) {
+	model.build_buffers(false);
+	const MeshBuffer *mb = model.get_buffer(0);
+	VertexCacheStats loaded = mb->cache_stats();
+	Stopwatch sw;
+	model.build_buffers(true);
+	double ms = sw.elapsed_ms();
+	VertexCacheStats optimized = model.get_buffer(0)->cache_stats();
+	model.build_meshlets();
+	mb = model.get_buffer(0);
+	cout << "\t" << what << ": " << mb->num_triangles() << " triangles, " << mb->num_vertices() << " vertices" << endl
+			<< "\t\tas loaded:   " << loaded << endl
+			<< "\t\toptimized:   " << optimized << ", " << ms << " ms to build" << endl
+			<< "\t\tin meshlets: " << mb->cache_stats() << ", " << mb->num_ranges() << " ranges" << endl;
+}
+
+// every model in data, and the syllables built from them
+static void vcache_bench() {
+	cout <<  "\n******************** vcache bench **************************" << endl;
+	vector<string> names;
+	DIR *dir = opendir("data");
+	if(!dir) {
+		cout << "no data directory" << endl;
+		return;
+	}
+	for (dirent *e = readdir(dir); e; e = readdir(dir)) {
+		string name = e->d_name;
+		if(name.size() > 4 && name.compare(name.size() - 4, 4, ".obj") == 0) {
+			names.push_back(name.substr(0, name.size() - 4));
+		}
+	}
+	closedir(dir);
+	sort(names.begin(), names.end());
+	const char *syllables[] = { "om", "ma", "ni", "pay", "may", "hung", "hrih" };
+	const char **syllables_end = syllables + sizeof(syllables)/sizeof(syllables[0]);
+	for (size_t i = 0; i < names.size(); ++i) {
+		cout << names[i] << ".obj:" << endl;
+		string path = "data/" + names[i] + ".obj";
+		streambuf *saved_buf = cout.rdbuf();
+		ostringstream chatter;
+		cout.rdbuf(chatter.rdbuf());
+		GLMmodel *glm_model = glmReadOBJ((char*)path.c_str());
+		glmFacetNormals(glm_model);
+		glmVertexNormals(glm_model, 90.0);
+		DrGlmModel model;
+		model.init(glm_model);
+		glmDelete(glm_model);
+		cout.rdbuf(saved_buf);
+		report_cache(model, "model");
+		if(find(syllables, syllables_end, names[i]) != syllables_end) {
+			Syllable3D *syll = lod_syllable(names[i].c_str());
+			report_cache(*syll, "extruded syllable");
+			delete syll;
+		}
+	}
+	cout << "\n***************** Done:  vcache bench ***********************" << endl;
+}
+
+// laying the heads up display out every frame against keeping the runs
+static void hud_bench() {
+	cout <<  "\n******************** hud bench **************************" << endl;
+	GlyphAtlas atlas;
+	vector<unsigned char> box(12 * 29, 255);
+	for (int c = GlyphAtlas::FIRST_CHAR; c <= GlyphAtlas::LAST_CHAR; ++c) {
+		atlas.add_glyph(c, 12, 29, 1, 7, 10 + c % 4, &box[0]);
+	}
+	atlas.finish();
+	// about what show_mantra shows with the keybindings up
+	vector<string> lines;
+	for (int i = 0; i < 20; ++i) {
+		lines.push_back("x    toggle showing something on the screen");
+	}
+	lines.push_back("Framerate: 59.94");
+	lines.push_back("Drawn: 5257/8775 polys, 9/9 objects");
+	size_t chars = 0;
+	for (size_t i = 0; i < lines.size(); ++i) {
+		chars += lines[i].size();
+	}
+	const int frames = 20000;
+	HudText hud(atlas);
+	size_t quads = 0;
+	Stopwatch sw;
+	for (int f = 0; f < frames; ++f) {
+		hud.clear();
+		for (size_t i = 0; i < lines.size(); ++i) {
+			hud.set_text(i, 20, 780 - 36 * i, lines[i]);
+		}
+		quads += hud.num_quads();
+	}
+	double every_ms = sw.elapsed_ms();
+	HudText kept(atlas);
+	sw.reset();
+	for (int f = 0; f < frames; ++f) {
+		for (size_t i = 0; i < lines.size(); ++i) {
+			kept.set_text(i, 20, 780 - 36 * i, lines[i]);
+		}
+		quads += kept.num_quads();
+	}
+	double kept_ms = sw.elapsed_ms();
+	cout << lines.size() << " lines, " << chars << " chars, " << quads / (2 * frames) << " quads" << endl;
+	cout << "\tgl calls per frame, glutBitmapCharacter: " << chars + lines.size() << ", atlas: 1" << endl;
+	cout << "\tlaid out every frame: " << 1000 * every_ms / frames << " us per frame" << endl;
+	cout << "\tkept runs: " << 1000 * kept_ms / frames << " us per frame, "
+			<< kept.num_layouts() << " layouts in " << frames << " frames" << endl;
+	cout << "\n***************** Done:  hud bench ***********************" << endl;
+}
+
+struct Bench {
+	const char *name;
+	void (*run)();
+};
+
+static const Bench benches[] = {
+		{ "noise", &NoiseEngine::bench },
+		{ "transform", &transform_bench },
+		{ "mesh", &Syllable3D::bench },
+		{ "alloc", &alloc_bench },
+		{ "hash", &hash_bench },
+		{ "region", &region_bench },
+		{ "cdt", &CDT::bench },
+		{ "lod", &lod_bench },
+		{ "cull", &cull_bench },
+		{ "vcache", &vcache_bench },
+		{ "hud", &hud_bench },
+};
+
+void DR::bench(const string& which) {
+	bool found = false;
+	for (size_t i = 0; i < sizeof(benches)/sizeof(benches[0]); ++i) {
+		if(which.empty() || which == benches[i].name) {
+			benches[i].run();
+			found = true;
+		}
+	}
+	if(!found) {
+		cout << "no benchmark named " << which << ", have:";
+		for (size_t i = 0; i < sizeof(benches)/sizeof(benches[0]); ++i) {
+			cout << " " << benches[i].name;
+		}
+		cout << endl;
+	}
+}
+
 vec3 vecs[] = { {0, 4, 0}, {3, 0, 0}, {0, 0, 5},
 			{-4, 2, 1}, {-6, -2, 1}, {2, -2, 1}, {2, 2, 1} };
 vec3 norms[] = { {0, 1, 0}, {0, 1, 0}, {0, 1, 0},
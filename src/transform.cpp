@@ -0,0 +1,250 @@
+/*
+ * transform.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "transform.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+using namespace std;
+using namespace DR;
+using linalg::Mat4f;
+using linalg::Vec3f;
+
+// below this many vectors per thread, threads cost more than they save
+static const size_t MIN_PER_THREAD = 1 << 14;
+
+Mat4f DR::normal_matrix(const Mat4f& m) {
+	Mat4f upper = Mat4f::identity(), inv;
+	for (int c = 0; c < 3; ++c) {
+		for (int r = 0; r < 3; ++r) {
+			upper(r, c) = m(r, c);
+		}
+	}
+	if(!upper.inverse(inv)) {
+		return upper;
+	}
+	return inv.transposed();
+}
+
+GLfloat DR::max_scale(const Mat4f& m) {
+	GLfloat scale = 0;
+	for (int c = 0; c < 3; ++c) {
+		scale = max(scale, (GLfloat)sqrt(m(0, c) * m(0, c) + m(1, c) * m(1, c) + m(2, c) * m(2, c)));
+	}
+	return scale;
+}
+
+#if defined(__SSE2__)
+// low 3 lanes of r to out, leaves out[3] alone
+static inline void store3(GLfloat *out, __m128 r) {
+	_mm_storel_pi((__m64*)out, r);
+	_mm_store_ss(out + 2, _mm_movehl_ps(r, r));
+}
+#endif
+
+static void points_range(const Mat4f& m, const vec3 *in, vec3 *out, size_t begin, size_t end) {
+#if defined(__SSE2__)
+	__m128 c0 = _mm_loadu_ps(m.m), c1 = _mm_loadu_ps(m.m + 4),
+			c2 = _mm_loadu_ps(m.m + 8), c3 = _mm_loadu_ps(m.m + 12);
+	for (size_t i = begin; i < end; ++i) {
+		const GLfloat *p = in[i];
+		__m128 r = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(p[0])));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+		store3(out[i], r);
+	}
+#else
+	for (size_t i = begin; i < end; ++i) {
+		linalg::as_vec3(out[i]) = m.transform_point(linalg::as_vec3(in[i]));
+	}
+#endif
+}
+
+// nm is the normal matrix, its 4th row and column are 0 apart from [15]
+static void normals_range(const Mat4f& nm, const vec3 *in, vec3 *out, size_t begin, size_t end) {
+#if defined(__SSE2__)
+	__m128 c0 = _mm_loadu_ps(nm.m), c1 = _mm_loadu_ps(nm.m + 4),
+			c2 = _mm_loadu_ps(nm.m + 8);
+	for (size_t i = begin; i < end; ++i) {
+		const GLfloat *n = in[i];
+		__m128 r = _mm_mul_ps(c0, _mm_set1_ps(n[0]));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(n[1])));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(n[2])));
+		// length^2 from the 3 used lanes, lane 3 is 0
+		__m128 sq = _mm_mul_ps(r, r);
+		sq = _mm_add_ps(sq, _mm_movehl_ps(sq, sq));
+		sq = _mm_add_ss(sq, _mm_shuffle_ps(sq, sq, 1));
+		__m128 len = _mm_sqrt_ss(sq);
+		if(_mm_cvtss_f32(len) > 0.0f) {
+			r = _mm_div_ps(r, _mm_shuffle_ps(len, len, 0));
+		}
+		store3(out[i], r);
+	}
+#else
+	for (size_t i = begin; i < end; ++i) {
+		linalg::as_vec3(out[i]) = linalg::normalized(nm.transform_dir(linalg::as_vec3(in[i])));
+	}
+#endif
+}
+
+typedef void (*RangeFn)(const Mat4f&, const vec3*, vec3*, size_t, size_t);
+
+// splits [0, count) over threads
+static void run_range(RangeFn fn, const Mat4f& m, const vec3 *in, vec3 *out,
+		size_t count, int threads) {
+	if(threads <= 0) {
+		threads = max(1u, std::thread::hardware_concurrency());
+	}
+	threads = (int)min((size_t)threads, max((size_t)1, count / MIN_PER_THREAD));
+	if(threads == 1) {
+		fn(m, in, out, 0, count);
+		return;
+	}
+	vector<std::thread> workers;
+	for (int t = 1; t < threads; ++t) {
+		size_t begin = count * t / threads, end = count * (t + 1) / threads;
+		workers.push_back(std::thread(fn, std::cref(m), in, out, begin, end));
+	}
+	fn(m, in, out, 0, count / threads);
+	for (size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+}
+
+void DR::transform_points(const Mat4f& m, const vec3 *in, vec3 *out,
+		size_t count, int threads) {
+	run_range(&points_range, m, in, out, count, threads);
+}
+
+void DR::transform_normals(const Mat4f& m, const vec3 *in, vec3 *out,
+		size_t count, int threads) {
+	run_range(&normals_range, normal_matrix(m), in, out, count, threads);
+}
+
+// uniform random float in [lo, hi)
+static float frand(float lo, float hi) {
+	return lo + (hi - lo) * (rand() / (RAND_MAX + 1.0f));
+}
+
+static bool near3(const GLfloat *a, const GLfloat *b, GLfloat tol=1e-4f) {
+	return fabs(a[0] - b[0]) <= tol && fabs(a[1] - b[1]) <= tol && fabs(a[2] - b[2]) <= tol;
+}
+
+// the seed syllable placement, non uniform scale to exercise the normal matrix
+static Mat4f test_matrix() {
+	return Mat4f::rotate(90, 1, 0, 0) * Mat4f::translate(0.25f, 0.2f, -0.5f) *
+			Mat4f::rotate(-30, 0, 0, 1) * Mat4f::scale(2.5f, 1.5f, 0.5f);
+}
+
+void DR::transform_test() {
+	cout <<  "\n******************** transform_test() **************************" << endl;
+	const size_t n = 3 * MIN_PER_THREAD + 7;
+	vector<GLfloat> in(3 * n), out(3 * n), threaded(3 * n);
+	srand(1234);
+	for (size_t i = 0; i < in.size(); ++i) {
+		in[i] = frand(-5, 5);
+	}
+	Mat4f m = test_matrix();
+	const vec3 *vin = (const vec3*)&in[0];
+
+	transform_points(m, vin, (vec3*)&out[0], n, 1);
+	for (size_t i = 0; i < n; ++i) {
+		vec3 ref;
+		transform_vec(ref, &in[3*i], m.m);
+		if(!near3(ref, &out[3*i])) {
+			cout << "!=: transform_points " << i << ": " << stringv(ref) << " vs "
+					<< stringv(&out[3*i]) << endl;
+			break;
+		}
+	}
+	transform_points(m, vin, (vec3*)&threaded[0], n, 4);
+	if(threaded != out) {
+		cout << "!=: transform_points threaded" << endl;
+	}
+	// in place
+	threaded = in;
+	transform_points(m, (const vec3*)&threaded[0], (vec3*)&threaded[0], n);
+	if(threaded != out) {
+		cout << "!=: transform_points in place" << endl;
+	}
+
+	// a transformed triangle's facet normal matches its transformed normal
+	vec3 tri[3] = { {0, 0, 0}, {1, 0.2f, 0}, {0.3f, 1, 0.4f} }, ttri[3];
+	Vec3f e1 = linalg::as_vec3(tri[1]) - linalg::as_vec3(tri[0]);
+	Vec3f e2 = linalg::as_vec3(tri[2]) - linalg::as_vec3(tri[0]);
+	vec3 fnorm, tnorm;
+	linalg::as_vec3(fnorm) = linalg::normalized(linalg::cross(e1, e2));
+	transform_points(m, tri, ttri, 3);
+	transform_normals(m, &fnorm, &tnorm, 1);
+	Vec3f te1 = linalg::as_vec3(ttri[1]) - linalg::as_vec3(ttri[0]);
+	Vec3f te2 = linalg::as_vec3(ttri[2]) - linalg::as_vec3(ttri[0]);
+	Vec3f expect = linalg::normalized(linalg::cross(te1, te2));
+	if(!near3(expect.data(), tnorm)) {
+		cout << "!=: transform_normals: " << expect << " vs " << stringv(tnorm) << endl;
+	}
+	transform_normals(m, vin, (vec3*)&out[0], n, 1);
+	transform_normals(m, vin, (vec3*)&threaded[0], n, 4);
+	if(threaded != out) {
+		cout << "!=: transform_normals threaded" << endl;
+	}
+	for (size_t i = 0; i < n; ++i) {
+		if(fabs(linalg::length(linalg::as_vec3(&out[3*i])) - 1.0f) > 1e-5f) {
+			cout << "!=: transform_normals not unit length at " << i << endl;
+			break;
+		}
+	}
+	if(fabs(max_scale(m) - 2.5f) > 1e-5f) {
+		cout << "!=: max_scale " << max_scale(m) << " vs 2.5" << endl;
+	}
+	cout << "\n***************** Done:  transform_test() ***********************" << endl;
+}
+
+static void print_rate(const char *what, size_t n, double ms) {
+	cout << "\t" << what << ": " << ms << " ms, " << (n / ms / 1000.0) << " M/s" << endl;
+}
+
+void DR::transform_bench() {
+	cout <<  "\n******************** transform_bench() **************************" << endl;
+	const size_t n = 1 << 20;
+	vector<GLfloat> in(3 * n), out(3 * n);
+	srand(4321);
+	for (size_t i = 0; i < in.size(); ++i) {
+		in[i] = frand(-5, 5);
+	}
+	Mat4f m = test_matrix();
+	const vec3 *vin = (const vec3*)&in[0];
+	vec3 *vout = (vec3*)&out[0];
+	Stopwatch sw;
+
+	cout << n << " vectors:" << endl;
+	sw.reset();
+	for (size_t i = 0; i < n; ++i) {
+		transform_vec(vout[i], vin[i], m.m);
+	}
+	print_rate("transform_vec loop", n, sw.elapsed_ms());
+	sw.reset();
+	transform_points(m, vin, vout, n, 1);
+	print_rate("transform_points, 1 thread", n, sw.elapsed_ms());
+	sw.reset();
+	transform_points(m, vin, vout, n, 0);
+	print_rate("transform_points, all cores", n, sw.elapsed_ms());
+	sw.reset();
+	transform_normals(m, vin, vout, n, 1);
+	print_rate("transform_normals, 1 thread", n, sw.elapsed_ms());
+	sw.reset();
+	transform_normals(m, vin, vout, n, 0);
+	print_rate("transform_normals, all cores", n, sw.elapsed_ms());
+	cout << "\n***************** Done:  transform_bench() ***********************" << endl;
+}
@@ -0,0 +1,165 @@
+/*
+ * uniform_blocks.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "uniform_blocks.h"
+#include "shader_variants.h"
+#include "linalg.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+void Std140Packer::pad_to(size_t align) {
+	bytes.resize((bytes.size() + align - 1) / align * align, 0);
+}
+
+size_t Std140Packer::add(const void *p, size_t n, size_t align) {
+	pad_to(align);
+	size_t offset = bytes.size();
+	bytes.resize(offset + n);
+	memcpy(&bytes[offset], p, n);
+	return offset;
+}
+
+size_t Std140Packer::add_float(GLfloat f) {
+	return add(&f, sizeof(f), 4);
+}
+
+size_t Std140Packer::add_int(GLint i) {
+	return add(&i, sizeof(i), 4);
+}
+
+size_t Std140Packer::add_vec(const GLfloat *v, int n) {
+	return add(v, n * sizeof(GLfloat), n == 2 ? 8 : n == 1 ? 4 : 16);
+}
+
+size_t Std140Packer::add_mat4(const GLfloat *m) {
+	size_t offset = add_vec(m, 4);
+	for (int c = 1; c < 4; ++c) {
+		add_vec(m + 4 * c, 4);
+	}
+	return offset;
+}
+
+void DR::pack_lights(Std140Packer& p, const vector<const GLlight*>& lights,
+		const GLfloat *scene_ambient, const GLfloat *view) {
+	using DR::linalg::Vec4f;
+	using DR::linalg::as_mat4;
+	using DR::linalg::as_vec4;
+	vec4 zero = {0, 0, 0, 0};
+	for (int i = 0; i < ShaderVariant::MAX_LIGHTS; ++i) {
+		p.align_struct();
+		if(i >= (int)lights.size()) {
+			for (int k = 0; k < 5; ++k) {
+				p.add_vec(zero, 4);
+			}
+			continue;
+		}
+		const GLlight *l = lights[i];
+		Vec4f eye = as_mat4(view) * as_vec4(l->pos);
+		// toward the light, plus toward the viewer
+		vec4 half = {eye[0], eye[1], eye[2], 0};
+		if(eye[3] != 0) {
+			// positional, as seen from the origin
+			for (int k = 0; k < 3; ++k) {
+				half[k] /= eye[3];
+			}
+		}
+		normalize(half);
+		half[2] += 1;
+		normalize(half);
+		p.add_vec(&eye[0], 4);
+		p.add_vec(half, 4);
+		p.add_vec(l->ambient, 4);
+		p.add_vec(l->diffuse, 4);
+		p.add_vec(l->specular, 4);
+	}
+	p.align_struct();
+	p.add_vec(scene_ambient, 4);
+}
+
+void DR::pack_material(Std140Packer& p, const GLfloat *ambient, const GLfloat *diffuse,
+		const GLfloat *specular, const GLfloat *emission, GLfloat shininess) {
+	p.align_struct();
+	p.add_vec(ambient, 4);
+	p.add_vec(diffuse, 4);
+	p.add_vec(specular, 4);
+	p.add_vec(emission, 4);
+	p.add_float(shininess);
+	p.align_struct();
+}
+
+UniformBuffer::~UniformBuffer() {
+	if(buffer) {
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+bool UniformBuffer::upload(const Std140Packer& p) {
+	const vector<unsigned char>& bytes = p.get_bytes();
+	// held has zeros past bytes, as the block would
+	if(buffer && held.size() == p.size() && std::equal(bytes.begin(), bytes.end(), held.begin())) {
+		return false;
+	}
+	if(!buffer) {
+		glGenBuffers(1, &buffer);
+	}
+	bool same_size = held.size() == p.size();
+	held.assign(bytes.begin(), bytes.end());
+	held.resize(p.size(), 0);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	if(same_size) {
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, held.size(), &held[0]);
+	} else {
+		glBufferData(GL_UNIFORM_BUFFER, held.size(), &held[0], GL_DYNAMIC_DRAW);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	++uploads;
+	return true;
+}
+
+void UniformBuffer::bind(GLuint binding) const {
+	glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+}
+
+void DR::bind_uniform_blocks(GLuint program) {
+	const char *names[] = { "Lights", "Material" };
+	GLuint bindings[] = { LIGHTS_BINDING, MATERIAL_BINDING };
+	for (int i = 0; i < 2; ++i) {
+		GLuint index = glGetUniformBlockIndex(program, names[i]);
+		if(index != GL_INVALID_INDEX) {
+			glUniformBlockBinding(program, index, bindings[i]);
+		}
+	}
+}
+
+static bool use_material_blocks = false;
+
+void DR::set_material_blocks(bool on) {
+	use_material_blocks = on;
+}
+
+bool DR::material_blocks() {
+	return use_material_blocks;
+}
+
+void DR::apply_material(UniformBuffer& block, const GLfloat *ambient_diffuse, const GLfloat *specular,
+		const GLfloat *shininess, const GLfloat *emission) {
+	if(!use_material_blocks) {
+		glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, ambient_diffuse);
+		glMaterialfv(GL_FRONT, GL_SPECULAR, specular);
+		glMaterialfv(GL_FRONT, GL_SHININESS, shininess);
+		glMaterialfv(GL_FRONT, GL_EMISSION, emission);
+		return;
+	}
+	// packed each draw to see if it changed, cheaper than the state it replaces
+	Std140Packer& p = block.packer();
+	pack_material(p, ambient_diffuse, ambient_diffuse, specular, emission, shininess[0]);
+	block.upload(p);
+	block.bind(MATERIAL_BINDING);
+}
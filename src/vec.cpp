@@ -8,7 +8,9 @@
  */
 
 #include "vec.h"
+#include "linalg.h"
 #include <cstdlib>
+#include <cassert>
 #include <sstream>
 #include <iostream>
 #include <cmath>
@@ -70,17 +72,10 @@ void Vec::normalize() {
 	}
 }
 // subscript
-// calls exit if bad index
-GLfloat Vec::operator[](GLint index) {
-	switch(index) {
-	case 0: return x;
-	case 1: return y;
-	case 2: return z;
-	default: // bad index, don't want to go unnoticed
-		cerr << "Vec: subscript out of range: " << index << endl
-			<< "vec = " << to_string() << endl;
-		exit(1);
-	}
+// bad index asserts in debug builds
+GLfloat Vec::operator[](GLint index) const {
+	assert(index >= 0 && index < 3);
+	return index == 0 ? x : (index == 1 ? y : z);
 }
 /**
  * Cross product of this vector and v.
@@ -89,14 +84,6 @@ Vec Vec::cross(const Vec& v) const {
 	return Vec(y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x);
 }
 
-const Vec& Vec::operator =(const Vec& other_vec) {
-	if(&other_vec != this) {
-		x = other_vec.x;
-		y = other_vec.y;
-		z = other_vec.z;
-	}
-	return *this;
-}
 const Vec& Vec::operator=(const GLfloat other[3]) {
 	x = other[0];
 	y = other[1];
@@ -150,23 +137,8 @@ Vec DR::operator*(Vec vec, GLfloat scalar) {
 }
 // transforms Vec by multiplying p by submat[3x3]
 Vec DR::operator*(GLfloat matrix[16], Vec p) {
-	GLfloat ret[3] = {0, 0, 0};
-	for (int i = 0; i < 3; ++i) {
-		for (int j = 0; j < 3; ++j) {
-			ret[i] += matrix[i+4*j] * p[j];
-		}
-	}
-//	Vec vp = p.vec();
-//	Vec mvec[3];
-//	for (int i = 0; i < 3; ++i) {
-//		mvec[i] = Vec(matrix[i*4], matrix[i*4+1], matrix[i*4+2]);
-//	}
-//
-//	for (int i = 0; i < 3; ++i) {
-//		ret[i] = mvec[i].dot(vp);
-//	}
-	return Vec(ret);
-
+	linalg::Vec3f v(p.x, p.y, p.z);
+	return Vec(linalg::as_mat4(matrix).transform_dir(v).data());
 }
 
 GLfloat DR::dist(Vec pt1, Vec pt2) {
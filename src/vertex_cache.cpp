@@ -0,0 +1,166 @@
+/*
+ * vertex_cache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "vertex_cache.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+using namespace DR;
+
+ostream& DR::operator<<(ostream& out, const VertexCacheStats& s) {
+	out << "acmr " << s.acmr << ", atvr " << s.atvr;
+	return out;
+}
+
+// Forsyth's constants
+static const GLfloat CACHE_DECAY_POWER = 1.5f;
+static const GLfloat LAST_TRI_SCORE = 0.75f;
+static const GLfloat VALENCE_BOOST_SCALE = 2.0f;
+static const GLfloat VALENCE_BOOST_POWER = 0.5f;
+
+// higher is better to use next, -1 once nothing uses it
+static GLfloat vertex_score(GLint cache_pos, GLuint live, size_t cache_size) {
+	if(live == 0) {
+		return -1;
+	}
+	GLfloat score = 0;
+	if(cache_pos >= 0) {
+		// the last triangle's vertices are all equally good
+		score = cache_pos < 3 ? LAST_TRI_SCORE :
+				pow(1 - (GLfloat)(cache_pos - 3) / (cache_size - 3), CACHE_DECAY_POWER);
+	}
+	// finish off vertices with few triangles left, rather than strand them
+	return score + VALENCE_BOOST_SCALE * pow((GLfloat)live, -VALENCE_BOOST_POWER);
+}
+
+void DR::optimize_vertex_cache(GLuint *indices, size_t num_indices, size_t num_verts, size_t cache_size) {
+	size_t num_tris = num_indices / 3;
+	if(num_tris < 2) {
+		return;
+	}
+	cache_size = max(cache_size, (size_t)4);
+	// live triangles of vertex v are tris[first[v] .. first[v] + live[v])
+	vector<GLuint> live(num_verts, 0), first(num_verts + 1, 0);
+	for (size_t i = 0; i < num_tris * 3; ++i) {
+		++live[indices[i]];
+	}
+	for (size_t v = 0; v < num_verts; ++v) {
+		first[v + 1] = first[v] + live[v];
+	}
+	vector<GLuint> tris(num_tris * 3), fill(first.begin(), first.end() - 1);
+	for (size_t i = 0; i < num_tris * 3; ++i) {
+		tris[fill[indices[i]]++] = i / 3;
+	}
+	vector<GLint> cache_pos(num_verts, -1);
+	vector<GLfloat> vscore(num_verts);
+	for (size_t v = 0; v < num_verts; ++v) {
+		vscore[v] = vertex_score(-1, live[v], cache_size);
+	}
+	vector<GLfloat> tscore(num_tris);
+	vector<bool> emitted(num_tris, false);
+	GLint best = 0;
+	for (size_t t = 0; t < num_tris; ++t) {
+		const GLuint *c = indices + 3 * t;
+		tscore[t] = vscore[c[0]] + vscore[c[1]] + vscore[c[2]];
+		if(tscore[t] > tscore[best]) {
+			best = t;
+		}
+	}
+	vector<GLuint> out, cache, next_cache;
+	out.reserve(num_tris * 3);
+	size_t cursor = 0;
+	while(best >= 0) {
+		const GLuint *c = indices + 3 * best;
+		out.insert(out.end(), c, c + 3);
+		emitted[best] = true;
+		// the triangle's vertices move to the front
+		next_cache.assign(c, c + 3);
+		for (size_t i = 0; i < cache.size(); ++i) {
+			if(cache[i] != c[0] && cache[i] != c[1] && cache[i] != c[2]) {
+				next_cache.push_back(cache[i]);
+			}
+		}
+		for (int k = 0; k < 3; ++k) {
+			GLuint v = c[k];
+			GLuint *vt = &tris[first[v]];
+			for (GLuint i = 0; i < live[v]; ++i) {
+				if(vt[i] == (GLuint)best) {
+					vt[i] = vt[--live[v]];
+					break;
+				}
+			}
+		}
+		for (size_t i = 0; i < next_cache.size(); ++i) {
+			GLuint v = next_cache[i];
+			cache_pos[v] = i < cache_size ? i : -1;
+			vscore[v] = vertex_score(cache_pos[v], live[v], cache_size);
+		}
+		// rescore what those vertices touch, the best of them goes next
+		best = -1;
+		GLfloat best_score = -1;
+		for (size_t i = 0; i < next_cache.size(); ++i) {
+			GLuint v = next_cache[i];
+			for (GLuint j = 0; j < live[v]; ++j) {
+				GLuint t = tris[first[v] + j];
+				const GLuint *tc = indices + 3 * t;
+				tscore[t] = vscore[tc[0]] + vscore[tc[1]] + vscore[tc[2]];
+				if(tscore[t] > best_score) {
+					best_score = tscore[t];
+					best = t;
+				}
+			}
+		}
+		if(next_cache.size() > cache_size) {
+			next_cache.resize(cache_size);
+		}
+		cache.swap(next_cache);
+		// nothing left near the cache, go on in the input order
+		if(best < 0) {
+			while(cursor < num_tris && emitted[cursor]) {
+				++cursor;
+			}
+			best = cursor < num_tris ? (GLint)cursor : -1;
+		}
+	}
+	copy(out.begin(), out.end(), indices);
+}
+
+size_t DR::optimize_vertex_fetch(GLuint *indices, size_t num_indices, size_t num_verts, vector<GLint>& remap) {
+	remap.assign(num_verts, -1);
+	size_t next = 0;
+	for (size_t i = 0; i < num_indices; ++i) {
+		GLuint v = indices[i];
+		if(remap[v] < 0) {
+			remap[v] = next++;
+		}
+		indices[i] = remap[v];
+	}
+	return next;
+}
+
+VertexCacheStats DR::analyze_vertex_cache(const GLuint *indices, size_t num_indices, size_t num_verts,
+		size_t cache_size) {
+	VertexCacheStats s;
+	// in the cache while fewer than cache_size misses since it went in
+	vector<size_t> stamp(num_verts, 0);
+	size_t time = cache_size + 1;
+	size_t used = 0;
+	for (size_t i = 0; i < num_indices; ++i) {
+		GLuint v = indices[i];
+		if(stamp[v] == 0) {
+			++used;
+		}
+		if(time - stamp[v] > cache_size) {
+			stamp[v] = time++;
+			++s.misses;
+		}
+	}
+	s.acmr = num_indices ? (GLfloat)s.misses / (num_indices / 3) : 0;
+	s.atvr = used ? (GLfloat)s.misses / used : 0;
+	return s;
+}